@@ -0,0 +1,463 @@
+/**
+ * @file board.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "casper/app/board.h"
+
+#include <unistd.h>   // getpid, close, ftruncate, unlink
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#include <sched.h>    // sched_yield
+#include <string.h>   // memcpy, memcmp, memset, strncpy
+
+#include <chrono> // std::chrono
+
+const char     casper::app::Board::k_magic_[4] = { 'C', 'M', 'S', 'B' };
+const uint32_t casper::app::Board::k_version_  = 1;
+
+// ... layout is shared by different processes, possibly built separately ...
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "unexpected std::atomic<uint32_t> size");
+static_assert(sizeof(casper::app::Board::Entry) == 256, "unexpected board entry size");
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::Board::Board ()
+{
+    fd_       = -1;
+    map_      = nullptr;
+    size_     = 0;
+    writable_ = false;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::Board::~Board ()
+{
+    Close();
+}
+
+#ifdef __APPLE__
+#pragma mark - Writer
+#endif
+
+/**
+ * @brief Create, or replace, a board.
+ *
+ * @param a_uri      Board file URI.
+ * @param a_capacity Maximum number of children.
+ *
+ * @return True on success, false otherwise - errno is set.
+ *
+ * @note A previous board is unlinked, not truncated, readers still mapping it won't crash.
+ */
+bool casper::app::Board::Create (const std::string& a_uri, const size_t a_capacity)
+{
+    Close();
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    (void)unlink(a_uri.c_str());
+    
+    // ... not inherited by children ...
+    const int fd = open(a_uri.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if ( -1 == fd ) {
+        return false;
+    }
+    
+    // ... zero filled ...
+    const size_t size = sizeof(Header) + a_capacity * sizeof(Slot);
+    if ( 0 != ftruncate(fd, static_cast<off_t>(size)) || false == Map(fd, size, /* a_writable */ true) ) {
+        const int error = errno;
+        close(fd);
+        (void)unlink(a_uri.c_str());
+        errno = error;
+        return false;
+    }
+    
+    Header* header = static_cast<Header*>(map_);
+    memcpy(header->magic_, k_magic_, sizeof(k_magic_));
+    header->version_   = k_version_;
+    header->capacity_  = static_cast<uint32_t>(a_capacity);
+    header->slot_size_ = static_cast<uint32_t>(sizeof(Slot));
+    header->count_     = 0;
+    header->pid_       = static_cast<int32_t>(getpid());
+    header->updated_   = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    
+    return true;
+}
+
+/**
+ * @brief Lay out board for a new set of children, children already known keep their entries.
+ *
+ * @param a_ids Children ids, children that don't fit are not published.
+ */
+void casper::app::Board::Reset (const std::vector<std::string>& a_ids)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if ( nullptr == map_ || false == writable_ ) {
+        return;
+    }
+    
+    Header* header = static_cast<Header*>(map_);
+    
+    std::vector<Entry>            entries;
+    std::map<std::string, size_t> index;
+    for ( const auto& id : a_ids ) {
+        if ( entries.size() >= static_cast<size_t>(header->capacity_) ) {
+            break;
+        }
+        const auto it = index_.find(id);
+        if ( index_.end() != it ) {
+            entries.push_back(entries_[it->second]);
+        } else {
+            Entry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.status_ = -1;
+            entry.state_  = static_cast<uint8_t>(State::Stopped);
+            strncpy(entry.id_, id.c_str(), sizeof(entry.id_) - 1);
+            entries.push_back(entry);
+        }
+        index[id] = entries.size() - 1;
+    }
+    entries_.swap(entries);
+    index_.swap(index);
+    
+    for ( size_t idx = 0 ; idx < entries_.size() ; ++idx ) {
+        Write(idx);
+    }
+    
+    // ... readers see new slots only when all of them are written ...
+    const uint32_t sequence = header->sequence_.load(std::memory_order_relaxed);
+    header->sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    header->count_    = static_cast<uint32_t>(entries_.size());
+    header->updated_  = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    header->sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Publish a child state.
+ *
+ * @param a_id       Child id.
+ * @param a_pid      Child pid, 0 when it's not running.
+ * @param a_state    Child state.
+ * @param a_restarts Number of restarts since it was loaded.
+ * @param a_started  When it was last spawned, in milliseconds since epoch, 0 when unknown.
+ */
+void casper::app::Board::Set (const std::string& a_id, const pid_t a_pid, const casper::app::Board::State a_state, const uint32_t a_restarts,
+                              const int64_t a_started)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = index_.find(a_id);
+    if ( index_.end() == it ) {
+        return;
+    }
+    Entry& entry = entries_[it->second];
+    entry.pid_      = static_cast<int32_t>(a_pid);
+    entry.state_    = static_cast<uint8_t>(a_state);
+    entry.restarts_ = a_restarts;
+    entry.started_  = a_started;
+    Write(it->second);
+}
+
+/**
+ * @brief Publish a child exit, it's live metrics are cleared.
+ *
+ * @param a_id        Child id.
+ * @param a_status    Exit status, -1 when it was signalled or it's unknown.
+ * @param a_signal    Signal that terminated it, 0 when none.
+ * @param a_reason    Human readable exit reason.
+ * @param a_timestamp When it was reaped, in milliseconds since epoch.
+ */
+void casper::app::Board::Exited (const std::string& a_id, const int a_status, const int a_signal, const std::string& a_reason, const int64_t a_timestamp)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = index_.find(a_id);
+    if ( index_.end() == it ) {
+        return;
+    }
+    Entry& entry = entries_[it->second];
+    entry.pid_       = 0;
+    entry.status_    = static_cast<int32_t>(a_status);
+    entry.signal_    = static_cast<int32_t>(a_signal);
+    entry.exited_    = a_timestamp;
+    // ... live metrics are only meaningful while it's running ...
+    entry.cpu_       = 0.0f;
+    entry.rss_       = 0;
+    entry.fds_       = 0;
+    entry.threads_   = 0;
+    entry.processes_ = 0;
+    memset(entry.reason_, 0, sizeof(entry.reason_));
+    strncpy(entry.reason_, a_reason.c_str(), sizeof(entry.reason_) - 1);
+    Write(it->second);
+}
+
+/**
+ * @brief Publish a child most recent resource usage sample.
+ *
+ * @param a_id        Child id.
+ * @param a_timestamp When it was sampled, in milliseconds since epoch.
+ * @param a_cpu       CPU usage, 100 is one core.
+ * @param a_rss       Resident set size, in bytes.
+ * @param a_fds       Number of open file descriptors.
+ * @param a_threads   Number of threads.
+ * @param a_processes Number of processes.
+ */
+void casper::app::Board::Measure (const std::string& a_id, const int64_t a_timestamp, const float a_cpu, const uint64_t a_rss,
+                                  const uint32_t a_fds, const uint32_t a_threads, const uint32_t a_processes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = index_.find(a_id);
+    if ( index_.end() == it ) {
+        return;
+    }
+    Entry& entry = entries_[it->second];
+    entry.sampled_   = a_timestamp;
+    entry.cpu_       = a_cpu;
+    entry.rss_       = a_rss;
+    entry.fds_       = a_fds;
+    entry.threads_   = a_threads;
+    entry.processes_ = a_processes;
+    Write(it->second);
+}
+
+#ifdef __APPLE__
+#pragma mark - Reader
+#endif
+
+/**
+ * @brief Map an existing board, read only.
+ *
+ * @param a_uri Board file URI.
+ *
+ * @return True on success, false when it does not exist or it's not a board - errno is set.
+ */
+bool casper::app::Board::Open (const std::string& a_uri)
+{
+    Close();
+    
+    const int fd = open(a_uri.c_str(), O_RDONLY | O_CLOEXEC);
+    if ( -1 == fd ) {
+        return false;
+    }
+    
+    struct stat info;
+    if ( 0 != fstat(fd, &info) || static_cast<size_t>(info.st_size) < sizeof(Header) ) {
+        close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    
+    if ( false == Map(fd, static_cast<size_t>(info.st_size), /* a_writable */ false) ) {
+        const int error = errno;
+        close(fd);
+        errno = error;
+        return false;
+    }
+    
+    const Header* header = static_cast<const Header*>(map_);
+    if ( 0 != memcmp(header->magic_, k_magic_, sizeof(k_magic_)) || k_version_ != header->version_ || sizeof(Slot) != header->slot_size_
+        || size_ < sizeof(Header) + static_cast<size_t>(header->capacity_) * sizeof(Slot) ) {
+        Close();
+        errno = EINVAL;
+        return false;
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Read a consistent copy of all entries, without ever blocking the writer.
+ *
+ * @param o_entries Entries, in 'monitor' launch order.
+ * @param o_pid     Writer pid, 0 when it's gone and entries are no longer updated.
+ *
+ * @return True on success, false when board is not mapped or an entry was being written for too long.
+ */
+bool casper::app::Board::Read (std::vector<casper::app::Board::Entry>& o_entries, pid_t& o_pid) const
+{
+    const size_t k_max_attempts = 10000;
+    
+    o_entries.clear();
+    
+    if ( nullptr == map_ ) {
+        return false;
+    }
+    
+    const Header* header = static_cast<const Header*>(map_);
+    
+    // ... sequence lock reader: copy, then check nothing was written meanwhile ...
+    const auto read = [k_max_attempts] (const std::atomic<uint32_t>& a_sequence, const void* a_from, void* o_to, const size_t a_length) -> bool {
+        for ( size_t attempt = 0 ; attempt < k_max_attempts ; ++attempt ) {
+            const uint32_t before = a_sequence.load(std::memory_order_acquire);
+            if ( 0 != ( before & 1 ) ) {
+                sched_yield();
+                continue;
+            }
+            memcpy(o_to, a_from, a_length);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ( before == a_sequence.load(std::memory_order_relaxed) ) {
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    uint32_t count = 0;
+    int32_t  pid   = 0;
+    {
+        // ... count_ and pid_ are adjacent, both protected by header sequence lock ...
+        struct {
+            uint32_t count_;
+            int32_t  pid_;
+        } copy;
+        if ( false == read(header->sequence_, &header->count_, &copy, sizeof(copy)) ) {
+            return false;
+        }
+        count = ( copy.count_ > header->capacity_ ? header->capacity_ : copy.count_ );
+        pid   = copy.pid_;
+    }
+    
+    o_entries.resize(static_cast<size_t>(count));
+    for ( uint32_t idx = 0 ; idx < count ; ++idx ) {
+        const Slot* slot = this->slot(idx);
+        if ( false == read(slot->sequence_, &slot->entry_, &o_entries[idx], sizeof(Entry)) ) {
+            o_entries.clear();
+            return false;
+        }
+        // ... never trust strings from another process ...
+        o_entries[idx].id_[sizeof(o_entries[idx].id_) - 1]         = '\0';
+        o_entries[idx].reason_[sizeof(o_entries[idx].reason_) - 1] = '\0';
+    }
+    
+    o_pid = static_cast<pid_t>(pid);
+    
+    return true;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Unmap board, a writer first marks it as no longer updated.
+ */
+void casper::app::Board::Close ()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( nullptr != map_ ) {
+        if ( true == writable_ ) {
+            Header* header = static_cast<Header*>(map_);
+            const uint32_t sequence = header->sequence_.load(std::memory_order_relaxed);
+            header->sequence_.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            header->pid_ = 0;
+            header->sequence_.store(sequence + 2, std::memory_order_release);
+        }
+        munmap(map_, size_);
+        map_ = nullptr;
+    }
+    if ( -1 != fd_ ) {
+        close(fd_);
+        fd_ = -1;
+    }
+    size_     = 0;
+    writable_ = false;
+    entries_.clear();
+    index_.clear();
+}
+
+/**
+ * @return State name.
+ */
+const char* casper::app::Board::Name (const casper::app::Board::State a_state)
+{
+    switch (a_state) {
+        case State::Stopped:
+            return "stopped";
+        case State::Starting:
+            return "starting";
+        case State::Ready:
+            return "ready";
+        case State::Stopping:
+            return "stopping";
+        case State::Restarting:
+            return "restarting";
+        case State::Held:
+            return "held";
+        case State::Quarantined:
+            return "quarantined";
+        case State::Parked:
+            return "parked";
+        default:
+            return "???";
+    }
+}
+
+/**
+ * @brief Map board file.
+ *
+ * @param a_fd       Board file descriptor, owned by this object on success.
+ * @param a_size     Board file size, in bytes.
+ * @param a_writable True for the writer, false for readers.
+ *
+ * @return True on success, false otherwise - errno is set.
+ */
+bool casper::app::Board::Map (const int a_fd, const size_t a_size, const bool a_writable)
+{
+    void* map = mmap(nullptr, a_size, ( true == a_writable ? PROT_READ | PROT_WRITE : PROT_READ ), MAP_SHARED, a_fd, 0);
+    if ( MAP_FAILED == map ) {
+        return false;
+    }
+    fd_       = a_fd;
+    map_      = map;
+    size_     = a_size;
+    writable_ = a_writable;
+    return true;
+}
+
+/**
+ * @return Slot at a given index, index must be less than board capacity.
+ */
+casper::app::Board::Slot* casper::app::Board::slot (const size_t a_index) const
+{
+    return reinterpret_cast<Slot*>(static_cast<char*>(map_) + sizeof(Header) + a_index * sizeof(Slot));
+}
+
+/**
+ * @brief Copy an entry to it's slot, sequence lock writer.
+ *
+ * @param a_index Entry index.
+ */
+void casper::app::Board::Write (const size_t a_index)
+{
+    Slot* slot = this->slot(a_index);
+    const uint32_t sequence = slot->sequence_.load(std::memory_order_relaxed);
+    // ... odd while being written ...
+    slot->sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&slot->entry_, &entries_[a_index], sizeof(Entry));
+    slot->sequence_.store(sequence + 2, std::memory_order_release);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file board.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CASPER_APP_BOARD_H_
+#define CASPER_APP_BOARD_H_
+#pragma once
+
+#include <sys/types.h> // pid_t
+#include <stdint.h>    // uint8_t, uint32_t, int32_t, uint64_t, int64_t
+#include <stddef.h>    // size_t
+
+#include <string> // std::string
+#include <vector> // std::vector
+#include <map>    // std::map
+#include <atomic> // std::atomic
+#include <mutex>  // std::mutex
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        /**
+         * @brief Fixed layout table, in a memory mapped file, with the most recent state of each 'monitor' child.
+         *
+         * 'monitor' is the only writer, any other process can map it read only and read it at memory speed, without
+         * any IPC round trip. Each entry is protected by a sequence lock: the writer never waits for readers, readers
+         * retry while an entry is being written. Integers are in host byte order - readers always share the same host.
+         */
+        class Board final
+        {
+
+        public: // Data Type(s)
+
+            enum class State : uint8_t {
+                Stopped = 0, //!< Not running, waiting for it's precedents or never spawned.
+                Starting,    //!< Running, readiness probe ( if any ) did not succeed yet.
+                Ready,       //!< Running and ready.
+                Stopping,    //!< Running, it was signalled by 'monitor'.
+                Restarting,  //!< Not running, restart delay pending.
+                Held,        //!< Not running, it won't be restarted.
+                Quarantined, //!< Not running, it crashed too often.
+                Parked       //!< Not running, pool instance above current pool size.
+            };
+
+            typedef struct {
+                int64_t  started_;     //!< When it was last spawned, in milliseconds since epoch, 0 when unknown.
+                int64_t  exited_;      //!< When it last exited, in milliseconds since epoch, 0 when it didn't.
+                int64_t  sampled_;     //!< When metrics were last sampled, in milliseconds since epoch, 0 when never.
+                uint64_t rss_;         //!< Resident set size, in bytes, of it and all it's descendants.
+                int32_t  pid_;         //!< 0 when it's not running.
+                uint32_t restarts_;    //!< Number of restarts since it was loaded.
+                int32_t  status_;      //!< Last exit status, -1 when it was signalled or it's unknown.
+                int32_t  signal_;      //!< Signal that terminated last run, 0 when none.
+                float    cpu_;         //!< CPU usage, 100 is one core.
+                uint32_t fds_;         //!< Number of open file descriptors.
+                uint32_t threads_;     //!< Number of threads.
+                uint32_t processes_;   //!< Number of processes, it and all it's descendants.
+                uint8_t  state_;       //!< See \link State \link.
+                uint8_t  reserved_[7];
+                char     id_[64];      //!< Child id, nul terminated, truncated if needed.
+                char     reason_[120]; //!< Last exit reason, nul terminated, truncated if needed.
+            } Entry;
+
+        private: // Data Type(s)
+
+            typedef struct {
+                char                  magic_[4];
+                uint32_t              version_;
+                uint32_t              capacity_;   //!< Number of slots.
+                uint32_t              slot_size_;  //!< Size of each slot, in bytes.
+                std::atomic<uint32_t> sequence_;   //!< Sequence lock of count_ and pid_, odd while they are being written.
+                uint32_t              count_;      //!< Number of used slots.
+                int32_t               pid_;        //!< Writer pid, 0 when it's gone and board is no longer updated.
+                uint32_t              reserved_;
+                int64_t               updated_;    //!< When board was laid out, in milliseconds since epoch.
+                uint8_t               padding_[24];
+            } Header;
+
+            typedef struct {
+                std::atomic<uint32_t> sequence_;   //!< Sequence lock of entry_, odd while it's being written.
+                uint32_t              reserved_;
+                Entry                 entry_;
+            } Slot;
+
+        private: // Const Data
+
+            static const char     k_magic_[4];
+            static const uint32_t k_version_;
+
+        private: // Data
+
+            int                           fd_;
+            void*                         map_;
+            size_t                        size_;
+            bool                          writable_;
+            std::vector<Entry>            entries_; //!< Writer only, last written entries.
+            std::map<std::string, size_t> index_;   //!< Writer only, slot index by child id.
+
+        private: // Threading
+
+            std::mutex                    mutex_;   //!< Writer only, more than one thread might update it.
+
+        public: // Constructor(s) / Destructor
+
+            Board ();
+            virtual ~Board ();
+
+        public: // Writer Method(s) / Function(s)
+
+            bool Create  (const std::string& a_uri, const size_t a_capacity);
+            void Reset   (const std::vector<std::string>& a_ids);
+            void Set     (const std::string& a_id, const pid_t a_pid, const State a_state, const uint32_t a_restarts, const int64_t a_started);
+            void Exited  (const std::string& a_id, const int a_status, const int a_signal, const std::string& a_reason, const int64_t a_timestamp);
+            void Measure (const std::string& a_id, const int64_t a_timestamp, const float a_cpu, const uint64_t a_rss,
+                          const uint32_t a_fds, const uint32_t a_threads, const uint32_t a_processes);
+
+        public: // Reader Method(s) / Function(s)
+
+            bool Open    (const std::string& a_uri);
+            bool Read    (std::vector<Entry>& o_entries, pid_t& o_pid) const;
+
+        public: // Method(s) / Function(s)
+
+            void Close   ();
+
+        public: // Static Method(s) / Function(s)
+
+            static const char* Name (const State a_state);
+
+        private: // Method(s) / Function(s)
+
+            bool   Map   (const int a_fd, const size_t a_size, const bool a_writable);
+            Slot*  slot  (const size_t a_index) const;
+            void   Write (const size_t a_index);
+
+        }; // end of class 'Board'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_BOARD_H_
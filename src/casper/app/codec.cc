@@ -0,0 +1,621 @@
+/**
+ * @file codec.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/codec.h"
+
+#include <string.h> // memcpy, memcmp
+
+#include <vector> // std::vector
+
+#include "cc/b64.h"
+
+const char    casper::app::Codec::k_magic_[2]    = { 'C', 'M' };
+const uint8_t casper::app::Codec::k_version_     = 2; // 2: list and event frames carry a sequence number
+const size_t  casper::app::Codec::k_header_size_ = 8; // magic, version, type and payload length
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::Codec::Codec ()
+{
+    buffer_.reserve(4096);
+    count_ = 0;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::Codec::~Codec ()
+{
+    /* empty */
+}
+
+#ifdef __APPLE__
+#pragma mark - Encoding
+#endif
+
+/**
+ * @brief Start encoding a running processes list, processes are added by \link Append \link.
+ *
+ * @param a_sequence Sequence number of most recent event already reflected by this list.
+ */
+void casper::app::Codec::List (const uint64_t a_sequence)
+{
+    Begin(Type::List);
+    count_ = 0;
+    Put(&count_, sizeof(count_));
+    Put(&a_sequence, sizeof(a_sequence));
+}
+
+/**
+ * @brief Add a process to the list being encoded.
+ *
+ * @param a_id    Process id.
+ * @param a_pid   Process pid, 0 when it's not running.
+ * @param a_tree  Process tree pids, including it's own, can be nullptr when \link a_count \link is 0.
+ * @param a_count Number of pids in process tree.
+ */
+void casper::app::Codec::Append (const std::string& a_id, const pid_t a_pid, const pid_t* a_tree, const size_t a_count)
+{
+    const int32_t  pid   = static_cast<int32_t>(a_pid);
+    const uint16_t count = static_cast<uint16_t>(a_count > UINT16_MAX ? UINT16_MAX : a_count);
+    Put(a_id);
+    Put(&pid, sizeof(pid));
+    Put(&count, sizeof(count));
+    for ( uint16_t idx = 0 ; idx < count ; ++idx ) {
+        const int32_t member = static_cast<int32_t>(a_tree[idx]);
+        Put(&member, sizeof(member));
+    }
+    count_++;
+    // ... keep count up to date, so list frame is always complete ...
+    memcpy(&buffer_[k_header_size_], &count_, sizeof(count_));
+}
+
+/**
+ * @brief Encode an error.
+ *
+ * @param a_no    Error number.
+ * @param a_str   Error number description.
+ * @param a_msg   Error message.
+ * @param a_fnc   Function where error was raised.
+ * @param a_ln    Line where error was raised.
+ * @param a_fatal True when 'monitor' can't recover from it.
+ */
+void casper::app::Codec::Error (const int a_no, const std::string& a_str, const std::string& a_msg, const std::string& a_fnc, const int a_ln, const bool a_fatal)
+{
+    const int32_t no    = static_cast<int32_t>(a_no);
+    const int32_t ln    = static_cast<int32_t>(a_ln);
+    const uint8_t fatal = ( true == a_fatal ? 1 : 0 );
+    Begin(Type::Error);
+    Put(&no, sizeof(no));
+    Put(a_str);
+    Put(a_msg);
+    Put(a_fnc);
+    Put(&ln, sizeof(ln));
+    Put(&fatal, sizeof(fatal));
+}
+
+/**
+ * @brief Encode a 'monitor' status.
+ *
+ * @param a_status 'started' or 'terminated'.
+ */
+void casper::app::Codec::Status (const std::string& a_status)
+{
+    Begin(Type::Status);
+    Put(a_status);
+}
+
+/**
+ * @brief Encode a control request.
+ *
+ * @param a_control 'start', 'refresh', 'stop' or 'reload'.
+ */
+void casper::app::Codec::Control (const std::string& a_control)
+{
+    Begin(Type::Control);
+    Put(a_control);
+}
+
+/**
+ * @brief Encode a process change.
+ *
+ * @param a_sequence Event sequence number, consecutive events differ by one.
+ * @param a_kind     What changed.
+ * @param a_id       Process id.
+ * @param a_pid      Process pid, 0 when it's not running.
+ * @param a_detail   Exit reason, restart delay or crossed threshold, can be empty.
+ */
+void casper::app::Codec::Event (const uint64_t a_sequence, const casper::app::Codec::Kind a_kind, const std::string& a_id, const pid_t a_pid,
+                                const std::string& a_detail)
+{
+    const uint8_t kind = static_cast<uint8_t>(a_kind);
+    const int32_t pid  = static_cast<int32_t>(a_pid);
+    Begin(Type::Event);
+    Put(&a_sequence, sizeof(a_sequence));
+    Put(&kind, sizeof(kind));
+    Put(a_id);
+    Put(&pid, sizeof(pid));
+    Put(a_detail);
+}
+
+/**
+ * @brief Encode the equivalent of a JSON message.
+ *
+ * @param a_message 'list', 'error', 'status', 'control' or 'event' message.
+ *
+ * @return True on success, false when message type is unknown or it's malformed.
+ */
+bool casper::app::Codec::Encode (const Json::Value& a_message)
+{
+    if ( false == a_message.isObject() || false == a_message["type"].isString() ) {
+        return false;
+    }
+    const std::string  type = a_message["type"].asString();
+    const Json::Value& data = a_message[type];
+    if ( 0 == type.compare("list") && true == data.isArray() ) {
+        List(a_message.get("sequence", 0).asUInt64());
+        std::vector<pid_t> tree;
+        for ( Json::ArrayIndex idx = 0 ; idx < data.size() ; ++idx ) {
+            const Json::Value& process = data[idx];
+            tree.clear();
+            for ( Json::ArrayIndex member = 0 ; member < process["tree"].size() ; ++member ) {
+                tree.push_back(static_cast<pid_t>(process["tree"][member].asInt()));
+            }
+            Append(process["id"].asString(), static_cast<pid_t>(process.get("pid", 0).asInt()), tree.data(), tree.size());
+        }
+    } else if ( 0 == type.compare("error") && true == data.isObject() ) {
+        Error(data.get("no", 0).asInt(), data.get("str", "").asString(), data.get("msg", "").asString(), data.get("fnc", "").asString(),
+              data.get("ln", 0).asInt(), data.get("fatal", true).asBool()
+        );
+    } else if ( 0 == type.compare("status") && true == data.isString() ) {
+        Status(data.asString());
+    } else if ( 0 == type.compare("control") && true == data.isString() ) {
+        Control(data.asString());
+    } else if ( 0 == type.compare("event") && true == data.isObject() ) {
+        Kind kind;
+        if ( false == Parse(data.get("kind", "").asString(), kind) ) {
+            return false;
+        }
+        Event(data.get("sequence", 0).asUInt64(), kind, data["id"].asString(), static_cast<pid_t>(data.get("pid", 0).asInt()),
+              data.get("detail", "").asString()
+        );
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @return Most recently encoded frame, valid until next encoding.
+ */
+const std::string& casper::app::Codec::frame ()
+{
+    const uint32_t length = static_cast<uint32_t>(buffer_.length() - k_header_size_);
+    memcpy(&buffer_[4], &length, sizeof(length));
+    return buffer_;
+}
+
+/**
+ * @brief Wrap most recently encoded frame in a message that can be sent by IPC transport.
+ *
+ * @param o_message { "type": "frame", "frame": "<frame, base64 url encoded>" }
+ */
+void casper::app::Codec::Wrap (Json::Value& o_message)
+{
+    o_message          = Json::Value(Json::ValueType::objectValue);
+    o_message["type"]  = "frame";
+    o_message["frame"] = cc::base64_url_unpadded::encode(frame());
+}
+
+#ifdef __APPLE__
+#pragma mark - Decoding
+#endif
+
+/**
+ * @brief Unwrap a frame received by IPC transport, see \link Wrap \link.
+ *
+ * @param a_message Received message.
+ * @param o_frame   Frame, still to be decoded.
+ *
+ * @return True when message is a wrapped frame, false otherwise.
+ */
+bool casper::app::Codec::Unwrap (const Json::Value& a_message, std::string& o_frame)
+{
+    if ( false == a_message.isObject() || false == a_message["type"].isString() || 0 != a_message["type"].asString().compare("frame") ) {
+        return false;
+    }
+    const Json::Value& frame = a_message["frame"];
+    if ( false == frame.isString() ) {
+        return false;
+    }
+    const char* begin = nullptr;
+    const char* end   = nullptr;
+    if ( false == frame.getString(&begin, &end) ) {
+        return false;
+    }
+    o_frame = cc::base64_url_unpadded::decode<std::string>(begin, static_cast<size_t>(end - begin));
+    return true;
+}
+
+/**
+ * @brief Validate a frame header.
+ *
+ * @param a_data   Frame data, must outlive \link o_frame \link and all views read from it.
+ * @param a_length Frame length, in bytes.
+ * @param o_frame  Decoded frame, ready to be read.
+ *
+ * @return True on success, false when it's not a frame, it's version is not supported or it's truncated.
+ */
+bool casper::app::Codec::Decode (const char* const a_data, const size_t a_length, casper::app::Codec::Frame& o_frame)
+{
+    if ( a_length < k_header_size_ || 0 != memcmp(a_data, k_magic_, sizeof(k_magic_)) || k_version_ != static_cast<uint8_t>(a_data[2]) ) {
+        return false;
+    }
+    const uint8_t type = static_cast<uint8_t>(a_data[3]);
+    if ( type < static_cast<uint8_t>(Type::List) || type > static_cast<uint8_t>(Type::Event) ) {
+        return false;
+    }
+    uint32_t length;
+    memcpy(&length, a_data + 4, sizeof(length));
+    if ( static_cast<size_t>(length) != a_length - k_header_size_ ) {
+        return false;
+    }
+    o_frame = {
+        /* type_     */ static_cast<Type>(type),
+        /* payload_  */ a_data + k_header_size_,
+        /* length_   */ static_cast<size_t>(length),
+        /* offset_   */ 0,
+        /* count_    */ 0,
+        /* sequence_ */ 0
+    };
+    if ( Type::List == o_frame.type_ && false == Get(o_frame, o_frame.offset_, &o_frame.count_, sizeof(o_frame.count_)) ) {
+        return false;
+    }
+    if ( ( Type::List == o_frame.type_ || Type::Event == o_frame.type_ ) && false == Get(o_frame, o_frame.offset_, &o_frame.sequence_, sizeof(o_frame.sequence_)) ) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Read next process of a list frame.
+ *
+ * @param a_frame   List frame, as returned by \link Decode \link.
+ * @param o_process Next process.
+ *
+ * @return True when a process was read, false when there are no more processes or frame is malformed.
+ */
+bool casper::app::Codec::Next (casper::app::Codec::Frame& a_frame, casper::app::Codec::Process& o_process)
+{
+    if ( Type::List != a_frame.type_ || a_frame.offset_ >= a_frame.length_ ) {
+        return false;
+    }
+    size_t offset = a_frame.offset_;
+    if ( false == Get(a_frame, offset, o_process.id_) || false == Get(a_frame, offset, &o_process.pid_, sizeof(o_process.pid_))
+        || false == Get(a_frame, offset, &o_process.tree_, sizeof(o_process.tree_)) ) {
+        return false;
+    }
+    const size_t size = static_cast<size_t>(o_process.tree_) * sizeof(int32_t);
+    if ( offset + size > a_frame.length_ ) {
+        return false;
+    }
+    o_process.pids_ = a_frame.payload_ + offset;
+    a_frame.offset_ = offset + size;
+    return true;
+}
+
+/**
+ * @brief Read an error frame.
+ *
+ * @param a_frame Error frame, as returned by \link Decode \link.
+ * @param o_error Error, strings are views into frame.
+ *
+ * @return True on success, false when it's not an error frame or it's malformed.
+ */
+bool casper::app::Codec::Read (const casper::app::Codec::Frame& a_frame, casper::app::Codec::Failure& o_error)
+{
+    if ( Type::Error != a_frame.type_ ) {
+        return false;
+    }
+    size_t  offset = 0;
+    uint8_t fatal  = 0;
+    if ( false == Get(a_frame, offset, &o_error.no_, sizeof(o_error.no_)) || false == Get(a_frame, offset, o_error.str_)
+        || false == Get(a_frame, offset, o_error.msg_) || false == Get(a_frame, offset, o_error.fnc_)
+        || false == Get(a_frame, offset, &o_error.ln_, sizeof(o_error.ln_)) || false == Get(a_frame, offset, &fatal, sizeof(fatal)) ) {
+        return false;
+    }
+    o_error.fatal_ = ( 0 != fatal );
+    return true;
+}
+
+/**
+ * @brief Read a status or control frame.
+ *
+ * @param a_frame Status or control frame, as returned by \link Decode \link.
+ * @param o_value Status or control, a view into frame.
+ *
+ * @return True on success, false when it's not a status or control frame or it's malformed.
+ */
+bool casper::app::Codec::Read (const casper::app::Codec::Frame& a_frame, casper::app::Codec::View& o_value)
+{
+    if ( Type::Status != a_frame.type_ && Type::Control != a_frame.type_ ) {
+        return false;
+    }
+    size_t offset = 0;
+    return Get(a_frame, offset, o_value);
+}
+
+/**
+ * @brief Read an event frame.
+ *
+ * @param a_frame  Event frame, as returned by \link Decode \link, it's sequence number was already read.
+ * @param o_change Process change, strings are views into frame.
+ *
+ * @return True on success, false when it's not an event frame or it's malformed.
+ */
+bool casper::app::Codec::Read (const casper::app::Codec::Frame& a_frame, casper::app::Codec::Change& o_change)
+{
+    if ( Type::Event != a_frame.type_ ) {
+        return false;
+    }
+    size_t  offset = a_frame.offset_;
+    uint8_t kind   = 0;
+    if ( false == Get(a_frame, offset, &kind, sizeof(kind)) || false == Get(a_frame, offset, o_change.id_)
+        || false == Get(a_frame, offset, &o_change.pid_, sizeof(o_change.pid_)) || false == Get(a_frame, offset, o_change.detail_) ) {
+        return false;
+    }
+    if ( kind < static_cast<uint8_t>(Kind::Spawned) || kind > static_cast<uint8_t>(Kind::Threshold) ) {
+        return false;
+    }
+    o_change.kind_ = static_cast<Kind>(kind);
+    return true;
+}
+
+/**
+ * @brief Read a process tree pid, frames are not aligned.
+ *
+ * @param a_process Process, as returned by \link Next \link.
+ * @param a_index   Pid index, must be less than it's tree size.
+ *
+ * @return Pid.
+ */
+pid_t casper::app::Codec::Pid (const casper::app::Codec::Process& a_process, const size_t a_index)
+{
+    int32_t pid;
+    memcpy(&pid, a_process.pids_ + a_index * sizeof(int32_t), sizeof(pid));
+    return static_cast<pid_t>(pid);
+}
+
+/**
+ * @brief Convert a frame to the equivalent JSON message.
+ *
+ * @param a_data    Frame data.
+ * @param a_length  Frame length, in bytes.
+ * @param o_message JSON message, as sent before this encoding existed.
+ *
+ * @return True on success, false when frame is malformed.
+ */
+bool casper::app::Codec::ToJSON (const char* const a_data, const size_t a_length, Json::Value& o_message)
+{
+    Frame frame;
+    if ( false == Decode(a_data, a_length, frame) ) {
+        return false;
+    }
+    
+    const auto string = [] (const View& a_view) -> Json::Value {
+        return Json::Value(a_view.data_, a_view.data_ + a_view.length_);
+    };
+    
+    o_message = Json::Value(Json::ValueType::objectValue);
+    switch (frame.type_) {
+        case Type::List:
+        {
+            o_message["type"]     = "list";
+            o_message["sequence"] = static_cast<Json::UInt64>(frame.sequence_);
+            Json::Value& list = ( o_message["list"] = Json::Value(Json::ValueType::arrayValue) );
+            Process      process;
+            for ( uint32_t idx = 0 ; idx < frame.count_ ; ++idx ) {
+                if ( false == Next(frame, process) ) {
+                    return false;
+                }
+                Json::Value& element = list.append(Json::Value(Json::ValueType::objectValue));
+                element["id"]   = string(process.id_);
+                element["pid"]  = process.pid_;
+                element["tree"] = Json::Value(Json::ValueType::arrayValue);
+                for ( size_t member = 0 ; member < process.tree_ ; ++member ) {
+                    element["tree"].append(Pid(process, member));
+                }
+            }
+            break;
+        }
+        case Type::Error:
+        {
+            Failure error;
+            if ( false == Read(frame, error) ) {
+                return false;
+            }
+            o_message["type"]           = "error";
+            o_message["error"]["no"]    = error.no_;
+            o_message["error"]["str"]   = string(error.str_);
+            o_message["error"]["msg"]   = string(error.msg_);
+            o_message["error"]["fnc"]   = string(error.fnc_);
+            o_message["error"]["ln"]    = error.ln_;
+            o_message["error"]["fatal"] = error.fatal_;
+            break;
+        }
+        case Type::Status:
+        case Type::Control:
+        {
+            View value;
+            if ( false == Read(frame, value) ) {
+                return false;
+            }
+            const char* const type = ( Type::Status == frame.type_ ? "status" : "control" );
+            o_message["type"] = type;
+            o_message[type]   = string(value);
+            break;
+        }
+        case Type::Event:
+        {
+            Change change;
+            if ( false == Read(frame, change) ) {
+                return false;
+            }
+            o_message["type"]              = "event";
+            o_message["event"]["sequence"] = static_cast<Json::UInt64>(frame.sequence_);
+            o_message["event"]["kind"]     = Name(change.kind_);
+            o_message["event"]["id"]       = string(change.id_);
+            o_message["event"]["pid"]      = change.pid_;
+            o_message["event"]["detail"]   = string(change.detail_);
+            break;
+        }
+    }
+    return true;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @return Event kind name, as used by JSON messages.
+ */
+const char* casper::app::Codec::Name (const casper::app::Codec::Kind a_kind)
+{
+    switch (a_kind) {
+        case Kind::Spawned:
+            return "spawned";
+        case Kind::Ready:
+            return "ready";
+        case Kind::Exited:
+            return "exited";
+        case Kind::Restarting:
+            return "restarting";
+        case Kind::Threshold:
+            return "threshold";
+        default:
+            return "???";
+    }
+}
+
+/**
+ * @brief Find an event kind by it's name.
+ *
+ * @param a_name Event kind name, as used by JSON messages.
+ * @param o_kind Event kind.
+ *
+ * @return True when name is known, false otherwise.
+ */
+bool casper::app::Codec::Parse (const std::string& a_name, casper::app::Codec::Kind& o_kind)
+{
+    for ( uint8_t kind = static_cast<uint8_t>(Kind::Spawned) ; kind <= static_cast<uint8_t>(Kind::Threshold) ; ++kind ) {
+        if ( 0 == a_name.compare(Name(static_cast<Kind>(kind))) ) {
+            o_kind = static_cast<Kind>(kind);
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Start encoding a frame, previous one is discarded.
+ *
+ * @param a_type Frame type.
+ */
+void casper::app::Codec::Begin (const casper::app::Codec::Type a_type)
+{
+    const uint32_t length = 0;
+    buffer_.clear();
+    buffer_.append(k_magic_, sizeof(k_magic_));
+    buffer_.push_back(static_cast<char>(k_version_));
+    buffer_.push_back(static_cast<char>(a_type));
+    // ... payload length is only known when frame is requested ...
+    buffer_.append(reinterpret_cast<const char*>(&length), sizeof(length));
+}
+
+/**
+ * @brief Append raw data to frame being encoded.
+ *
+ * @param a_data   Data.
+ * @param a_length Data length, in bytes.
+ */
+void casper::app::Codec::Put (const void* a_data, const size_t a_length)
+{
+    buffer_.append(reinterpret_cast<const char*>(a_data), a_length);
+}
+
+/**
+ * @brief Append a string, length prefixed, to frame being encoded.
+ *
+ * @param a_value String, truncated to 65535 bytes.
+ */
+void casper::app::Codec::Put (const std::string& a_value)
+{
+    const uint16_t length = static_cast<uint16_t>(a_value.length() > UINT16_MAX ? UINT16_MAX : a_value.length());
+    Put(&length, sizeof(length));
+    buffer_.append(a_value.c_str(), length);
+}
+
+/**
+ * @brief Read raw data from a frame payload.
+ *
+ * @param a_frame  Frame.
+ * @param a_offset Read position, advanced on success.
+ * @param o_data   Where to copy data to.
+ * @param a_length Data length, in bytes.
+ *
+ * @return True on success, false when frame is truncated.
+ */
+bool casper::app::Codec::Get (const casper::app::Codec::Frame& a_frame, size_t& a_offset, void* o_data, const size_t a_length)
+{
+    if ( a_offset + a_length > a_frame.length_ ) {
+        return false;
+    }
+    memcpy(o_data, a_frame.payload_ + a_offset, a_length);
+    a_offset += a_length;
+    return true;
+}
+
+/**
+ * @brief Read a length prefixed string from a frame payload.
+ *
+ * @param a_frame  Frame.
+ * @param a_offset Read position, advanced on success.
+ * @param o_view   A view into frame payload.
+ *
+ * @return True on success, false when frame is truncated.
+ */
+bool casper::app::Codec::Get (const casper::app::Codec::Frame& a_frame, size_t& a_offset, casper::app::Codec::View& o_view)
+{
+    uint16_t length;
+    if ( false == Get(a_frame, a_offset, &length, sizeof(length)) || a_offset + length > a_frame.length_ ) {
+        return false;
+    }
+    o_view.data_   = a_frame.payload_ + a_offset;
+    o_view.length_ = static_cast<size_t>(length);
+    a_offset      += static_cast<size_t>(length);
+    return true;
+}
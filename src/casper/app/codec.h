@@ -0,0 +1,170 @@
+/**
+ * @file codec.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_CODEC_H_
+#define CASPER_APP_CODEC_H_
+#pragma once
+
+#include <sys/types.h> // pid_t
+#include <stdint.h>    // uint8_t, uint16_t, uint32_t, int32_t, uint64_t
+#include <stddef.h>    // size_t
+
+#include <string> // std::string
+
+#include "json/json.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        /**
+         * @brief Compact, versioned, binary encoding of 'monitor' <-> app messages.
+         *
+         * A frame is a fixed header ( magic, version, type and payload length ) followed by the payload, integers are
+         * written in host byte order - both ends always share the same host. Decoding does not copy, strings are
+         * views into the frame, that must outlive them.
+         *
+         * Frames can be converted to and from the equivalent JSON messages, for debugging and for peers that don't
+         * speak this encoding. IPC transport only carries JSON, so frames travel wrapped in a { "type": "frame" } message.
+         */
+        class Codec final
+        {
+
+        public: // Data Type(s)
+
+            enum class Type : uint8_t {
+                List = 1, //!< Running processes.
+                Error,    //!< An error, fatal or not.
+                Status,   //!< 'monitor' status: started or terminated.
+                Control,  //!< A request to 'monitor': start, refresh, stop or reload.
+                Event     //!< A single process change, applied on top of most recent list.
+            };
+
+            enum class Kind : uint8_t {
+                Spawned = 1, //!< It's running, with a new pid.
+                Ready,       //!< It's readiness probe succeeded.
+                Exited,      //!< It's no longer running, detail is the exit reason.
+                Restarting,  //!< It will be spawned again, detail is the restart delay.
+                Threshold    //!< A resource usage threshold was crossed, detail describes it.
+            };
+
+            typedef struct {
+                const char* data_;
+                size_t      length_;
+            } View;
+
+            typedef struct {
+                Type        type_;
+                const char* payload_;
+                size_t      length_;
+                size_t      offset_;   //!< Read position within payload, used by \link Next \link.
+                uint32_t    count_;    //!< List only, number of processes.
+                uint64_t    sequence_; //!< List and event only, list is as of this event, 0 when there was none yet.
+            } Frame;
+
+            typedef struct {
+                View        id_;
+                int32_t     pid_;
+                uint16_t    tree_;    //!< Number of pids in process tree, including it's own.
+                const char* pids_;    //!< Process tree pids, use \link Pid \link to read them.
+            } Process;
+
+            typedef struct {
+                int32_t no_;
+                View    str_;
+                View    msg_;
+                View    fnc_;
+                int32_t ln_;
+                bool    fatal_;
+            } Failure;
+
+            typedef struct {
+                Kind    kind_;
+                View    id_;
+                int32_t pid_;
+                View    detail_;
+            } Change;
+
+        private: // Const Data
+
+            static const char    k_magic_[2];
+            static const uint8_t k_version_;
+            static const size_t  k_header_size_;
+
+        private: // Data
+
+            std::string buffer_; //!< Frame being encoded, reused.
+            uint32_t    count_;  //!< List only, number of processes encoded so far.
+
+        public: // Constructor(s) / Destructor
+
+            Codec ();
+            virtual ~Codec ();
+
+        public: // Encoding Method(s) / Function(s)
+
+            void List    (const uint64_t a_sequence);
+            void Append  (const std::string& a_id, const pid_t a_pid, const pid_t* a_tree, const size_t a_count);
+            void Error   (const int a_no, const std::string& a_str, const std::string& a_msg, const std::string& a_fnc, const int a_ln, const bool a_fatal);
+            void Status  (const std::string& a_status);
+            void Control (const std::string& a_control);
+            void Event   (const uint64_t a_sequence, const Kind a_kind, const std::string& a_id, const pid_t a_pid, const std::string& a_detail);
+            bool Encode  (const Json::Value& a_message);
+
+            const std::string& frame ();
+            void               Wrap  (Json::Value& o_message);
+
+        public: // Decoding Static Method(s) / Function(s)
+
+            static bool  Decode (const char* const a_data, const size_t a_length, Frame& o_frame);
+            static bool  Next   (Frame& a_frame, Process& o_process);
+            static bool  Read   (const Frame& a_frame, Failure& o_error);
+            static bool  Read   (const Frame& a_frame, View& o_value);
+            static bool  Read   (const Frame& a_frame, Change& o_change);
+            static pid_t Pid    (const Process& a_process, const size_t a_index);
+            static bool  ToJSON (const char* const a_data, const size_t a_length, Json::Value& o_message);
+            static bool  Unwrap (const Json::Value& a_message, std::string& o_frame);
+
+        public: // Static Method(s) / Function(s)
+
+            static const char* Name  (const Kind a_kind);
+            static bool        Parse (const std::string& a_name, Kind& o_kind);
+
+        private: // Method(s) / Function(s)
+
+            void Begin (const Type a_type);
+            void Put   (const void* a_data, const size_t a_length);
+            void Put   (const std::string& a_value);
+
+        private: // Static Method(s) / Function(s)
+
+            static bool Get (const Frame& a_frame, size_t& a_offset, void* o_data, const size_t a_length);
+            static bool Get (const Frame& a_frame, size_t& a_offset, View& o_view);
+
+        }; // end of class 'Codec'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_CODEC_H_
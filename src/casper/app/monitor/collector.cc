@@ -0,0 +1,725 @@
+/**
+ * @file collector.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/collector.h"
+
+#include "casper/app/monitor/helper.h"
+
+#include "casper/app/logger.h"
+
+#include <unistd.h>       // pipe, read, write, close, unlink
+#include <errno.h>        // errno
+#include <fcntl.h>        // open, fcntl
+#include <stdio.h>        // rename, snprintf
+#include <string.h>       // strlen
+#include <time.h>         // localtime_r, strftime
+#include <dirent.h>       // opendir, readdir
+#include <sys/stat.h>     // S_IRUSR, etc
+#include <sys/resource.h> // setpriority
+
+#include <vector>    // std::vector
+#include <algorithm> // std::sort
+
+#include <zlib.h> // gzopen, gzwrite, gzclose
+
+#ifndef __APPLE__
+    #include <sys/syscall.h> // syscall, SYS_gettid
+#endif
+
+const size_t casper::app::monitor::Collector::k_tail_size_;
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Collector::Collector ()
+{
+    config_ = {
+        /* max_size_    */ 64 * 1024 * 1024,
+        /* max_age_ms_  */ 0,
+        /* keep_        */ 10,
+        /* buffer_size_ */ 1024 * 1024,
+        /* compress_    */ true
+    };
+    reader_    = nullptr;
+    writer_    = nullptr;
+    archiver_  = nullptr;
+    reading_   = false;
+    writing_   = false;
+    archiving_ = false;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Collector::~Collector ()
+{
+    Stop();
+    for ( auto it : sinks_ ) {
+        delete it.second;
+    }
+}
+
+/**
+ * @brief Set rotation, retention and buffering options.
+ *
+ * @param a_config See \link Config \link.
+ *
+ * @note Must be called before \link Start \link.
+ */
+void casper::app::monitor::Collector::Setup (const casper::app::monitor::Collector::Config& a_config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = a_config;
+    if ( 0 == config_.buffer_size_ ) {
+        config_.buffer_size_ = 64 * 1024;
+    }
+}
+
+/**
+ * @brief Start reader, writer and archiver threads, if not running already.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Collector::Start ()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( nullptr != reader_ ) {
+        return true;
+    }
+
+    CASPER_APP_MONITOR_RESET_ERROR(error_);
+
+    // ... no control signals, it's only used to wait for pipes data ...
+    if ( false == reactor_.Open({}) ) {
+        error_ = reactor_.error();
+        return false;
+    }
+
+    reading_   = true;
+    writing_   = true;
+    archiving_ = true;
+    reader_    = new std::thread(&casper::app::monitor::Collector::Read, this);
+    writer_    = new std::thread(&casper::app::monitor::Collector::Write, this);
+    archiver_  = new std::thread(&casper::app::monitor::Collector::Archive, this);
+
+    return true;
+}
+
+/**
+ * @brief Stop all threads, pipes are drained and buffered data is written first.
+ */
+void casper::app::monitor::Collector::Stop ()
+{
+    std::thread* reader;
+    std::thread* writer;
+    std::thread* archiver;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reader    = reader_;
+        writer    = writer_;
+        archiver  = archiver_;
+        reader_   = nullptr;
+        writer_   = nullptr;
+        archiver_ = nullptr;
+        reading_  = false;
+    }
+    if ( nullptr == reader ) {
+        return;
+    }
+
+    // ... each thread is only stopped when it's producer is done ...
+    reactor_.Wake();
+    reader->join();
+    delete reader;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+    }
+    writer_cv_.notify_all();
+    writer->join();
+    delete writer;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        archiving_ = false;
+    }
+    archiver_cv_.notify_all();
+    archiver->join();
+    delete archiver;
+
+    reactor_.Close();
+}
+
+/**
+ * @brief Create a pipe to collect a child output.
+ *
+ * @param a_uri Log file uri.
+ * @param o_fd  Write end of the pipe, to be inherited by child and closed by caller after fork.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Collector::Open (const std::string& a_uri, int& o_fd)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    o_fd = -1;
+
+    if ( nullptr == reader_ ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, ::sys::Error::k_no_error_, "unable to collect '%s' - collector is not running", a_uri.c_str());
+        return false;
+    }
+
+    Sink* sink;
+
+    const auto it = sinks_.find(a_uri);
+    if ( sinks_.end() == it ) {
+        // ... active segment is created now, readers ( e.g. log probes ) expect it to exist as soon as child is spawned ...
+        const int fd = open(a_uri.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+        if ( -1 == fd ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to open %s for stream redirect", a_uri.c_str());
+            return false;
+        }
+        struct stat stat_info;
+        sink = new Sink({
+            /* uri_     */ a_uri,
+            /* fd_      */ fd,
+            /* size_    */ ( 0 == fstat(fd, &stat_info) ? static_cast<uint64_t>(stat_info.st_size) : 0 ),
+            /* opened_  */ std::chrono::steady_clock::now(),
+            /* buffer_  */ "",
+            /* dropped_ */ 0,
+            /* total_   */ 0,
+            /* tail_    */ ""
+        });
+        sink->buffer_.reserve(config_.buffer_size_);
+        sinks_[a_uri] = sink;
+    } else {
+        sink = it->second;
+    }
+
+    int fds[2];
+#ifdef __APPLE__
+    if ( -1 == pipe(fds) || -1 == fcntl(fds[0], F_SETFD, FD_CLOEXEC) || -1 == fcntl(fds[1], F_SETFD, FD_CLOEXEC) ) {
+#else
+    if ( -1 == pipe2(fds, O_CLOEXEC) ) {
+#endif
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to collect '%s' - pipe failure", a_uri.c_str());
+        return false;
+    }
+
+    // ... reader must never block ...
+    if ( -1 == fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to collect '%s' - fcntl failure", a_uri.c_str());
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    // ... hand it over to reader thread ...
+    incoming_.push_back(std::make_pair(fds[0], sink));
+    reactor_.Wake();
+
+    o_fd = fds[1];
+
+    return true;
+}
+
+/**
+ * @brief Copy the most recent lines collected for a log.
+ *
+ * @param a_uri   Log file uri.
+ * @param a_lines Maximum number of lines.
+ * @param o_lines Lines, oldest first, without line terminators.
+ *
+ * @return True when log is known, false otherwise.
+ *
+ * @note Data still in the pipe, not read yet, is not included.
+ */
+bool casper::app::monitor::Collector::Tail (const std::string& a_uri, const size_t a_lines, std::vector<std::string>& o_lines) const
+{
+    o_lines.clear();
+
+    std::string tail;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = sinks_.find(a_uri);
+        if ( sinks_.end() == it ) {
+            return false;
+        }
+        tail = it->second->tail_;
+    }
+
+    // ... backwards, ignoring the line terminator of the last line ...
+    size_t end = tail.size();
+    if ( end > 0 && '\n' == tail[end - 1] ) {
+        end--;
+    }
+    while ( o_lines.size() < a_lines && end > 0 ) {
+        const size_t newline = tail.rfind('\n', end - 1);
+        const size_t start   = ( std::string::npos == newline ? 0 : newline + 1 );
+        // ... first line might be truncated, it's kept anyway ...
+        o_lines.insert(o_lines.begin(), tail.substr(start, end - start));
+        if ( std::string::npos == newline ) {
+            break;
+        }
+        end = newline;
+    }
+
+    return true;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Thread function where the 'reader loop' will run.
+ */
+void casper::app::monitor::Collector::Read ()
+{
+#ifdef __APPLE__
+    pthread_setname_np("Monitor Collector");
+#else
+    pthread_setname_np(pthread_self(), "Collector");
+#endif
+
+    std::deque<std::pair<int, Sink*>> incoming;
+    bool                              reading = true;
+
+    while ( true == reading ) {
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming.swap(incoming_);
+            reading = reading_;
+        }
+
+        // ... start watching new pipes ...
+        for ( auto it : incoming ) {
+            Sink* sink = it.second;
+            if ( false == reactor_.Add(it.first, [this, sink] (const int a_fd) { Drain(a_fd, sink); }) ) {
+                close(it.first);
+                continue;
+            }
+            pipes_[it.first] = sink;
+        }
+        incoming.clear();
+
+        if ( false == reading ) {
+            break;
+        }
+
+        // ... wait for data, new pipes or stop ...
+        if ( false == reactor_.Wait(/* a_timeout_ms */ -1, [] (const Reactor::Exit&) {}, [] (const int) {}) ) {
+            break;
+        }
+
+    }
+
+    // ... collect whatever is left, children are gone by now ...
+    while ( pipes_.size() > 0 ) {
+        const auto it   = pipes_.begin();
+        const int  fd   = it->first;
+        Sink*      sink = it->second;
+        Drain(fd, sink);
+        if ( pipes_.end() != pipes_.find(fd) ) {
+            reactor_.Remove(fd);
+            close(fd);
+            pipes_.erase(fd);
+        }
+    }
+}
+
+/**
+ * @brief Thread function where the 'writer loop' will run.
+ */
+void casper::app::monitor::Collector::Write ()
+{
+#ifdef __APPLE__
+    pthread_setname_np("Monitor Log Writer");
+#else
+    pthread_setname_np(pthread_self(), "Log Writer");
+#endif
+
+    typedef struct {
+        Sink*       sink_;
+        std::string data_;
+        uint64_t    dropped_;
+    } Pending;
+
+    std::vector<Pending> pending;
+    bool                 writing = true;
+
+    while ( true ) {
+
+        // ... wait for data, stop or next rotation check ...
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            writer_cv_.wait_for(lock, std::chrono::milliseconds(1000), [this] {
+                if ( false == writing_ ) {
+                    return true;
+                }
+                for ( auto it : sinks_ ) {
+                    if ( it.second->buffer_.size() > 0 || it.second->dropped_ > 0 ) {
+                        return true;
+                    }
+                }
+                return false;
+            });
+            writing = writing_;
+            // ... take buffered data, sink buffers keep their capacity ...
+            size_t idx = 0;
+            for ( auto it : sinks_ ) {
+                Sink* sink = it.second;
+                if ( pending.size() <= idx ) {
+                    pending.push_back({ nullptr, "", 0 });
+                }
+                pending[idx].sink_    = sink;
+                pending[idx].dropped_ = sink->dropped_;
+                pending[idx].data_.clear();
+                pending[idx].data_.swap(sink->buffer_);
+                sink->dropped_ = 0;
+                idx++;
+            }
+            pending.resize(idx);
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        for ( auto& entry : pending ) {
+            Sink* sink = entry.sink_;
+            if ( entry.data_.size() > 0 || entry.dropped_ > 0 ) {
+                (void)Flush(sink, entry.data_, entry.dropped_);
+            }
+            // ... time based rotation, empty segments are kept ...
+            if ( config_.max_age_ms_ > 0 && sink->size_ > 0 && ( now - sink->opened_ ) >= std::chrono::milliseconds(config_.max_age_ms_) ) {
+                Rotate(sink);
+            }
+        }
+
+        if ( false == writing ) {
+            break;
+        }
+    }
+
+    // ... close all active segments ...
+    std::lock_guard<std::mutex> lock(mutex_);
+    for ( auto it : sinks_ ) {
+        if ( -1 != it.second->fd_ ) {
+            close(it.second->fd_);
+            it.second->fd_ = -1;
+        }
+    }
+}
+
+/**
+ * @brief Thread function where the 'archiver loop' will run.
+ */
+void casper::app::monitor::Collector::Archive ()
+{
+#ifdef __APPLE__
+    pthread_setname_np("Monitor Log Archiver");
+    // ... background priority, for this thread only ...
+    (void)setpriority(PRIO_DARWIN_THREAD, 0, PRIO_DARWIN_BG);
+#else
+    pthread_setname_np(pthread_self(), "Log Archiver");
+    // ... lowest priority, for this thread only ( Linux threads have their own nice value ) ...
+    (void)setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#endif
+
+    while ( true ) {
+
+        std::pair<std::string, std::string> segment;
+        bool                                compress;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            archiver_cv_.wait(lock, [this] { return ( segments_.size() > 0 || false == archiving_ ); });
+            // ... closed segments are always archived, even when stopping ...
+            if ( 0 == segments_.size() ) {
+                break;
+            }
+            segment  = segments_.front();
+            compress = config_.compress_;
+            segments_.pop_front();
+        }
+
+        if ( true == compress && false == Gzip(segment.first) ) {
+            CASPER_APP_LOG("error", "Unable to compress log segment '%s', it will be kept as is...", segment.first.c_str());
+        }
+
+        Prune(segment.second);
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Read all available data from a pipe, called by reactor.
+ *
+ * @param a_fd   Read end of the pipe.
+ * @param a_sink Where data is buffered.
+ *
+ * @note Data that does not fit in sink buffer is read anyway and dropped, child must never block on a write.
+ */
+void casper::app::monitor::Collector::Drain (const int a_fd, casper::app::monitor::Collector::Sink* a_sink)
+{
+    char buffer[64 * 1024];
+
+    // ... bounded, so one busy child can't starve the others ...
+    for ( int idx = 0 ; idx < 16 ; ++idx ) {
+
+        const ssize_t count = read(a_fd, buffer, sizeof(buffer));
+        if ( count > 0 ) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                const size_t available = ( a_sink->buffer_.size() < config_.buffer_size_ ? config_.buffer_size_ - a_sink->buffer_.size() : 0 );
+                const size_t accepted  = std::min(available, static_cast<size_t>(count));
+                a_sink->buffer_.append(buffer, accepted);
+                a_sink->dropped_ += ( static_cast<size_t>(count) - accepted );
+                a_sink->total_   += ( static_cast<size_t>(count) - accepted );
+                // ... most recent data is always kept, even when dropped, it might explain a crash ...
+                if ( static_cast<size_t>(count) >= k_tail_size_ ) {
+                    a_sink->tail_.assign(buffer + static_cast<size_t>(count) - k_tail_size_, k_tail_size_);
+                } else {
+                    if ( a_sink->tail_.size() + static_cast<size_t>(count) > k_tail_size_ ) {
+                        a_sink->tail_.erase(0, a_sink->tail_.size() + static_cast<size_t>(count) - k_tail_size_);
+                    }
+                    a_sink->tail_.append(buffer, static_cast<size_t>(count));
+                }
+            }
+            writer_cv_.notify_one();
+            continue;
+        }
+
+        if ( -1 == count && EINTR == errno ) {
+            continue;
+        }
+
+        if ( -1 == count && ( EAGAIN == errno || EWOULDBLOCK == errno ) ) {
+            return;
+        }
+
+        // ... eof ( all writers are gone ) or error ...
+        reactor_.Remove(a_fd);
+        close(a_fd);
+        pipes_.erase(a_fd);
+        return;
+    }
+}
+
+/**
+ * @brief Write data to active segment, rotate it if it's too big.
+ *
+ * @param a_sink    Log.
+ * @param a_buffer  Data to write.
+ * @param a_dropped Number of bytes dropped after this data.
+ *
+ * @return True on success, false otherwise ( unwritten data is accounted as dropped ).
+ */
+bool casper::app::monitor::Collector::Flush (casper::app::monitor::Collector::Sink* a_sink, std::string& a_buffer, const uint64_t a_dropped)
+{
+    if ( a_dropped > 0 ) {
+        char marker[160];
+        const int length = snprintf(marker, sizeof(marker), "\n---- %llu byte(s) dropped, log writer could not keep up ( %llu total ) ----\n",
+                                    static_cast<unsigned long long>(a_dropped), static_cast<unsigned long long>(a_sink->total_)
+        );
+        if ( length > 0 ) {
+            a_buffer.append(marker, std::min(static_cast<size_t>(length), sizeof(marker) - 1));
+        }
+    }
+
+    if ( -1 == a_sink->fd_ ) {
+        a_sink->fd_     = open(a_sink->uri_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+        a_sink->size_   = 0;
+        a_sink->opened_ = std::chrono::steady_clock::now();
+    }
+
+    size_t offset = 0;
+    while ( -1 != a_sink->fd_ && offset < a_buffer.size() ) {
+        const ssize_t count = write(a_sink->fd_, a_buffer.data() + offset, a_buffer.size() - offset);
+        if ( count > 0 ) {
+            offset += static_cast<size_t>(count);
+        } else if ( -1 == count && EINTR == errno ) {
+            continue;
+        } else {
+            break;
+        }
+    }
+    a_sink->size_ += offset;
+
+    const bool rv = ( offset == a_buffer.size() );
+    if ( false == rv ) {
+        // ... disk full? data is lost, but it will be reported with next write ...
+        std::lock_guard<std::mutex> lock(mutex_);
+        a_sink->dropped_ += ( a_buffer.size() - offset );
+        a_sink->total_   += ( a_buffer.size() - offset );
+    }
+
+    a_buffer.clear();
+
+    if ( config_.max_size_ > 0 && a_sink->size_ >= config_.max_size_ ) {
+        Rotate(a_sink);
+    }
+
+    return rv;
+}
+
+/**
+ * @brief Close active segment, rename it with a timestamp and open a new one.
+ *
+ * @param a_sink Log.
+ */
+void casper::app::monitor::Collector::Rotate (casper::app::monitor::Collector::Sink* a_sink)
+{
+    if ( -1 != a_sink->fd_ ) {
+        close(a_sink->fd_);
+        a_sink->fd_ = -1;
+    }
+
+    // ... <name>.log -> <name>.<yyyymmddHHMMSS>.<ms>.log ...
+    const auto       now     = std::chrono::system_clock::now();
+    const time_t     seconds = std::chrono::system_clock::to_time_t(now);
+    const long long  ms      = static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+    struct tm        tm;
+    char             timestamp[32];
+    (void)localtime_r(&seconds, &tm);
+    const size_t length = strftime(timestamp, sizeof(timestamp), "%Y%m%d%H%M%S", &tm);
+    (void)snprintf(timestamp + length, sizeof(timestamp) - length, ".%03lld", ms);
+
+    const std::string stem    = ( a_sink->uri_.size() > 4 && 0 == a_sink->uri_.compare(a_sink->uri_.size() - 4, 4, ".log") ? a_sink->uri_.substr(0, a_sink->uri_.size() - 4) : a_sink->uri_ );
+    const std::string segment = stem + "." + timestamp + ".log";
+
+    const bool renamed = ( 0 == rename(a_sink->uri_.c_str(), segment.c_str()) );
+
+    a_sink->fd_     = open(a_sink->uri_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+    a_sink->size_   = 0;
+    a_sink->opened_ = std::chrono::steady_clock::now();
+
+    if ( true == renamed ) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            segments_.push_back(std::make_pair(segment, a_sink->uri_));
+        }
+        archiver_cv_.notify_one();
+    }
+}
+
+/**
+ * @brief Compress a closed segment, original file is removed on success.
+ *
+ * @param a_uri Segment uri.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Collector::Gzip (const std::string& a_uri)
+{
+    const int fd = open(a_uri.c_str(), O_RDONLY | O_CLOEXEC);
+    if ( -1 == fd ) {
+        // ... already pruned?
+        return ( ENOENT == errno );
+    }
+
+    const std::string tmp = a_uri + ".gz.tmp";
+
+    gzFile file = gzopen(tmp.c_str(), "wb6");
+    if ( nullptr == file ) {
+        close(fd);
+        return false;
+    }
+    (void)gzbuffer(file, 128 * 1024);
+
+    bool    rv = true;
+    char    buffer[64 * 1024];
+    ssize_t count;
+    while ( true == rv && ( count = read(fd, buffer, sizeof(buffer)) ) != 0 ) {
+        if ( -1 == count ) {
+            rv = ( EINTR == errno );
+        } else {
+            rv = ( gzwrite(file, buffer, static_cast<unsigned>(count)) == static_cast<int>(count) );
+        }
+    }
+
+    close(fd);
+
+    if ( Z_OK != gzclose(file) ) {
+        rv = false;
+    }
+
+    if ( true == rv && 0 == rename(tmp.c_str(), ( a_uri + ".gz" ).c_str()) ) {
+        (void)unlink(a_uri.c_str());
+    } else {
+        (void)unlink(tmp.c_str());
+        rv = false;
+    }
+
+    return rv;
+}
+
+/**
+ * @brief Remove oldest closed segments of a log, keeping only the configured number of them.
+ *
+ * @param a_uri Log ( active segment ) uri.
+ */
+void casper::app::monitor::Collector::Prune (const std::string& a_uri)
+{
+    const size_t      slash     = a_uri.rfind('/');
+    const std::string directory = ( std::string::npos != slash ? a_uri.substr(0, slash + 1) : "./" );
+    const std::string name      = ( std::string::npos != slash ? a_uri.substr(slash + 1) : a_uri );
+    const std::string prefix    = ( name.size() > 4 && 0 == name.compare(name.size() - 4, 4, ".log") ? name.substr(0, name.size() - 4) : name ) + ".";
+
+    const auto ends_with = [] (const std::string& a_string, const char* const a_suffix) -> bool {
+        const size_t length = strlen(a_suffix);
+        return ( a_string.size() >= length && 0 == a_string.compare(a_string.size() - length, length, a_suffix) );
+    };
+
+    DIR* dir = opendir(directory.c_str());
+    if ( nullptr == dir ) {
+        return;
+    }
+
+    std::vector<std::string> segments;
+
+    struct dirent* entry;
+    while ( nullptr != ( entry = readdir(dir) ) ) {
+        const std::string file = entry->d_name;
+        if ( 0 != file.compare(0, prefix.size(), prefix) || 0 == file.compare(name) ) {
+            continue;
+        }
+        if ( true == ends_with(file, ".log") || true == ends_with(file, ".log.gz") ) {
+            segments.push_back(file);
+        }
+    }
+    closedir(dir);
+
+    if ( segments.size() <= config_.keep_ ) {
+        return;
+    }
+
+    // ... timestamp is part of the name, oldest first ...
+    std::sort(segments.begin(), segments.end());
+
+    for ( size_t idx = 0 ; idx < segments.size() - config_.keep_ ; ++idx ) {
+        (void)unlink(( directory + segments[idx] ).c_str());
+    }
+}
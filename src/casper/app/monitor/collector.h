@@ -0,0 +1,155 @@
+/**
+ * @file collector.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_COLLECTOR_H_
+#define CASPER_APP_MONITOR_COLLECTOR_H_
+#pragma once
+
+#include <stdint.h> // uint64_t
+#include <stddef.h> // size_t
+
+#include <string>             // std::string
+#include <map>                // std::map
+#include <deque>              // std::deque
+#include <vector>             // std::vector
+#include <thread>             // std::thread
+#include <mutex>              // std::mutex
+#include <condition_variable> // std::condition_variable
+#include <chrono>             // std::chrono
+
+#include "casper/app/monitor/reactor.h"
+
+#include "sys/error.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Collects children stdout / stderr through pipes and writes them to rotated log files.
+             *
+             * One thread reads all pipes ( reactor ), one writes buffered data to disk and one compresses closed segments.
+             * Buffered data is bounded, when the disk can't keep up data is dropped ( and accounted ) instead of blocking children.
+             */
+            class Collector final
+            {
+
+            public: // Data Type(s)
+
+                typedef struct {
+                    uint64_t max_size_;    //!< Rotate when active segment reaches this size, in bytes, 0 to disable.
+                    int      max_age_ms_;  //!< Rotate when active segment is older than this, in milliseconds, 0 to disable.
+                    size_t   keep_;        //!< Number of closed segments kept for each log.
+                    size_t   buffer_size_; //!< Maximum number of bytes buffered for each log.
+                    bool     compress_;    //!< True when closed segments must be gzip'ed.
+                } Config;
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    std::string                           uri_;     //!< Active segment uri.
+                    int                                   fd_;      //!< Active segment, writer thread only.
+                    uint64_t                              size_;    //!< Active segment size, writer thread only.
+                    std::chrono::steady_clock::time_point opened_;  //!< When active segment was opened, writer thread only.
+                    std::string                           buffer_;  //!< Data not yet written.
+                    uint64_t                              dropped_; //!< Bytes dropped since last report.
+                    uint64_t                              total_;   //!< Bytes dropped since this log was opened.
+                    std::string                           tail_;    //!< Most recent data read, written or dropped, at most k_tail_size_ bytes.
+                } Sink;
+
+            private: // Const Data
+
+                static const size_t k_tail_size_ = 8 * 1024;
+
+            private: // Data
+
+                Config                                          config_;
+                std::map<std::string, Sink*>                    sinks_;    //!< By uri, never erased while this object is alive, pointers are stable.
+                std::deque<std::pair<int, Sink*>>               incoming_; //!< Pipes not yet watched by reader thread.
+                std::map<int, Sink*>                            pipes_;    //!< Reader thread only.
+                std::deque<std::pair<std::string, std::string>> segments_; //!< Closed segments and the log they belong to, not yet archived.
+                Reactor                                         reactor_;
+                ::sys::Error                                    error_;
+
+            private: // Threading
+
+                std::thread*            reader_;
+                std::thread*            writer_;
+                std::thread*            archiver_;
+                mutable std::mutex      mutex_;
+                std::condition_variable writer_cv_;
+                std::condition_variable archiver_cv_;
+                bool                    reading_;
+                bool                    writing_;
+                bool                    archiving_;
+
+            public: // Constructor(s) / Destructor
+
+                Collector ();
+                virtual ~Collector ();
+
+            public: // Method(s) / Function(s)
+
+                void Setup (const Config& a_config);
+                bool Start ();
+                void Stop  ();
+
+                bool Open  (const std::string& a_uri, int& o_fd);
+                bool Tail  (const std::string& a_uri, const size_t a_lines, std::vector<std::string>& o_lines) const;
+
+            public: // Inline Method(s) / Function(s)
+
+                const ::sys::Error& error () const;
+
+            private: // Method(s) / Function(s)
+
+                void Read    ();
+                void Write   ();
+                void Archive ();
+
+                void Drain   (const int a_fd, Sink* a_sink);
+                bool Flush   (Sink* a_sink, std::string& a_buffer, const uint64_t a_dropped);
+                void Rotate  (Sink* a_sink);
+                bool Gzip    (const std::string& a_uri);
+                void Prune   (const std::string& a_uri);
+
+            }; // end of class 'Collector'
+
+            /**
+             * @return R/O access to last error.
+             */
+            inline const ::sys::Error& Collector::error () const
+            {
+                return error_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_COLLECTOR_H_
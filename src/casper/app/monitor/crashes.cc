@@ -0,0 +1,562 @@
+/**
+ * @file crashes.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/crashes.h"
+
+#include "casper/app/logger.h"
+
+#include <unistd.h>     // read, write, close, unlink, gethostname, getuid, getgid
+#include <errno.h>      // errno
+#include <fcntl.h>      // open
+#include <stdio.h>      // rename, snprintf
+#include <string.h>     // strerror, strsignal
+#include <time.h>       // localtime_r, strftime
+#include <dirent.h>     // opendir, readdir
+#include <sys/stat.h>   // stat, mkdir
+
+#ifdef __APPLE__
+    #include <limits.h>     // PATH_MAX
+    #include <sys/sysctl.h> // sysctlbyname
+#endif
+
+#include <map>       // std::map
+#include <set>       // std::set
+#include <fstream>   // std::ofstream
+#include <algorithm> // std::replace
+
+#include "json/json.h"
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Crashes::Crashes ()
+{
+    config_ = {
+        /* directory_ */ "",
+        /* keep_      */ 10,
+        /* max_size_  */ 1024 * 1024 * 1024,
+        /* lines_     */ 20
+    };
+    thread_  = nullptr;
+    running_ = false;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Crashes::~Crashes ()
+{
+    Stop();
+}
+
+/**
+ * @brief Set crash directory and retention options, kernel core file name pattern is read now.
+ *
+ * @param a_config See \link Config \link.
+ *
+ * @note Must be called before \link Start \link.
+ */
+void casper::app::monitor::Crashes::Setup (const casper::app::monitor::Crashes::Config& a_config)
+{
+    std::string pattern;
+
+#ifdef __APPLE__
+    char   corefile[PATH_MAX];
+    size_t length = sizeof(corefile);
+    if ( 0 == sysctlbyname("kern.corefile", corefile, &length, nullptr, 0) && length > 0 ) {
+        pattern = std::string(corefile, strnlen(corefile, length));
+    } else {
+        pattern = "/cores/core.%P";
+    }
+#else
+    std::ifstream core_pattern("/proc/sys/kernel/core_pattern");
+    if ( true == core_pattern.is_open() ) {
+        std::getline(core_pattern, pattern);
+    }
+    // ... a pid suffix is added when pattern has no pid and core_uses_pid is set ...
+    std::ifstream core_uses_pid("/proc/sys/kernel/core_uses_pid");
+    int           uses_pid = 0;
+    if ( true == core_uses_pid.is_open() && ( core_uses_pid >> uses_pid ) && 0 != uses_pid
+        && pattern.length() > 0 && '|' != pattern[0] && std::string::npos == pattern.find("%p") ) {
+        pattern += ".%p";
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_  = a_config;
+    pattern_ = pattern;
+    if ( config_.directory_.length() > 0 && '/' != config_.directory_[config_.directory_.length() - 1] ) {
+        config_.directory_ += '/';
+    }
+}
+
+/**
+ * @brief Start collector thread, if not running already.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Crashes::Start ()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( nullptr != thread_ ) {
+        return true;
+    }
+    if ( config_.directory_.length() > 0 && 0 != mkdir(config_.directory_.c_str(), S_IRWXU | S_IRGRP | S_IXGRP) && EEXIST != errno ) {
+        CASPER_APP_LOG("error", "Unable to create crash directory '%s': %s, core dumps won't be collected...", config_.directory_.c_str(), strerror(errno));
+        config_.directory_ = "";
+    }
+    if ( 0 == pattern_.length() || '|' == pattern_[0] ) {
+        CASPER_APP_LOG("status", "Core dumps are handled by '%s', they won't be collected...", pattern_.c_str());
+    }
+    running_ = true;
+    thread_  = new std::thread(&casper::app::monitor::Crashes::Loop, this);
+    return true;
+}
+
+/**
+ * @brief Stop collector thread, pending cores are collected first.
+ */
+void casper::app::monitor::Crashes::Stop ()
+{
+    std::thread* thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread   = thread_;
+        thread_  = nullptr;
+        running_ = false;
+    }
+    if ( nullptr == thread ) {
+        return;
+    }
+    cv_.notify_all();
+    thread->join();
+    delete thread;
+}
+
+/**
+ * @brief Keep a crash report, it's core ( if any ) and the report itself are written later.
+ *
+ * @param a_report      Report, it's name is set here.
+ * @param a_directories Where a core with a relative path might have been written, in order of preference.
+ */
+void casper::app::monitor::Crashes::Add (const casper::app::monitor::Crashes::Report& a_report, const std::vector<std::string>& a_directories)
+{
+    // ... timestamp first, so names sort by age ...
+    const time_t seconds = static_cast<time_t>(a_report.timestamp_ / 1000);
+    struct tm    tm;
+    char         timestamp[32];
+    (void)localtime_r(&seconds, &tm);
+    const size_t length = strftime(timestamp, sizeof(timestamp), "%Y%m%d%H%M%S", &tm);
+    (void)snprintf(timestamp + length, sizeof(timestamp) - length, ".%03lld", static_cast<long long>(a_report.timestamp_ % 1000));
+
+    Report report = a_report;
+    report.name_  = std::string(timestamp) + '-' + report.id_ + '-' + std::to_string(report.pid_);
+    report.core_  = "";
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reports_.push_back(report);
+        while ( reports_.size() > config_.keep_ ) {
+            reports_.pop_front();
+        }
+        if ( 0 == config_.directory_.length() || nullptr == thread_ ) {
+            return;
+        }
+        pending_.push_back({ report, a_directories });
+    }
+    cv_.notify_one();
+}
+
+/**
+ * @brief Copy all kept reports.
+ *
+ * @param o_reports Reports, oldest first.
+ */
+void casper::app::monitor::Crashes::Copy (std::vector<casper::app::monitor::Crashes::Report>& o_reports) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    o_reports.assign(reports_.begin(), reports_.end());
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Thread function where the 'collector loop' will run.
+ */
+void casper::app::monitor::Crashes::Loop ()
+{
+#ifdef __APPLE__
+    pthread_setname_np("Monitor Crashes");
+#else
+    pthread_setname_np(pthread_self(), "Crashes");
+#endif
+
+    Prune();
+
+    while ( true ) {
+
+        Pending  pending;
+        uint64_t max_size;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return ( pending_.size() > 0 || false == running_ ); });
+            // ... cores are always collected, even when stopping ...
+            if ( 0 == pending_.size() ) {
+                break;
+            }
+            pending  = pending_.front();
+            max_size = config_.max_size_;
+            pending_.pop_front();
+        }
+
+        Report&     report = pending.report_;
+        std::string uri;
+        struct stat stat_info;
+
+        if ( true == report.core_dumped_ && true == Find(pending, uri) && 0 == stat(uri.c_str(), &stat_info) ) {
+            report.core_size_ = static_cast<uint64_t>(stat_info.st_size);
+            const std::string core = config_.directory_ + report.name_ + ".core";
+            if ( report.core_size_ > max_size ) {
+                CASPER_APP_LOG("status", "%s ( %d ) core %s is too big ( %llu byte(s) ), it won't be kept...",
+                               report.id_.c_str(), report.pid_, uri.c_str(), static_cast<unsigned long long>(report.core_size_)
+                );
+                (void)unlink(uri.c_str());
+            } else if ( true == Move(uri, core) ) {
+                report.core_ = core;
+            }
+        }
+
+        if ( false == Write(report) ) {
+            CASPER_APP_LOG("error", "Unable to write crash report for %s ( %d ): %s...", report.id_.c_str(), report.pid_, strerror(errno));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for ( auto& it : reports_ ) {
+                if ( it.name_ == report.name_ ) {
+                    it.core_      = report.core_;
+                    it.core_size_ = report.core_size_;
+                }
+            }
+        }
+
+        Prune();
+    }
+}
+
+/**
+ * @brief Find a core dump, expanding kernel core file name pattern.
+ *
+ * @param a_pending Crash.
+ * @param o_uri     Core uri.
+ *
+ * @return True when it was found, false otherwise ( not written, piped to a handler or unsupported pattern ).
+ */
+bool casper::app::monitor::Crashes::Find (const casper::app::monitor::Crashes::Pending& a_pending, std::string& o_uri) const
+{
+    const Report& report = a_pending.report_;
+
+    if ( 0 == pattern_.length() || '|' == pattern_[0] ) {
+        return false;
+    }
+
+    const size_t      slash      = report.uri_.rfind('/');
+    const std::string executable = ( std::string::npos != slash ? report.uri_.substr(slash + 1) : report.uri_ );
+
+    char hostname[256];
+    if ( 0 != gethostname(hostname, sizeof(hostname)) ) {
+        hostname[0] = '\0';
+    }
+    hostname[sizeof(hostname) - 1] = '\0';
+
+    // ... %t is the dump time, in seconds, a few of them are tried ...
+    std::vector<std::string> candidates;
+    for ( int64_t delta = 0 ; delta < ( std::string::npos != pattern_.find("%t") ? 5 : 1 ) ; ++delta ) {
+        std::string candidate;
+        for ( size_t idx = 0 ; idx < pattern_.length() ; ++idx ) {
+            if ( '%' != pattern_[idx] || idx + 1 == pattern_.length() ) {
+                candidate += pattern_[idx];
+                continue;
+            }
+            switch ( pattern_[++idx] ) {
+                case '%':
+                    candidate += '%';
+                    break;
+                case 'p':
+                case 'P':
+                case 'i':
+                case 'I':
+                    candidate += std::to_string(report.pid_);
+                    break;
+                case 'e':
+                case 'N':
+#ifdef __APPLE__
+                    candidate += executable;
+#else
+                    // ... comm, truncated to 15 characters ...
+                    candidate += executable.substr(0, 15);
+#endif
+                    break;
+                case 'E':
+                {
+                    std::string path = report.uri_;
+                    std::replace(path.begin(), path.end(), '/', '!');
+                    candidate += path;
+                    break;
+                }
+                case 'h':
+                    candidate += hostname;
+                    break;
+                case 'u':
+                case 'U':
+                    candidate += std::to_string(getuid());
+                    break;
+                case 'g':
+                    candidate += std::to_string(getgid());
+                    break;
+                case 's':
+                    candidate += std::to_string(report.signal_);
+                    break;
+                case 't':
+                    candidate += std::to_string(report.timestamp_ / 1000 - delta);
+                    break;
+                default:
+                    // ... not known after the fact ...
+                    return false;
+            }
+        }
+        candidates.push_back(candidate);
+    }
+
+    struct stat stat_info;
+    for ( const auto& candidate : candidates ) {
+        if ( '/' == candidate[0] ) {
+            if ( 0 == stat(candidate.c_str(), &stat_info) && 0 != S_ISREG(stat_info.st_mode) ) {
+                o_uri = candidate;
+                return true;
+            }
+            continue;
+        }
+        // ... relative to child working directory, unknown if it changed it ...
+        for ( auto directory : a_pending.directories_ ) {
+            if ( directory.length() > 0 && '/' != directory[directory.length() - 1] ) {
+                directory += '/';
+            }
+            const std::string uri = directory + candidate;
+            if ( 0 == stat(uri.c_str(), &stat_info) && 0 != S_ISREG(stat_info.st_mode) ) {
+                o_uri = uri;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Move a file, copying it when it's on another file system.
+ *
+ * @param a_from Source uri.
+ * @param a_to   Destination uri.
+ *
+ * @return True on success, false otherwise ( source is kept ).
+ */
+bool casper::app::monitor::Crashes::Move (const std::string& a_from, const std::string& a_to) const
+{
+    if ( 0 == rename(a_from.c_str(), a_to.c_str()) ) {
+        return true;
+    }
+    if ( EXDEV != errno ) {
+        CASPER_APP_LOG("error", "Unable to move core %s to %s: %s...", a_from.c_str(), a_to.c_str(), strerror(errno));
+        return false;
+    }
+
+    const int from = open(a_from.c_str(), O_RDONLY | O_CLOEXEC);
+    if ( -1 == from ) {
+        CASPER_APP_LOG("error", "Unable to open core %s: %s...", a_from.c_str(), strerror(errno));
+        return false;
+    }
+    const int to = open(a_to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if ( -1 == to ) {
+        CASPER_APP_LOG("error", "Unable to create %s: %s...", a_to.c_str(), strerror(errno));
+        close(from);
+        return false;
+    }
+
+    char    buffer[64 * 1024];
+    bool    copied = true;
+    ssize_t count;
+    while ( 0 != ( count = read(from, buffer, sizeof(buffer)) ) ) {
+        if ( -1 == count ) {
+            if ( EINTR == errno ) {
+                continue;
+            }
+            copied = false;
+            break;
+        }
+        ssize_t written = 0;
+        while ( written < count ) {
+            const ssize_t rv = write(to, buffer + written, static_cast<size_t>(count - written));
+            if ( -1 == rv && EINTR == errno ) {
+                continue;
+            }
+            if ( -1 == rv ) {
+                copied = false;
+                break;
+            }
+            written += rv;
+        }
+        if ( false == copied ) {
+            break;
+        }
+    }
+
+    close(from);
+    if ( 0 != close(to) ) {
+        copied = false;
+    }
+
+    if ( false == copied ) {
+        CASPER_APP_LOG("error", "Unable to copy core %s to %s: %s...", a_from.c_str(), a_to.c_str(), strerror(errno));
+        (void)unlink(a_to.c_str());
+        return false;
+    }
+
+    (void)unlink(a_from.c_str());
+
+    return true;
+}
+
+/**
+ * @brief Write a crash report, next to it's core.
+ *
+ * @param a_report Report.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Crashes::Write (const casper::app::monitor::Crashes::Report& a_report) const
+{
+    Json::Value report = Json::Value(Json::ValueType::objectValue);
+    report["id"]          = a_report.id_;
+    report["pid"]         = a_report.pid_;
+    report["executable"]  = a_report.uri_;
+    report["signal"]      = a_report.signal_;
+    report["description"] = ( nullptr != strsignal(a_report.signal_) ? strsignal(a_report.signal_) : "" );
+    report["core_dumped"] = a_report.core_dumped_;
+    report["ts"]          = static_cast<Json::Int64>(a_report.timestamp_);
+    report["user"]        = a_report.user_cpu_;
+    report["system"]      = a_report.system_cpu_;
+    report["max_rss"]     = static_cast<Json::UInt64>(a_report.max_rss_);
+    report["crashes"]     = static_cast<Json::UInt64>(a_report.count_);
+    report["quarantined"] = a_report.quarantined_;
+    report["core"]        = a_report.core_;
+    report["core_size"]   = static_cast<Json::UInt64>(a_report.core_size_);
+    report["stderr"]      = Json::Value(Json::ValueType::arrayValue);
+    for ( const auto& line : a_report.stderr_ ) {
+        report["stderr"].append(line);
+    }
+
+    std::ofstream stream(config_.directory_ + a_report.name_ + ".json", std::ios::out | std::ios::trunc);
+    if ( false == stream.is_open() ) {
+        return false;
+    }
+    Json::StyledStreamWriter writer;
+    writer.write(stream, report);
+    stream.close();
+
+    return ( false == stream.fail() );
+}
+
+/**
+ * @brief Remove oldest reports and cores, keeping only the configured number of reports and cores size.
+ */
+void casper::app::monitor::Crashes::Prune ()
+{
+    std::string directory;
+    size_t      keep;
+    uint64_t    max_size;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        directory = config_.directory_;
+        keep      = config_.keep_;
+        max_size  = config_.max_size_;
+    }
+
+    if ( 0 == directory.length() ) {
+        return;
+    }
+
+    DIR* dir = opendir(directory.c_str());
+    if ( nullptr == dir ) {
+        return;
+    }
+
+    // ... by name, without extension ...
+    std::map<std::string, std::set<std::string>> crashes;
+
+    struct dirent* entry;
+    while ( nullptr != ( entry = readdir(dir) ) ) {
+        const std::string file = entry->d_name;
+        const size_t      dot  = file.rfind('.');
+        if ( std::string::npos == dot || ( 0 != file.compare(dot, std::string::npos, ".json") && 0 != file.compare(dot, std::string::npos, ".core") ) ) {
+            continue;
+        }
+        crashes[file.substr(0, dot)].insert(file);
+    }
+    closedir(dir);
+
+    std::set<std::string> removed;
+
+    // ... timestamp is part of the name, newest first ...
+    size_t   count = 0;
+    uint64_t size  = 0;
+    for ( auto it = crashes.rbegin() ; crashes.rend() != it ; ++it ) {
+        count++;
+        for ( const auto& file : it->second ) {
+            const std::string uri     = directory + file;
+            const bool        is_core = ( file.length() > 5 && 0 == file.compare(file.length() - 5, 5, ".core") );
+            struct stat       stat_info;
+            if ( true == is_core && 0 == stat(uri.c_str(), &stat_info) ) {
+                size += static_cast<uint64_t>(stat_info.st_size);
+            }
+            // ... reports beyond limit go away with their cores, older cores go away when they don't fit ...
+            if ( count > keep || ( true == is_core && size > max_size ) ) {
+                (void)unlink(uri.c_str());
+                if ( true == is_core ) {
+                    removed.insert(uri);
+                }
+            }
+        }
+    }
+
+    if ( 0 == removed.size() ) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for ( auto& it : reports_ ) {
+        if ( removed.end() != removed.find(it.core_) ) {
+            it.core_ = "";
+        }
+    }
+}
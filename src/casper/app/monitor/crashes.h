@@ -0,0 +1,146 @@
+/**
+ * @file crashes.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_CRASHES_H_
+#define CASPER_APP_MONITOR_CRASHES_H_
+#pragma once
+
+#include <stdint.h>     // uint64_t, int64_t
+#include <stddef.h>     // size_t
+#include <sys/types.h>  // pid_t
+
+#include <string>             // std::string
+#include <vector>             // std::vector
+#include <deque>              // std::deque
+#include <thread>             // std::thread
+#include <mutex>              // std::mutex
+#include <condition_variable> // std::condition_variable
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Keeps children crash reports and collects their core dumps.
+             *
+             * Reports are kept in memory and, along with the cores, written to a bounded crash directory by a background
+             * thread - cores can be large and must not block the watchdog.
+             */
+            class Crashes final
+            {
+
+            public: // Data Type(s)
+
+                typedef struct {
+                    std::string directory_; //!< Where cores and reports are written, empty to keep reports in memory only.
+                    size_t      keep_;      //!< Number of reports kept, in memory and on disk.
+                    uint64_t    max_size_;  //!< Maximum size of all kept cores, in bytes, oldest are removed first.
+                    size_t      lines_;     //!< Number of stderr lines kept in each report.
+                } Config;
+
+                typedef struct {
+                    std::string              id_;          //!< Child id.
+                    pid_t                    pid_;         //!< Child pid.
+                    std::string              uri_;         //!< Executable uri.
+                    int                      signal_;      //!< Signal that terminated it.
+                    bool                     core_dumped_; //!< True when kernel reported a core dump.
+                    int64_t                  timestamp_;   //!< When it was reaped, in milliseconds since epoch.
+                    double                   user_cpu_;    //!< User CPU time, in seconds.
+                    double                   system_cpu_;  //!< System CPU time, in seconds.
+                    uint64_t                 max_rss_;     //!< Maximum resident set size, in bytes.
+                    size_t                   count_;       //!< Number of crashes within quarantine window, including this one.
+                    bool                     quarantined_; //!< True when it won't be restarted.
+                    std::vector<std::string> stderr_;      //!< Last stderr lines, oldest first.
+                    std::string              core_;        //!< Collected core uri, empty when none or not collected yet.
+                    uint64_t                 core_size_;   //!< Core size, in bytes, even when it was too big to be kept.
+                    std::string              name_;        //!< Base name of report and core files.
+                } Report;
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    Report                   report_;
+                    std::vector<std::string> directories_; //!< Where core might have been written, when it's path is relative.
+                } Pending;
+
+            private: // Data
+
+                Config              config_;
+                std::deque<Report>  reports_; //!< Oldest first.
+                std::deque<Pending> pending_; //!< Not written yet.
+                std::string         pattern_; //!< Kernel core file name pattern.
+
+            private: // Threading
+
+                std::thread*            thread_;
+                mutable std::mutex      mutex_;
+                std::condition_variable cv_;
+                bool                    running_;
+
+            public: // Constructor(s) / Destructor
+
+                Crashes ();
+                virtual ~Crashes ();
+
+            public: // Method(s) / Function(s)
+
+                void Setup (const Config& a_config);
+                bool Start ();
+                void Stop  ();
+
+                void Add   (const Report& a_report, const std::vector<std::string>& a_directories);
+                void Copy  (std::vector<Report>& o_reports) const;
+
+            public: // Inline Method(s) / Function(s)
+
+                size_t lines () const;
+
+            private: // Method(s) / Function(s)
+
+                void Loop    ();
+                bool Find    (const Pending& a_pending, std::string& o_uri) const;
+                bool Move    (const std::string& a_from, const std::string& a_to) const;
+                bool Write   (const Report& a_report) const;
+                void Prune   ();
+
+            }; // end of class 'Crashes'
+
+            /**
+             * @return Number of stderr lines kept in each report.
+             */
+            inline size_t Crashes::lines () const
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return config_.lines_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_CRASHES_H_
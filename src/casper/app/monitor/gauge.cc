@@ -0,0 +1,300 @@
+/**
+ * @file gauge.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/gauge.h"
+
+#include "casper/app/monitor/helper.h"
+
+#include <unistd.h>     // close, read, write
+#include <errno.h>      // errno
+#include <fcntl.h>      // fcntl
+#include <poll.h>       // poll
+#include <netdb.h>      // getaddrinfo
+#include <stdlib.h>     // strtoull
+#include <string.h>     // memset, memcpy
+#include <sys/socket.h> // socket, connect, getsockopt
+
+#include <chrono> // std::chrono
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_config Load signal configuration.
+ */
+casper::app::monitor::Gauge::Gauge (const casper::app::monitor::Gauge::Config& a_config)
+    : config_(a_config)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Gauge::~Gauge ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Create a new load signal reader.
+ *
+ * @param a_config Load signal configuration.
+ *
+ * @return New object, caller takes ownership.
+ */
+casper::app::monitor::Gauge* casper::app::monitor::Gauge::New (const casper::app::monitor::Gauge::Config& a_config)
+{
+    switch ( a_config.kind_ ) {
+        case Kind::Beanstalkd:
+        default:
+            return new Beanstalkd(a_config);
+    }
+}
+
+/**
+ * @return Human readable load signal kind.
+ */
+const char* casper::app::monitor::Gauge::Name (const casper::app::monitor::Gauge::Kind a_kind)
+{
+    switch ( a_kind ) {
+        case Kind::Beanstalkd:
+            return "beanstalkd";
+        default:
+            return "???";
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark - Beanstalkd
+#endif
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_config Server address and tube name.
+ */
+casper::app::monitor::Beanstalkd::Beanstalkd (const casper::app::monitor::Gauge::Config& a_config)
+    : casper::app::monitor::Gauge(a_config)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Beanstalkd::~Beanstalkd ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Read tube depth: jobs waiting to be processed and jobs being processed.
+ *
+ * @param o_value current-jobs-ready + current-jobs-reserved, 0 when tube does not exist ( yet ).
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Beanstalkd::Read (double& o_value)
+{
+    // ... one connection per reading, it's not worth keeping it between intervals ...
+    const int fd = Connect();
+    if ( -1 == fd ) {
+        return false;
+    }
+
+    std::string reply;
+    const bool  exchanged = Exchange(fd, "stats-tube " + config_.tube_ + "\r\n", reply);
+
+    close(fd);
+
+    if ( false == exchanged ) {
+        return false;
+    }
+
+    // ... a tube only exists while it's being used or watched ...
+    if ( 0 == reply.compare(0, 11, "NOT_FOUND\r\n") ) {
+        o_value = 0;
+        return true;
+    }
+
+    // ... OK <bytes>\r\n<yaml>\r\n ...
+    const auto field = [&reply] (const char* const a_name, uint64_t& o_field) -> bool {
+        const std::string key = std::string("\n") + a_name + ": ";
+        const size_t      pos = reply.find(key);
+        if ( std::string::npos == pos ) {
+            return false;
+        }
+        o_field = strtoull(reply.c_str() + pos + key.length(), nullptr, 10);
+        return true;
+    };
+
+    uint64_t ready    = 0;
+    uint64_t reserved = 0;
+    if ( 0 != reply.compare(0, 3, "OK ") || false == field("current-jobs-ready", ready) || false == field("current-jobs-reserved", reserved) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                     sys::Error::k_no_error_,
+                                     "unexpected beanstalkd reply to stats-tube %s: '%s'", config_.tube_.c_str(),
+                                     reply.substr(0, reply.find('\r')).c_str()
+        );
+        return false;
+    }
+
+    o_value = static_cast<double>(ready + reserved);
+
+    return true;
+}
+
+/**
+ * @brief Connect to server, within timeout.
+ *
+ * @return Connected non-blocking socket, -1 on failure.
+ */
+int casper::app::monitor::Beanstalkd::Connect ()
+{
+    struct addrinfo  hints;
+    struct addrinfo* result = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_NUMERICSERV;
+    const int rv = getaddrinfo(config_.host_.c_str(), std::to_string(config_.port_).c_str(), &hints, &result);
+    if ( 0 != rv || nullptr == result ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                     sys::Error::k_no_error_,
+                                     "unable to resolve '%s': %s", config_.host_.c_str(), gai_strerror(rv)
+        );
+        if ( nullptr != result ) {
+            freeaddrinfo(result);
+        }
+        return -1;
+    }
+
+    const int fd = socket(result->ai_family, SOCK_STREAM, 0);
+    if ( -1 == fd ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to create beanstalkd socket");
+        freeaddrinfo(result);
+        return -1;
+    }
+
+    if ( -1 == fcntl(fd, F_SETFD, FD_CLOEXEC) || -1 == fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to set beanstalkd socket options");
+        freeaddrinfo(result);
+        close(fd);
+        return -1;
+    }
+
+    int err_no = 0;
+    if ( 0 != connect(fd, result->ai_addr, result->ai_addrlen) ) {
+        err_no = errno;
+        if ( EINPROGRESS == err_no || EINTR == err_no ) {
+            struct pollfd pfd = { fd, POLLOUT, 0 };
+            socklen_t     len = sizeof(err_no);
+            const int     n   = poll(&pfd, 1, config_.timeout_ms_);
+            if ( 0 == n ) {
+                err_no = ETIMEDOUT;
+            } else if ( n < 0 || 0 != getsockopt(fd, SOL_SOCKET, SO_ERROR, &err_no, &len) ) {
+                err_no = errno;
+            }
+        }
+    }
+
+    freeaddrinfo(result);
+
+    if ( 0 != err_no ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, err_no, "unable to connect to beanstalkd at %s:%d", config_.host_.c_str(), config_.port_);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief Send a command and read it's reply, within timeout.
+ *
+ * @param a_fd      Connected non-blocking socket.
+ * @param a_request Command, including trailing \r\n.
+ * @param o_reply   Reply status line and data ( if any ).
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Beanstalkd::Exchange (const int a_fd, const std::string& a_request, std::string& o_reply)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.timeout_ms_);
+
+    // ... wait for socket to be ready, until deadline ...
+    const auto wait = [this, a_fd, &deadline] (const short a_events) -> bool {
+        const int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count());
+        struct pollfd pfd = { a_fd, a_events, 0 };
+        const int n = ( remaining > 0 ? poll(&pfd, 1, remaining) : 0 );
+        if ( n <= 0 ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, ( 0 == n ? ETIMEDOUT : errno ),
+                                         "no reply from beanstalkd at %s:%d", config_.host_.c_str(), config_.port_
+            );
+            return false;
+        }
+        return true;
+    };
+
+    size_t sent = 0;
+    while ( sent < a_request.length() ) {
+        const ssize_t count = write(a_fd, a_request.c_str() + sent, a_request.length() - sent);
+        if ( count > 0 ) {
+            sent += static_cast<size_t>(count);
+        } else if ( -1 == count && ( EAGAIN == errno || EINTR == errno ) ) {
+            if ( false == wait(POLLOUT) ) {
+                return false;
+            }
+        } else {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to write to beanstalkd at %s:%d", config_.host_.c_str(), config_.port_);
+            return false;
+        }
+    }
+
+    // ... status line, followed by <bytes> of data and \r\n when status is OK ...
+    o_reply.clear();
+    size_t expected = 0;
+    char   buffer[4096];
+    while ( 0 == expected || o_reply.length() < expected ) {
+        const ssize_t count = read(a_fd, buffer, sizeof(buffer));
+        if ( count > 0 ) {
+            o_reply.append(buffer, static_cast<size_t>(count));
+            const size_t eol = o_reply.find("\r\n");
+            if ( 0 == expected && std::string::npos != eol ) {
+                expected = eol + 2;
+                if ( 0 == o_reply.compare(0, 3, "OK ") ) {
+                    expected += static_cast<size_t>(strtoull(o_reply.c_str() + 3, nullptr, 10)) + 2;
+                }
+            }
+        } else if ( -1 == count && ( EAGAIN == errno || EINTR == errno ) ) {
+            if ( false == wait(POLLIN) ) {
+                return false;
+            }
+        } else {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, ( 0 == count ? ECONNRESET : errno ),
+                                         "unable to read from beanstalkd at %s:%d", config_.host_.c_str(), config_.port_
+            );
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file gauge.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_GAUGE_H_
+#define CASPER_APP_MONITOR_GAUGE_H_
+#pragma once
+
+#include <stdint.h> // uint8_t
+
+#include <string> // std::string
+
+#include "sys/error.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief A load signal, read periodically to decide how many instances of a pool must run.
+             *
+             * New signals are added by extending \link Kind \link and \link New \link.
+             */
+            class Gauge
+            {
+
+            public: // Data Type(s)
+
+                enum class Kind : uint8_t {
+                    Beanstalkd = 0 //!< Jobs ready or reserved in a beanstalkd tube.
+                };
+
+                typedef struct {
+                    Kind        kind_;
+                    std::string host_;       //!< Server host.
+                    int         port_;       //!< Server port.
+                    std::string tube_;       //!< Beanstalkd tube name.
+                    int         timeout_ms_; //!< Maximum time to connect, send the request or wait for a reply.
+                } Config;
+
+            protected: // Const Data
+
+                const Config config_;
+
+            protected: // Data
+
+                ::sys::Error error_;
+
+            public: // Constructor(s) / Destructor
+
+                Gauge (const Config& a_config);
+                virtual ~Gauge ();
+
+            public: // API Pure Virtual Method(s) / Function(s)
+
+                virtual bool Read (double& o_value) = 0;
+
+            public: // Inline Method(s) / Function(s)
+
+                const Config&       config () const;
+                const ::sys::Error& error  () const;
+
+            public: // Static Method(s) / Function(s)
+
+                static Gauge*      New  (const Config& a_config);
+                static const char* Name (const Kind a_kind);
+
+            }; // end of class 'Gauge'
+
+            /**
+             * @return R/O access to configuration.
+             */
+            inline const Gauge::Config& Gauge::config () const
+            {
+                return config_;
+            }
+
+            /**
+             * @return R/O access to last error.
+             */
+            inline const ::sys::Error& Gauge::error () const
+            {
+                return error_;
+            }
+
+            /**
+             * @brief Beanstalkd tube depth, read with 'stats-tube' over beanstalkd text protocol.
+             */
+            class Beanstalkd final : public Gauge
+            {
+
+            public: // Constructor(s) / Destructor
+
+                Beanstalkd (const Config& a_config);
+                virtual ~Beanstalkd ();
+
+            public: // Inherited Virtual Method(s) / Function(s)
+
+                virtual bool Read (double& o_value);
+
+            private: // Method(s) / Function(s)
+
+                int  Connect  ();
+                bool Exchange (const int a_fd, const std::string& a_request, std::string& o_reply);
+
+            }; // end of class 'Beanstalkd'
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_GAUGE_H_
@@ -0,0 +1,653 @@
+/**
+ * @file health.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/health.h"
+
+#include <unistd.h>     // close, read, write, pipe
+#include <errno.h>      // errno
+#include <fcntl.h>      // fcntl
+#include <poll.h>       // poll
+#include <netdb.h>      // getaddrinfo
+#include <stdlib.h>     // strtoul
+#include <string.h>     // memset, strerror
+#include <sys/socket.h> // socket, connect, getsockopt
+
+#include <vector>    // std::vector
+#include <algorithm> // std::min, std::max
+
+/**
+ * @brief Maximum number of bytes of a reply that are kept, only it's beginning matters.
+ */
+static const size_t k_casper_app_monitor_health_max_reply_ = 64 * 1024;
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Health::Health ()
+{
+    version_     = 0;
+    callback_    = nullptr;
+    thread_      = nullptr;
+    wake_fds_[0] = -1;
+    wake_fds_[1] = -1;
+    aborted_     = false;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Health::~Health ()
+{
+    Stop();
+}
+
+/**
+ * @brief Replace configured checks, can be called while running.
+ *
+ * @param a_checks Health checks, by child id.
+ */
+void casper::app::monitor::Health::Setup (const std::map<std::string, casper::app::monitor::Health::Check>& a_checks)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        checks_ = a_checks;
+        version_++;
+    }
+    Wake();
+}
+
+/**
+ * @brief Start checks thread, if not running already.
+ *
+ * @param a_callback Function to call, from checks thread, when a child became unhealthy.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Health::Start (const casper::app::monitor::Health::Callback& a_callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( nullptr != thread_ ) {
+        return true;
+    }
+    if ( 0 != pipe(wake_fds_) ) {
+        wake_fds_[0] = wake_fds_[1] = -1;
+        return false;
+    }
+    for ( auto fd : wake_fds_ ) {
+        (void)fcntl(fd, F_SETFD, FD_CLOEXEC);
+        (void)fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    }
+    aborted_  = false;
+    callback_ = a_callback;
+    thread_   = new std::thread(&casper::app::monitor::Health::Loop, this);
+    return true;
+}
+
+/**
+ * @brief Stop checks thread, statistics are kept.
+ */
+void casper::app::monitor::Health::Stop ()
+{
+    std::thread* thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread   = thread_;
+        thread_  = nullptr;
+        aborted_ = true;
+    }
+    if ( nullptr == thread ) {
+        return;
+    }
+    Wake();
+    thread->join();
+    delete thread;
+    for ( auto& fd : wake_fds_ ) {
+        close(fd);
+        fd = -1;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    targets_.clear();
+    unhealthy_.clear();
+}
+
+/**
+ * @brief Start checking a child, it must be ready.
+ *
+ * @param a_id Child id, ignored when it has no health check.
+ */
+void casper::app::monitor::Health::Track (const std::string& a_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if ( checks_.end() == checks_.find(a_id) ) {
+            return;
+        }
+        // ... a new run, even when it's untracked and tracked again before it's noticed ...
+        targets_[a_id] = ++version_;
+        unhealthy_.erase(a_id);
+    }
+    Wake();
+}
+
+/**
+ * @brief Stop checking a child, it's statistics are kept.
+ *
+ * @param a_id Child id.
+ */
+void casper::app::monitor::Health::Untrack (const std::string& a_id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if ( 0 == targets_.erase(a_id) ) {
+            return;
+        }
+        unhealthy_.erase(a_id);
+        version_++;
+    }
+    Wake();
+}
+
+/**
+ * @brief Collect children reported unhealthy since last call.
+ *
+ * @param o_reasons Failure reasons, by child id.
+ */
+void casper::app::monitor::Health::Unhealthy (std::map<std::string, std::string>& o_reasons)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    o_reasons.clear();
+    o_reasons.swap(unhealthy_);
+}
+
+/**
+ * @brief Copy a child checks statistics.
+ *
+ * @param a_id    Child id.
+ * @param o_stats Statistics.
+ *
+ * @return True if child was ever checked, false otherwise.
+ */
+bool casper::app::monitor::Health::Copy (const std::string& a_id, casper::app::monitor::Health::Stats& o_stats) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = stats_.find(a_id);
+    if ( stats_.end() == it ) {
+        return false;
+    }
+    o_stats = it->second;
+    return true;
+}
+
+/**
+ * @return Human readable name of a check kind, as used in configuration.
+ */
+const char* casper::app::monitor::Health::Name (const casper::app::monitor::Health::Kind a_kind)
+{
+    switch ( a_kind ) {
+        case Kind::Redis:
+            return "redis";
+        case Kind::Beanstalkd:
+            return "beanstalkd";
+        case Kind::Postgres:
+            return "postgres";
+        case Kind::HTTP:
+            return "http";
+        default:
+            return "???";
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Checks thread function.
+ */
+void casper::app::monitor::Health::Loop ()
+{
+#ifdef __APPLE__
+    pthread_setname_np("Monitor Health");
+#else
+    pthread_setname_np(pthread_self(), "Health");
+#endif
+
+    const std::chrono::steady_clock::time_point k_never_;
+
+    std::map<std::string, Entry> entries;
+    std::vector<struct pollfd>   pfds;
+    std::vector<std::string>     ids;
+    uint64_t                     version = version_ - 1;
+
+    while ( true ) {
+
+        // ... checks or targets changed?
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if ( true == aborted_ ) {
+                break;
+            }
+            if ( version != version_ ) {
+                version = version_;
+                for ( auto it = entries.begin() ; entries.end() != it ; ) {
+                    const auto check  = checks_.find(it->first);
+                    const auto target = targets_.find(it->first);
+                    if ( targets_.end() == target || checks_.end() == check || target->second != it->second.tracked_ ) {
+                        Abort(it->second);
+                        it = entries.erase(it);
+                    } else {
+                        it->second.check_ = check->second;
+                        ++it;
+                    }
+                }
+                // ... first check of a new target is only due after an interval, it was just found ready ...
+                const auto now = std::chrono::steady_clock::now();
+                for ( const auto& target : targets_ ) {
+                    const auto check = checks_.find(target.first);
+                    if ( checks_.end() == check || entries.end() != entries.find(target.first) ) {
+                        continue;
+                    }
+                    entries[target.first] = {
+                        /* check_    */ check->second,
+                        /* fd_       */ -1,
+                        /* phase_    */ Phase::Idle,
+                        /* request_  */ "",
+                        /* sent_     */ 0,
+                        /* reply_    */ "",
+                        /* start_tp_ */ k_never_,
+                        /* next_tp_  */ now + std::chrono::milliseconds(check->second.interval_ms_),
+                        /* slow_tp_  */ k_never_,
+                        /* failures_ */ 0,
+                        /* reported_ */ false,
+                        /* tracked_  */ target.second
+                    };
+                }
+            }
+        }
+
+        auto now     = std::chrono::steady_clock::now();
+        auto next_tp = now + std::chrono::seconds(1);
+
+        // ... start due checks and expire slow ones ...
+        for ( auto& it : entries ) {
+            Entry& entry = it.second;
+            if ( true == entry.reported_ ) {
+                continue;
+            }
+            std::string reason;
+            if ( Phase::Idle == entry.phase_ ) {
+                if ( now < entry.next_tp_ ) {
+                    next_tp = std::min(next_tp, entry.next_tp_);
+                    continue;
+                }
+                if ( false == Begin(entry, reason) ) {
+                    Finish(it.first, entry, /* a_success */ false, reason);
+                    next_tp = std::min(next_tp, entry.next_tp_);
+                    continue;
+                }
+            }
+            const auto deadline = entry.start_tp_ + std::chrono::milliseconds(entry.check_.timeout_ms_);
+            if ( now >= deadline ) {
+                Finish(it.first, entry, /* a_success */ false, "timed out after " + std::to_string(entry.check_.timeout_ms_) + " ms");
+                next_tp = std::min(next_tp, entry.next_tp_);
+            } else {
+                next_tp = std::min(next_tp, deadline);
+            }
+        }
+
+        // ... wait for any socket, a change or next deadline ...
+        pfds.clear();
+        ids.clear();
+        pfds.push_back({ wake_fds_[0], POLLIN, 0 });
+        ids.push_back("");
+        for ( auto& it : entries ) {
+            if ( -1 == it.second.fd_ ) {
+                continue;
+            }
+            pfds.push_back({ it.second.fd_, static_cast<short>( Phase::Receiving == it.second.phase_ ? POLLIN : POLLOUT ), 0 });
+            ids.push_back(it.first);
+        }
+
+        now = std::chrono::steady_clock::now();
+        const int timeout_ms = ( next_tp > now ? static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(next_tp - now).count()) + 1 : 0 );
+
+        const int rv = poll(pfds.data(), static_cast<nfds_t>(pfds.size()), timeout_ms);
+        if ( rv <= 0 ) {
+            continue;
+        }
+
+        if ( 0 != pfds[0].revents ) {
+            char buffer[64];
+            while ( read(wake_fds_[0], buffer, sizeof(buffer)) > 0 ) {
+                /* drain */
+            }
+        }
+
+        for ( size_t idx = 1 ; idx < pfds.size() ; ++idx ) {
+            if ( 0 == pfds[idx].revents ) {
+                continue;
+            }
+            Entry&      entry = entries[ids[idx]];
+            std::string reason;
+            const Verdict verdict = Advance(entry, reason);
+            if ( Verdict::Pending != verdict ) {
+                Finish(ids[idx], entry, ( Verdict::Healthy == verdict ), reason);
+            }
+        }
+    }
+
+    for ( auto& it : entries ) {
+        Abort(it.second);
+    }
+}
+
+/**
+ * @brief Wake up checks thread.
+ */
+void casper::app::monitor::Health::Wake ()
+{
+    if ( -1 != wake_fds_[1] ) {
+        (void)write(wake_fds_[1], "w", 1);
+    }
+}
+
+/**
+ * @brief Start a check: non-blocking connection and request.
+ *
+ * @param a_entry  Check to start.
+ * @param o_reason Failure reason.
+ *
+ * @return True when check started, false on failure.
+ */
+bool casper::app::monitor::Health::Begin (casper::app::monitor::Health::Entry& a_entry, std::string& o_reason)
+{
+    a_entry.start_tp_ = std::chrono::steady_clock::now();
+    a_entry.sent_     = 0;
+    a_entry.reply_.clear();
+
+    switch ( a_entry.check_.kind_ ) {
+        case Kind::Redis:
+            a_entry.request_ = "PING\r\n";
+            break;
+        case Kind::Beanstalkd:
+            a_entry.request_ = "stats\r\n";
+            break;
+        case Kind::Postgres:
+            // ... SSLRequest: length ( 8 ) and code ( 80877103 ), both in network order ...
+            a_entry.request_ = std::string("\x00\x00\x00\x08\x04\xd2\x16\x2f", 8);
+            break;
+        case Kind::HTTP:
+        default:
+            a_entry.request_ = "GET " + a_entry.check_.path_ + " HTTP/1.0\r\nHost: " + a_entry.check_.host_ + "\r\nConnection: close\r\n\r\n";
+            break;
+    }
+
+    struct addrinfo  hints;
+    struct addrinfo* result = nullptr;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_NUMERICSERV;
+    const int rv = getaddrinfo(a_entry.check_.host_.c_str(), std::to_string(a_entry.check_.port_).c_str(), &hints, &result);
+    if ( 0 != rv || nullptr == result ) {
+        o_reason = "unable to resolve '" + a_entry.check_.host_ + "': " + gai_strerror(rv);
+        if ( nullptr != result ) {
+            freeaddrinfo(result);
+        }
+        return false;
+    }
+
+    a_entry.fd_ = socket(result->ai_family, SOCK_STREAM, 0);
+    if ( -1 == a_entry.fd_ ) {
+        o_reason = std::string("unable to create socket: ") + strerror(errno);
+        freeaddrinfo(result);
+        return false;
+    }
+
+    if ( -1 == fcntl(a_entry.fd_, F_SETFD, FD_CLOEXEC) || -1 == fcntl(a_entry.fd_, F_SETFL, fcntl(a_entry.fd_, F_GETFL, 0) | O_NONBLOCK) ) {
+        o_reason = std::string("unable to set socket options: ") + strerror(errno);
+        freeaddrinfo(result);
+        return false;
+    }
+
+    const int connected = connect(a_entry.fd_, result->ai_addr, result->ai_addrlen);
+    const int err_no    = errno;
+
+    freeaddrinfo(result);
+
+    if ( 0 == connected ) {
+        a_entry.phase_ = Phase::Sending;
+    } else if ( EINPROGRESS == err_no || EINTR == err_no ) {
+        a_entry.phase_ = Phase::Connecting;
+    } else {
+        o_reason = "unable to connect to " + a_entry.check_.host_ + ':' + std::to_string(a_entry.check_.port_) + ": " + strerror(err_no);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Continue a check, it's socket is ready.
+ *
+ * @param a_entry  Check in progress.
+ * @param o_reason Failure reason.
+ *
+ * @return \link Verdict \link.
+ */
+casper::app::monitor::Health::Verdict casper::app::monitor::Health::Advance (casper::app::monitor::Health::Entry& a_entry, std::string& o_reason)
+{
+    if ( Phase::Connecting == a_entry.phase_ ) {
+        int       err_no = 0;
+        socklen_t length = sizeof(err_no);
+        if ( -1 == getsockopt(a_entry.fd_, SOL_SOCKET, SO_ERROR, &err_no, &length) ) {
+            err_no = errno;
+        }
+        if ( 0 != err_no ) {
+            o_reason = "unable to connect to " + a_entry.check_.host_ + ':' + std::to_string(a_entry.check_.port_) + ": " + strerror(err_no);
+            return Verdict::Failed;
+        }
+        a_entry.phase_ = Phase::Sending;
+    }
+
+    if ( Phase::Sending == a_entry.phase_ ) {
+        const ssize_t count = write(a_entry.fd_, a_entry.request_.c_str() + a_entry.sent_, a_entry.request_.length() - a_entry.sent_);
+        if ( count < 0 ) {
+            if ( EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno ) {
+                return Verdict::Pending;
+            }
+            o_reason = std::string("unable to send request: ") + strerror(errno);
+            return Verdict::Failed;
+        }
+        a_entry.sent_ += static_cast<size_t>(count);
+        if ( a_entry.sent_ == a_entry.request_.length() ) {
+            a_entry.phase_ = Phase::Receiving;
+        }
+        return Verdict::Pending;
+    }
+
+    char          buffer[4096];
+    const ssize_t count = read(a_entry.fd_, buffer, sizeof(buffer));
+    if ( count < 0 ) {
+        if ( EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno ) {
+            return Verdict::Pending;
+        }
+        o_reason = std::string("unable to read reply: ") + strerror(errno);
+        return Verdict::Failed;
+    }
+    if ( a_entry.reply_.length() < k_casper_app_monitor_health_max_reply_ ) {
+        a_entry.reply_.append(buffer, static_cast<size_t>(count));
+    }
+
+    const Verdict verdict = Parse(a_entry, o_reason);
+    if ( Verdict::Pending == verdict && 0 == count ) {
+        o_reason = ( 0 == a_entry.reply_.length() ? "connection closed without a reply" : "connection closed before reply was complete" );
+        return Verdict::Failed;
+    }
+
+    return verdict;
+}
+
+/**
+ * @brief Check a ( partial ) reply.
+ *
+ * @param a_entry  Check in progress.
+ * @param o_reason Failure reason.
+ *
+ * @return \link Verdict \link.
+ */
+casper::app::monitor::Health::Verdict casper::app::monitor::Health::Parse (const casper::app::monitor::Health::Entry& a_entry, std::string& o_reason) const
+{
+    const std::string& reply = a_entry.reply_;
+    const size_t       eol   = reply.find("\r\n");
+
+    switch ( a_entry.check_.kind_ ) {
+        case Kind::Redis:
+            if ( std::string::npos == eol ) {
+                return Verdict::Pending;
+            }
+            if ( 0 == reply.compare(0, eol, "+PONG") ) {
+                return Verdict::Healthy;
+            }
+            o_reason = "unexpected reply to PING: '" + reply.substr(0, eol) + "'";
+            return Verdict::Failed;
+
+        case Kind::Beanstalkd:
+        {
+            if ( std::string::npos == eol ) {
+                return Verdict::Pending;
+            }
+            if ( 0 != reply.compare(0, 3, "OK ") ) {
+                o_reason = "unexpected reply to stats: '" + reply.substr(0, eol) + "'";
+                return Verdict::Failed;
+            }
+            // ... OK <bytes>\r\n<data>\r\n ...
+            const size_t bytes = static_cast<size_t>(strtoul(reply.c_str() + 3, nullptr, 10));
+            return ( reply.length() >= eol + 2 + bytes + 2 || reply.length() >= k_casper_app_monitor_health_max_reply_ ? Verdict::Healthy : Verdict::Pending );
+        }
+
+        case Kind::Postgres:
+            if ( 0 == reply.length() ) {
+                return Verdict::Pending;
+            }
+            if ( 'S' == reply[0] || 'N' == reply[0] ) {
+                return Verdict::Healthy;
+            }
+            o_reason = std::string("unexpected reply to SSLRequest: '") + reply[0] + "'";
+            return Verdict::Failed;
+
+        case Kind::HTTP:
+        default:
+        {
+            if ( std::string::npos == eol ) {
+                return Verdict::Pending;
+            }
+            // ... HTTP/1.x <status> <reason> ...
+            const size_t space  = reply.find(' ');
+            const int    status = ( std::string::npos != space && space < eol ? atoi(reply.c_str() + space + 1) : 0 );
+            if ( 0 == reply.compare(0, 5, "HTTP/") && status >= 200 && status < 400 ) {
+                return Verdict::Healthy;
+            }
+            o_reason = "unexpected reply to GET " + a_entry.check_.path_ + ": '" + reply.substr(0, eol) + "'";
+            return Verdict::Failed;
+        }
+    }
+}
+
+/**
+ * @brief Record a check result and decide if child is still healthy.
+ *
+ * @param a_id      Child id.
+ * @param a_entry   Finished check.
+ * @param a_success True when check succeeded.
+ * @param a_reason  Failure reason.
+ */
+void casper::app::monitor::Health::Finish (const std::string& a_id, casper::app::monitor::Health::Entry& a_entry,
+                                           const bool a_success, const std::string& a_reason)
+{
+    const std::chrono::steady_clock::time_point k_never_;
+
+    const auto     now        = std::chrono::steady_clock::now();
+    const uint64_t latency_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - a_entry.start_tp_).count());
+
+    Abort(a_entry);
+
+    // ... fixed rate, unless a check took longer than an interval ...
+    a_entry.next_tp_ = std::max(a_entry.start_tp_ + std::chrono::milliseconds(a_entry.check_.interval_ms_), now);
+
+    std::string reason;
+    if ( true == a_success ) {
+        a_entry.failures_ = 0;
+        if ( a_entry.check_.max_latency_ms_ > 0 && latency_us > static_cast<uint64_t>(a_entry.check_.max_latency_ms_) * 1000 ) {
+            if ( k_never_ == a_entry.slow_tp_ ) {
+                a_entry.slow_tp_ = a_entry.start_tp_;
+            }
+            if ( now - a_entry.slow_tp_ >= std::chrono::milliseconds(a_entry.check_.sustain_ms_) ) {
+                reason = std::string(Name(a_entry.check_.kind_)) + " check latency above " + std::to_string(a_entry.check_.max_latency_ms_)
+                         + " ms for " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(now - a_entry.slow_tp_).count()) + " ms";
+            }
+        } else {
+            a_entry.slow_tp_ = k_never_;
+        }
+    } else {
+        a_entry.failures_++;
+        if ( a_entry.failures_ >= a_entry.check_.failures_ ) {
+            reason = std::string(Name(a_entry.check_.kind_)) + " check failed " + std::to_string(a_entry.failures_) + " time(s) in a row, " + a_reason;
+        }
+    }
+
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats& stats = stats_[a_id];
+        stats.checks_++;
+        if ( true == a_success ) {
+            stats.latency_.Record(latency_us);
+        } else {
+            stats.failures_++;
+        }
+        // ... only for the run it was started for, a check that outlived an untrack and track must not report a new run ...
+        const auto target = targets_.find(a_id);
+        if ( 0 != reason.length() && targets_.end() != target && target->second == a_entry.tracked_ ) {
+            unhealthy_[a_id]  = reason;
+            a_entry.reported_ = true;
+            notify            = true;
+        }
+    }
+
+    if ( true == notify && nullptr != callback_ ) {
+        callback_();
+    }
+}
+
+/**
+ * @brief Release a check socket ( if any ).
+ *
+ * @param a_entry Check.
+ */
+void casper::app::monitor::Health::Abort (casper::app::monitor::Health::Entry& a_entry)
+{
+    if ( -1 != a_entry.fd_ ) {
+        close(a_entry.fd_);
+        a_entry.fd_ = -1;
+    }
+    a_entry.phase_ = Phase::Idle;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file health.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_HEALTH_H_
+#define CASPER_APP_MONITOR_HEALTH_H_
+#pragma once
+
+#include <stdint.h> // uint8_t, uint64_t
+
+#include <string>             // std::string
+#include <map>                // std::map
+#include <thread>             // std::thread
+#include <mutex>              // std::mutex
+#include <functional>         // std::function
+#include <chrono>             // std::chrono
+
+#include "casper/app/monitor/histogram.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Periodic liveness checks of ready children, all of them running concurrently on a single poll loop.
+             *
+             * Each check speaks just enough of the child protocol to prove it's serving requests, a child is reported
+             * unhealthy after a number of consecutive failures or when latency stayed above a threshold for a period.
+             */
+            class Health final
+            {
+
+            public: // Data Type(s)
+
+                enum class Kind : uint8_t {
+                    Redis = 0,  //!< PING, expecting +PONG.
+                    Beanstalkd, //!< stats, expecting OK and it's data.
+                    Postgres,   //!< SSLRequest, expecting 'S' or 'N'.
+                    HTTP        //!< GET <path>, expecting a 2xx or 3xx status.
+                };
+
+                typedef struct {
+                    Kind        kind_;
+                    std::string host_;           //!< Server host.
+                    int         port_;           //!< Server port.
+                    std::string path_;           //!< HTTP only, request path.
+                    int         interval_ms_;    //!< Delay between the start of two checks.
+                    int         timeout_ms_;     //!< Maximum duration of each check.
+                    int         failures_;       //!< Consecutive failures before it's unhealthy.
+                    int         max_latency_ms_; //!< Latency threshold, 0 to disable.
+                    int         sustain_ms_;     //!< For how long latency must stay above threshold before it's unhealthy.
+                } Check;
+
+                typedef struct {
+                    uint64_t  checks_;   //!< Number of finished checks.
+                    uint64_t  failures_; //!< Number of failed checks.
+                    Histogram latency_;  //!< Latency of successful checks.
+                } Stats;
+
+                typedef std::function<void()> Callback;
+
+            private: // Data Type(s)
+
+                enum class Phase : uint8_t {
+                    Idle = 0,
+                    Connecting,
+                    Sending,
+                    Receiving
+                };
+
+                typedef struct {
+                    Check                                 check_;
+                    int                                   fd_;
+                    Phase                                 phase_;
+                    std::string                           request_;
+                    size_t                                sent_;
+                    std::string                           reply_;
+                    std::chrono::steady_clock::time_point start_tp_;
+                    std::chrono::steady_clock::time_point next_tp_;
+                    std::chrono::steady_clock::time_point slow_tp_;  //!< First of current run of slow checks, epoch when last one was fast.
+                    int                                   failures_; //!< Consecutive failures.
+                    bool                                  reported_; //!< True when it was reported unhealthy, no more checks until it's tracked again.
+                    uint64_t                              tracked_;  //!< Version when it's child was tracked, a newer one starts a new run.
+                } Entry;
+
+                enum class Verdict : uint8_t {
+                    Pending = 0,
+                    Healthy,
+                    Failed
+                };
+
+            private: // Data
+
+                std::map<std::string, Check>       checks_;    //!< Configured checks, by child id.
+                std::map<std::string, uint64_t>    targets_;   //!< Ready children, version when they were tracked, by id.
+                std::map<std::string, Stats>       stats_;     //!< By child id, kept across runs.
+                std::map<std::string, std::string> unhealthy_; //!< Reasons, by child id, not collected yet.
+                uint64_t                           version_;   //!< Incremented when checks or targets change.
+                Callback                           callback_;
+
+            private: // Threading
+
+                std::thread*       thread_;
+                mutable std::mutex mutex_;
+                int                wake_fds_[2];
+                bool               aborted_;
+
+            public: // Constructor(s) / Destructor
+
+                Health ();
+                virtual ~Health ();
+
+            public: // Method(s) / Function(s)
+
+                void Setup     (const std::map<std::string, Check>& a_checks);
+                bool Start     (const Callback& a_callback);
+                void Stop      ();
+
+                void Track     (const std::string& a_id);
+                void Untrack   (const std::string& a_id);
+
+                void Unhealthy (std::map<std::string, std::string>& o_reasons);
+                bool Copy      (const std::string& a_id, Stats& o_stats) const;
+
+            public: // Static Method(s) / Function(s)
+
+                static const char* Name (const Kind a_kind);
+
+            private: // Method(s) / Function(s)
+
+                void    Loop    ();
+                void    Wake    ();
+                bool    Begin   (Entry& a_entry, std::string& o_reason);
+                Verdict Advance (Entry& a_entry, std::string& o_reason);
+                Verdict Parse   (const Entry& a_entry, std::string& o_reason) const;
+                void    Finish  (const std::string& a_id, Entry& a_entry, const bool a_success, const std::string& a_reason);
+                void    Abort   (Entry& a_entry);
+
+            }; // end of class 'Health'
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_HEALTH_H_
@@ -33,6 +33,26 @@
 
 #include "casper/app/logger.h"
 
+#ifndef __APPLE__
+    typedef int errno_t;
+#endif
+
+// ... children and exec probes are spawned without any of our fds ...
+#ifndef __APPLE__
+    #include <sys/syscall.h> // syscall
+    #ifndef SYS_close_range
+        #define SYS_close_range 436
+    #endif
+    #define CASPER_APP_MONITOR_CLOSE_RANGE_CLOEXEC ( 1U << 2 )
+#endif
+
+// ... posix_spawn can only be used when it can close all inherited fds ...
+#if defined(__APPLE__) || ( defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 34 ) ) )
+    #define CASPER_APP_MONITOR_SPAWN_CLOSES_FDS 1
+#else
+    #define CASPER_APP_MONITOR_SPAWN_CLOSES_FDS 0
+#endif
+
 #ifdef CASPER_APP_MONITOR_SET_ERROR
     #undef CASPER_APP_MONITOR_SET_ERROR
 #endif
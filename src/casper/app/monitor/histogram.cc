@@ -0,0 +1,120 @@
+/**
+ * @file histogram.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/histogram.h"
+
+#include <string.h> // memset
+
+const size_t casper::app::monitor::Histogram::k_sub_buckets_;
+const size_t casper::app::monitor::Histogram::k_buckets_;
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Histogram::Histogram ()
+{
+    Reset();
+}
+
+/**
+ * @brief Forget all recorded values.
+ */
+void casper::app::monitor::Histogram::Reset ()
+{
+    memset(counts_, 0, sizeof(counts_));
+    count_  = 0;
+    sum_us_ = 0;
+    max_us_ = 0;
+}
+
+/**
+ * @brief Record a value.
+ *
+ * @param a_value_us Value, in microseconds, values above range are recorded in the last bucket.
+ */
+void casper::app::monitor::Histogram::Record (const uint64_t a_value_us)
+{
+    counts_[Index(a_value_us)]++;
+    count_++;
+    sum_us_ += a_value_us;
+    if ( a_value_us > max_us_ ) {
+        max_us_ = a_value_us;
+    }
+}
+
+/**
+ * @brief Calculate a percentile.
+ *
+ * @param a_percentile Percentile, ]0, 100].
+ *
+ * @return Upper bound of the bucket where percentile falls, never above max, 0 when nothing was recorded.
+ */
+uint64_t casper::app::monitor::Histogram::Percentile (const double a_percentile) const
+{
+    if ( 0 == count_ ) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(( a_percentile / 100.0 ) * static_cast<double>(count_) + 0.5);
+    if ( rank < 1 ) {
+        rank = 1;
+    } else if ( rank > count_ ) {
+        rank = count_;
+    }
+    uint64_t seen = 0;
+    for ( size_t idx = 0 ; idx < k_buckets_ ; ++idx ) {
+        seen += counts_[idx];
+        if ( seen >= rank ) {
+            const uint64_t upper = Upper(idx);
+            return ( upper < max_us_ ? upper : max_us_ );
+        }
+    }
+    return max_us_;
+}
+
+/**
+ * @return Bucket index of a value.
+ */
+size_t casper::app::monitor::Histogram::Index (const uint64_t a_value_us)
+{
+    if ( a_value_us < k_sub_buckets_ ) {
+        return static_cast<size_t>(a_value_us);
+    }
+    // ... magnitude is the highest bit set, >= 4 ...
+    size_t magnitude = 63;
+    while ( 0 == ( a_value_us & ( 1ULL << magnitude ) ) ) {
+        magnitude--;
+    }
+    const size_t index = ( magnitude - 3 ) * k_sub_buckets_ + static_cast<size_t>(( a_value_us >> ( magnitude - 4 ) ) & ( k_sub_buckets_ - 1 ));
+    return ( index < k_buckets_ ? index : k_buckets_ - 1 );
+}
+
+/**
+ * @return Highest value that falls in a bucket.
+ */
+uint64_t casper::app::monitor::Histogram::Upper (const size_t a_index)
+{
+    if ( a_index < k_sub_buckets_ ) {
+        return static_cast<uint64_t>(a_index);
+    }
+    const size_t magnitude = a_index / k_sub_buckets_ + 3;
+    const size_t sub       = a_index % k_sub_buckets_;
+    return ( static_cast<uint64_t>(k_sub_buckets_ + sub + 1) << ( magnitude - 4 ) ) - 1;
+}
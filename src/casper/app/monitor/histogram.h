@@ -0,0 +1,112 @@
+/**
+ * @file histogram.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_HISTOGRAM_H_
+#define CASPER_APP_MONITOR_HISTOGRAM_H_
+#pragma once
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Latency histogram with HDR-style log-linear buckets, in microseconds.
+             *
+             * Values below 16 us are exact, above that each power of two is split in 16 buckets ( ~6% precision ),
+             * up to 2^32 us. Fixed size, no allocations, trivially copyable.
+             */
+            class Histogram final
+            {
+
+            public: // Const Data
+
+                static const size_t k_sub_buckets_ = 16;
+                static const size_t k_buckets_     = ( 32 - 4 + 1 ) * k_sub_buckets_;
+
+            private: // Data
+
+                uint64_t counts_[k_buckets_];
+                uint64_t count_;
+                uint64_t sum_us_;
+                uint64_t max_us_;
+
+            public: // Constructor(s) / Destructor
+
+                Histogram ();
+
+            public: // Method(s) / Function(s)
+
+                void     Reset      ();
+                void     Record     (const uint64_t a_value_us);
+                uint64_t Percentile (const double a_percentile) const;
+
+            public: // Inline Method(s) / Function(s)
+
+                uint64_t count () const;
+                uint64_t max   () const;
+                uint64_t mean  () const;
+
+            private: // Static Method(s) / Function(s)
+
+                static size_t   Index (const uint64_t a_value_us);
+                static uint64_t Upper (const size_t a_index);
+
+            }; // end of class 'Histogram'
+
+            /**
+             * @return Number of recorded values.
+             */
+            inline uint64_t Histogram::count () const
+            {
+                return count_;
+            }
+
+            /**
+             * @return Highest recorded value, in microseconds.
+             */
+            inline uint64_t Histogram::max () const
+            {
+                return max_us_;
+            }
+
+            /**
+             * @return Average of recorded values, in microseconds.
+             */
+            inline uint64_t Histogram::mean () const
+            {
+                return ( count_ > 0 ? sum_us_ / count_ : 0 );
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_HISTOGRAM_H_
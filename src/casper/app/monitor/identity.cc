@@ -0,0 +1,292 @@
+/**
+ * @file identity.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/identity.h"
+
+#include "casper/app/monitor/helper.h"
+
+#include <errno.h>  // errno
+#include <stdio.h>  // fopen, fread, fwrite, snprintf, sscanf
+#include <string.h> // strrchr, strlen
+#include <limits.h> // PATH_MAX
+
+#ifdef __APPLE__
+    #include <libproc.h>    // proc_pidpath, proc_pidinfo
+    #include <sys/sysctl.h> // sysctl, KERN_PROCARGS2
+#else
+    #include <unistd.h> // readlink, sysconf
+#endif
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Identity::Identity ()
+{
+    pid_     = 0;
+    started_ = 0;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Identity::~Identity ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Load a process identity.
+ *
+ * @param a_pid Process id.
+ *
+ * @return True on success, false otherwise ( ESRCH when process does not exist ).
+ */
+bool casper::app::monitor::Identity::Load (const pid_t a_pid)
+{
+    pid_     = a_pid;
+    started_ = 0;
+    executable_.clear();
+    arguments_.clear();
+
+    if ( a_pid <= 0 ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, ESRCH, "invalid pid %d", a_pid);
+        return false;
+    }
+
+#ifdef __APPLE__
+
+    struct proc_bsdinfo info;
+    if ( static_cast<int>(sizeof(info)) != proc_pidinfo(a_pid, PROC_PIDTBSDINFO, 0, &info, sizeof(info)) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, ( 0 != errno ? errno : ESRCH ), "unable to read process %d info", a_pid);
+        return false;
+    }
+    started_ = static_cast<time_t>(info.pbi_start_tvsec);
+
+    char path[PROC_PIDPATHINFO_MAXSIZE];
+    if ( proc_pidpath(a_pid, path, sizeof(path)) <= 0 ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to read process %d executable", a_pid);
+        return false;
+    }
+    executable_ = path;
+
+    // ... [ argc ][ exec path ][ \0 padding ][ argv[0] ]\0...[ argv[argc-1] ]\0[ environment ] ...
+    int    mib[3] = { CTL_KERN, KERN_PROCARGS2, static_cast<int>(a_pid) };
+    size_t size   = 0;
+    if ( 0 != sysctl(mib, 3, nullptr, &size, nullptr, 0) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to read process %d arguments", a_pid);
+        return false;
+    }
+    std::vector<char> buffer(size + 1, '\0');
+    if ( 0 != sysctl(mib, 3, buffer.data(), &size, nullptr, 0) || size < sizeof(int) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to read process %d arguments", a_pid);
+        return false;
+    }
+    int argc = 0;
+    memcpy(&argc, buffer.data(), sizeof(argc));
+    const char* ptr = buffer.data() + sizeof(argc);
+    const char* end = buffer.data() + size;
+    // ... skip exec path and padding ...
+    ptr += strnlen(ptr, static_cast<size_t>(end - ptr));
+    while ( ptr < end && '\0' == *ptr ) {
+        ptr++;
+    }
+    for ( int idx = 0 ; idx < argc && ptr < end ; ++idx ) {
+        const size_t length = strnlen(ptr, static_cast<size_t>(end - ptr));
+        arguments_.push_back(std::string(ptr, length));
+        ptr += length + 1;
+    }
+
+#else
+
+    char uri[64];
+
+    // ... start time, in clock ticks since boot ( 22nd field ) ...
+    snprintf(uri, sizeof(uri), "/proc/%d/stat", static_cast<int>(a_pid));
+    FILE* file = fopen(uri, "r");
+    if ( nullptr == file ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to open '%s'", uri);
+        return false;
+    }
+    char line[1024];
+    size_t length = fread(line, sizeof(char), sizeof(line) - 1, file);
+    fclose(file);
+    line[length] = '\0';
+
+    // ... comm can contain spaces and parenthesis, skip to last ')' ...
+    const char*        ptr   = strrchr(line, ')');
+    unsigned long long ticks = 0;
+    if ( nullptr == ptr || 1 != sscanf(ptr + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu", &ticks) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, EINVAL, "unable to parse '%s'", uri);
+        return false;
+    }
+
+    // ... boot time, seconds since epoch ...
+    unsigned long long boot = 0;
+    file = fopen("/proc/stat", "r");
+    if ( nullptr != file ) {
+        while ( nullptr != fgets(line, sizeof(line), file) ) {
+            if ( 1 == sscanf(line, "btime %llu", &boot) ) {
+                break;
+            }
+        }
+        fclose(file);
+    }
+    if ( 0 == boot ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, EINVAL, "%s", "unable to read boot time from '/proc/stat'");
+        return false;
+    }
+    started_ = static_cast<time_t>(boot + ticks / static_cast<unsigned long long>(sysconf(_SC_CLK_TCK)));
+
+    // ... executable, ' (deleted)' is appended when it was replaced or removed ...
+    char path[PATH_MAX];
+    snprintf(uri, sizeof(uri), "/proc/%d/exe", static_cast<int>(a_pid));
+    const ssize_t count = readlink(uri, path, sizeof(path) - 1);
+    if ( -1 == count ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to read '%s'", uri);
+        return false;
+    }
+    executable_ = std::string(path, static_cast<size_t>(count));
+
+    // ... command line, '\0' separated ...
+    snprintf(uri, sizeof(uri), "/proc/%d/cmdline", static_cast<int>(a_pid));
+    file = fopen(uri, "r");
+    if ( nullptr == file ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to open '%s'", uri);
+        return false;
+    }
+    std::string cmdline;
+    while ( ( length = fread(line, sizeof(char), sizeof(line), file) ) > 0 ) {
+        cmdline.append(line, length);
+    }
+    fclose(file);
+    for ( size_t start = 0 ; start < cmdline.length() ; ) {
+        size_t end = cmdline.find('\0', start);
+        if ( std::string::npos == end ) {
+            end = cmdline.length();
+        }
+        arguments_.push_back(cmdline.substr(start, end - start));
+        start = end + 1;
+    }
+
+#endif
+
+    return true;
+}
+
+/**
+ * @brief Load a process identity, as it was saved when it was spawned.
+ *
+ * @param a_uri File written by \link Save \link.
+ *
+ * @return True on success, false otherwise ( ENOENT when it was never saved ).
+ */
+bool casper::app::monitor::Identity::Load (const std::string& a_uri)
+{
+    pid_     = 0;
+    started_ = 0;
+    executable_.clear();
+    arguments_.clear();
+
+    FILE* file = fopen(a_uri.c_str(), "r");
+    if ( nullptr == file ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to open '%s'", a_uri.c_str());
+        return false;
+    }
+    std::string content;
+    char        buffer[1024];
+    size_t      length;
+    while ( ( length = fread(buffer, sizeof(char), sizeof(buffer), file) ) > 0 ) {
+        content.append(buffer, length);
+    }
+    fclose(file);
+
+    // ... <pid> <start time>\n<executable>\0<argv[0]>\0...<argv[argc-1]>\0 ...
+    int          pid     = 0;
+    long long    started = 0;
+    const size_t eol     = content.find('\n');
+    if ( std::string::npos == eol || 2 != sscanf(content.substr(0, eol).c_str(), "%d %lld", &pid, &started) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, EINVAL, "unable to parse '%s'", a_uri.c_str());
+        return false;
+    }
+    std::vector<std::string> fields;
+    for ( size_t start = eol + 1 ; start < content.length() ; ) {
+        size_t end = content.find('\0', start);
+        if ( std::string::npos == end ) {
+            end = content.length();
+        }
+        fields.push_back(content.substr(start, end - start));
+        start = end + 1;
+    }
+    if ( 0 == fields.size() ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, EINVAL, "unable to parse '%s'", a_uri.c_str());
+        return false;
+    }
+
+    pid_        = static_cast<pid_t>(pid);
+    started_    = static_cast<time_t>(started);
+    executable_ = fields[0];
+    arguments_.assign(fields.begin() + 1, fields.end());
+
+    return true;
+}
+
+/**
+ * @brief Save this identity, to be loaded by a next monitor.
+ *
+ * @param a_uri File to write, it's replaced.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Identity::Save (const std::string& a_uri)
+{
+    std::string content = std::to_string(pid_) + " " + std::to_string(static_cast<long long>(started_)) + "\n";
+    content += executable_;
+    content += '\0';
+    for ( const auto& argument : arguments_ ) {
+        content += argument;
+        content += '\0';
+    }
+
+    FILE* file = fopen(a_uri.c_str(), "w");
+    if ( nullptr == file ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to create '%s'", a_uri.c_str());
+        return false;
+    }
+    const bool written = ( content.length() == fwrite(content.data(), sizeof(char), content.length(), file) );
+    if ( 0 != fclose(file) || false == written ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to write '%s'", a_uri.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Replace what this process runs and how by it's definition, as it was spawned.
+ *
+ * @param a_executable Absolute executable path.
+ * @param a_arguments  Command line, including argv[0].
+ */
+void casper::app::monitor::Identity::Define (const std::string& a_executable, const std::vector<std::string>& a_arguments)
+{
+    executable_ = a_executable;
+    arguments_  = a_arguments;
+}
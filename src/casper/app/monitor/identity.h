@@ -0,0 +1,131 @@
+/**
+ * @file identity.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_IDENTITY_H_
+#define CASPER_APP_MONITOR_IDENTITY_H_
+#pragma once
+
+#include <sys/types.h> // pid_t
+#include <time.h>      // time_t
+
+#include <string> // std::string
+#include <vector> // std::vector
+
+#include "sys/error.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief What identifies a running process, beyond it's pid: when it started, what it runs and how.
+             *
+             * Linux: /proc/<pid>/{stat,exe,cmdline} and /proc/stat boot time.
+             * Darwin: libproc and KERN_PROCARGS2.
+             *
+             * A process can rewrite it's command line ( redis-server, nginx ), so what it was spawned with is saved to,
+             * and loaded from, a file next to it's pid file.
+             */
+            class Identity final
+            {
+
+            private: // Data
+
+                pid_t                    pid_;
+                time_t                   started_;    //!< Start time, seconds since epoch.
+                std::string              executable_; //!< Absolute executable path, as seen by the kernel.
+                std::vector<std::string> arguments_;  //!< Command line, including argv[0].
+                ::sys::Error             error_;
+
+            public: // Constructor(s) / Destructor
+
+                Identity ();
+                virtual ~Identity ();
+
+            public: // Method(s) / Function(s)
+
+                bool Load   (const pid_t a_pid);
+                bool Load   (const std::string& a_uri);
+                bool Save   (const std::string& a_uri);
+                void Define (const std::string& a_executable, const std::vector<std::string>& a_arguments);
+
+            public: // Inline Method(s) / Function(s)
+
+                pid_t                           pid        () const;
+                time_t                          started    () const;
+                const std::string&              executable () const;
+                const std::vector<std::string>& arguments  () const;
+                const ::sys::Error&             error      () const;
+
+            }; // end of class 'Identity'
+
+            /**
+             * @return Process id.
+             */
+            inline pid_t Identity::pid () const
+            {
+                return pid_;
+            }
+
+            /**
+             * @return Start time, seconds since epoch.
+             */
+            inline time_t Identity::started () const
+            {
+                return started_;
+            }
+
+            /**
+             * @return R/O access to executable path.
+             */
+            inline const std::string& Identity::executable () const
+            {
+                return executable_;
+            }
+
+            /**
+             * @return R/O access to command line.
+             */
+            inline const std::vector<std::string>& Identity::arguments () const
+            {
+                return arguments_;
+            }
+
+            /**
+             * @return R/O access to last error.
+             */
+            inline const ::sys::Error& Identity::error () const
+            {
+                return error_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_IDENTITY_H_
@@ -25,6 +25,8 @@
 
 #include <string>
 #include <map>
+#include <vector>    // std::vector
+#include <algorithm> // std::remove_if, std::min
 
 #include "casper/app/monitor/watchdog.h"
 #include "cc/sockets/dgram/ipc/client.h"
@@ -39,8 +41,14 @@
 #include "ev/signals.h"
 
 #include "casper/app/logger.h"
+#include "casper/app/tracer.h"
+#include "casper/app/codec.h"
+#include "casper/app/board.h"
+#include "casper/app/rpc.h"
 
 #include <signal.h>
+#include <string.h> // strsignal
+#include <errno.h>  // errno
 
 /**
  * @brief Show version.
@@ -63,9 +71,469 @@ static void show_help (const char* a_name)
     fprintf(stderr, "       -%c: %s\n", 'c' , "configuration file.");
     fprintf(stderr, "       -%d: %s\n", 'd' , "register debug token");
     fprintf(stderr, "       -%c: %s\n", 'h' , "show help.");
+    fprintf(stderr, "       -%c: %s\n", 'j' , "send JSON messages instead of binary frames, for debugging.");
+    fprintf(stderr, "       -%c: %s\n", 's' , "show status of a running 'monitor', given it's runtime directory, and exit.");
     fprintf(stderr, "       -%c: %s\n", 'v' , "show version.");
 }
 
+/**
+ * @brief Show children state, as published by a running 'monitor' in it's status board.
+ *
+ * @param a_runtime_dir 'monitor' runtime directory.
+ *
+ * @return 0 on success, -1 when status board can't be read.
+ */
+static int show_status (const std::string& a_runtime_dir)
+{
+    const std::string uri = a_runtime_dir + ( a_runtime_dir.length() > 0 && '/' != a_runtime_dir[a_runtime_dir.length() - 1] ? "/" : "" ) + "monitor.board";
+    
+    casper::app::Board                     board;
+    std::vector<casper::app::Board::Entry> entries;
+    pid_t                                  pid = 0;
+    if ( false == board.Open(uri) ) {
+        fprintf(stderr, "unable to open status board '%s': %s\n", uri.c_str(), strerror(errno));
+        return -1;
+    }
+    if ( false == board.Read(entries, pid) ) {
+        fprintf(stderr, "unable to read status board '%s'\n", uri.c_str());
+        return -1;
+    }
+    
+    // ... a crashed 'monitor' could not mark it ...
+    if ( 0 == pid || ( 0 != kill(pid, 0) && ESRCH == errno ) ) {
+        fprintf(stdout, "monitor is not running, last known state:\n");
+    } else {
+        fprintf(stdout, "monitor ( %d ) is running:\n", static_cast<int>(pid));
+    }
+    
+    fprintf(stdout, "%-24s %8s %-12s %8s %7s %12s %6s %8s %6s  %s\n",
+            "ID", "PID", "STATE", "RESTARTS", "CPU", "RSS", "FDS", "THREADS", "PROCS", "LAST EXIT"
+    );
+    for ( const auto& entry : entries ) {
+        fprintf(stdout, "%-24s %8d %-12s %8u %6.1f%% %12llu %6u %8u %6u  %s\n",
+                entry.id_, static_cast<int>(entry.pid_), casper::app::Board::Name(static_cast<casper::app::Board::State>(entry.state_)),
+                entry.restarts_, entry.cpu_, static_cast<unsigned long long>(entry.rss_), entry.fds_, entry.threads_, entry.processes_,
+                ( 0 != entry.exited_ ? entry.reason_ : "-" )
+        );
+    }
+    fflush(stdout);
+    
+    return 0;
+}
+
+/**
+ * @brief Send most recently encoded frame to parent process.
+ *
+ * @param a_codec Codec with an encoded frame.
+ * @param a_json  When true, the equivalent JSON message is sent instead, for debugging.
+ */
+static void send_frame (casper::app::Codec& a_codec, const bool a_json)
+{
+    Json::Value message;
+    if ( true == a_json ) {
+        (void)casper::app::Codec::ToJSON(a_codec.frame().c_str(), a_codec.frame().length(), message);
+    } else {
+        a_codec.Wrap(message);
+    }
+    cc::sockets::dgram::ipc::Client::GetInstance().Send(message);
+}
+
+/**
+ * @brief Convert a resource usage sample to JSON.
+ *
+ * @param a_sample  The sample.
+ * @param o_element JSON object.
+ */
+static void sample_to_json (const casper::app::monitor::Sampler::Sample& a_sample, Json::Value& o_element)
+{
+    o_element["ts"]        = static_cast<Json::Int64>(a_sample.timestamp_);
+    o_element["pid"]       = a_sample.pid_;
+    o_element["cpu"]       = a_sample.cpu_;
+    o_element["rss"]       = static_cast<Json::UInt64>(a_sample.rss_);
+    o_element["read"]      = static_cast<Json::UInt64>(a_sample.read_bytes_);
+    o_element["write"]     = static_cast<Json::UInt64>(a_sample.write_bytes_);
+    o_element["fds"]       = a_sample.fds_;
+    o_element["threads"]   = a_sample.threads_;
+    o_element["processes"] = a_sample.processes_;
+}
+
+/**
+ * @brief Convert health checks statistics to JSON, latencies in microseconds.
+ *
+ * @param a_stats   Statistics.
+ * @param o_element JSON object.
+ */
+static void health_to_json (const casper::app::monitor::Health::Stats& a_stats, Json::Value& o_element)
+{
+    o_element["checks"]   = static_cast<Json::UInt64>(a_stats.checks_);
+    o_element["failures"] = static_cast<Json::UInt64>(a_stats.failures_);
+    o_element["mean"]     = static_cast<Json::UInt64>(a_stats.latency_.mean());
+    o_element["p50"]      = static_cast<Json::UInt64>(a_stats.latency_.Percentile(50.0));
+    o_element["p90"]      = static_cast<Json::UInt64>(a_stats.latency_.Percentile(90.0));
+    o_element["p99"]      = static_cast<Json::UInt64>(a_stats.latency_.Percentile(99.0));
+    o_element["max"]      = static_cast<Json::UInt64>(a_stats.latency_.max());
+}
+
+/**
+ * @brief Reply to a 'metrics' request with most recent resource usage samples.
+ *
+ * @param a_request { "type": "metrics", "metrics": { "id": "<optional child id>", "count": <optional, default 1> } }
+ *
+ * One datagram per child, at most 10 samples each - larger requests are split using 'offset' and 'total'.
+ * Health checks statistics ( latencies in microseconds ), when configured, are only sent with the first datagram.
+ */
+static void send_metrics (const Json::Value& a_request)
+{
+    const size_t k_max_samples_per_message = 10;
+    
+    const Json::Value&                   request = a_request["metrics"];
+    const casper::app::monitor::Sampler& sampler = casper::app::monitor::Watchdog::GetInstance().sampler();
+    const casper::app::monitor::Health&  health  = casper::app::monitor::Watchdog::GetInstance().health();
+    
+    const size_t count = ( true == request.isObject() ? request.get("count", 1).asUInt() : 1 );
+    
+    std::vector<std::string> ids;
+    if ( true == request.isObject() && true == request["id"].isString() ) {
+        ids.push_back(request["id"].asString());
+    } else {
+        sampler.IDs(ids);
+    }
+    
+    std::vector<casper::app::monitor::Sampler::Sample> samples;
+    casper::app::monitor::Health::Stats                stats;
+    for ( auto id : ids ) {
+        
+        (void)sampler.Copy(id, count, samples);
+        
+        const bool checked = health.Copy(id, stats);
+        
+        size_t offset = 0;
+        do {
+            Json::Value message = Json::Value(Json::ValueType::objectValue);
+            message["type"] = "metrics";
+            
+            Json::Value& metrics = message["metrics"];
+            metrics["id"]       = id;
+            metrics["interval"] = sampler.interval();
+            metrics["offset"]   = static_cast<Json::UInt64>(offset);
+            metrics["total"]    = static_cast<Json::UInt64>(samples.size());
+            metrics["samples"]  = Json::Value(Json::ValueType::arrayValue);
+            
+            for ( size_t idx = offset ; idx < samples.size() && idx < offset + k_max_samples_per_message ; ++idx ) {
+                sample_to_json(samples[idx], metrics["samples"].append(Json::Value(Json::ValueType::objectValue)));
+            }
+            
+            if ( true == checked && 0 == offset ) {
+                health_to_json(stats, metrics["health"]);
+            }
+            
+            try {
+                cc::sockets::dgram::ipc::Client::GetInstance().Send(message);
+            } catch (const ::cc::Exception& a_cc_exception) {
+                CASPER_APP_LOG("error", "%s", a_cc_exception.what());
+                return;
+            }
+            
+            offset += k_max_samples_per_message;
+            
+        } while ( offset < samples.size() );
+    }
+}
+
+/**
+ * @brief Reply to a 'runs' request with most recent runs history.
+ *
+ * @param a_request { "type": "runs", "runs": { "id": "<optional child id>", "count": <optional, default 10> } }
+ *
+ * One datagram per child, at most 10 runs each - larger requests are split using 'offset' and 'total'.
+ * CPU times are in microseconds, timestamps in milliseconds since epoch.
+ */
+static void send_runs (const Json::Value& a_request)
+{
+    const size_t k_max_runs_per_message = 10;
+    
+    const Json::Value&                request = a_request["runs"];
+    const casper::app::monitor::Runs& runs    = casper::app::monitor::Watchdog::GetInstance().runs();
+    
+    const size_t count = ( true == request.isObject() ? request.get("count", 10).asUInt() : 10 );
+    
+    std::vector<std::string> ids;
+    if ( true == request.isObject() && true == request["id"].isString() ) {
+        ids.push_back(request["id"].asString());
+    } else {
+        runs.IDs(ids);
+    }
+    
+    std::vector<casper::app::monitor::Runs::Run> history;
+    for ( auto id : ids ) {
+        
+        (void)runs.Copy(id, count, history);
+        
+        size_t offset = 0;
+        do {
+            Json::Value message = Json::Value(Json::ValueType::objectValue);
+            message["type"] = "runs";
+            
+            Json::Value& object = message["runs"];
+            object["id"]     = id;
+            object["offset"] = static_cast<Json::UInt64>(offset);
+            object["total"]  = static_cast<Json::UInt64>(history.size());
+            object["runs"]   = Json::Value(Json::ValueType::arrayValue);
+            
+            for ( size_t idx = offset ; idx < history.size() && idx < offset + k_max_runs_per_message ; ++idx ) {
+                const casper::app::monitor::Runs::Run& run = history[idx];
+                Json::Value& element = object["runs"].append(Json::Value(Json::ValueType::objectValue));
+                element["pid"]     = run.pid_;
+                element["start"]   = static_cast<Json::Int64>(run.start_);
+                element["stop"]    = static_cast<Json::Int64>(run.stop_);
+                element["user"]    = static_cast<Json::UInt64>(run.user_us_);
+                element["system"]  = static_cast<Json::UInt64>(run.system_us_);
+                element["max_rss"] = static_cast<Json::UInt64>(run.max_rss_);
+                element["minflt"]  = static_cast<Json::UInt64>(run.minor_faults_);
+                element["majflt"]  = static_cast<Json::UInt64>(run.major_faults_);
+                element["nvcsw"]   = static_cast<Json::UInt64>(run.voluntary_switches_);
+                element["nivcsw"]  = static_cast<Json::UInt64>(run.involuntary_switches_);
+                element["status"]  = run.status_;
+                element["signal"]  = run.signal_;
+                element["reason"]  = run.reason_;
+            }
+            
+            try {
+                cc::sockets::dgram::ipc::Client::GetInstance().Send(message);
+            } catch (const ::cc::Exception& a_cc_exception) {
+                CASPER_APP_LOG("error", "%s", a_cc_exception.what());
+                return;
+            }
+            
+            offset += k_max_runs_per_message;
+            
+        } while ( offset < history.size() );
+    }
+}
+
+/**
+ * @brief Reply to a 'crashes' request with most recent crash reports.
+ *
+ * @param a_request { "type": "crashes", "crashes": { "id": "<optional child id>" } }
+ *
+ * One datagram per report, oldest first, 'offset' and 'total' identify it - stderr lines are truncated, full reports are
+ * kept in the crashes directory.
+ */
+static void send_crashes (const Json::Value& a_request)
+{
+    const size_t k_max_line_length = 256;
+    
+    const Json::Value&                   request = a_request["crashes"];
+    const casper::app::monitor::Crashes& crashes = casper::app::monitor::Watchdog::GetInstance().crashes();
+    
+    std::vector<casper::app::monitor::Crashes::Report> reports;
+    crashes.Copy(reports);
+    
+    if ( true == request.isObject() && true == request["id"].isString() ) {
+        const std::string id = request["id"].asString();
+        reports.erase(std::remove_if(reports.begin(), reports.end(), [&id] (const casper::app::monitor::Crashes::Report& a_report) {
+            return 0 != a_report.id_.compare(id);
+        }), reports.end());
+    }
+    
+    for ( size_t offset = 0 ; offset < reports.size() ; ++offset ) {
+        
+        const casper::app::monitor::Crashes::Report& report = reports[offset];
+        
+        Json::Value message = Json::Value(Json::ValueType::objectValue);
+        message["type"] = "crashes";
+        
+        Json::Value& crash = message["crashes"];
+        crash["offset"]      = static_cast<Json::UInt64>(offset);
+        crash["total"]       = static_cast<Json::UInt64>(reports.size());
+        crash["id"]          = report.id_;
+        crash["pid"]         = report.pid_;
+        crash["ts"]          = static_cast<Json::Int64>(report.timestamp_);
+        crash["signal"]      = report.signal_;
+        crash["description"] = strsignal(report.signal_);
+        crash["core_dumped"] = report.core_dumped_;
+        crash["core"]        = report.core_;
+        crash["core_size"]   = static_cast<Json::UInt64>(report.core_size_);
+        crash["user"]        = report.user_cpu_;
+        crash["system"]      = report.system_cpu_;
+        crash["max_rss"]     = static_cast<Json::UInt64>(report.max_rss_);
+        crash["count"]       = static_cast<Json::UInt64>(report.count_);
+        crash["quarantined"] = report.quarantined_;
+        crash["stderr"]      = Json::Value(Json::ValueType::arrayValue);
+        for ( auto line : report.stderr_ ) {
+            crash["stderr"].append(line.substr(0, k_max_line_length));
+        }
+        
+        try {
+            cc::sockets::dgram::ipc::Client::GetInstance().Send(message);
+        } catch (const ::cc::Exception& a_cc_exception) {
+            CASPER_APP_LOG("error", "%s", a_cc_exception.what());
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Send a request response to parent process.
+ *
+ * @param a_request The request being answered.
+ * @param a_status  Outcome.
+ * @param a_message Why it was not OK, ignored when empty.
+ * @param a_result  Operation result, ignored when null.
+ */
+static void send_response (const casper::app::RPC::Request& a_request, const casper::app::RPC::Status a_status, const std::string& a_message,
+                           const Json::Value& a_result = Json::Value::null)
+{
+    Json::Value message;
+    casper::app::RPC::Reply(a_request, a_status, a_message, a_result, message);
+    try {
+        cc::sockets::dgram::ipc::Client::GetInstance().Send(message);
+    } catch (const ::cc::Exception& a_cc_exception) {
+        CASPER_APP_LOG("error", "%s", a_cc_exception.what());
+    }
+}
+
+/**
+ * @brief Execute a request and send it's response.
+ *
+ * @param a_request  { "type": "request", "request": { "id": <number>, "op": "<operation>", "target": "<child id>", "args": { ... } } }
+ * @param a_start_cv Released by 'start'.
+ *
+ * Without a target: 'start', 'refresh', 'reload' and 'stop' ( whole stack ).
+ * With a target: 'restart', 'stop', 'signal' ( { "signal": <number> } ), 'tail' ( { "stream": "stderr" | "stdout", "lines": <optional, default 20> } )
+ * and 'metrics' ( { "count": <optional, default 1> } ). Restart, stop and signal are acknowledged by the watchdog loop
+ * thread once executed - exits and spawns are reported by events, as usual.
+ */
+static void handle_request (const casper::app::RPC::Request& a_request, osal::ConditionVariable& a_start_cv)
+{
+    const size_t k_max_lines       = 50;
+    const size_t k_max_line_length = 256;
+    const size_t k_max_samples     = 10;
+    
+    casper::app::monitor::Watchdog& watchdog = casper::app::monitor::Watchdog::GetInstance();
+    const Json::Value&              args     = a_request.args_;
+    const char* const               op       = a_request.op_.c_str();
+    
+    // ... whole stack ...
+    if ( 0 == a_request.target_.length() ) {
+        if ( 0 == strcasecmp("start", op) ) {
+            send_response(a_request, casper::app::RPC::Status::OK, "");
+            a_start_cv.Wake();
+        } else if ( 0 == strcasecmp("refresh", op) ) {
+            // ... full list is sent by watchdog ...
+            watchdog.Refresh();
+            send_response(a_request, casper::app::RPC::Status::OK, "");
+        } else if ( 0 == strcasecmp("reload", op) ) {
+            watchdog.Reload();
+            send_response(a_request, casper::app::RPC::Status::OK, "");
+        } else if ( 0 == strcasecmp("stop", op) ) {
+            // ... answered first, nothing is answered after this ...
+            send_response(a_request, casper::app::RPC::Status::OK, "");
+            watchdog.Stop();
+        } else if ( 0 == strcasecmp("restart", op) || 0 == strcasecmp("signal", op) || 0 == strcasecmp("tail", op) || 0 == strcasecmp("metrics", op) ) {
+            send_response(a_request, casper::app::RPC::Status::Invalid, "missing target");
+        } else {
+            send_response(a_request, casper::app::RPC::Status::Invalid, "unknown operation '" + a_request.op_ + "'");
+        }
+        return;
+    }
+    
+    const std::string id = a_request.target_;
+    
+    // ... single child ...
+    if ( 0 == strcasecmp("restart", op) || 0 == strcasecmp("stop", op) || 0 == strcasecmp("signal", op) ) {
+        
+        casper::app::monitor::Watchdog::Command command;
+        int                                     signal_no = 0;
+        if ( 0 == strcasecmp("restart", op) ) {
+            command = casper::app::monitor::Watchdog::Command::Restart;
+        } else if ( 0 == strcasecmp("stop", op) ) {
+            command = casper::app::monitor::Watchdog::Command::Stop;
+        } else {
+            command = casper::app::monitor::Watchdog::Command::Signal;
+            if ( false == args.isObject() || false == args["signal"].isInt() || args["signal"].asInt() <= 0 || args["signal"].asInt() >= NSIG ) {
+                send_response(a_request, casper::app::RPC::Status::Invalid, "missing or invalid signal number");
+                return;
+            }
+            signal_no = args["signal"].asInt();
+        }
+        
+        const casper::app::RPC::Request request = a_request;
+        watchdog.Submit(command, id, signal_no, [request] (const casper::app::monitor::Watchdog::Outcome a_outcome, const std::string& a_detail) {
+            switch (a_outcome) {
+                case casper::app::monitor::Watchdog::Outcome::Done:
+                {
+                    Json::Value result = Json::Value(Json::ValueType::objectValue);
+                    result["detail"] = a_detail;
+                    send_response(request, casper::app::RPC::Status::OK, "", result);
+                }
+                    break;
+                case casper::app::monitor::Watchdog::Outcome::Unknown:
+                    send_response(request, casper::app::RPC::Status::NotFound, a_detail);
+                    break;
+                case casper::app::monitor::Watchdog::Outcome::Refused:
+                    send_response(request, casper::app::RPC::Status::Rejected, a_detail);
+                    break;
+                case casper::app::monitor::Watchdog::Outcome::Failed:
+                default:
+                    send_response(request, casper::app::RPC::Status::Failed, a_detail);
+                    break;
+            }
+        });
+        
+    } else if ( 0 == strcasecmp("tail", op) ) {
+        
+        const std::string stream = ( true == args.isObject() && true == args["stream"].isString() ? args["stream"].asString() : "stderr" );
+        const size_t      lines  = ( true == args.isObject() && true == args["lines"].isUInt() ? args["lines"].asUInt() : 20 );
+        if ( 0 != stream.compare("stderr") && 0 != stream.compare("stdout") ) {
+            send_response(a_request, casper::app::RPC::Status::Invalid, "unknown stream '" + stream + "'");
+            return;
+        }
+        
+        std::vector<std::string> tail;
+        if ( false == watchdog.Tail(id, /* a_stderr */ 0 == stream.compare("stderr"), std::min(lines, k_max_lines), tail) ) {
+            send_response(a_request, casper::app::RPC::Status::NotFound, "unknown process, or it was never spawned");
+            return;
+        }
+        
+        Json::Value result = Json::Value(Json::ValueType::objectValue);
+        result["id"]     = id;
+        result["stream"] = stream;
+        result["lines"]  = Json::Value(Json::ValueType::arrayValue);
+        for ( auto line : tail ) {
+            result["lines"].append(line.substr(0, k_max_line_length));
+        }
+        send_response(a_request, casper::app::RPC::Status::OK, "", result);
+        
+    } else if ( 0 == strcasecmp("metrics", op) ) {
+        
+        const casper::app::monitor::Sampler& sampler = watchdog.sampler();
+        const size_t                         count   = ( true == args.isObject() && true == args["count"].isUInt() ? args["count"].asUInt() : 1 );
+        
+        std::vector<casper::app::monitor::Sampler::Sample> samples;
+        casper::app::monitor::Health::Stats                stats;
+        if ( false == sampler.Copy(id, std::min(count, k_max_samples), samples) ) {
+            send_response(a_request, casper::app::RPC::Status::NotFound, "unknown process, or it was never sampled");
+            return;
+        }
+        
+        Json::Value result = Json::Value(Json::ValueType::objectValue);
+        result["id"]       = id;
+        result["interval"] = sampler.interval();
+        result["samples"]  = Json::Value(Json::ValueType::arrayValue);
+        for ( const auto& sample : samples ) {
+            sample_to_json(sample, result["samples"].append(Json::Value(Json::ValueType::objectValue)));
+        }
+        if ( true == watchdog.health().Copy(id, stats) ) {
+            health_to_json(stats, result["health"]);
+        }
+        send_response(a_request, casper::app::RPC::Status::OK, "", result);
+        
+    } else {
+        send_response(a_request, casper::app::RPC::Status::Invalid, "unknown operation '" + a_request.op_ + "'");
+    }
+}
+
 /**
  * @brief 'monitor' process entry point
  *
@@ -78,15 +546,18 @@ int main (int a_argc, char* a_argv[])
     // -c B64 of a JSON string with required configuration
     // -d register debug token
     // -h display help
+    // -j send JSON messages instead of binary frames
+    // -s show status of a running 'monitor', given it's runtime directory
     // -v display version
     //
     CASPER_APP_LOG("status", "%s", "Starting 'monitor'...");
     
     Json::Value config;
+    bool        json = false;
 
     // ... parse arguments ...
     char opt;
-    while ( -1 != ( opt = getopt(a_argc, a_argv, "hvc:") ) ) {
+    while ( -1 != ( opt = getopt(a_argc, a_argv, "hvjs:c:") ) ) {
         switch (opt) {
             case 'h':
                 show_help(a_argv[0]);
@@ -94,6 +565,11 @@ int main (int a_argc, char* a_argv[])
             case 'v':
                 show_version(a_argv[0]);
                 return 0;
+            case 'j':
+                json = true;
+                break;
+            case 's':
+                return show_status(optarg);
             case 'c':
             {
                 Json::Reader reader;
@@ -134,8 +610,9 @@ int main (int a_argc, char* a_argv[])
         
     private: // Data
         
-        Json::Value   data_;
-        size_t        sigterm_count_;
+        casper::app::Codec codec_;
+        const bool         json_;
+        size_t             sigterm_count_;
         
     public: // Flags
         
@@ -145,8 +622,11 @@ int main (int a_argc, char* a_argv[])
         
         /**
          * @brief Default constructor.
+         *
+         * @param a_json When true, JSON messages are sent instead of binary frames.
          */
-        Listener ()
+        Listener (const bool a_json)
+            : json_(a_json)
         {
             sigterm_count_ = 0;
             abort_flag_    = false;
@@ -162,27 +642,55 @@ int main (int a_argc, char* a_argv[])
         
     public: // API Inherited Pure Virtual Method(s) / Function(s)
         
-        virtual void OnRunningProcessesUpdated (const ::sys::Process::List& a_list)
+        virtual void OnRunningProcessesUpdated (const ::sys::Process::List& a_list, const uint64_t a_sequence)
         {
-            data_         = Json::Value(Json::ValueType::objectValue);
-            data_["type"] = "list";
-            
-            Json::Value array = Json::Value(Json::ValueType::arrayValue);
-            
-            Json::Value& element = array.append(Json::Value(Json::ValueType::objectValue));
-            element["id" ] = "monitor";
-            element["pid"] = getpid();
+            codec_.List(a_sequence);
+            codec_.Append("monitor", getpid(), nullptr, 0);
 
+            const casper::app::monitor::Sampler& sampler = casper::app::monitor::Watchdog::GetInstance().sampler();
+            std::vector<pid_t>                   pids;
+            
             for ( auto process : a_list ) {
-                Json::Value& element = array.append(Json::Value(Json::ValueType::objectValue));
-                element["id" ] = process->info().id_;
-                element["pid"] = process->pid();
+                // ... workers and backends, as seen by most recent sample of this same run ...
+                if ( 0 != process->pid() && true == sampler.Members(process->info().id_, pids) && pids.size() > 0 && process->pid() == pids[0] ) {
+                    codec_.Append(process->info().id_, process->pid(), pids.data(), pids.size());
+                } else {
+                    codec_.Append(process->info().id_, process->pid(), nullptr, 0);
+                }
             }
             
-            data_["list"] = array;
+            try {
+                send_frame(codec_, json_);
+            } catch (const ::cc::Exception& a_cc_exception) {
+                CASPER_APP_LOG("error", "%s", a_cc_exception.what());
+            }
+        }
+        
+        virtual void OnProcessChanged (const casper::app::monitor::Watchdog::Event& a_event)
+        {
+            casper::app::Codec::Kind kind;
+            switch (a_event.kind_) {
+                case casper::app::monitor::Watchdog::Change::Spawned:
+                    kind = casper::app::Codec::Kind::Spawned;
+                    break;
+                case casper::app::monitor::Watchdog::Change::Ready:
+                    kind = casper::app::Codec::Kind::Ready;
+                    break;
+                case casper::app::monitor::Watchdog::Change::Exited:
+                    kind = casper::app::Codec::Kind::Exited;
+                    break;
+                case casper::app::monitor::Watchdog::Change::Restarting:
+                    kind = casper::app::Codec::Kind::Restarting;
+                    break;
+                case casper::app::monitor::Watchdog::Change::Threshold:
+                default:
+                    kind = casper::app::Codec::Kind::Threshold;
+                    break;
+            }
+            codec_.Event(a_event.sequence_, kind, a_event.id_, a_event.pid_, a_event.detail_);
             
             try {
-                cc::sockets::dgram::ipc::Client::GetInstance().Send(data_);
+                send_frame(codec_, json_);
             } catch (const ::cc::Exception& a_cc_exception) {
                 CASPER_APP_LOG("error", "%s", a_cc_exception.what());
             }
@@ -190,17 +698,9 @@ int main (int a_argc, char* a_argv[])
         
         virtual void OnError (const sys::Error& a_error, const bool a_fatal)
         {
-            data_         = Json::Value(Json::ValueType::objectValue);
-            data_["type"] = "error";
-            
-            data_["error"]["no"]    = a_error.no();
-            data_["error"]["str"]   = a_error.str();
-            data_["error"]["msg"]   = a_error.message();
-            data_["error"]["fnc"]   = a_error.function();
-            data_["error"]["ln"]    = a_error.line();
-            data_["error"]["fatal"] = a_fatal;
+            codec_.Error(a_error.no(), a_error.str(), a_error.message(), a_error.function(), a_error.line(), a_fatal);
             
-            cc::sockets::dgram::ipc::Client::GetInstance().Send(data_);
+            send_frame(codec_, json_);
         }
         
         virtual void OnTerminated ()
@@ -250,6 +750,9 @@ int main (int a_argc, char* a_argv[])
         // ... start logger ...
         ::casper::app::Logger::GetInstance().Startup(directories["logs"].asString(), "monitor", CASPER_MONITOR_VERSION);
         
+        // ... and trace, parent process already started a new one ...
+        ::casper::app::Tracer::GetInstance().Startup(directories["logs"].asString(), "monitor", /* a_truncate */ false);
+        
         // ... install signal(s) handler ...
         ::ev::Signals::GetInstance().Startup(::casper::app::Logger::GetInstance().loggable_data());
         ::ev::Signals::GetInstance().Register(
@@ -271,7 +774,7 @@ int main (int a_argc, char* a_argv[])
                                               }
         );
         
-        Listener                listener;
+        Listener                listener(json);
         osal::ConditionVariable start_cv;
         
         // ( on error, an exception will be thrown )
@@ -282,16 +785,43 @@ int main (int a_argc, char* a_argv[])
                                                                        try {
                                                                            const Json::Value& type       = a_value["type"];
                                                                            const char* const  type_c_str = type.asCString();
-                                                                           if ( 0 == strcasecmp("control", type_c_str) ) {
-                                                                               const char* const control_c_str = a_value[type_c_str].asCString();
-                                                                               if ( 0 == strcasecmp("start", control_c_str) ) {
-                                                                                   start_cv.Wake();
-                                                                               } else if ( 0 == strcasecmp("refresh", control_c_str) ) {
-                                                                                   casper::app::monitor::Watchdog::GetInstance().Refresh();
-                                                                               } else if ( 0 == strcasecmp("stop", control_c_str) ) {
-                                                                                   casper::app::monitor::Watchdog::GetInstance().Stop();
+                                                                           std::string        control;
+                                                                           std::string        frame;
+                                                                           if ( true == casper::app::Codec::Unwrap(a_value, frame) ) {
+                                                                               // ... binary frame, only control requests are expected ...
+                                                                               casper::app::Codec::Frame decoded;
+                                                                               casper::app::Codec::View  value;
+                                                                               if ( true == casper::app::Codec::Decode(frame.c_str(), frame.length(), decoded)
+                                                                                    && casper::app::Codec::Type::Control == decoded.type_ && true == casper::app::Codec::Read(decoded, value) ) {
+                                                                                   control.assign(value.data_, value.length_);
+                                                                               } else {
+                                                                                   CASPER_APP_LOG("error", "%s", "Ignored an invalid or unexpected frame...");
+                                                                               }
+                                                                           } else if ( 0 == strcasecmp("control", type_c_str) ) {
+                                                                               control = a_value[type_c_str].asString();
+                                                                           } else if ( 0 == strcasecmp("metrics", type_c_str) ) {
+                                                                               send_metrics(a_value);
+                                                                           } else if ( 0 == strcasecmp("crashes", type_c_str) ) {
+                                                                               send_crashes(a_value);
+                                                                           } else if ( 0 == strcasecmp("runs", type_c_str) ) {
+                                                                               send_runs(a_value);
+                                                                           } else if ( 0 == strcasecmp("request", type_c_str) ) {
+                                                                               casper::app::RPC::Request request;
+                                                                               if ( true == casper::app::RPC::Parse(a_value, request) ) {
+                                                                                   handle_request(request, start_cv);
+                                                                               } else {
+                                                                                   CASPER_APP_LOG("error", "%s", "Ignored a request without an id...");
                                                                                }
                                                                            }
+                                                                           if ( 0 == strcasecmp("start", control.c_str()) ) {
+                                                                               start_cv.Wake();
+                                                                           } else if ( 0 == strcasecmp("refresh", control.c_str()) ) {
+                                                                               casper::app::monitor::Watchdog::GetInstance().Refresh();
+                                                                           } else if ( 0 == strcasecmp("stop", control.c_str()) ) {
+                                                                               casper::app::monitor::Watchdog::GetInstance().Stop();
+                                                                           } else if ( 0 == strcasecmp("reload", control.c_str()) ) {
+                                                                               casper::app::monitor::Watchdog::GetInstance().Reload();
+                                                                           }
                                                                            
                                                                        } catch (const Json::Exception& a_json_exception) {
                                                                            // ... failure ...
@@ -311,19 +841,20 @@ int main (int a_argc, char* a_argv[])
                                                                }
         );
 
-        Json::Value status = Json::Value(Json::ValueType::objectValue);
-        status["type"]   = "status";
-
         // ... start a unidirectional message channel to send messages to parent process ...
         // ( on error, an exception will be thrown )
         cc::sockets::dgram::ipc::Client::GetInstance().Start("casper", directories["runtime"].asString());
         
-        status["status"] = "started";
-        cc::sockets::dgram::ipc::Client::GetInstance().Send(status);
+        casper::app::Codec codec;
+        codec.Status("started");
+        send_frame(codec, json);
 
         // ... wait for parent process order ...
         CASPER_APP_LOG("status", "%s", "Waiting for monitor's parent...");
-        start_cv.Wait();
+        {
+            ::casper::app::Tracer::Span span("Wait Parent");
+            start_cv.Wait();
+        }
         
         // ... start monitoring process(es) ...
         // ( on error, an exception will be thrown )
@@ -333,6 +864,9 @@ int main (int a_argc, char* a_argv[])
         CASPER_APP_LOG("status", "%s", "Resuming monitor...");
         watchdog.Start(config, /* a_detached */ false, listener, &listener.abort_flag_);
         
+        // ... it might carry an error, it's always sent as JSON ...
+        Json::Value status = Json::Value(Json::ValueType::objectValue);
+        status["type"]   = "status";
         status["status"] = "terminated";
         if ( true == watchdog.IsErrorSet() ) {
             watchdog.GetError([&status] (const ::sys::Error& a_error) {
@@ -0,0 +1,621 @@
+/**
+ * @file probe.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/probe.h"
+
+#include "casper/app/monitor/helper.h"
+
+#include <unistd.h>     // close, pread, fork, execve
+#include <errno.h>      // errno
+#include <fcntl.h>      // fcntl, open
+#include <signal.h>     // kill, sigemptyset, sigaddset, pthread_sigmask
+#include <poll.h>       // poll
+#include <netdb.h>      // getaddrinfo
+#include <spawn.h>      // posix_spawn
+#include <string.h>     // strerror, strncpy
+#include <sys/stat.h>   // fstat
+#include <sys/wait.h>   // waitpid
+#include <sys/socket.h> // socket, connect, getsockopt
+#include <sys/un.h>     // sockaddr_un
+
+extern char** environ;
+
+/**
+ * @brief Maximum delay between two checks of an attempt that is still pending and can't be watched by reactor, in milliseconds.
+ */
+static const int k_casper_app_monitor_probe_poll_ms_ = 10;
+
+/**
+ * @brief Maximum number of bytes of an incomplete log line kept between attempts.
+ */
+static const size_t k_casper_app_monitor_probe_max_partial_line_ = 64 * 1024;
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_id       Child process id.
+ * @param a_config   Probe configuration, must be already validated.
+ * @param a_reactor  Reactor that watches pending attempts, it must outlive this object.
+ * @param a_callback Function to call, from reactor, when a pending attempt can be checked.
+ */
+casper::app::monitor::Probe::Probe (const std::string& a_id, const casper::app::monitor::Probe::Config& a_config,
+                                    casper::app::monitor::Reactor& a_reactor, const casper::app::monitor::Probe::Callback& a_callback)
+    : id_(a_id), config_(a_config), callback_(a_callback), reactor_ptr_(&a_reactor)
+{
+    if ( Kind::Log == config_.kind_ ) {
+        regex_ = std::regex(config_.pattern_, std::regex::ECMAScript | std::regex::optimize);
+    }
+    fd_          = -1;
+    pid_         = -1;
+    offset_      = 0;
+    dev_         = 0;
+    ino_         = 0;
+    attempts_    = 0;
+    in_progress_ = false;
+    watching_    = false;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Probe::~Probe ()
+{
+    Abort();
+}
+
+/**
+ * @brief Prepare a new sequence of attempts, must be called before the child is spawned.
+ */
+void casper::app::monitor::Probe::Arm ()
+{
+    Abort();
+
+    attempts_ = 0;
+    partial_.clear();
+    CASPER_APP_MONITOR_RESET_ERROR(error_);
+
+    // ... only new log lines are relevant ...
+    offset_ = 0;
+    dev_    = 0;
+    ino_    = 0;
+    if ( Kind::Log == config_.kind_ ) {
+        struct stat stat_info;
+        if ( 0 == stat(config_.path_.c_str(), &stat_info) ) {
+            offset_ = stat_info.st_size;
+            dev_    = stat_info.st_dev;
+            ino_    = stat_info.st_ino;
+        }
+    }
+}
+
+/**
+ * @brief Start or continue an attempt.
+ *
+ * @param o_delay_ms When \link Status::Waiting \link is returned, delay until next call.
+ *
+ * @return \link Status \link.
+ */
+casper::app::monitor::Probe::Status casper::app::monitor::Probe::Step (int& o_delay_ms)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    Attempt attempt;
+    if ( false == in_progress_ ) {
+        attempts_++;
+        attempt_tp_  = now;
+        in_progress_ = true;
+        CASPER_APP_MONITOR_RESET_ERROR(error_);
+        attempt = Begin();
+    } else {
+        attempt = Check();
+    }
+
+    if ( Attempt::Ready == attempt ) {
+        Abort();
+        return Status::Ready;
+    }
+
+    if ( Attempt::Pending == attempt ) {
+        const int elapsed = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(now - attempt_tp_).count());
+        if ( elapsed < config_.timeout_ms_ ) {
+            const int remaining = config_.timeout_ms_ - elapsed;
+            // ... reactor calls back when it's done, only it's timeout is left to the caller ...
+            o_delay_ms = ( true == Watch() || remaining < k_casper_app_monitor_probe_poll_ms_ ? remaining : k_casper_app_monitor_probe_poll_ms_ );
+            return Status::Waiting;
+        }
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                     sys::Error::k_no_error_,
+                                     "%s probe timed out after %d ms", Name(config_.kind_), config_.timeout_ms_
+        );
+    }
+
+    // ... attempt failed ...
+    Abort();
+
+    if ( config_.retries_ >= 0 && attempts_ > config_.retries_ ) {
+        return Status::Failed;
+    }
+
+    o_delay_ms = config_.interval_ms_;
+
+    return Status::Waiting;
+}
+
+/**
+ * @return Human readable name of a probe kind, as used in configuration.
+ */
+const char* casper::app::monitor::Probe::Name (const casper::app::monitor::Probe::Kind a_kind)
+{
+    switch (a_kind) {
+        case Kind::TCP:
+            return "tcp";
+        case Kind::Unix:
+            return "unix";
+        case Kind::PIDFile:
+            return "pid_file";
+        case Kind::Log:
+            return "log";
+        case Kind::Exec:
+            return "exec";
+        default:
+            return "???";
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Start a new attempt.
+ *
+ * @return \link Attempt \link.
+ */
+casper::app::monitor::Probe::Attempt casper::app::monitor::Probe::Begin ()
+{
+    switch (config_.kind_) {
+        case Kind::TCP:
+        case Kind::Unix:
+            return Connect();
+        case Kind::PIDFile:
+            return ReadPIDFile();
+        case Kind::Log:
+            return ScanLog();
+        case Kind::Exec:
+            return Run();
+        default:
+            return Attempt::Failed;
+    }
+}
+
+/**
+ * @brief Check a pending attempt.
+ *
+ * @return \link Attempt \link.
+ */
+casper::app::monitor::Probe::Attempt casper::app::monitor::Probe::Check ()
+{
+    switch (config_.kind_) {
+        case Kind::TCP:
+        case Kind::Unix:
+            return IsConnected();
+        case Kind::Exec:
+            return IsDone();
+        default:
+            // ... pid file and log attempts are never left pending ...
+            return Attempt::Failed;
+    }
+}
+
+/**
+ * @brief Watch a pending attempt: it's socket until it's writable, or it's command until it exits.
+ *
+ * @return True when reactor will call back, false when it must be polled.
+ */
+bool casper::app::monitor::Probe::Watch ()
+{
+    if ( true == watching_ ) {
+        return true;
+    }
+    const Callback callback = callback_;
+    if ( -1 != fd_ ) {
+        watching_ = reactor_ptr_->Add(fd_, [callback] (const int /* a_fd */) { callback(); }, /* a_writable */ true);
+    } else if ( -1 != pid_ ) {
+        watching_ = reactor_ptr_->Follow(pid_, [callback] (const pid_t /* a_pid */) { callback(); });
+    }
+    return watching_;
+}
+
+/**
+ * @brief Stop watching current attempt, before it's socket is closed or it's command is reaped.
+ */
+void casper::app::monitor::Probe::Unwatch ()
+{
+    if ( false == watching_ ) {
+        return;
+    }
+    if ( -1 != fd_ ) {
+        reactor_ptr_->Remove(fd_);
+    } else if ( -1 != pid_ ) {
+        reactor_ptr_->Unfollow(pid_);
+    }
+    watching_ = false;
+}
+
+/**
+ * @brief Release all resources of current attempt ( if any ).
+ */
+void casper::app::monitor::Probe::Abort ()
+{
+    Unwatch();
+    if ( -1 != fd_ ) {
+        close(fd_);
+        fd_ = -1;
+    }
+    if ( -1 != pid_ ) {
+        (void)kill(pid_, SIGKILL);
+        int status;
+        while ( -1 == waitpid(pid_, &status, 0) && EINTR == errno ) {
+            /* retry */
+        }
+        pid_ = -1;
+    }
+    in_progress_ = false;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Start a non-blocking connection to a TCP or unix socket.
+ *
+ * @return \link Attempt \link.
+ */
+casper::app::monitor::Probe::Attempt casper::app::monitor::Probe::Connect ()
+{
+    struct sockaddr_storage address;
+    socklen_t               length;
+
+    memset(&address, 0, sizeof(address));
+
+    if ( Kind::Unix == config_.kind_ ) {
+        struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&address);
+        if ( config_.path_.length() >= sizeof(un->sun_path) ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                         sys::Error::k_no_error_,
+                                         "unix socket path '%s' is too long", config_.path_.c_str()
+            );
+            return Attempt::Failed;
+        }
+        un->sun_family = AF_UNIX;
+        strncpy(un->sun_path, config_.path_.c_str(), sizeof(un->sun_path) - 1);
+        length = static_cast<socklen_t>(sizeof(struct sockaddr_un));
+    } else {
+        struct addrinfo  hints;
+        struct addrinfo* result = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags    = AI_NUMERICSERV;
+        const int rv = getaddrinfo(config_.host_.c_str(), std::to_string(config_.port_).c_str(), &hints, &result);
+        if ( 0 != rv || nullptr == result ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                         sys::Error::k_no_error_,
+                                         "unable to resolve '%s': %s", config_.host_.c_str(), gai_strerror(rv)
+            );
+            if ( nullptr != result ) {
+                freeaddrinfo(result);
+            }
+            return Attempt::Failed;
+        }
+        memcpy(&address, result->ai_addr, result->ai_addrlen);
+        length = result->ai_addrlen;
+        freeaddrinfo(result);
+    }
+
+    fd_ = socket(address.ss_family, SOCK_STREAM, 0);
+    if ( -1 == fd_ ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to create probe socket");
+        return Attempt::Failed;
+    }
+
+    if ( -1 == fcntl(fd_, F_SETFD, FD_CLOEXEC) || -1 == fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL, 0) | O_NONBLOCK) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to set probe socket options");
+        return Attempt::Failed;
+    }
+
+    if ( 0 == connect(fd_, reinterpret_cast<struct sockaddr*>(&address), length) ) {
+        return Attempt::Ready;
+    } else if ( EINPROGRESS == errno || EINTR == errno ) {
+        return Attempt::Pending;
+    }
+
+    CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to connect to %s",
+                                 ( Kind::Unix == config_.kind_ ? config_.path_ : config_.host_ + ':' + std::to_string(config_.port_) ).c_str()
+    );
+
+    return Attempt::Failed;
+}
+
+/**
+ * @brief Check if a pending connection was established.
+ *
+ * @return \link Attempt \link.
+ */
+casper::app::monitor::Probe::Attempt casper::app::monitor::Probe::IsConnected ()
+{
+    struct pollfd pfd = { fd_, POLLOUT, 0 };
+
+    const int rv = poll(&pfd, 1, 0);
+    if ( 0 == rv || ( -1 == rv && EINTR == errno ) ) {
+        return Attempt::Pending;
+    } else if ( -1 == rv ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to poll probe socket");
+        return Attempt::Failed;
+    }
+
+    int       err_no = 0;
+    socklen_t length = sizeof(err_no);
+    if ( -1 == getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err_no, &length) ) {
+        err_no = errno;
+    }
+
+    if ( 0 == err_no ) {
+        return Attempt::Ready;
+    }
+
+    CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, err_no, "unable to connect to %s",
+                                 ( Kind::Unix == config_.kind_ ? config_.path_ : config_.host_ + ':' + std::to_string(config_.port_) ).c_str()
+    );
+
+    return Attempt::Failed;
+}
+
+/**
+ * @brief Check if a pid file exists and refers to a live process.
+ *
+ * @return \link Attempt \link.
+ */
+casper::app::monitor::Probe::Attempt casper::app::monitor::Probe::ReadPIDFile ()
+{
+    FILE* file = fopen(config_.path_.c_str(), "r");
+    if ( nullptr == file ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to open pid file '%s'", config_.path_.c_str());
+        return Attempt::Failed;
+    }
+
+    int pid = 0;
+    const int count = fscanf(file, "%d", &pid);
+    fclose(file);
+
+    if ( 1 != count || pid <= 0 ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                     sys::Error::k_no_error_,
+                                     "pid file '%s' is empty or invalid", config_.path_.c_str()
+        );
+        return Attempt::Failed;
+    }
+
+    if ( 0 != kill(static_cast<pid_t>(pid), 0) && EPERM != errno ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "process %d, from pid file '%s', is not running", pid, config_.path_.c_str());
+        return Attempt::Failed;
+    }
+
+    return Attempt::Ready;
+}
+
+/**
+ * @brief Search new log lines for a regular expression match.
+ *
+ * @return \link Attempt \link.
+ */
+casper::app::monitor::Probe::Attempt casper::app::monitor::Probe::ScanLog ()
+{
+    const int fd = open(config_.path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if ( -1 == fd ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to open log file '%s'", config_.path_.c_str());
+        return Attempt::Failed;
+    }
+
+    struct stat stat_info;
+    if ( 0 == fstat(fd, &stat_info) ) {
+        if ( stat_info.st_dev != dev_ || stat_info.st_ino != ino_ ) {
+            // ... rotated, renamed and a new file created, it's new segment may already be past old offset ...
+            offset_ = 0;
+            dev_    = stat_info.st_dev;
+            ino_    = stat_info.st_ino;
+            partial_.clear();
+        } else if ( stat_info.st_size < offset_ ) {
+            // ... truncated in place ...
+            offset_ = 0;
+            partial_.clear();
+        }
+    }
+
+    Attempt attempt = Attempt::Failed;
+
+    char    buffer[4096];
+    ssize_t count;
+    while ( Attempt::Ready != attempt && ( count = pread(fd, buffer, sizeof(buffer), offset_) ) > 0 ) {
+        offset_ += count;
+        partial_.append(buffer, static_cast<size_t>(count));
+        // ... match complete lines only ...
+        size_t start = 0;
+        size_t end;
+        while ( std::string::npos != ( end = partial_.find('\n', start) ) ) {
+            if ( true == std::regex_search(partial_.begin() + static_cast<std::string::difference_type>(start),
+                                           partial_.begin() + static_cast<std::string::difference_type>(end), regex_) ) {
+                attempt = Attempt::Ready;
+                break;
+            }
+            start = end + 1;
+        }
+        partial_.erase(0, start);
+        if ( partial_.length() > k_casper_app_monitor_probe_max_partial_line_ ) {
+            partial_.erase(0, partial_.length() - k_casper_app_monitor_probe_max_partial_line_);
+        }
+    }
+
+    close(fd);
+
+    if ( Attempt::Ready != attempt ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                     sys::Error::k_no_error_,
+                                     "'%s' not found in log file '%s'", config_.pattern_.c_str(), config_.path_.c_str()
+        );
+    }
+
+    return attempt;
+}
+
+/**
+ * @brief Launch a command, success is reported by it's exit status.
+ *
+ * @return \link Attempt \link.
+ */
+casper::app::monitor::Probe::Attempt casper::app::monitor::Probe::Run ()
+{
+    const char* argv[] = { "sh", "-c", config_.command_.c_str(), nullptr };
+
+#if CASPER_APP_MONITOR_SPAWN_CLOSES_FDS
+
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t          attributes;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO , "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+    short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+
+    // ... close ALL other open files, as children are spawned ...
+#ifdef __APPLE__
+    flags |= POSIX_SPAWN_CLOEXEC_DEFAULT;
+#else
+    posix_spawn_file_actions_addclosefrom_np(&actions, 3);
+#endif
+
+    // ... control signals are blocked in watchdog thread ...
+    sigset_t sigmask;
+    sigemptyset(&sigmask);
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setsigmask(&attributes, &sigmask);
+
+    // ... and ignored signals would survive exec ...
+    sigset_t sigdefault;
+    sigemptyset(&sigdefault);
+    for ( auto signal_no : { SIGINT, SIGHUP, SIGTERM, SIGUSR2, SIGPIPE, SIGTRAP } ) {
+        sigaddset(&sigdefault, signal_no);
+    }
+    posix_spawnattr_setsigdefault(&attributes, &sigdefault);
+
+    posix_spawnattr_setflags(&attributes, flags);
+
+    const int rv = posix_spawn(&pid_, "/bin/sh", &actions, &attributes, const_cast<char* const*>(argv), environ);
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+
+#else
+
+    // ... no posix_spawn_file_actions_addclosefrom_np, only async-signal-safe calls between fork and exec ...
+    int rv = 0;
+    pid_ = fork();
+    if ( -1 == pid_ ) {
+        rv = errno;
+    } else if ( 0 == pid_ ) {
+
+        sigset_t sigmask;
+        sigemptyset(&sigmask);
+        pthread_sigmask(SIG_SETMASK, &sigmask, NULL);
+        for ( auto signal_no : { SIGINT, SIGHUP, SIGTERM, SIGUSR2, SIGPIPE, SIGTRAP } ) {
+            (void)signal(signal_no, SIG_DFL);
+        }
+
+        const int null_fd = open("/dev/null", O_RDWR);
+        if ( -1 == null_fd || -1 == dup2(null_fd, STDIN_FILENO) || -1 == dup2(null_fd, STDOUT_FILENO) || -1 == dup2(null_fd, STDERR_FILENO) ) {
+            _exit(127);
+        }
+
+        // ... close ALL other open files ...
+        if ( 0 != syscall(SYS_close_range, 3U, ~0U, 0U) ) {
+            const int max = getdtablesize();
+            for ( int n = 3 ; n < max ; n++ ) {
+                close(n);
+            }
+        }
+
+        execve("/bin/sh", const_cast<char* const*>(argv), environ);
+
+        _exit(127);
+    }
+
+#endif
+
+    if ( 0 != rv ) {
+        pid_ = -1;
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, rv, "unable to run '%s'", config_.command_.c_str());
+        return Attempt::Failed;
+    }
+
+    return Attempt::Pending;
+}
+
+/**
+ * @brief Check if a command launched by \link Run \link is done.
+ *
+ * @return \link Attempt \link.
+ */
+casper::app::monitor::Probe::Attempt casper::app::monitor::Probe::IsDone ()
+{
+    int   status = 0;
+    pid_t rv;
+    do {
+        rv = waitpid(pid_, &status, WNOHANG);
+    } while ( -1 == rv && EINTR == errno );
+
+    if ( 0 == rv ) {
+        return Attempt::Pending;
+    }
+
+    Unwatch();
+    pid_ = -1;
+
+    if ( -1 == rv ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to wait for '%s'", config_.command_.c_str());
+        return Attempt::Failed;
+    }
+
+    if ( true == WIFEXITED(status) && 0 == WEXITSTATUS(status) ) {
+        return Attempt::Ready;
+    }
+
+    CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                 sys::Error::k_no_error_,
+                                 "'%s' %s %d", config_.command_.c_str(),
+                                 ( true == WIFEXITED(status) ? "exited with status" : "was killed by signal" ),
+                                 ( true == WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status) )
+    );
+
+    return Attempt::Failed;
+}
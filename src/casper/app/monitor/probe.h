@@ -0,0 +1,184 @@
+/**
+ * @file probe.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_PROBE_H_
+#define CASPER_APP_MONITOR_PROBE_H_
+#pragma once
+
+#include <sys/types.h> // pid_t, off_t, dev_t, ino_t
+
+#include <string>     // std::string
+#include <regex>      // std::regex
+#include <chrono>     // std::chrono
+#include <functional> // std::function
+
+#include "sys/error.h"
+
+#include "casper/app/monitor/reactor.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Non-blocking readiness probe, one attempt at a time, driven by the watchdog reactor.
+             *
+             * A pending connection ( writable ) or command ( exit ) wakes it up, timers only bound and space attempts.
+             */
+            class Probe final
+            {
+
+            public: // Data Type(s)
+
+                enum class Kind : uint8_t {
+                    TCP = 0,
+                    Unix,
+                    PIDFile,
+                    Log,
+                    Exec
+                };
+
+                enum class Status : uint8_t {
+                    Waiting = 0, //!< Not ready yet, call \link Step \link again after the returned delay.
+                    Ready,       //!< Probe succeeded.
+                    Failed       //!< All attempts failed, \link error \link is set.
+                };
+
+                typedef struct {
+                    Kind        kind_;
+                    std::string host_;        //!< TCP only.
+                    int         port_;        //!< TCP only.
+                    std::string path_;        //!< Unix socket, pid or log file URI.
+                    std::string pattern_;     //!< Log only, ECMAScript regular expression.
+                    std::string command_;     //!< Exec only, run by /bin/sh -c.
+                    int         interval_ms_; //!< Delay between attempts.
+                    int         timeout_ms_;  //!< Maximum duration of each attempt.
+                    int         retries_;     //!< Number of attempts after first one, -1 for unlimited.
+                } Config;
+
+                typedef std::function<void()> Callback;
+
+            private: // Data Type(s)
+
+                enum class Attempt : uint8_t {
+                    Pending = 0,
+                    Ready,
+                    Failed
+                };
+
+            private: // Const Data
+
+                const std::string id_;
+                const Config      config_;
+                const Callback    callback_; //!< Called by reactor when a pending attempt can be checked.
+
+            private: // Ptrs
+
+                Reactor* reactor_ptr_; //!< NOT MANAGED BY THIS CLASS
+
+            private: // Data
+
+                std::regex                            regex_;
+                int                                   fd_;
+                pid_t                                 pid_;
+                off_t                                 offset_;
+                dev_t                                 dev_;
+                ino_t                                 ino_;
+                std::string                           partial_;
+                int                                   attempts_;
+                bool                                  in_progress_;
+                bool                                  watching_;    //!< True when pending attempt fd or pid is watched by reactor.
+                std::chrono::steady_clock::time_point attempt_tp_;
+                ::sys::Error                          error_;
+
+            public: // Constructor(s) / Destructor
+
+                Probe (const std::string& a_id, const Config& a_config, Reactor& a_reactor, const Callback& a_callback);
+                virtual ~Probe ();
+
+            public: // Method(s) / Function(s)
+
+                void   Arm   ();
+                Status Step  (int& o_delay_ms);
+                void   Abort ();
+
+            public: // Inline Method(s) / Function(s)
+
+                Kind                kind     () const;
+                int                 attempts () const;
+                const ::sys::Error& error    () const;
+
+            public: // Static Method(s) / Function(s)
+
+                static const char* Name (const Kind a_kind);
+
+            private: // Method(s) / Function(s)
+
+                Attempt Begin   ();
+                Attempt Check   ();
+                bool    Watch   ();
+                void    Unwatch ();
+
+                Attempt Connect     ();
+                Attempt IsConnected ();
+                Attempt ReadPIDFile ();
+                Attempt ScanLog     ();
+                Attempt Run         ();
+                Attempt IsDone      ();
+
+            }; // end of class 'Probe'
+
+            /**
+             * @return Probe kind.
+             */
+            inline Probe::Kind Probe::kind () const
+            {
+                return config_.kind_;
+            }
+
+            /**
+             * @return Number of attempts made so far.
+             */
+            inline int Probe::attempts () const
+            {
+                return attempts_;
+            }
+
+            /**
+             * @return R/O access to last attempt error.
+             */
+            inline const ::sys::Error& Probe::error () const
+            {
+                return error_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_PROBE_H_
@@ -0,0 +1,137 @@
+/**
+ * @file process.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/process.h"
+
+#ifndef __APPLE__
+
+#include <stdio.h>  // fopen, fscanf
+#include <string.h> // strrchr
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_info Process info.
+ */
+casper::app::monitor::Process::Process (const ::sys::Process::Info& a_info)
+    : ::sys::Process(a_info)
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Process::~Process ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Check if this process is running.
+ *
+ * @param a_optional   If true, a missing process is not an error.
+ * @param a_parent_pid Expected parent process id.
+ * @param o_running    True when process exists, it's not a zombie and it's parent is the expected one.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Process::IsRunning (const bool& a_optional, const pid_t a_parent_pid, bool& o_running)
+{
+    pid_t ppid;
+    char  state;
+
+    o_running = false;
+    if ( false == Stat(ppid, state) ) {
+        return a_optional;
+    }
+
+    o_running = ( 'Z' != state && 'X' != state && a_parent_pid == ppid );
+
+    return true;
+}
+
+/**
+ * @brief Check if this process is a zombie.
+ *
+ * @param a_optional If true, a missing process is not an error.
+ * @param o_zombie   True when process is waiting to be reaped.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Process::IsZombie (const bool& a_optional, bool& o_zombie)
+{
+    pid_t ppid;
+    char  state;
+
+    o_zombie = false;
+    if ( false == Stat(ppid, state) ) {
+        return a_optional;
+    }
+
+    o_zombie = ( 'Z' == state );
+
+    return true;
+}
+
+/**
+ * @brief Read parent pid and state from /proc/<pid>/stat.
+ *
+ * @param o_ppid  Parent process id.
+ * @param o_state Process state.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Process::Stat (pid_t& o_ppid, char& o_state) const
+{
+    if ( pid() <= 0 ) {
+        return false;
+    }
+
+    char uri[64];
+    snprintf(uri, sizeof(uri), "/proc/%d/stat", static_cast<int>(pid()));
+
+    FILE* file = fopen(uri, "r");
+    if ( nullptr == file ) {
+        return false;
+    }
+
+    char line[1024];
+    const size_t length = fread(line, sizeof(char), sizeof(line) - 1, file);
+    fclose(file);
+    line[length] = '\0';
+
+    // ... comm can contain spaces and parenthesis, skip to last ')' ...
+    const char* ptr = strrchr(line, ')');
+    if ( nullptr == ptr ) {
+        return false;
+    }
+
+    int ppid = 0;
+    if ( 2 != sscanf(ptr + 1, " %c %d", &o_state, &ppid) ) {
+        return false;
+    }
+    o_ppid = static_cast<pid_t>(ppid);
+
+    return true;
+}
+
+#endif // __APPLE__
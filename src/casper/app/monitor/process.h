@@ -0,0 +1,77 @@
+/**
+ * @file process.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_PROCESS_H_
+#define CASPER_APP_MONITOR_PROCESS_H_
+#pragma once
+
+#ifdef __APPLE__
+    #include "sys/darwin/process.h"
+#else
+    #include "sys/process.h"
+#endif
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+#ifdef __APPLE__
+
+            typedef ::sys::darwin::Process Process;
+
+#else
+
+            /**
+             * @brief A process backed by /proc/<pid>/stat.
+             */
+            class Process final : public ::sys::Process
+            {
+
+            public: // Constructor(s) / Destructor
+
+                Process (const ::sys::Process::Info& a_info);
+                virtual ~Process ();
+
+            public: // Inherited Virtual Method(s) / Function(s)
+
+                virtual bool IsRunning (const bool& a_optional, const pid_t a_parent_pid, bool& o_running);
+                virtual bool IsZombie  (const bool& a_optional, bool& o_zombie);
+
+            private: // Method(s) / Function(s)
+
+                bool Stat (pid_t& o_ppid, char& o_state) const;
+
+            }; // end of class 'Process'
+
+#endif
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_PROCESS_H_
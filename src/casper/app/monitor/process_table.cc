@@ -0,0 +1,309 @@
+/**
+ * @file process_table.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/process_table.h"
+
+#include "casper/app/monitor/helper.h"
+
+#include <errno.h>  // errno
+#include <stdio.h>  // fopen, fread, snprintf, sscanf
+#include <stdlib.h> // atoi
+#include <string.h> // strrchr
+
+#include <set>   // std::set
+#include <deque> // std::deque
+
+#ifdef __APPLE__
+    #include <sys/proc.h> // SIDL, SRUN, SSLEEP, SSTOP, SZOMB
+#else
+    #include <unistd.h> // sysconf
+    #include <fcntl.h>  // open
+    #include <dirent.h> // opendir, readdir
+#endif
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::ProcessTable::ProcessTable ()
+{
+    generation_ = 0;
+#ifndef __APPLE__
+    boot_us_   = 0;
+    ticks_     = static_cast<int64_t>(sysconf(_SC_CLK_TCK));
+    page_size_ = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    // ... boot time, seconds since epoch ...
+    FILE* file = fopen("/proc/stat", "r");
+    if ( nullptr != file ) {
+        char               line[256];
+        unsigned long long boot = 0;
+        while ( nullptr != fgets(line, sizeof(line), file) ) {
+            if ( 1 == sscanf(line, "btime %llu", &boot) ) {
+                boot_us_ = static_cast<int64_t>(boot) * 1000000;
+                break;
+            }
+        }
+        fclose(file);
+    }
+#endif
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::ProcessTable::~ProcessTable ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Read a new snapshot of all processes.
+ *
+ * @param o_diff When not null, differences from previous snapshot.
+ *
+ * @return True on success, false otherwise ( previous snapshot is kept ).
+ */
+bool casper::app::monitor::ProcessTable::Refresh (casper::app::monitor::ProcessTable::Diff* o_diff)
+{
+    next_.clear();
+
+#ifdef __APPLE__
+
+    int    mib[3] = { CTL_KERN, KERN_PROC, KERN_PROC_ALL };
+    size_t size   = 0;
+
+    // ... table might grow between calls, retry with some room ...
+    int rv;
+    do {
+        if ( 0 != sysctl(mib, 3, nullptr, &size, nullptr, 0) ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to read process table size");
+            return false;
+        }
+        buffer_.resize(size / sizeof(struct kinfo_proc) + 32);
+        size = buffer_.size() * sizeof(struct kinfo_proc);
+        rv   = sysctl(mib, 3, buffer_.data(), &size, nullptr, 0);
+    } while ( 0 != rv && ENOMEM == errno );
+
+    if ( 0 != rv ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to read process table");
+        return false;
+    }
+
+    const size_t count = size / sizeof(struct kinfo_proc);
+    for ( size_t idx = 0 ; idx < count ; ++idx ) {
+        const struct kinfo_proc& info = buffer_[idx];
+        char state;
+        switch ( info.kp_proc.p_stat ) {
+            case SIDL  : state = 'I'; break;
+            case SRUN  : state = 'R'; break;
+            case SSLEEP: state = 'S'; break;
+            case SSTOP : state = 'T'; break;
+            case SZOMB : state = 'Z'; break;
+            default    : state = '?'; break;
+        }
+        next_[info.kp_proc.p_pid] = {
+            /* pid_      */ info.kp_proc.p_pid,
+            /* ppid_     */ info.kp_eproc.e_ppid,
+            /* pgid_     */ info.kp_eproc.e_pgid,
+            /* state_    */ state,
+            /* start_us_ */ static_cast<int64_t>(info.kp_proc.p_starttime.tv_sec) * 1000000 + static_cast<int64_t>(info.kp_proc.p_starttime.tv_usec),
+            /* rss_      */ 0
+        };
+    }
+
+#else
+
+    DIR* dir = opendir("/proc");
+    if ( nullptr == dir ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to open '/proc'");
+        return false;
+    }
+
+    char           uri[64];
+    char           buffer[1024];
+    struct dirent* entry;
+    while ( nullptr != ( entry = readdir(dir) ) ) {
+        if ( entry->d_name[0] < '0' || entry->d_name[0] > '9' ) {
+            continue;
+        }
+        snprintf(uri, sizeof(uri), "/proc/%s/stat", entry->d_name);
+        // ... gone meanwhile ...
+        const int fd = open(uri, O_RDONLY | O_CLOEXEC);
+        if ( -1 == fd ) {
+            continue;
+        }
+        const ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+        close(fd);
+        if ( length <= 0 ) {
+            continue;
+        }
+        buffer[length] = '\0';
+        // ... comm can contain spaces and parenthesis, skip to last ')' ...
+        const char* ptr = strrchr(buffer, ')');
+        if ( nullptr == ptr ) {
+            continue;
+        }
+        char               state = '?';
+        int                ppid  = 0;
+        int                pgid  = 0;
+        unsigned long long start = 0;
+        long long          rss   = 0;
+        if ( 5 != sscanf(ptr + 1, " %c %d %d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d %*d %*d %llu %*u %lld", &state, &ppid, &pgid, &start, &rss) ) {
+            continue;
+        }
+        const pid_t pid = static_cast<pid_t>(atoi(entry->d_name));
+        next_[pid] = {
+            /* pid_      */ pid,
+            /* ppid_     */ static_cast<pid_t>(ppid),
+            /* pgid_     */ static_cast<pid_t>(pgid),
+            /* state_    */ state,
+            /* start_us_ */ boot_us_ + static_cast<int64_t>(start) * 1000000 / ticks_,
+            /* rss_      */ ( rss > 0 ? static_cast<uint64_t>(rss) * page_size_ : 0 )
+        };
+    }
+
+    closedir(dir);
+
+#endif
+
+    // ... differences, a pid with a new start time was reused ...
+    if ( nullptr != o_diff ) {
+        o_diff->added_.clear();
+        o_diff->removed_.clear();
+        o_diff->changed_.clear();
+        for ( const auto& it : next_ ) {
+            const auto previous = entries_.find(it.first);
+            if ( entries_.end() == previous || previous->second.start_us_ != it.second.start_us_ ) {
+                o_diff->added_.push_back(it.first);
+            } else if ( previous->second.state_ != it.second.state_ || previous->second.ppid_ != it.second.ppid_ ) {
+                o_diff->changed_.push_back(it.first);
+            }
+        }
+        for ( const auto& it : entries_ ) {
+            const auto current = next_.find(it.first);
+            if ( next_.end() == current || current->second.start_us_ != it.second.start_us_ ) {
+                o_diff->removed_.push_back(it.first);
+            }
+        }
+    }
+
+    entries_.swap(next_);
+    generation_++;
+
+    return true;
+}
+
+/**
+ * @brief Find a process in current snapshot.
+ *
+ * @param a_pid Process id.
+ *
+ * @return Process entry, nullptr when it was not running.
+ */
+const casper::app::monitor::ProcessTable::Entry* casper::app::monitor::ProcessTable::Find (const pid_t a_pid) const
+{
+    const auto it = entries_.find(a_pid);
+    return ( entries_.end() != it ? &it->second : nullptr );
+}
+
+/**
+ * @brief Check if a process was running in current snapshot.
+ *
+ * @param a_pid        Process id.
+ * @param a_parent_pid Expected parent process id.
+ *
+ * @return True when process exists, it's not a zombie and it's parent is the expected one.
+ */
+bool casper::app::monitor::ProcessTable::IsRunning (const pid_t a_pid, const pid_t a_parent_pid) const
+{
+    const Entry* entry = Find(a_pid);
+    return ( nullptr != entry && 'Z' != entry->state_ && 'X' != entry->state_ && a_parent_pid == entry->ppid_ );
+}
+
+/**
+ * @brief Check if a process was a zombie in current snapshot.
+ *
+ * @param a_pid Process id.
+ *
+ * @return True when process is waiting to be reaped.
+ */
+bool casper::app::monitor::ProcessTable::IsZombie (const pid_t a_pid) const
+{
+    const Entry* entry = Find(a_pid);
+    return ( nullptr != entry && 'Z' == entry->state_ );
+}
+
+/**
+ * @brief Collect children of all processes in current snapshot.
+ *
+ * @param o_tree Children, by parent process id.
+ */
+void casper::app::monitor::ProcessTable::Tree (std::map<pid_t, std::vector<pid_t>>& o_tree) const
+{
+    o_tree.clear();
+    for ( const auto& it : entries_ ) {
+        if ( it.second.ppid_ > 0 ) {
+            o_tree[it.second.ppid_].push_back(it.first);
+        }
+    }
+}
+
+/**
+ * @brief Collect all processes of a tree, rooted at a process.
+ *
+ * @param a_root Root process id, a process group leader.
+ * @param a_tree Children, by parent process id, as returned by \link Tree \link.
+ * @param o_pids Root ( if still running ), it's descendants and all processes of it's group.
+ *
+ * @note Group members are included so that processes reparented after their parent died are still found.
+ */
+void casper::app::monitor::ProcessTable::Members (const pid_t a_root, const std::map<pid_t, std::vector<pid_t>>& a_tree,
+                                                  std::vector<pid_t>& o_pids) const
+{
+    o_pids.clear();
+    if ( a_root <= 0 ) {
+        return;
+    }
+
+    std::set<pid_t>   visited;
+    std::deque<pid_t> pending;
+
+    if ( entries_.end() != entries_.find(a_root) ) {
+        pending.push_back(a_root);
+    }
+    for ( const auto& it : entries_ ) {
+        if ( a_root == it.second.pgid_ && a_root != it.first ) {
+            pending.push_back(it.first);
+        }
+    }
+
+    while ( pending.size() > 0 ) {
+        const pid_t pid = pending.front();
+        pending.pop_front();
+        if ( false == visited.insert(pid).second ) {
+            continue;
+        }
+        o_pids.push_back(pid);
+        const auto children = a_tree.find(pid);
+        if ( a_tree.end() != children ) {
+            pending.insert(pending.end(), children->second.begin(), children->second.end());
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file process_table.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_PROCESS_TABLE_H_
+#define CASPER_APP_MONITOR_PROCESS_TABLE_H_
+#pragma once
+
+#include <sys/types.h> // pid_t
+#include <stdint.h>    // int64_t, uint64_t
+
+#ifdef __APPLE__
+    #include <sys/sysctl.h> // struct kinfo_proc
+#endif
+
+#include <vector>        // std::vector
+#include <map>           // std::map
+#include <unordered_map> // std::unordered_map
+
+#include "sys/error.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief A snapshot of all processes, read in one pass and diffed against the previous one.
+             *
+             * Darwin: a single KERN_PROC_ALL sysctl.
+             * Linux: one /proc/<pid>/stat read per process.
+             */
+            class ProcessTable final
+            {
+
+            public: // Data Type(s)
+
+                typedef struct {
+                    pid_t    pid_;
+                    pid_t    ppid_;
+                    pid_t    pgid_;     //!< Process group, for supervised children it's the session created at spawn.
+                    char     state_;    //!< As shown by ps: 'R' running, 'S' sleeping, 'T' stopped, 'Z' zombie, ...
+                    int64_t  start_us_; //!< Start time, microseconds since epoch.
+                    uint64_t rss_;      //!< Resident set size, in bytes, 0 when unknown ( Darwin ).
+                } Entry;
+
+                typedef struct {
+                    std::vector<pid_t> added_;   //!< New processes, including reused pids.
+                    std::vector<pid_t> removed_; //!< Processes that are gone.
+                    std::vector<pid_t> changed_; //!< Processes which state or parent changed.
+                } Diff;
+
+            private: // Data
+
+                std::unordered_map<pid_t, Entry> entries_;    //!< Current snapshot.
+                std::unordered_map<pid_t, Entry> next_;       //!< Being read, kept to reuse it's buckets.
+                uint64_t                         generation_; //!< Incremented by each successful refresh.
+#ifdef __APPLE__
+                std::vector<struct kinfo_proc>   buffer_;
+#else
+                int64_t                          boot_us_;    //!< Boot time, microseconds since epoch.
+                int64_t                          ticks_;      //!< Clock ticks per second.
+                uint64_t                         page_size_;
+#endif
+                ::sys::Error                     error_;
+
+            public: // Constructor(s) / Destructor
+
+                ProcessTable ();
+                virtual ~ProcessTable ();
+
+            public: // Method(s) / Function(s)
+
+                bool         Refresh   (Diff* o_diff = nullptr);
+                const Entry* Find      (const pid_t a_pid) const;
+                bool         IsRunning (const pid_t a_pid, const pid_t a_parent_pid) const;
+                bool         IsZombie  (const pid_t a_pid) const;
+                void         Tree      (std::map<pid_t, std::vector<pid_t>>& o_tree) const;
+                void         Members   (const pid_t a_root, const std::map<pid_t, std::vector<pid_t>>& a_tree, std::vector<pid_t>& o_pids) const;
+
+            public: // Inline Method(s) / Function(s)
+
+                const std::unordered_map<pid_t, Entry>& entries    () const;
+                uint64_t                                generation () const;
+                const ::sys::Error&                     error      () const;
+
+            }; // end of class 'ProcessTable'
+
+            /**
+             * @return R/O access to current snapshot, by pid.
+             */
+            inline const std::unordered_map<pid_t, ProcessTable::Entry>& ProcessTable::entries () const
+            {
+                return entries_;
+            }
+
+            /**
+             * @return Number of successful refreshes.
+             */
+            inline uint64_t ProcessTable::generation () const
+            {
+                return generation_;
+            }
+
+            /**
+             * @return R/O access to last error.
+             */
+            inline const ::sys::Error& ProcessTable::error () const
+            {
+                return error_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_PROCESS_TABLE_H_
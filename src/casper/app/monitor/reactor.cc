@@ -0,0 +1,739 @@
+/**
+ * @file reactor.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/reactor.h"
+
+#include "casper/app/monitor/helper.h"
+
+#include <unistd.h>   // close, read, write
+#include <errno.h>    // errno
+#include <string.h>   // memset
+#include <sys/wait.h> // wait4
+
+#ifdef __APPLE__
+    #include <sys/event.h> // kqueue, kevent
+#else
+    #include <sys/epoll.h>    // epoll_create1, epoll_ctl, epoll_wait
+    #include <sys/signalfd.h> // signalfd
+    #include <sys/eventfd.h>  // eventfd
+    #include <sys/syscall.h>  // syscall
+    #ifndef SYS_pidfd_open
+        #define SYS_pidfd_open 434
+    #endif
+#endif
+
+#ifndef __APPLE__
+    //
+    // epoll_event.data.u64 layout: [ kind : 32 ][ pid or fd : 32 ]
+    //
+    #define CASPER_APP_MONITOR_REACTOR_KIND_SIGNAL 1ull
+    #define CASPER_APP_MONITOR_REACTOR_KIND_WAKE   2ull
+    #define CASPER_APP_MONITOR_REACTOR_KIND_CHILD  3ull
+    #define CASPER_APP_MONITOR_REACTOR_KIND_FD     4ull
+    #define CASPER_APP_MONITOR_REACTOR_KIND_PROC   5ull
+    #define CASPER_APP_MONITOR_REACTOR_TAG(a_kind, a_pid) \
+        ( ( a_kind << 32 ) | static_cast<uint32_t>(a_pid) )
+#endif
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Reactor::Reactor ()
+{
+    fd_              = -1;
+    signal_fd_       = -1;
+    wake_fd_         = -1;
+    next_timer_id_   = 0;
+    pending_signals_ = 0;
+    sigemptyset(&saved_sigmask_);
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Reactor::~Reactor ()
+{
+    Close();
+}
+
+/**
+ * @brief Create the event set.
+ *
+ * @param a_signals Control signals to be delivered by this reactor, they will be blocked in the calling thread.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Reactor::Open (const std::set<int>& a_signals)
+{
+    Close();
+
+    CASPER_APP_MONITOR_RESET_ERROR(error_);
+
+    signals_ = a_signals;
+
+#ifdef __APPLE__
+
+    fd_ = kqueue();
+    if ( -1 == fd_ ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to create kqueue");
+        return false;
+    }
+
+    std::vector<struct kevent> changes;
+    for ( auto signal_no : signals_ ) {
+        struct kevent change;
+        EV_SET(&change, signal_no, EVFILT_SIGNAL, EV_ADD, 0, 0, nullptr);
+        changes.push_back(change);
+    }
+    {
+        struct kevent change;
+        EV_SET(&change, 0, EVFILT_USER, EV_ADD | EV_CLEAR, 0, 0, nullptr);
+        changes.push_back(change);
+    }
+
+    if ( -1 == kevent(fd_, changes.data(), static_cast<int>(changes.size()), nullptr, 0, nullptr) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to register control events");
+        Close();
+        return false;
+    }
+
+#else
+
+    fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if ( -1 == fd_ ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to create epoll set");
+        return false;
+    }
+
+    // ... signals must be blocked to be consumed by a signalfd ...
+    sigset_t sigmask;
+    sigemptyset(&sigmask);
+    for ( auto signal_no : signals_ ) {
+        sigaddset(&sigmask, signal_no);
+    }
+    pthread_sigmask(SIG_BLOCK, &sigmask, &saved_sigmask_);
+
+    signal_fd_ = signalfd(-1, &sigmask, SFD_NONBLOCK | SFD_CLOEXEC);
+    wake_fd_   = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ( -1 == signal_fd_ || -1 == wake_fd_ ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to create control file descriptors");
+        Close();
+        return false;
+    }
+
+    const std::vector<std::pair<int, uint64_t>> control = {
+        { signal_fd_, CASPER_APP_MONITOR_REACTOR_TAG(CASPER_APP_MONITOR_REACTOR_KIND_SIGNAL, 0) },
+        { wake_fd_  , CASPER_APP_MONITOR_REACTOR_TAG(CASPER_APP_MONITOR_REACTOR_KIND_WAKE  , 0) }
+    };
+    for ( auto it : control ) {
+        struct epoll_event event;
+        event.events   = EPOLLIN;
+        event.data.u64 = it.second;
+        if ( -1 == epoll_ctl(fd_, EPOLL_CTL_ADD, it.first, &event) ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to register control events");
+            Close();
+            return false;
+        }
+    }
+
+#endif
+
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Release all file descriptors and restore signal mask.
+ */
+void casper::app::monitor::Reactor::Close ()
+{
+    if ( -1 == fd_ ) {
+        return;
+    }
+
+#ifndef __APPLE__
+    for ( auto it : children_ ) {
+        close(it.second);
+    }
+    for ( auto it : followed_ ) {
+        close(it.second.fd_);
+    }
+#endif
+    children_.clear();
+    followed_.clear();
+    fds_.clear();
+    writable_.clear();
+    timers_.clear();
+
+#ifndef __APPLE__
+    if ( -1 != signal_fd_ ) {
+        close(signal_fd_);
+        signal_fd_ = -1;
+    }
+    if ( -1 != wake_fd_ ) {
+        close(wake_fd_);
+        wake_fd_ = -1;
+    }
+    pthread_sigmask(SIG_SETMASK, &saved_sigmask_, nullptr);
+#endif
+
+    close(fd_);
+    fd_ = -1;
+
+    signals_.clear();
+    pending_signals_ = 0;
+}
+
+/**
+ * @brief Start watching a child process exit.
+ *
+ * @param a_pid Child process id, or any other process id ( it's exit status won't be known ).
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Reactor::Watch (const pid_t a_pid)
+{
+    if ( children_.end() != children_.find(a_pid) ) {
+        return true;
+    }
+
+#ifdef __APPLE__
+
+    struct kevent change;
+    EV_SET(&change, a_pid, EVFILT_PROC, EV_ADD | EV_ONESHOT, NOTE_EXIT, 0, nullptr);
+    if ( -1 == kevent(fd_, &change, 1, nullptr, 0, nullptr) ) {
+        if ( ESRCH != errno ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to watch child with pid %d", a_pid);
+            return false;
+        }
+        // ... already exited, it will be reaped on next wait ...
+        children_[a_pid] = -1;
+        Wake();
+    } else {
+        children_[a_pid] = 0;
+    }
+
+#else
+
+    const int pid_fd = static_cast<int>(syscall(SYS_pidfd_open, a_pid, 0));
+    if ( -1 == pid_fd ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to open pidfd for child with pid %d", a_pid);
+        return false;
+    }
+
+    struct epoll_event event;
+    event.events   = EPOLLIN;
+    event.data.u64 = CASPER_APP_MONITOR_REACTOR_TAG(CASPER_APP_MONITOR_REACTOR_KIND_CHILD, a_pid);
+    if ( -1 == epoll_ctl(fd_, EPOLL_CTL_ADD, pid_fd, &event) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to watch child with pid %d", a_pid);
+        close(pid_fd);
+        return false;
+    }
+    children_[a_pid] = pid_fd;
+
+#endif
+
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Stop watching a child process.
+ *
+ * @param a_pid Child process id.
+ */
+void casper::app::monitor::Reactor::Unwatch (const pid_t a_pid)
+{
+    const auto it = children_.find(a_pid);
+    if ( children_.end() == it ) {
+        return;
+    }
+#ifdef __APPLE__
+    if ( 0 == it->second ) {
+        struct kevent change;
+        EV_SET(&change, a_pid, EVFILT_PROC, EV_DELETE, 0, 0, nullptr);
+        (void)kevent(fd_, &change, 1, nullptr, 0, nullptr);
+    }
+#else
+    (void)epoll_ctl(fd_, EPOLL_CTL_DEL, it->second, nullptr);
+    close(it->second);
+#endif
+    children_.erase(it);
+}
+
+/**
+ * @brief Start watching a file descriptor for read availability ( or EOF ).
+ *
+ * @param a_fd       File descriptor, not owned by this reactor.
+ * @param a_callback Function to call when \link a_fd \link is readable.
+ * @param a_writable When true, \link a_callback \link is called when \link a_fd \link is writable instead ( or on error ).
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Reactor::Add (const int a_fd, const casper::app::monitor::Reactor::ReadCallback& a_callback, const bool a_writable)
+{
+#ifdef __APPLE__
+    struct kevent change;
+    EV_SET(&change, a_fd, ( true == a_writable ? EVFILT_WRITE : EVFILT_READ ), EV_ADD, 0, 0, nullptr);
+    if ( -1 == kevent(fd_, &change, 1, nullptr, 0, nullptr) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to watch fd %d", a_fd);
+        return false;
+    }
+#else
+    struct epoll_event event;
+    event.events   = ( true == a_writable ? EPOLLOUT : EPOLLIN );
+    event.data.u64 = CASPER_APP_MONITOR_REACTOR_TAG(CASPER_APP_MONITOR_REACTOR_KIND_FD, a_fd);
+    if ( -1 == epoll_ctl(fd_, EPOLL_CTL_ADD, a_fd, &event) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to watch fd %d", a_fd);
+        return false;
+    }
+#endif
+    fds_[a_fd] = a_callback;
+    if ( true == a_writable ) {
+        writable_.insert(a_fd);
+    } else {
+        writable_.erase(a_fd);
+    }
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Stop watching a file descriptor, it must be called before closing it.
+ *
+ * @param a_fd File descriptor.
+ */
+void casper::app::monitor::Reactor::Remove (const int a_fd)
+{
+    const auto it = fds_.find(a_fd);
+    if ( fds_.end() == it ) {
+        return;
+    }
+#ifdef __APPLE__
+    struct kevent change;
+    EV_SET(&change, a_fd, ( writable_.end() != writable_.find(a_fd) ? EVFILT_WRITE : EVFILT_READ ), EV_DELETE, 0, 0, nullptr);
+    (void)kevent(fd_, &change, 1, nullptr, 0, nullptr);
+#else
+    (void)epoll_ctl(fd_, EPOLL_CTL_DEL, a_fd, nullptr);
+#endif
+    fds_.erase(it);
+    writable_.erase(a_fd);
+}
+
+/**
+ * @brief Start watching a process exit, without reaping it.
+ *
+ * @param a_pid      Process id, when it's our child it must be reaped by the caller.
+ * @param a_callback Function to call, once, when it exits.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Reactor::Follow (const pid_t a_pid, const casper::app::monitor::Reactor::ProcessCallback& a_callback)
+{
+    if ( followed_.end() != followed_.find(a_pid) ) {
+        followed_[a_pid].callback_ = a_callback;
+        return true;
+    }
+
+#ifdef __APPLE__
+
+    // ... udata tells it apart from children, which are reaped here ...
+    struct kevent change;
+    EV_SET(&change, a_pid, EVFILT_PROC, EV_ADD | EV_ONESHOT, NOTE_EXIT, 0, &followed_);
+    if ( -1 == kevent(fd_, &change, 1, nullptr, 0, nullptr) ) {
+        if ( ESRCH != errno ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to follow process with pid %d", a_pid);
+            return false;
+        }
+        // ... already exited, it will be notified on next wait ...
+        followed_[a_pid] = { /* fd_ */ -1, /* callback_ */ a_callback };
+        Wake();
+    } else {
+        followed_[a_pid] = { /* fd_ */ 0, /* callback_ */ a_callback };
+    }
+
+#else
+
+    const int pid_fd = static_cast<int>(syscall(SYS_pidfd_open, a_pid, 0));
+    if ( -1 == pid_fd ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to open pidfd for process with pid %d", a_pid);
+        return false;
+    }
+
+    struct epoll_event event;
+    event.events   = EPOLLIN;
+    event.data.u64 = CASPER_APP_MONITOR_REACTOR_TAG(CASPER_APP_MONITOR_REACTOR_KIND_PROC, a_pid);
+    if ( -1 == epoll_ctl(fd_, EPOLL_CTL_ADD, pid_fd, &event) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to follow process with pid %d", a_pid);
+        close(pid_fd);
+        return false;
+    }
+    followed_[a_pid] = { /* fd_ */ pid_fd, /* callback_ */ a_callback };
+
+#endif
+
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Stop watching a followed process, it must be called before it's reaped.
+ *
+ * @param a_pid Process id.
+ */
+void casper::app::monitor::Reactor::Unfollow (const pid_t a_pid)
+{
+    const auto it = followed_.find(a_pid);
+    if ( followed_.end() == it ) {
+        return;
+    }
+#ifdef __APPLE__
+    if ( 0 == it->second.fd_ ) {
+        struct kevent change;
+        EV_SET(&change, a_pid, EVFILT_PROC, EV_DELETE, 0, 0, nullptr);
+        (void)kevent(fd_, &change, 1, nullptr, 0, nullptr);
+    }
+#else
+    (void)epoll_ctl(fd_, EPOLL_CTL_DEL, it->second.fd_, nullptr);
+    close(it->second.fd_);
+#endif
+    followed_.erase(it);
+}
+
+/**
+ * @brief Schedule a one-shot timer, it will be fired by \link Wait \link from the waiting thread.
+ *
+ * @param a_delay_ms Delay in milliseconds, 0 to fire on next wait.
+ * @param a_callback Function to call when timer expires.
+ *
+ * @return Timer id, to be used with \link Cancel \link.
+ */
+uint64_t casper::app::monitor::Reactor::Schedule (const int a_delay_ms, const casper::app::monitor::Reactor::TimerCallback& a_callback)
+{
+    const uint64_t id = ++next_timer_id_;
+    timers_.insert(std::make_pair(std::chrono::steady_clock::now() + std::chrono::milliseconds(a_delay_ms > 0 ? a_delay_ms : 0),
+                                  Timer({ /* id_ */ id, /* callback_ */ a_callback })
+    ));
+    return id;
+}
+
+/**
+ * @brief Cancel a previously scheduled timer.
+ *
+ * @param a_id Timer id, unknown or already fired timers are ignored.
+ */
+void casper::app::monitor::Reactor::Cancel (const uint64_t a_id)
+{
+    for ( auto it = timers_.begin() ; timers_.end() != it ; ++it ) {
+        if ( a_id == it->second.id_ ) {
+            timers_.erase(it);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Block until at least one event is available or a timer expires and deliver all of them.
+ *
+ * @param a_timeout_ms      Maximum time to wait, -1 to wait forever ( or until next timer expires ).
+ * @param a_exit_callback   Function to call for each reaped child.
+ * @param a_signal_callback Function to call for each received control signal.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Reactor::Wait (const int a_timeout_ms,
+                                          const casper::app::monitor::Reactor::ExitCallback& a_exit_callback,
+                                          const casper::app::monitor::Reactor::SignalCallback& a_signal_callback)
+{
+    const int k_max_events = 64;
+
+#ifdef __APPLE__
+
+    // ... children that exited before they could be registered ...
+    std::vector<pid_t> exited;
+    for ( auto it : children_ ) {
+        if ( -1 == it.second ) {
+            exited.push_back(it.first);
+        }
+    }
+    for ( auto pid : exited ) {
+        if ( false == Reap(pid, a_exit_callback) ) {
+            return false;
+        }
+    }
+    exited.clear();
+    for ( auto it : followed_ ) {
+        if ( -1 == it.second.fd_ ) {
+            exited.push_back(it.first);
+        }
+    }
+    for ( auto pid : exited ) {
+        Notify(pid);
+    }
+
+    struct kevent   events[k_max_events];
+    struct timespec timeout;
+
+    const int timeout_ms = Timeout(a_timeout_ms);
+    if ( timeout_ms >= 0 ) {
+        timeout.tv_sec  = timeout_ms / 1000;
+        timeout.tv_nsec = ( timeout_ms % 1000 ) * 1000000;
+    }
+
+    const int count = kevent(fd_, nullptr, 0, events, k_max_events, ( timeout_ms >= 0 ? &timeout : nullptr ));
+    if ( -1 == count && EINTR != errno ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "an error occurred while waiting for events");
+        return false;
+    }
+
+    for ( int idx = 0 ; idx < count ; ++idx ) {
+        const struct kevent& event = events[idx];
+        if ( EVFILT_SIGNAL == event.filter ) {
+            pending_signals_.fetch_or(( 1ull << event.ident ));
+        } else if ( EVFILT_PROC == event.filter && nullptr != event.udata ) {
+            const auto it = followed_.find(static_cast<pid_t>(event.ident));
+            if ( followed_.end() != it ) {
+                it->second.fd_ = -1;
+            }
+            Notify(static_cast<pid_t>(event.ident));
+        } else if ( EVFILT_PROC == event.filter ) {
+            const pid_t pid = static_cast<pid_t>(event.ident);
+            const auto  it  = children_.find(pid);
+            if ( children_.end() != it ) {
+                it->second = -1;
+            }
+            if ( false == Reap(pid, a_exit_callback) ) {
+                return false;
+            }
+        } else if ( EVFILT_READ == event.filter || EVFILT_WRITE == event.filter ) {
+            Dispatch(static_cast<int>(event.ident));
+        } /* else { EVFILT_USER - wake } */
+    }
+
+#else
+
+    struct epoll_event events[k_max_events];
+
+    const int count = epoll_wait(fd_, events, k_max_events, Timeout(a_timeout_ms));
+    if ( -1 == count && EINTR != errno ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "an error occurred while waiting for events");
+        return false;
+    }
+
+    for ( int idx = 0 ; idx < count ; ++idx ) {
+        const uint64_t kind  = ( events[idx].data.u64 >> 32 );
+        const uint32_t ident = static_cast<uint32_t>(events[idx].data.u64 & 0xFFFFFFFF);
+        if ( CASPER_APP_MONITOR_REACTOR_KIND_SIGNAL == kind ) {
+            struct signalfd_siginfo info;
+            while ( sizeof(info) == read(signal_fd_, &info, sizeof(info)) ) {
+                pending_signals_.fetch_or(( 1ull << info.ssi_signo ));
+            }
+        } else if ( CASPER_APP_MONITOR_REACTOR_KIND_WAKE == kind ) {
+            uint64_t value;
+            (void)read(wake_fd_, &value, sizeof(value));
+        } else if ( CASPER_APP_MONITOR_REACTOR_KIND_CHILD == kind ) {
+            if ( false == Reap(static_cast<pid_t>(ident), a_exit_callback) ) {
+                return false;
+            }
+        } else if ( CASPER_APP_MONITOR_REACTOR_KIND_FD == kind ) {
+            Dispatch(static_cast<int>(ident));
+        } else if ( CASPER_APP_MONITOR_REACTOR_KIND_PROC == kind ) {
+            Notify(static_cast<pid_t>(ident));
+        }
+    }
+
+#endif
+
+    // ... fire expired timers ...
+    Expire();
+
+    // ... deliver pending signals, coalesced ...
+    const uint64_t pending = pending_signals_.exchange(0);
+    for ( int signal_no = 1 ; signal_no < 64 && 0 != pending ; ++signal_no ) {
+        if ( 0 != ( pending & ( 1ull << signal_no ) ) ) {
+            a_signal_callback(signal_no);
+        }
+    }
+
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Mark a signal as pending and wake up the waiting thread.
+ *
+ * @param a_signal_no The signal number.
+ *
+ * @note Async-signal-safe, it's meant to be called from a signal handler running in other thread.
+ */
+void casper::app::monitor::Reactor::Raise (const int a_signal_no)
+{
+    pending_signals_.fetch_or(( 1ull << a_signal_no ));
+    Wake();
+}
+
+/**
+ * @brief Wake up the waiting thread.
+ */
+void casper::app::monitor::Reactor::Wake ()
+{
+    if ( -1 == fd_ ) {
+        return;
+    }
+#ifdef __APPLE__
+    struct kevent change;
+    EV_SET(&change, 0, EVFILT_USER, 0, NOTE_TRIGGER, 0, nullptr);
+    (void)kevent(fd_, &change, 1, nullptr, 0, nullptr);
+#else
+    const uint64_t one = 1;
+    (void)write(wake_fd_, &one, sizeof(one));
+#endif
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Collect a child exit status and stop watching it.
+ *
+ * @param a_pid      Child process id.
+ * @param a_callback Function to call with exit status.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Reactor::Reap (const pid_t a_pid, const casper::app::monitor::Reactor::ExitCallback& a_callback)
+{
+    Exit exit;
+    exit.pid_    = a_pid;
+    exit.status_ = 0;
+    exit.known_  = true;
+    memset(&exit.usage_, 0, sizeof(exit.usage_));
+
+    // ... kernel accounting is only available while reaping ...
+    pid_t rv;
+    do {
+        rv = wait4(a_pid, &exit.status_, WNOHANG, &exit.usage_);
+    } while ( -1 == rv && EINTR == errno );
+
+    if ( 0 == rv ) {
+        // ... not ready yet ...
+        return true;
+    }
+
+    Unwatch(a_pid);
+
+    if ( -1 == rv && ECHILD == errno ) {
+        // ... not a child, it was started by someone else and only it's exit is known ...
+        exit.known_ = false;
+        a_callback(exit);
+        return true;
+    }
+
+    if ( -1 == rv ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "an error occurred while reaping child with pid %d", a_pid);
+        return false;
+    }
+
+    a_callback(exit);
+
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Call the function registered for a readable file descriptor.
+ *
+ * @param a_fd File descriptor.
+ */
+void casper::app::monitor::Reactor::Dispatch (const int a_fd)
+{
+    const auto it = fds_.find(a_fd);
+    if ( fds_.end() == it ) {
+        // ... removed by a previous callback ...
+        return;
+    }
+    // ... copy it, callback is allowed to remove itself ...
+    const ReadCallback callback = it->second;
+    callback(a_fd);
+}
+
+/**
+ * @brief Call the function registered for a followed process that exited, it's no longer followed.
+ *
+ * @param a_pid Process id.
+ */
+void casper::app::monitor::Reactor::Notify (const pid_t a_pid)
+{
+    const auto it = followed_.find(a_pid);
+    if ( followed_.end() == it ) {
+        // ... unfollowed by a previous callback ...
+        return;
+    }
+    // ... copy it, it's entry is gone before it's called ...
+    const ProcessCallback callback = it->second.callback_;
+    Unfollow(a_pid);
+    callback(a_pid);
+}
+
+/**
+ * @brief Calculate how long a wait can block without missing a timer.
+ *
+ * @param a_timeout_ms Requested timeout, -1 for none.
+ *
+ * @return Timeout in milliseconds, -1 to wait forever.
+ */
+int casper::app::monitor::Reactor::Timeout (const int a_timeout_ms) const
+{
+    if ( 0 == timers_.size() ) {
+        return a_timeout_ms;
+    }
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(timers_.begin()->first - std::chrono::steady_clock::now()).count();
+    // ... round up, so a timer is never fired early ...
+    const int next_ms = ( remaining <= 0 ? 0 : static_cast<int>(remaining) + 1 );
+    return ( a_timeout_ms < 0 || next_ms < a_timeout_ms ) ? next_ms : a_timeout_ms;
+}
+
+/**
+ * @brief Fire all timers that already expired.
+ */
+void casper::app::monitor::Reactor::Expire ()
+{
+    const auto now = std::chrono::steady_clock::now();
+    // ... collect their ids first, callbacks are allowed to schedule or cancel timers ...
+    std::vector<uint64_t> expired;
+    for ( auto it = timers_.begin() ; timers_.end() != it && it->first <= now ; ++it ) {
+        expired.push_back(it->second.id_);
+    }
+    for ( const auto id : expired ) {
+        // ... it might have been cancelled by a previous callback of this same batch ...
+        auto it = timers_.begin();
+        while ( timers_.end() != it && it->first <= now && id != it->second.id_ ) {
+            ++it;
+        }
+        if ( timers_.end() == it || it->first > now ) {
+            continue;
+        }
+        const TimerCallback callback = it->second.callback_;
+        timers_.erase(it);
+        callback();
+    }
+}
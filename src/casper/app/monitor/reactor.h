@@ -0,0 +1,179 @@
+/**
+ * @file reactor.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_REACTOR_H_
+#define CASPER_APP_MONITOR_REACTOR_H_
+#pragma once
+
+#include <sys/types.h>    // pid_t
+#include <signal.h>       // sigset_t
+#include <sys/resource.h> // struct rusage
+
+#include <set>        // std::set
+#include <map>        // std::map
+#include <vector>     // std::vector
+#include <atomic>     // std::atomic
+#include <chrono>     // std::chrono
+#include <functional> // std::function
+
+#include "sys/error.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Event multiplexer used by the watchdog to wait for children and control signals.
+             *
+             * Linux: one epoll set with a pidfd per child, a signalfd and an eventfd ( wake ).
+             * Darwin: one kqueue with EVFILT_PROC, EVFILT_SIGNAL and EVFILT_USER ( wake ).
+             *
+             * Followed processes ( probe commands ) are watched the same way, but they are reaped by whoever follows them.
+             *
+             * One-shot timers are kept ordered by deadline and bound the wait timeout.
+             */
+            class Reactor final
+            {
+
+            public: // Data Type(s)
+
+                typedef struct {
+                    pid_t         pid_;
+                    int           status_;
+                    bool          known_;  //!< False when it was not a child ( adopted ), status and usage are unknown.
+                    struct rusage usage_;  //!< Resources used by the child ( not by it's descendants ), as reported by wait4.
+                } Exit;
+
+                typedef std::function<void(const Exit&)> ExitCallback;
+                typedef std::function<void(const int)>   SignalCallback;
+                typedef std::function<void(const int)>   ReadCallback;
+                typedef std::function<void()>            TimerCallback;
+                typedef std::function<void(const pid_t)> ProcessCallback;
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    uint64_t      id_;
+                    TimerCallback callback_;
+                } Timer;
+
+                typedef std::multimap<std::chrono::steady_clock::time_point, Timer> Timers;
+
+                typedef struct {
+                    int             fd_;      //!< Linux: pidfd, Darwin: 0 when registered, -1 when it exited before.
+                    ProcessCallback callback_;
+                } Follower;
+
+            private: // Data
+
+                int                         fd_;
+                int                         signal_fd_;
+                int                         wake_fd_;
+                std::set<int>               signals_;
+                std::map<pid_t, int>        children_;
+                std::map<int, ReadCallback> fds_;
+                std::set<int>               writable_; //!< Subset of fds_ watched for write availability.
+                std::map<pid_t, Follower>   followed_;
+                Timers                      timers_;
+                uint64_t                    next_timer_id_;
+                std::atomic<uint64_t>       pending_signals_;
+                sigset_t                    saved_sigmask_;
+                ::sys::Error                error_;
+
+            public: // Constructor(s) / Destructor
+
+                Reactor ();
+                virtual ~Reactor ();
+
+            public: // Method(s) / Function(s)
+
+                bool Open   (const std::set<int>& a_signals);
+                void Close  ();
+
+                bool Watch   (const pid_t a_pid);
+                void Unwatch (const pid_t a_pid);
+
+                bool Add     (const int a_fd, const ReadCallback& a_callback, const bool a_writable = false);
+                void Remove  (const int a_fd);
+
+                bool Follow   (const pid_t a_pid, const ProcessCallback& a_callback);
+                void Unfollow (const pid_t a_pid);
+
+                uint64_t Schedule (const int a_delay_ms, const TimerCallback& a_callback);
+                void     Cancel   (const uint64_t a_id);
+
+                bool Wait    (const int a_timeout_ms, const ExitCallback& a_exit_callback, const SignalCallback& a_signal_callback);
+
+                void Raise   (const int a_signal_no);
+                void Wake    ();
+
+            public: // Inline Method(s) / Function(s)
+
+                bool                IsOpen   () const;
+                size_t              Count    () const;
+                const ::sys::Error& error    () const;
+
+            private: // Method(s) / Function(s)
+
+                bool Reap     (const pid_t a_pid, const ExitCallback& a_callback);
+                void Dispatch (const int a_fd);
+                void Notify   (const pid_t a_pid);
+                int  Timeout  (const int a_timeout_ms) const;
+                void Expire   ();
+
+            }; // end of class 'Reactor'
+
+            /**
+             * @return True if the event set is open, false otherwise.
+             */
+            inline bool Reactor::IsOpen () const
+            {
+                return ( -1 != fd_ );
+            }
+
+            /**
+             * @return The number of children being watched.
+             */
+            inline size_t Reactor::Count () const
+            {
+                return children_.size();
+            }
+
+            /**
+             * @return R/O access to last error.
+             */
+            inline const ::sys::Error& Reactor::error () const
+            {
+                return error_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_REACTOR_H_
@@ -0,0 +1,123 @@
+/**
+ * @file registry.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/registry.h"
+
+#include <unordered_set> // std::unordered_set
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Registry::Registry ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Registry::~Registry ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Replace registered processes, dependency levels must be placed again.
+ *
+ * @param a_list Processes, sorted by dependencies.
+ *
+ * @note Indexed pids of processes that remain registered are kept.
+ */
+void casper::app::monitor::Registry::Reset (const ::sys::Process::List& a_list)
+{
+    list_ = a_list;
+    levels_.clear();
+    ids_.clear();
+    dependants_.clear();
+    
+    std::unordered_set<const ::sys::Process*> kept;
+    for ( auto process : list_ ) {
+        ids_[process->info().id_] = process;
+        for ( const auto& precedent : process->info().depends_on_ ) {
+            dependants_[precedent].push_back(process);
+        }
+        kept.insert(process);
+    }
+    
+    for ( auto it = pids_.begin() ; pids_.end() != it ; ) {
+        if ( kept.end() == kept.find(it->second) || it->first != it->second->pid() ) {
+            it = pids_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Set a process dependency level.
+ *
+ * @param a_process Registered process.
+ * @param a_level   Dependency level, 0 when it does not depend on any other process.
+ */
+void casper::app::monitor::Registry::Place (::sys::Process* a_process, const size_t a_level)
+{
+    if ( levels_.size() <= a_level ) {
+        levels_.resize(a_level + 1);
+    }
+    levels_[a_level].push_back(a_process);
+}
+
+/**
+ * @brief Index a process by it's current pid, call it once it was spawned or adopted.
+ *
+ * @param a_process Registered process.
+ */
+void casper::app::monitor::Registry::Index (::sys::Process* a_process)
+{
+    if ( 0 != a_process->pid() ) {
+        pids_[a_process->pid()] = a_process;
+    }
+}
+
+/**
+ * @brief Forget a process current pid, call it before it's pid is reset.
+ *
+ * @param a_process Registered process.
+ */
+void casper::app::monitor::Registry::Unindex (const ::sys::Process* a_process)
+{
+    const auto it = pids_.find(a_process->pid());
+    if ( pids_.end() != it && a_process == it->second ) {
+        pids_.erase(it);
+    }
+}
+
+/**
+ * @brief Forget all processes.
+ */
+void casper::app::monitor::Registry::Clear ()
+{
+    list_.clear();
+    levels_.clear();
+    ids_.clear();
+    pids_.clear();
+    dependants_.clear();
+}
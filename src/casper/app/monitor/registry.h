@@ -0,0 +1,145 @@
+/**
+ * @file registry.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_REGISTRY_H_
+#define CASPER_APP_MONITOR_REGISTRY_H_
+#pragma once
+
+#include <sys/types.h> // pid_t
+
+#include <string>        // std::string
+#include <vector>        // std::vector
+#include <unordered_map> // std::unordered_map
+
+#include "casper/app/monitor/process.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Monitored processes, sorted by dependencies and indexed by id, pid, dependency level and precedent.
+             *
+             * Processes are NOT MANAGED BY THIS CLASS, their pointers are handles that remain valid while they are registered.
+             * Pids are only indexed for processes that were spawned or adopted, so stale pids ( from pid files ) are never matched.
+             */
+            class Registry final
+            {
+
+            private: // Data
+
+                ::sys::Process::List                                          list_;       //!< Sorted, precedents first.
+                std::vector<::sys::Process::List>                             levels_;     //!< By dependency level.
+                std::unordered_map<std::string, ::sys::Process*>              ids_;
+                std::unordered_map<pid_t, ::sys::Process*>                    pids_;
+                std::unordered_map<std::string, std::vector<::sys::Process*>> dependants_; //!< Direct dependants, by precedent id.
+
+            public: // Constructor(s) / Destructor
+
+                Registry ();
+                virtual ~Registry ();
+
+            public: // Method(s) / Function(s)
+
+                void Reset   (const ::sys::Process::List& a_list);
+                void Place   (::sys::Process* a_process, const size_t a_level);
+                void Index   (::sys::Process* a_process);
+                void Unindex (const ::sys::Process* a_process);
+                void Clear   ();
+
+            public: // Inline Method(s) / Function(s)
+
+                ::sys::Process*                          Find       (const pid_t a_pid) const;
+                ::sys::Process*                          Find       (const std::string& a_id) const;
+                const std::vector<::sys::Process*>&      Dependants (const std::string& a_id) const;
+                const ::sys::Process::List&              list       () const;
+                const std::vector<::sys::Process::List>& levels     () const;
+
+            }; // end of class 'Registry'
+
+            /**
+             * @brief Find a spawned or adopted process by pid.
+             *
+             * @param a_pid Process pid.
+             *
+             * @return Process handle, nullptr when not found.
+             */
+            inline ::sys::Process* Registry::Find (const pid_t a_pid) const
+            {
+                const auto it = pids_.find(a_pid);
+                return ( pids_.end() != it ? it->second : nullptr );
+            }
+
+            /**
+             * @brief Find a process by id.
+             *
+             * @param a_id Process id.
+             *
+             * @return Process handle, nullptr when not found.
+             */
+            inline ::sys::Process* Registry::Find (const std::string& a_id) const
+            {
+                const auto it = ids_.find(a_id);
+                return ( ids_.end() != it ? it->second : nullptr );
+            }
+
+            /**
+             * @brief Processes that directly depend on a process.
+             *
+             * @param a_id Precedent id.
+             *
+             * @return R/O access to dependants, sorted.
+             */
+            inline const std::vector<::sys::Process*>& Registry::Dependants (const std::string& a_id) const
+            {
+                static const std::vector<::sys::Process*> k_none_;
+                const auto it = dependants_.find(a_id);
+                return ( dependants_.end() != it ? it->second : k_none_ );
+            }
+
+            /**
+             * @return R/O access to all processes, precedents first.
+             */
+            inline const ::sys::Process::List& Registry::list () const
+            {
+                return list_;
+            }
+
+            /**
+             * @return R/O access to processes, by dependency level.
+             */
+            inline const std::vector<::sys::Process::List>& Registry::levels () const
+            {
+                return levels_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_REGISTRY_H_
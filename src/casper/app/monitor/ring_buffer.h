@@ -0,0 +1,191 @@
+/**
+ * @file ring_buffer.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_RING_BUFFER_H_
+#define CASPER_APP_MONITOR_RING_BUFFER_H_
+#pragma once
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uint64_t
+
+#include <algorithm>   // std::min
+#include <atomic>      // std::atomic
+#include <vector>      // std::vector
+#include <type_traits> // std::is_trivially_copyable
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Fixed-size, single writer / multiple readers, lock-free ring buffer.
+             *
+             * Each slot is guarded by it's own sequence number ( odd while being written ),
+             * readers never block the writer, they just skip slots that were overwritten while being copied.
+             */
+            template <typename T>
+            class RingBuffer final
+            {
+
+                static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    std::atomic<uint64_t> sequence_;
+                    T                     value_;
+                } Slot;
+
+            private: // Data
+
+                const size_t          capacity_;
+                Slot*                 slots_;
+                std::atomic<uint64_t> head_; //!< Number of values written so far.
+
+            public: // Constructor(s) / Destructor
+
+                RingBuffer (const size_t a_capacity);
+                virtual ~RingBuffer ();
+
+            public: // Method(s) / Function(s)
+
+                void   Push (const T& a_value);
+                size_t Copy (const size_t a_max, std::vector<T>& o_values) const;
+
+            public: // Inline Method(s) / Function(s)
+
+                size_t capacity () const;
+                size_t size     () const;
+
+            }; // end of class 'RingBuffer'
+
+            /**
+             * @brief Default constructor.
+             *
+             * @param a_capacity Maximum number of values kept, older ones are overwritten.
+             */
+            template <typename T>
+            RingBuffer<T>::RingBuffer (const size_t a_capacity)
+                : capacity_(a_capacity > 0 ? a_capacity : 1)
+            {
+                slots_ = new Slot[capacity_];
+                for ( size_t idx = 0 ; idx < capacity_ ; ++idx ) {
+                    slots_[idx].sequence_.store(0, std::memory_order_relaxed);
+                }
+                head_.store(0, std::memory_order_release);
+            }
+
+            /**
+             * @brief Destructor.
+             */
+            template <typename T>
+            RingBuffer<T>::~RingBuffer ()
+            {
+                delete [] slots_;
+            }
+
+            /**
+             * @brief Append a value, overwriting the oldest one when full.
+             *
+             * @param a_value Value to copy.
+             *
+             * @note Must only be called by the writer thread.
+             */
+            template <typename T>
+            void RingBuffer<T>::Push (const T& a_value)
+            {
+                const uint64_t head = head_.load(std::memory_order_relaxed);
+                Slot&          slot = slots_[head % capacity_];
+                // ... odd while writing ...
+                slot.sequence_.store(( 2 * head ) + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.value_ = a_value;
+                // ... even when done ...
+                slot.sequence_.store(( 2 * head ) + 2, std::memory_order_release);
+                head_.store(head + 1, std::memory_order_release);
+            }
+
+            /**
+             * @brief Copy most recent values, oldest first.
+             *
+             * @param a_max    Maximum number of values to copy.
+             * @param o_values Values, previous content is discarded.
+             *
+             * @return Number of values copied.
+             */
+            template <typename T>
+            size_t RingBuffer<T>::Copy (const size_t a_max, std::vector<T>& o_values) const
+            {
+                o_values.clear();
+
+                const uint64_t head  = head_.load(std::memory_order_acquire);
+                const uint64_t count = std::min<uint64_t>(std::min<uint64_t>(head, capacity_), a_max);
+
+                o_values.reserve(static_cast<size_t>(count));
+                for ( uint64_t index = head - count ; index < head ; ++index ) {
+                    const Slot&    slot     = slots_[index % capacity_];
+                    const uint64_t expected = ( 2 * index ) + 2;
+                    if ( expected != slot.sequence_.load(std::memory_order_acquire) ) {
+                        // ... being written or already overwritten ...
+                        continue;
+                    }
+                    const T value = slot.value_;
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if ( expected != slot.sequence_.load(std::memory_order_relaxed) ) {
+                        continue;
+                    }
+                    o_values.push_back(value);
+                }
+
+                return o_values.size();
+            }
+
+            /**
+             * @return Maximum number of values kept.
+             */
+            template <typename T>
+            inline size_t RingBuffer<T>::capacity () const
+            {
+                return capacity_;
+            }
+
+            /**
+             * @return Number of values currently kept.
+             */
+            template <typename T>
+            inline size_t RingBuffer<T>::size () const
+            {
+                const uint64_t head = head_.load(std::memory_order_acquire);
+                return static_cast<size_t>(head < capacity_ ? head : capacity_);
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_RING_BUFFER_H_
@@ -0,0 +1,304 @@
+/**
+ * @file runs.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/runs.h"
+
+#include "casper/app/logger.h"
+
+#include <unistd.h>   // write, close
+#include <errno.h>    // errno
+#include <fcntl.h>    // open
+#include <stdio.h>    // rename
+#include <stdlib.h>   // strtoll, strtoull
+#include <string.h>   // strerror
+#include <sys/stat.h> // fstat
+
+#include <fstream>   // std::ifstream
+#include <sstream>   // std::stringstream
+#include <algorithm> // std::replace
+
+const char* const casper::app::monitor::Runs::k_version_ = "1";
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Runs::Runs ()
+{
+    config_ = {
+        /* uri_      */ "",
+        /* keep_     */ 100,
+        /* max_size_ */ 4 * 1024 * 1024
+    };
+    fd_   = -1;
+    size_ = 0;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Runs::~Runs ()
+{
+    Close();
+}
+
+/**
+ * @brief Set history file and retention options, previous runs are loaded from history file ( and it's rotated copy ).
+ *
+ * @param a_config See \link Config \link.
+ */
+void casper::app::monitor::Runs::Setup (const casper::app::monitor::Runs::Config& a_config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    Close();
+    
+    config_ = a_config;
+    runs_.clear();
+    
+    if ( 0 == config_.uri_.length() ) {
+        return;
+    }
+    
+    // ... oldest first ...
+    Load(config_.uri_ + ".1");
+    Load(config_.uri_);
+    
+    if ( false == Open() ) {
+        CASPER_APP_LOG("error", "Unable to open runs history file '%s': %s, runs will only be kept in memory...", config_.uri_.c_str(), strerror(errno));
+    }
+}
+
+/**
+ * @brief Keep a run and append it to history file.
+ *
+ * @param a_run See \link Run \link.
+ */
+void casper::app::monitor::Runs::Add (const casper::app::monitor::Runs::Run& a_run)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    Keep(a_run);
+    
+    if ( -1 == fd_ ) {
+        return;
+    }
+    
+    // ... one line per run, reason is the last field and the only one that might need to be sanitized ...
+    std::string reason = a_run.reason_;
+    std::replace(reason.begin(), reason.end(), '\t', ' ');
+    std::replace(reason.begin(), reason.end(), '\n', ' ');
+    
+    std::stringstream ss;
+    ss << k_version_
+       << '\t' << a_run.id_                   << '\t' << a_run.pid_
+       << '\t' << a_run.start_                << '\t' << a_run.stop_
+       << '\t' << a_run.user_us_              << '\t' << a_run.system_us_
+       << '\t' << a_run.max_rss_
+       << '\t' << a_run.minor_faults_         << '\t' << a_run.major_faults_
+       << '\t' << a_run.voluntary_switches_   << '\t' << a_run.involuntary_switches_
+       << '\t' << a_run.status_               << '\t' << a_run.signal_
+       << '\t' << reason
+       << '\n';
+    const std::string line = ss.str();
+    
+    // ... rotate, only one copy is kept ...
+    if ( size_ > 0 && size_ + line.length() > config_.max_size_ ) {
+        Close();
+        if ( 0 != rename(config_.uri_.c_str(), ( config_.uri_ + ".1" ).c_str()) || false == Open() ) {
+            CASPER_APP_LOG("error", "Unable to rotate runs history file '%s': %s...", config_.uri_.c_str(), strerror(errno));
+            Close();
+            return;
+        }
+    }
+    
+    ssize_t written;
+    do {
+        written = write(fd_, line.c_str(), line.length());
+    } while ( -1 == written && EINTR == errno );
+    if ( written > 0 ) {
+        size_ += static_cast<uint64_t>(written);
+    }
+}
+
+/**
+ * @brief Copy most recent runs of a child, oldest first.
+ *
+ * @param a_id   Child id.
+ * @param a_max  Maximum number of runs.
+ * @param o_runs Runs.
+ *
+ * @return True when child has runs, false otherwise.
+ */
+bool casper::app::monitor::Runs::Copy (const std::string& a_id, const size_t a_max, std::vector<casper::app::monitor::Runs::Run>& o_runs) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    o_runs.clear();
+    const auto it = runs_.find(a_id);
+    if ( runs_.end() == it ) {
+        return false;
+    }
+    const size_t count = std::min(a_max, it->second.size());
+    o_runs.assign(it->second.end() - static_cast<std::ptrdiff_t>(count), it->second.end());
+    return true;
+}
+
+/**
+ * @brief Collect ids of all children with runs.
+ *
+ * @param o_ids Children ids.
+ */
+void casper::app::monitor::Runs::IDs (std::vector<std::string>& o_ids) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    o_ids.clear();
+    for ( auto& it : runs_ ) {
+        o_ids.push_back(it.first);
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Load runs from a history file, mutex must be locked.
+ *
+ * @param a_uri History file uri.
+ */
+void casper::app::monitor::Runs::Load (const std::string& a_uri)
+{
+    std::ifstream file(a_uri);
+    if ( false == file.is_open() ) {
+        return;
+    }
+    std::string line;
+    Run         run;
+    size_t      invalid = 0;
+    while ( std::getline(file, line) ) {
+        if ( true == Parse(line, run) ) {
+            Keep(run);
+        } else {
+            invalid++;
+        }
+    }
+    if ( invalid > 0 ) {
+        CASPER_APP_LOG("status", "Ignored %zu invalid line(s) of runs history file '%s'...", invalid, a_uri.c_str());
+    }
+}
+
+/**
+ * @brief Parse a history file line.
+ *
+ * @param a_line Line, without line terminator.
+ * @param o_run  Run.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Runs::Parse (const std::string& a_line, casper::app::monitor::Runs::Run& o_run) const
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while ( fields.size() < 14 ) {
+        const size_t tab = a_line.find('\t', start);
+        if ( std::string::npos == tab ) {
+            break;
+        }
+        fields.push_back(a_line.substr(start, tab - start));
+        start = tab + 1;
+    }
+    // ... reason is the remainder of the line ...
+    if ( 14 != fields.size() || 0 != fields[0].compare(k_version_) || 0 == fields[1].length() ) {
+        return false;
+    }
+    
+    const auto i64 = [] (const std::string& a_field) -> int64_t {
+        return static_cast<int64_t>(strtoll(a_field.c_str(), nullptr, 10));
+    };
+    const auto u64 = [] (const std::string& a_field) -> uint64_t {
+        return static_cast<uint64_t>(strtoull(a_field.c_str(), nullptr, 10));
+    };
+    
+    o_run = {
+        /* id_                   */ fields[1],
+        /* pid_                  */ static_cast<pid_t>(i64(fields[2])),
+        /* start_                */ i64(fields[3]),
+        /* stop_                 */ i64(fields[4]),
+        /* user_us_              */ u64(fields[5]),
+        /* system_us_            */ u64(fields[6]),
+        /* max_rss_              */ u64(fields[7]),
+        /* minor_faults_         */ u64(fields[8]),
+        /* major_faults_         */ u64(fields[9]),
+        /* voluntary_switches_   */ u64(fields[10]),
+        /* involuntary_switches_ */ u64(fields[11]),
+        /* status_               */ static_cast<int>(i64(fields[12])),
+        /* signal_               */ static_cast<int>(i64(fields[13])),
+        /* reason_               */ a_line.substr(start)
+    };
+    
+    return true;
+}
+
+/**
+ * @brief Keep a run in memory, mutex must be locked.
+ *
+ * @param a_run See \link Run \link.
+ */
+void casper::app::monitor::Runs::Keep (const casper::app::monitor::Runs::Run& a_run)
+{
+    std::deque<Run>& runs = runs_[a_run.id_];
+    runs.push_back(a_run);
+    while ( runs.size() > config_.keep_ ) {
+        runs.pop_front();
+    }
+}
+
+/**
+ * @brief Open history file for appending, mutex must be locked.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Runs::Open ()
+{
+    // ... not inherited by children ...
+    fd_ = open(config_.uri_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if ( -1 == fd_ ) {
+        return false;
+    }
+    struct stat info;
+    if ( 0 != fstat(fd_, &info) ) {
+        Close();
+        return false;
+    }
+    size_ = static_cast<uint64_t>(info.st_size);
+    return true;
+}
+
+/**
+ * @brief Close history file, if open.
+ */
+void casper::app::monitor::Runs::Close ()
+{
+    if ( -1 != fd_ ) {
+        close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+}
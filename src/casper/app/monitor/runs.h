@@ -0,0 +1,122 @@
+/**
+ * @file runs.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_RUNS_H_
+#define CASPER_APP_MONITOR_RUNS_H_
+#pragma once
+
+#include <stdint.h>     // uint64_t, int64_t
+#include <stddef.h>     // size_t
+#include <sys/types.h>  // pid_t
+
+#include <string> // std::string
+#include <vector> // std::vector
+#include <deque>  // std::deque
+#include <map>    // std::map
+#include <mutex>  // std::mutex
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief History of children runs, from spawn to exit, with kernel accounting collected when they are reaped.
+             *
+             * Runs are appended, one line each, to a file that survives monitor restarts - it's rotated once, when it
+             * reaches it's maximum size, and loaded back on setup.
+             */
+            class Runs final
+            {
+
+            public: // Data Type(s)
+
+                typedef struct {
+                    std::string uri_;      //!< History file uri, empty to keep runs in memory only.
+                    size_t      keep_;     //!< Number of runs kept in memory, per child.
+                    uint64_t    max_size_; //!< History file is rotated when it reaches this size, in bytes.
+                } Config;
+
+                typedef struct {
+                    std::string id_;                   //!< Child id.
+                    pid_t       pid_;                  //!< Child pid.
+                    int64_t     start_;                //!< When it was spawned, in milliseconds since epoch, 0 when unknown.
+                    int64_t     stop_;                 //!< When it was reaped, in milliseconds since epoch.
+                    uint64_t    user_us_;              //!< User CPU time, in microseconds.
+                    uint64_t    system_us_;            //!< System CPU time, in microseconds.
+                    uint64_t    max_rss_;              //!< Maximum resident set size, in bytes.
+                    uint64_t    minor_faults_;         //!< Page faults serviced without I/O.
+                    uint64_t    major_faults_;         //!< Page faults that required I/O.
+                    uint64_t    voluntary_switches_;   //!< Context switches while waiting for a resource.
+                    uint64_t    involuntary_switches_; //!< Context switches due to preemption.
+                    int         status_;               //!< Exit status, -1 when it was terminated by a signal.
+                    int         signal_;               //!< Signal that terminated it, 0 when none.
+                    std::string reason_;               //!< Human readable exit reason.
+                } Run;
+
+            private: // Const Data
+
+                static const char* const k_version_; //!< First field of each line.
+
+            private: // Data
+
+                Config                                 config_;
+                std::map<std::string, std::deque<Run>> runs_; //!< By child id, oldest first.
+                int                                    fd_;   //!< History file, -1 when not open.
+                uint64_t                               size_; //!< Current history file size, in bytes.
+
+            private: // Threading
+
+                mutable std::mutex mutex_;
+
+            public: // Constructor(s) / Destructor
+
+                Runs ();
+                virtual ~Runs ();
+
+            public: // Method(s) / Function(s)
+
+                void Setup (const Config& a_config);
+                void Add   (const Run& a_run);
+                bool Copy  (const std::string& a_id, const size_t a_max, std::vector<Run>& o_runs) const;
+                void IDs   (std::vector<std::string>& o_ids) const;
+
+            private: // Method(s) / Function(s)
+
+                void Load  (const std::string& a_uri);
+                bool Parse (const std::string& a_line, Run& o_run) const;
+                void Keep  (const Run& a_run);
+                bool Open  ();
+                void Close ();
+
+            }; // end of class 'Runs'
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_RUNS_H_
@@ -0,0 +1,557 @@
+/**
+ * @file sampler.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/sampler.h"
+
+#include <unistd.h> // sysconf
+#include <stdio.h>  // fopen, fread, sscanf
+#include <string.h> // strrchr, strncmp
+#include <stdlib.h> // strtoull
+#include <dirent.h> // opendir, readdir
+
+#ifdef __APPLE__
+    #include <libproc.h>        // proc_pidinfo, proc_pid_rusage
+    #include <sys/proc_info.h>  // proc_taskinfo, proc_bsdinfo
+    #include <mach/mach_time.h> // mach_timebase_info
+#endif
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Sampler::Sampler ()
+{
+    interval_ms_ = 1000;
+    capacity_    = 300;
+    thread_      = nullptr;
+    aborted_     = false;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Sampler::~Sampler ()
+{
+    Stop();
+}
+
+/**
+ * @brief Set sampling interval and number of samples kept for each child.
+ *
+ * @param a_interval_ms Sampling interval, in milliseconds.
+ * @param a_capacity    Number of samples kept for each child, only applies to children not yet tracked.
+ */
+void casper::app::monitor::Sampler::Setup (const int a_interval_ms, const size_t a_capacity)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    interval_ms_ = ( a_interval_ms > 0 ? a_interval_ms : 1000 );
+    capacity_    = ( a_capacity > 0 ? a_capacity : 1 );
+}
+
+/**
+ * @brief Set per child thresholds, crossings are only reported for these children.
+ *
+ * @param a_limits Thresholds, by child id.
+ */
+void casper::app::monitor::Sampler::Limit (const std::map<std::string, casper::app::monitor::Sampler::Limits>& a_limits)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    limits_ = a_limits;
+}
+
+/**
+ * @brief Start sampler thread, if not running already.
+ *
+ * @param a_callback Called by sampler thread when thresholds were crossed, must not block.
+ * @param a_observer Called by sampler thread with each new sample, must not block.
+ */
+void casper::app::monitor::Sampler::Start (const casper::app::monitor::Sampler::Callback& a_callback,
+                                           const casper::app::monitor::Sampler::Observer& a_observer)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( nullptr != thread_ ) {
+        return;
+    }
+    aborted_  = false;
+    last_tp_  = std::chrono::steady_clock::now();
+    callback_ = a_callback;
+    observer_ = a_observer;
+    counters_.clear();
+    above_.clear();
+    crossed_.clear();
+    thread_   = new std::thread(&casper::app::monitor::Sampler::Loop, this);
+}
+
+/**
+ * @brief Stop sampler thread, collected samples are kept.
+ */
+void casper::app::monitor::Sampler::Stop ()
+{
+    std::thread* thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread   = thread_;
+        thread_  = nullptr;
+        aborted_ = true;
+    }
+    if ( nullptr == thread ) {
+        return;
+    }
+    wait_cv_.notify_all();
+    thread->join();
+    delete thread;
+}
+
+/**
+ * @brief Start, or continue, sampling a child.
+ *
+ * @param a_id  Child id.
+ * @param a_pid Child process id.
+ */
+void casper::app::monitor::Sampler::Track (const std::string& a_id, const pid_t a_pid)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    targets_[a_id] = a_pid;
+    if ( series_.end() == series_.find(a_id) ) {
+        series_[a_id] = std::make_shared<Series>(capacity_);
+    }
+}
+
+/**
+ * @brief Stop sampling a child, collected samples are kept.
+ *
+ * @param a_id Child id.
+ */
+void casper::app::monitor::Sampler::Untrack (const std::string& a_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    targets_.erase(a_id);
+}
+
+/**
+ * @brief Stop sampling a child and release it's samples, for children that are no longer configured.
+ *
+ * @param a_id Child id.
+ */
+void casper::app::monitor::Sampler::Forget (const std::string& a_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    targets_.erase(a_id);
+    series_.erase(a_id);
+    members_.erase(a_id);
+}
+
+/**
+ * @brief Copy most recent samples of a child, oldest first.
+ *
+ * @param a_id      Child id.
+ * @param a_max     Maximum number of samples to copy.
+ * @param o_samples Samples.
+ *
+ * @return True if child is known, false otherwise.
+ */
+bool casper::app::monitor::Sampler::Copy (const std::string& a_id, const size_t a_max, std::vector<casper::app::monitor::Sampler::Sample>& o_samples) const
+{
+    std::shared_ptr<const Series> series;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = series_.find(a_id);
+        if ( series_.end() == it ) {
+            o_samples.clear();
+            return false;
+        }
+        series = it->second;
+    }
+    // ... lock-free from here on, series is kept alive by this reference even if it's child is forgotten meanwhile ...
+    (void)series->Copy(a_max, o_samples);
+    return true;
+}
+
+/**
+ * @brief Collect ids of all children that were ever sampled.
+ *
+ * @param o_ids Children ids.
+ */
+void casper::app::monitor::Sampler::IDs (std::vector<std::string>& o_ids) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    o_ids.clear();
+    for ( auto it : series_ ) {
+        o_ids.push_back(it.first);
+    }
+}
+
+/**
+ * @brief Collect all processes of a child tree, as seen by most recent sample.
+ *
+ * @param a_id   Child id.
+ * @param o_pids Child pid first, followed by it's descendants and other members of it's process group.
+ *
+ * @return True if child was sampled, false otherwise.
+ */
+bool casper::app::monitor::Sampler::Members (const std::string& a_id, std::vector<pid_t>& o_pids) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = members_.find(a_id);
+    if ( members_.end() == it ) {
+        o_pids.clear();
+        return false;
+    }
+    o_pids = it->second;
+    return true;
+}
+
+/**
+ * @brief Collect, and forget, thresholds crossings.
+ *
+ * @param o_crossings Crossings, oldest first.
+ */
+void casper::app::monitor::Sampler::Crossed (std::vector<casper::app::monitor::Sampler::Crossing>& o_crossings)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    o_crossings.clear();
+    o_crossings.swap(crossed_);
+}
+
+/**
+ * @return Metric name.
+ */
+const char* casper::app::monitor::Sampler::Name (const casper::app::monitor::Sampler::Metric a_metric)
+{
+    switch (a_metric) {
+        case Metric::CPU:
+            return "cpu";
+        case Metric::RSS:
+            return "rss";
+        default:
+            return "???";
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Thread function where the 'sampler loop' will run.
+ */
+void casper::app::monitor::Sampler::Loop ()
+{
+#ifdef __APPLE__
+    pthread_setname_np("Monitor Sampler");
+#else
+    pthread_setname_np(pthread_self(), "Sampler");
+#endif
+
+    std::map<pid_t, std::vector<pid_t>>            tree;
+    std::map<std::string, pid_t>                   targets;
+    std::map<std::string, std::shared_ptr<Series>> series;
+    std::map<pid_t, Counters>                      counters;
+    std::map<std::string, std::vector<pid_t>>      members;
+    std::vector<pid_t>                             pids;
+    std::map<std::string, Limits>                  limits;
+    std::vector<Crossing>                          crossings;
+    Callback                                       callback;
+    Observer                                       observer;
+
+    while ( true ) {
+
+        // ... wait for next sample or abort ...
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wait_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this] { return aborted_; });
+            if ( true == aborted_ ) {
+                break;
+            }
+            targets  = targets_;
+            series   = series_;
+            limits   = limits_;
+            callback = callback_;
+            observer = observer_;
+        }
+
+        const auto   now     = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(now - last_tp_).count();
+        const auto   epoch   = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+        // ... one pass over all processes, trees are found by parent pid and process group ...
+        if ( true == table_.Refresh() ) {
+            table_.Tree(tree);
+        } else {
+            tree.clear();
+        }
+
+        counters.clear();
+        members.clear();
+        crossings.clear();
+        for ( auto target : targets ) {
+            Sample sample;
+            memset(&sample, 0, sizeof(sample));
+            sample.timestamp_ = static_cast<int64_t>(epoch);
+            sample.pid_       = target.second;
+            table_.Members(target.second, tree, pids);
+            Measure(pids, elapsed, counters, sample);
+            series[target.first]->Push(sample);
+            members[target.first] = pids;
+            if ( nullptr != observer ) {
+                observer(target.first, sample);
+            }
+            const auto limit = limits.find(target.first);
+            if ( limits.end() != limit ) {
+                (void)Compare(target.first, limit->second, sample, crossings);
+            }
+        }
+
+        // ... children that are no longer tracked start below thresholds on their next run ...
+        for ( auto it = above_.begin() ; above_.end() != it ; ) {
+            if ( targets.end() == targets.find(it->first) ) {
+                it = above_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        counters_.swap(counters);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            members_.swap(members);
+            crossed_.insert(crossed_.end(), crossings.begin(), crossings.end());
+        }
+        last_tp_ = now;
+
+        // ... watchdog collects them on it's own thread ...
+        if ( crossings.size() > 0 && nullptr != callback ) {
+            callback();
+        }
+    }
+}
+
+/**
+ * @brief Compare a sample against a child thresholds.
+ *
+ * @param a_id        Child id.
+ * @param a_limits    Child thresholds.
+ * @param a_sample    Most recent sample.
+ * @param o_crossings Where crossings are appended.
+ *
+ * @return True when a threshold was crossed, false otherwise.
+ *
+ * @note A metric only goes back below it's threshold when it drops under 90% of it, so it won't flap around it.
+ */
+bool casper::app::monitor::Sampler::Compare (const std::string& a_id, const casper::app::monitor::Sampler::Limits& a_limits,
+                                             const casper::app::monitor::Sampler::Sample& a_sample,
+                                             std::vector<casper::app::monitor::Sampler::Crossing>& o_crossings)
+{
+    Above& above = above_[a_id];
+    
+    const size_t count = o_crossings.size();
+    
+    const auto compare = [&a_id, &a_sample, &o_crossings] (const Metric a_metric, const double a_value, const double a_limit, bool& a_above) {
+        if ( a_limit <= 0.0 ) {
+            a_above = false;
+        } else if ( false == a_above && a_value > a_limit ) {
+            a_above = true;
+            o_crossings.push_back({ /* id_ */ a_id, /* pid_ */ a_sample.pid_, /* metric_ */ a_metric, /* value_ */ a_value, /* limit_ */ a_limit, /* above_ */ true });
+        } else if ( true == a_above && a_value < ( a_limit * 0.9 ) ) {
+            a_above = false;
+            o_crossings.push_back({ /* id_ */ a_id, /* pid_ */ a_sample.pid_, /* metric_ */ a_metric, /* value_ */ a_value, /* limit_ */ a_limit, /* above_ */ false });
+        }
+    };
+    
+    compare(Metric::CPU, static_cast<double>(a_sample.cpu_), static_cast<double>(a_limits.cpu_), above.cpu_);
+    compare(Metric::RSS, static_cast<double>(a_sample.rss_), static_cast<double>(a_limits.rss_), above.rss_);
+    
+    return ( o_crossings.size() > count );
+}
+
+/**
+ * @brief Measure all processes of a tree.
+ *
+ * @param a_pids     Root process id and all other processes of it's tree.
+ * @param a_elapsed  Seconds since previous sample.
+ * @param o_counters Cumulative counters of all measured processes, to be used by next sample.
+ * @param o_sample   Sample to fill.
+ */
+void casper::app::monitor::Sampler::Measure (const std::vector<pid_t>& a_pids, const double a_elapsed,
+                                             std::map<pid_t, casper::app::monitor::Sampler::Counters>& o_counters,
+                                             casper::app::monitor::Sampler::Sample& o_sample) const
+{
+#ifdef __APPLE__
+    static double ticks_per_second = 0.0;
+    if ( 0.0 == ticks_per_second ) {
+        // ... task info times are in mach absolute time units ...
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        ticks_per_second = 1e9 * static_cast<double>(timebase.denom) / static_cast<double>(timebase.numer);
+    }
+#else
+    static const double ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+#endif
+
+    uint64_t cpu_ticks = 0;
+
+    for ( const pid_t pid : a_pids ) {
+
+        Counters counters = { 0, 0, 0 };
+        if ( true == Read(pid, counters, o_sample) ) {
+            o_sample.processes_++;
+            // ... first time a process is seen it's counters are just a baseline ...
+            const auto previous = counters_.find(pid);
+            if ( counters_.end() != previous ) {
+                cpu_ticks             += ( counters.cpu_ticks_   >= previous->second.cpu_ticks_   ? counters.cpu_ticks_   - previous->second.cpu_ticks_   : 0 );
+                o_sample.read_bytes_  += ( counters.read_bytes_  >= previous->second.read_bytes_  ? counters.read_bytes_  - previous->second.read_bytes_  : 0 );
+                o_sample.write_bytes_ += ( counters.write_bytes_ >= previous->second.write_bytes_ ? counters.write_bytes_ - previous->second.write_bytes_ : 0 );
+            }
+            o_counters[pid] = counters;
+        }
+    }
+
+    if ( a_elapsed > 0.0 ) {
+        o_sample.cpu_ = static_cast<float>(( static_cast<double>(cpu_ticks) / ticks_per_second / a_elapsed ) * 100.0);
+    }
+}
+
+#ifdef __APPLE__
+
+/**
+ * @brief Read resource usage of a single process.
+ *
+ * @param a_pid      Process id.
+ * @param o_counters Cumulative counters.
+ * @param o_sample   Sample to accumulate rss, fds and threads.
+ *
+ * @return True on success, false when process is gone.
+ */
+bool casper::app::monitor::Sampler::Read (const pid_t a_pid, casper::app::monitor::Sampler::Counters& o_counters,
+                                          casper::app::monitor::Sampler::Sample& o_sample) const
+{
+    struct proc_taskinfo task_info;
+    if ( static_cast<int>(sizeof(task_info)) != proc_pidinfo(a_pid, PROC_PIDTASKINFO, 0, &task_info, sizeof(task_info)) ) {
+        return false;
+    }
+
+    o_counters.cpu_ticks_ = task_info.pti_total_user + task_info.pti_total_system;
+    o_sample.rss_        += task_info.pti_resident_size;
+    o_sample.threads_    += static_cast<uint32_t>(task_info.pti_threadnum);
+
+    rusage_info_v2 usage;
+    if ( 0 == proc_pid_rusage(a_pid, RUSAGE_INFO_V2, reinterpret_cast<rusage_info_t*>(&usage)) ) {
+        o_counters.read_bytes_  = usage.ri_diskio_bytesread;
+        o_counters.write_bytes_ = usage.ri_diskio_byteswritten;
+    }
+
+    const int size = proc_pidinfo(a_pid, PROC_PIDLISTFDS, 0, nullptr, 0);
+    if ( size > 0 ) {
+        o_sample.fds_ += static_cast<uint32_t>(size / PROC_PIDLISTFD_SIZE);
+    }
+
+    return true;
+}
+
+#else
+
+/**
+ * @brief Read resource usage of a single process from /proc/<pid>/{stat,statm,io,fd}.
+ *
+ * @param a_pid      Process id.
+ * @param o_counters Cumulative counters.
+ * @param o_sample   Sample to accumulate rss, fds and threads.
+ *
+ * @return True on success, false when process is gone.
+ */
+bool casper::app::monitor::Sampler::Read (const pid_t a_pid, casper::app::monitor::Sampler::Counters& o_counters,
+                                          casper::app::monitor::Sampler::Sample& o_sample) const
+{
+    static const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+    char uri[64];
+    char buffer[1024];
+
+    const auto read_file = [&buffer] (const char* const a_uri) -> bool {
+        FILE* file = fopen(a_uri, "r");
+        if ( nullptr == file ) {
+            return false;
+        }
+        const size_t length = fread(buffer, sizeof(char), sizeof(buffer) - 1, file);
+        fclose(file);
+        buffer[length] = '\0';
+        return ( length > 0 );
+    };
+
+    // ... stat: utime ( 14 ), stime ( 15 ) and num_threads ( 20 ) ...
+    snprintf(uri, sizeof(uri), "/proc/%d/stat", static_cast<int>(a_pid));
+    if ( false == read_file(uri) ) {
+        return false;
+    }
+    // ... comm can contain spaces and parenthesis, skip to last ')' ...
+    const char* ptr = strrchr(buffer, ')');
+    if ( nullptr == ptr ) {
+        return false;
+    }
+    unsigned long long utime = 0, stime = 0;
+    long               threads = 0;
+    if ( 3 != sscanf(ptr + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %ld", &utime, &stime, &threads) ) {
+        return false;
+    }
+    o_counters.cpu_ticks_ = static_cast<uint64_t>(utime + stime);
+    o_sample.threads_    += static_cast<uint32_t>(threads);
+
+    // ... statm: resident ( pages ) ...
+    snprintf(uri, sizeof(uri), "/proc/%d/statm", static_cast<int>(a_pid));
+    if ( true == read_file(uri) ) {
+        unsigned long long size = 0, resident = 0;
+        if ( 2 == sscanf(buffer, "%llu %llu", &size, &resident) ) {
+            o_sample.rss_ += static_cast<uint64_t>(resident) * page_size;
+        }
+    }
+
+    // ... io: read_bytes and write_bytes ( optional, requires same owner ) ...
+    snprintf(uri, sizeof(uri), "/proc/%d/io", static_cast<int>(a_pid));
+    if ( true == read_file(uri) ) {
+        for ( const char* line = buffer ; nullptr != line && '\0' != line[0] ; ) {
+            if ( 0 == strncmp(line, "read_bytes:", 11) ) {
+                o_counters.read_bytes_ = strtoull(line + 11, nullptr, 10);
+            } else if ( 0 == strncmp(line, "write_bytes:", 12) ) {
+                o_counters.write_bytes_ = strtoull(line + 12, nullptr, 10);
+            }
+            line = strchr(line, '\n');
+            if ( nullptr != line ) {
+                line++;
+            }
+        }
+    }
+
+    // ... fd: one entry per open file descriptor ...
+    snprintf(uri, sizeof(uri), "/proc/%d/fd", static_cast<int>(a_pid));
+    DIR* dir = opendir(uri);
+    if ( nullptr != dir ) {
+        struct dirent* entry;
+        while ( nullptr != ( entry = readdir(dir) ) ) {
+            if ( '.' != entry->d_name[0] ) {
+                o_sample.fds_++;
+            }
+        }
+        closedir(dir);
+    }
+
+    return true;
+}
+
+#endif // __APPLE__
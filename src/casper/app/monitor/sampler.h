@@ -0,0 +1,187 @@
+/**
+ * @file sampler.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_SAMPLER_H_
+#define CASPER_APP_MONITOR_SAMPLER_H_
+#pragma once
+
+#include <sys/types.h> // pid_t
+
+#include <string>             // std::string
+#include <map>                // std::map
+#include <vector>             // std::vector
+#include <thread>             // std::thread
+#include <mutex>              // std::mutex
+#include <condition_variable> // std::condition_variable
+#include <atomic>             // std::atomic
+#include <chrono>             // std::chrono
+#include <functional>         // std::function
+#include <memory>             // std::shared_ptr
+
+#include "casper/app/monitor/ring_buffer.h"
+#include "casper/app/monitor/process_table.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Periodically samples resource usage of each supervised child and it's descendants.
+             *
+             * Samples are kept in one fixed-size ring buffer per child, readers never block the sampler thread.
+             */
+            class Sampler final
+            {
+
+            public: // Data Type(s)
+
+                typedef struct {
+                    int64_t  timestamp_;   //!< Milliseconds since epoch.
+                    pid_t    pid_;         //!< Child process id, 0 when it was not running.
+                    float    cpu_;         //!< CPU usage since previous sample, 100 is one core.
+                    uint64_t rss_;         //!< Resident set size, in bytes.
+                    uint64_t read_bytes_;  //!< Bytes read from storage since previous sample.
+                    uint64_t write_bytes_; //!< Bytes written to storage since previous sample.
+                    uint32_t fds_;         //!< Number of open file descriptors.
+                    uint32_t threads_;     //!< Number of threads.
+                    uint32_t processes_;   //!< Number of processes, child and all it's descendants.
+                } Sample;
+
+                typedef RingBuffer<Sample> Series;
+
+                typedef struct {
+                    float    cpu_; //!< CPU usage threshold, 100 is one core, 0 to disable.
+                    uint64_t rss_; //!< Resident set size threshold, in bytes, 0 to disable.
+                } Limits;
+
+                enum class Metric : uint8_t {
+                    CPU = 0,
+                    RSS
+                };
+
+                typedef struct {
+                    std::string id_;     //!< Child id.
+                    pid_t       pid_;    //!< Child pid.
+                    Metric      metric_;
+                    double      value_;  //!< Sampled value.
+                    double      limit_;  //!< Threshold.
+                    bool        above_;  //!< True when it went above threshold, false when it's back below it.
+                } Crossing;
+
+                typedef std::function<void()>                                              Callback;
+                typedef std::function<void(const std::string& a_id, const Sample& a_sample)> Observer;
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    uint64_t cpu_ticks_;   //!< Clock ticks ( Linux ) or nanoseconds ( Darwin ).
+                    uint64_t read_bytes_;
+                    uint64_t write_bytes_;
+                } Counters;
+
+                typedef struct {
+                    bool cpu_; //!< True while CPU usage is above threshold.
+                    bool rss_; //!< True while resident set size is above threshold.
+                } Above;
+
+            private: // Data
+
+                int                                            interval_ms_;
+                size_t                                         capacity_;
+                std::map<std::string, pid_t>                   targets_;
+                std::map<std::string, std::shared_ptr<Series>> series_;   //!< Erased when it's child is forgotten, readers keep their own reference.
+                std::map<std::string, std::vector<pid_t>>      members_;  //!< Tree of each child, as seen by most recent sample.
+                std::map<pid_t, Counters>                      counters_; //!< Sampler thread only.
+                std::chrono::steady_clock::time_point          last_tp_;  //!< Sampler thread only.
+                ProcessTable                                   table_;    //!< Sampler thread only.
+                std::map<std::string, Limits>                  limits_;   //!< Configured thresholds, by child id.
+                std::map<std::string, Above>                   above_;    //!< Sampler thread only, by child id.
+                std::vector<Crossing>                          crossed_;  //!< Not collected yet, oldest first.
+                Callback                                       callback_;
+                Observer                                       observer_;
+
+            private: // Threading
+
+                std::thread*            thread_;
+                mutable std::mutex      mutex_;
+                std::condition_variable wait_cv_;
+                bool                    aborted_;
+
+            public: // Constructor(s) / Destructor
+
+                Sampler ();
+                virtual ~Sampler ();
+
+            public: // Method(s) / Function(s)
+
+                void Setup   (const int a_interval_ms, const size_t a_capacity);
+                void Limit   (const std::map<std::string, Limits>& a_limits);
+                void Start   (const Callback& a_callback, const Observer& a_observer);
+                void Stop    ();
+
+                void Track   (const std::string& a_id, const pid_t a_pid);
+                void Untrack (const std::string& a_id);
+                void Forget  (const std::string& a_id);
+
+                bool Copy    (const std::string& a_id, const size_t a_max, std::vector<Sample>& o_samples) const;
+                void IDs     (std::vector<std::string>& o_ids) const;
+                bool Members (const std::string& a_id, std::vector<pid_t>& o_pids) const;
+                void Crossed (std::vector<Crossing>& o_crossings);
+
+            public: // Static Method(s) / Function(s)
+
+                static const char* Name (const Metric a_metric);
+
+            public: // Inline Method(s) / Function(s)
+
+                int interval () const;
+
+            private: // Method(s) / Function(s)
+
+                void Loop    ();
+                void Measure (const std::vector<pid_t>& a_pids, const double a_elapsed,
+                              std::map<pid_t, Counters>& o_counters, Sample& o_sample) const;
+                bool Read    (const pid_t a_pid, Counters& o_counters, Sample& o_sample) const;
+                bool Compare (const std::string& a_id, const Limits& a_limits, const Sample& a_sample, std::vector<Crossing>& o_crossings);
+
+            }; // end of class 'Sampler'
+
+            /**
+             * @return Sampling interval, in milliseconds.
+             */
+            inline int Sampler::interval () const
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return interval_ms_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_SAMPLER_H_
@@ -0,0 +1,261 @@
+/**
+ * @file scaler.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/scaler.h"
+
+#include "casper/app/logger.h"
+
+#include <math.h> // ceil
+
+#include <algorithm> // std::min, std::max
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Scaler::Scaler ()
+{
+    version_  = 0;
+    callback_ = nullptr;
+    thread_   = nullptr;
+    aborted_  = false;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Scaler::~Scaler ()
+{
+    Stop();
+}
+
+/**
+ * @brief Replace pools, can be called while running.
+ *
+ * @param a_pools Pools definition, by pool id.
+ * @param a_sizes Current number of instances, by pool id.
+ */
+void casper::app::monitor::Scaler::Setup (const std::map<std::string, casper::app::monitor::Scaler::Pool>& a_pools,
+                                          const std::map<std::string, size_t>& a_sizes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pools_ = a_pools;
+        sizes_ = a_sizes;
+        version_++;
+    }
+    wait_cv_.notify_all();
+}
+
+/**
+ * @brief Start scaler thread, if not running already.
+ *
+ * @param a_callback Function to call, from scaler thread, when a pool size changed.
+ */
+void casper::app::monitor::Scaler::Start (const casper::app::monitor::Scaler::Callback& a_callback)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( nullptr != thread_ ) {
+        return;
+    }
+    aborted_  = false;
+    callback_ = a_callback;
+    thread_   = new std::thread(&casper::app::monitor::Scaler::Loop, this);
+}
+
+/**
+ * @brief Stop scaler thread, published sizes are kept.
+ */
+void casper::app::monitor::Scaler::Stop ()
+{
+    std::thread* thread;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread   = thread_;
+        thread_  = nullptr;
+        aborted_ = true;
+    }
+    if ( nullptr == thread ) {
+        return;
+    }
+    wait_cv_.notify_all();
+    thread->join();
+    delete thread;
+}
+
+/**
+ * @brief Copy published sizes.
+ *
+ * @param o_sizes Number of instances that must run, by pool id.
+ */
+void casper::app::monitor::Scaler::Sizes (std::map<std::string, size_t>& o_sizes) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    o_sizes = sizes_;
+}
+
+/**
+ * @brief Scaler thread function.
+ */
+void casper::app::monitor::Scaler::Loop ()
+{
+#ifdef __APPLE__
+    pthread_setname_np("Monitor Scaler");
+#else
+    pthread_setname_np(pthread_self(), "Scaler");
+#endif
+
+    const std::chrono::steady_clock::time_point k_never_;
+
+    std::map<std::string, Entry>  entries;
+    std::map<std::string, Pool>   pools;
+    std::map<std::string, size_t> sizes;
+    uint64_t                      version = version_ - 1;
+
+    while ( true ) {
+
+        bool reset = false;
+
+        // ... wait for next reading, pools changes or abort ...
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto next_tp = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            for ( auto& it : entries ) {
+                next_tp = std::min(next_tp, it.second.next_tp_);
+            }
+            wait_cv_.wait_until(lock, next_tp, [this, &version] { return aborted_ || version != version_; });
+            if ( true == aborted_ ) {
+                break;
+            }
+            if ( version != version_ ) {
+                pools   = pools_;
+                sizes   = sizes_;
+                version = version_;
+                reset   = true;
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        // ... new, changed or removed pools ...
+        if ( true == reset ) {
+            for ( auto it = entries.begin() ; entries.end() != it ; ) {
+                const auto pool = pools.find(it->first);
+                if ( pools.end() == pool || false == pool->second.scaled_
+                    ||
+                    pool->second.gauge_.kind_ != it->second.pool_.gauge_.kind_ || pool->second.gauge_.host_ != it->second.pool_.gauge_.host_
+                    ||
+                    pool->second.gauge_.port_ != it->second.pool_.gauge_.port_ || pool->second.gauge_.tube_ != it->second.pool_.gauge_.tube_
+                ) {
+                    delete it->second.gauge_;
+                    it = entries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            for ( auto pool : pools ) {
+                if ( false == pool.second.scaled_ ) {
+                    continue;
+                }
+                const size_t size = std::max(pool.second.min_, std::min(pool.second.max_, sizes[pool.first]));
+                const auto   it   = entries.find(pool.first);
+                if ( entries.end() != it ) {
+                    it->second.pool_   = pool.second;
+                    it->second.target_ = size;
+                    continue;
+                }
+                entries[pool.first] = {
+                    /* pool_    */ pool.second,
+                    /* gauge_   */ Gauge::New(pool.second.gauge_),
+                    /* target_  */ size,
+                    /* peak_    */ 0,
+                    /* low_tp_  */ k_never_,
+                    /* next_tp_ */ now,
+                    /* failed_  */ false
+                };
+            }
+        }
+
+        std::map<std::string, size_t> changed;
+
+        for ( auto& it : entries ) {
+
+            Entry& entry = it.second;
+            if ( entry.next_tp_ > now ) {
+                continue;
+            }
+            entry.next_tp_ = now + std::chrono::milliseconds(entry.pool_.interval_ms_);
+
+            double load = 0;
+            if ( false == entry.gauge_->Read(load) ) {
+                if ( false == entry.failed_ ) {
+                    // ... log ...
+                    CASPER_APP_LOG("error", "Unable to read %s load for %s, keeping %zu instance(s): %s...",
+                                   Gauge::Name(entry.pool_.gauge_.kind_), it.first.c_str(), entry.target_, entry.gauge_->error().message().c_str()
+                    );
+                    entry.failed_ = true;
+                }
+                continue;
+            }
+            entry.failed_ = false;
+
+            const size_t required = std::max(entry.pool_.min_,
+                                             std::min(entry.pool_.max_, static_cast<size_t>(ceil(load / entry.pool_.per_instance_)))
+            );
+
+            if ( required > entry.target_ ) {
+                // ... grow now ...
+                entry.target_ = required;
+                entry.low_tp_ = k_never_;
+                changed[it.first] = required;
+            } else if ( required < entry.target_ ) {
+                // ... shrink later, to the highest size required meanwhile ...
+                if ( k_never_ == entry.low_tp_ ) {
+                    entry.low_tp_ = now;
+                    entry.peak_   = required;
+                } else {
+                    entry.peak_ = std::max(entry.peak_, required);
+                }
+                if ( now - entry.low_tp_ >= std::chrono::milliseconds(entry.pool_.cooldown_ms_) ) {
+                    entry.target_ = entry.peak_;
+                    entry.low_tp_ = k_never_;
+                    changed[it.first] = entry.target_;
+                }
+            } else {
+                entry.low_tp_ = k_never_;
+            }
+        }
+
+        // ... publish ...
+        if ( changed.size() > 0 ) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for ( auto it : changed ) {
+                    sizes_[it.first] = it.second;
+                }
+            }
+            callback_();
+        }
+    }
+
+    for ( auto it : entries ) {
+        delete it.second.gauge_;
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * @file scaler.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_SCALER_H_
+#define CASPER_APP_MONITOR_SCALER_H_
+#pragma once
+
+#include <stdint.h> // uint64_t
+
+#include <string>             // std::string
+#include <map>                // std::map
+#include <thread>             // std::thread
+#include <mutex>              // std::mutex
+#include <condition_variable> // std::condition_variable
+#include <functional>         // std::function
+#include <chrono>             // std::chrono
+
+#include "casper/app/monitor/gauge.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Periodically reads each pool load signal and decides how many of it's instances must run.
+             *
+             * Pools grow as soon as load requires it, and shrink only after load stayed lower for a cooldown period.
+             */
+            class Scaler final
+            {
+
+            public: // Data Type(s)
+
+                typedef struct {
+                    size_t        min_;          //!< Instances always running.
+                    size_t        max_;          //!< Maximum number of instances.
+                    bool          scaled_;       //!< True when a load signal is configured, otherwise min_ instances run.
+                    Gauge::Config gauge_;        //!< Load signal, only valid when scaled_ is true.
+                    double        per_instance_; //!< Load handled by each instance, e.g. number of jobs.
+                    int           interval_ms_;  //!< Load signal reading interval.
+                    int           cooldown_ms_;  //!< Pool shrinks only when load was lower during this period.
+                } Pool;
+
+                typedef std::function<void()> Callback;
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    Pool                                  pool_;
+                    Gauge*                                gauge_;
+                    size_t                                target_;  //!< Last published size.
+                    size_t                                peak_;    //!< Highest size required since load dropped.
+                    std::chrono::steady_clock::time_point low_tp_;  //!< When load dropped below target, epoch when it didn't.
+                    std::chrono::steady_clock::time_point next_tp_; //!< Next reading.
+                    bool                                  failed_;  //!< True when last reading failed, failures are logged once.
+                } Entry;
+
+            private: // Data
+
+                std::map<std::string, Pool>   pools_;   //!< By pool id.
+                std::map<std::string, size_t> sizes_;   //!< Published sizes, by pool id.
+                uint64_t                      version_; //!< Incremented when pools are replaced.
+                Callback                      callback_;
+
+            private: // Threading
+
+                std::thread*            thread_;
+                mutable std::mutex      mutex_;
+                std::condition_variable wait_cv_;
+                bool                    aborted_;
+
+            public: // Constructor(s) / Destructor
+
+                Scaler ();
+                virtual ~Scaler ();
+
+            public: // Method(s) / Function(s)
+
+                void Setup (const std::map<std::string, Pool>& a_pools, const std::map<std::string, size_t>& a_sizes);
+                void Start (const Callback& a_callback);
+                void Stop  ();
+                void Sizes (std::map<std::string, size_t>& o_sizes) const;
+
+            private: // Method(s) / Function(s)
+
+                void Loop  ();
+
+            }; // end of class 'Scaler'
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_SCALER_H_
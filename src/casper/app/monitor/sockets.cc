@@ -0,0 +1,216 @@
+/**
+ * @file sockets.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/sockets.h"
+
+#include "casper/app/monitor/helper.h"
+
+#include <unistd.h>     // close, unlink
+#include <errno.h>      // errno
+#include <fcntl.h>      // fcntl
+#include <netdb.h>      // getaddrinfo
+#include <string.h>     // memset, strncpy
+#include <sys/stat.h>   // lstat
+#include <sys/socket.h> // socket, bind, listen, setsockopt
+#include <sys/un.h>     // sockaddr_un
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Sockets::Sockets ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Sockets::~Sockets ()
+{
+    Close();
+}
+
+/**
+ * @brief Obtain a listening socket, it's bound on first use and the same descriptor is returned from then on.
+ *
+ * @param a_address Address to listen on.
+ * @param o_fd      Listening socket, close-on-exec, owned by this object.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Sockets::Listen (const casper::app::monitor::Sockets::Address& a_address, int& o_fd)
+{
+    const std::string name = Name(a_address);
+
+    const auto it = entries_.find(name);
+    if ( entries_.end() != it ) {
+        // ... backlog might have been changed by a reload ...
+        (void)listen(it->second.fd_, a_address.backlog_);
+        o_fd = it->second.fd_;
+        return true;
+    }
+
+    if ( false == Bind(a_address, o_fd) ) {
+        return false;
+    }
+
+    entries_[name] = {
+        /* fd_   */ o_fd,
+        /* path_ */ ( Kind::Unix == a_address.kind_ ? a_address.path_ : "" )
+    };
+
+    return true;
+}
+
+/**
+ * @brief Close all sockets that are no longer used.
+ *
+ * @param a_names Sockets to keep, by \link Name \link.
+ */
+void casper::app::monitor::Sockets::Retain (const std::set<std::string>& a_names)
+{
+    for ( auto it = entries_.begin() ; entries_.end() != it ; ) {
+        if ( a_names.end() != a_names.find(it->first) ) {
+            ++it;
+            continue;
+        }
+        close(it->second.fd_);
+        if ( 0 != it->second.path_.length() ) {
+            (void)unlink(it->second.path_.c_str());
+        }
+        it = entries_.erase(it);
+    }
+}
+
+/**
+ * @brief Close all sockets.
+ */
+void casper::app::monitor::Sockets::Close ()
+{
+    Retain({});
+}
+
+/**
+ * @brief Build an address unique name.
+ *
+ * @param a_address Address.
+ *
+ * @return tcp:<host>:<port> or unix:<path>.
+ */
+std::string casper::app::monitor::Sockets::Name (const casper::app::monitor::Sockets::Address& a_address)
+{
+    if ( Kind::Unix == a_address.kind_ ) {
+        return "unix:" + a_address.path_;
+    }
+    return "tcp:" + a_address.host_ + ':' + std::to_string(a_address.port_);
+}
+
+/**
+ * @brief Create, bind and listen on a new socket.
+ *
+ * @param a_address Address to listen on.
+ * @param o_fd      New socket.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Sockets::Bind (const casper::app::monitor::Sockets::Address& a_address, int& o_fd)
+{
+    const std::string name = Name(a_address);
+
+    struct sockaddr_storage address;
+    socklen_t               length;
+
+    memset(&address, 0, sizeof(address));
+
+    if ( Kind::Unix == a_address.kind_ ) {
+        struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&address);
+        if ( a_address.path_.length() >= sizeof(un->sun_path) ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                         sys::Error::k_no_error_,
+                                         "unix socket path '%s' is too long", a_address.path_.c_str()
+            );
+            return false;
+        }
+        un->sun_family = AF_UNIX;
+        strncpy(un->sun_path, a_address.path_.c_str(), sizeof(un->sun_path) - 1);
+        length = static_cast<socklen_t>(sizeof(struct sockaddr_un));
+        // ... a previous monitor ( or child ) left it behind, only sockets are removed ...
+        struct stat info;
+        if ( 0 == lstat(a_address.path_.c_str(), &info) && 0 != S_ISSOCK(info.st_mode) ) {
+            (void)unlink(a_address.path_.c_str());
+        }
+    } else {
+        struct addrinfo  hints;
+        struct addrinfo* result = nullptr;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags    = AI_NUMERICSERV | AI_PASSIVE;
+        const int rv = getaddrinfo(a_address.host_.c_str(), std::to_string(a_address.port_).c_str(), &hints, &result);
+        if ( 0 != rv || nullptr == result ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_,
+                                         sys::Error::k_no_error_,
+                                         "unable to resolve '%s': %s", a_address.host_.c_str(), gai_strerror(rv)
+            );
+            if ( nullptr != result ) {
+                freeaddrinfo(result);
+            }
+            return false;
+        }
+        memcpy(&address, result->ai_addr, result->ai_addrlen);
+        length = result->ai_addrlen;
+        freeaddrinfo(result);
+    }
+
+    o_fd = socket(address.ss_family, SOCK_STREAM, 0);
+    if ( -1 == o_fd ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to create socket for %s", name.c_str());
+        return false;
+    }
+
+    // ... children get their own copy, at a fixed descriptor, it must not leak to any other child ...
+    const int reuse = 1;
+    if ( -1 == fcntl(o_fd, F_SETFD, FD_CLOEXEC)
+        ||
+        ( Kind::TCP == a_address.kind_ && -1 == setsockopt(o_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) )
+    ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to set socket options for %s", name.c_str());
+        close(o_fd);
+        o_fd = -1;
+        return false;
+    }
+
+    if ( -1 == bind(o_fd, reinterpret_cast<struct sockaddr*>(&address), length) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to bind %s", name.c_str());
+        close(o_fd);
+        o_fd = -1;
+        return false;
+    }
+
+    if ( -1 == listen(o_fd, a_address.backlog_) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to listen on %s", name.c_str());
+        close(o_fd);
+        o_fd = -1;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file sockets.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_SOCKETS_H_
+#define CASPER_APP_MONITOR_SOCKETS_H_
+#pragma once
+
+#include <stdint.h> // uint8_t
+
+#include <string> // std::string
+#include <set>    // std::set
+#include <map>    // std::map
+
+#include "sys/error.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Listening sockets bound by the monitor and passed to children, so they outlive children restarts.
+             *
+             * While a child is restarting, the kernel keeps queuing connections ( up to backlog ) instead of refusing them.
+             */
+            class Sockets final
+            {
+
+            public: // Data Type(s)
+
+                enum class Kind : uint8_t {
+                    TCP = 0,
+                    Unix
+                };
+
+                typedef struct {
+                    Kind        kind_;
+                    std::string host_;    //!< TCP only, numeric or name, IPv6 without brackets.
+                    int         port_;    //!< TCP only.
+                    std::string path_;    //!< Unix only.
+                    int         backlog_; //!< Pending connections queue length.
+                } Address;
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    int         fd_;
+                    std::string path_; //!< Unix only, removed when closed.
+                } Entry;
+
+            private: // Data
+
+                std::map<std::string, Entry> entries_; //!< By \link Name \link.
+                ::sys::Error                 error_;
+
+            public: // Constructor(s) / Destructor
+
+                Sockets ();
+                virtual ~Sockets ();
+
+            public: // Method(s) / Function(s)
+
+                bool Listen (const Address& a_address, int& o_fd);
+                void Retain (const std::set<std::string>& a_names);
+                void Close  ();
+
+            public: // Inline Method(s) / Function(s)
+
+                const ::sys::Error& error () const;
+
+            public: // Static Method(s) / Function(s)
+
+                static std::string Name (const Address& a_address);
+
+            private: // Method(s) / Function(s)
+
+                bool Bind   (const Address& a_address, int& o_fd);
+
+            }; // end of class 'Sockets'
+
+            /**
+             * @return R/O access to last error.
+             */
+            inline const ::sys::Error& Sockets::error () const
+            {
+                return error_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_SOCKETS_H_
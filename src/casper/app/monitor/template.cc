@@ -0,0 +1,116 @@
+/**
+ * @file template.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/template.h"
+
+#include <ctype.h> // isalnum
+
+/**
+ * @brief Default constructor.
+ *
+ * @param a_source Text to split, a placeholder is @@ followed by one or more [A-Za-z0-9_] and @@.
+ */
+casper::app::monitor::Template::Template (const std::string& a_source)
+{
+    length_ = 0;
+
+    size_t start = 0; // ... of current literal ...
+    size_t pos   = 0;
+
+    while ( std::string::npos != ( pos = a_source.find("@@", pos) ) ) {
+        // ... find closing delimiter, name must be valid ...
+        size_t end = pos + 2;
+        while ( end < a_source.length() && ( 0 != isalnum(static_cast<unsigned char>(a_source[end])) || '_' == a_source[end] ) ) {
+            end++;
+        }
+        if ( end == pos + 2 || end + 1 >= a_source.length() || '@' != a_source[end] || '@' != a_source[end + 1] ) {
+            // ... not a placeholder, it's part of a literal ...
+            pos += 1;
+            continue;
+        }
+        if ( pos > start ) {
+            segments_.push_back({ /* variable_ */ false, /* value_ */ a_source.substr(start, pos - start) });
+            length_ += ( pos - start );
+        }
+        segments_.push_back({ /* variable_ */ true, /* value_ */ a_source.substr(pos, end + 2 - pos) });
+        // ... next search starts after this placeholder, repeated placeholders are never skipped ...
+        pos   = end + 2;
+        start = pos;
+    }
+
+    if ( start < a_source.length() ) {
+        segments_.push_back({ /* variable_ */ false, /* value_ */ a_source.substr(start) });
+        length_ += ( a_source.length() - start );
+    }
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Template::~Template ()
+{
+    /* empty */
+}
+
+/**
+ * @brief Replace all placeholders, in one pass.
+ *
+ * @param a_variables Values by placeholder.
+ * @param a_is_path   When true, a value trailing '/' is dropped if it's followed by a '/' or it ends the text.
+ * @param o_value     Rendered text.
+ * @param o_unknown   First placeholder without a value, only set on failure.
+ *
+ * @return True on success, false when a placeholder has no value.
+ */
+bool casper::app::monitor::Template::Render (const casper::app::monitor::Template::Variables& a_variables, const bool a_is_path,
+                                             std::string& o_value, std::string& o_unknown) const
+{
+    o_value.clear();
+    o_value.reserve(length_);
+
+    for ( size_t idx = 0 ; idx < segments_.size() ; ++idx ) {
+
+        const Segment& segment = segments_[idx];
+        if ( false == segment.variable_ ) {
+            o_value += segment.value_;
+            continue;
+        }
+
+        const auto it = a_variables.find(segment.value_);
+        if ( a_variables.end() == it ) {
+            o_unknown = segment.value_;
+            return false;
+        }
+
+        const std::string& value = it->second;
+        if ( true == a_is_path && value.length() > 1 && '/' == value[value.length() - 1]
+            &&
+            ( idx + 1 == segments_.size() || ( false == segments_[idx + 1].variable_ && '/' == segments_[idx + 1].value_[0] ) )
+        ) {
+            // ... avoid '//' ...
+            o_value.append(value, 0, value.length() - 1);
+        } else {
+            o_value += value;
+        }
+    }
+
+    return true;
+}
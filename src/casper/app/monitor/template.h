@@ -0,0 +1,78 @@
+/**
+ * @file template.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_TEMPLATE_H_
+#define CASPER_APP_MONITOR_TEMPLATE_H_
+#pragma once
+
+#include <string> // std::string
+#include <vector> // std::vector
+#include <map>    // std::map
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief A string with @@NAME@@ placeholders, split once into literal and variable segments.
+             */
+            class Template final
+            {
+
+            public: // Data Type(s)
+
+                typedef std::map<std::string, std::string> Variables; //!< By placeholder, including @@ delimiters.
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    bool        variable_; //!< True when value_ is a placeholder.
+                    std::string value_;    //!< Literal text or placeholder, including @@ delimiters.
+                } Segment;
+
+            private: // Data
+
+                std::vector<Segment> segments_;
+                size_t               length_; //!< Sum of literals length, a hint for rendered length.
+
+            public: // Constructor(s) / Destructor
+
+                Template (const std::string& a_source);
+                virtual ~Template ();
+
+            public: // Method(s) / Function(s)
+
+                bool Render (const Variables& a_variables, const bool a_is_path, std::string& o_value, std::string& o_unknown) const;
+
+            }; // end of class 'Template'
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_TEMPLATE_H_
@@ -22,30 +22,40 @@
 #include "casper/app/monitor/watchdog.h"
 
 #include "casper/app/monitor/helper.h"
+#include "casper/app/monitor/template.h"
+#include "casper/app/monitor/identity.h"
 
-#include <unistd.h> // access, pid_t, getppid
+#include "casper/app/tracer.h"
+
+#include <unistd.h> // access, pid_t, getppid, unlink
 #include <errno.h>  // errno
+#include <stdio.h>  // snprintf
 #include <signal.h> // sigemptyset, sigaddset, pthread_sigmask, etc
 #include <sstream>  // stringstream
 #include <inttypes.h> // PRId32
+#include <limits.h> // PATH_MAX, INT_MIN
+#include <assert.h> // assert
 #include <sys/stat.h> //fstat
-
-#include <sys/event.h> // kevent
-#include <sys/select.h> // select
+#include <sys/wait.h> // WIFEXITED, WIFSIGNALED, etc
+#include <sys/resource.h> // getrlimit, setrlimit
 
 #include <grp.h> // getgrgid
 
-#include <set>     // std::set
+#include <set>       // std::set
+#include <algorithm> // std::min, std::max
 
 #include <cstdarg> // va_start, va_end, std::va_list
 
 #include <spawn.h>
 
+extern char** environ;
+
 #include "json/json.h"
 #include <iostream> // std::istream, std::ios
 #include <fstream>  // std::filebuf
 
 #include <fcntl.h>
+#include <sys/socket.h> // SOMAXCONN
 
 #ifdef CASPER_APP_WATCHDOG_LOCK
     #undef CASPER_APP_WATCHDOG_LOCK
@@ -108,6 +118,21 @@ casper::app::monitor::Initializer::Initializer (casper::app::monitor::Watchdog&
     instance_.locks_        = 0;
     instance_.abort_flag_   = nullptr;
     instance_.main_pid_     = 0;
+#if CASPER_APP_MONITOR_SPAWN_CLOSES_FDS
+    instance_.spawn_mode_   = casper::app::monitor::Watchdog::SpawnMode::PosixSpawn;
+#else
+    instance_.spawn_mode_   = casper::app::monitor::Watchdog::SpawnMode::Fork;
+#endif
+    instance_.spawn_stats_  = { 0, 0, 0 };
+    instance_.watch_        = { /* enabled_ */ false, /* debounce_ms_ */ 500 };
+    instance_.watch_timer_  = 0;
+    instance_.reload_       = false;
+    instance_.scale_        = false;
+    instance_.heal_         = false;
+    instance_.alert_        = false;
+    instance_.order_        = false;
+    instance_.adopt_        = false;
+    instance_.sequence_     = 0;
 }
 
 /**
@@ -150,6 +175,153 @@ void casper::app::monitor::Watchdog::Start (const Json::Value& a_config, const b
     //     }
     // }
     
+    // ... keep startup configuration, reloads only read configuration file again ...
+    config_ = a_config;
+    
+    Json::Value                           config;
+    std::list<const ::sys::Process::Info> sorted;
+    std::map<std::string, Options>        options;
+    std::map<std::string, Scaler::Pool>   pools;
+    
+    // ... read configuration file and load processes to launch and monitor ...
+    {
+        ::casper::app::Tracer::Span span("Load");
+        (void)Load(a_config, config, sorted, options, pools);
+    }
+    
+    // ... notify fatal error ( if any ) ...
+    CASPER_APP_WATCHDOG_FATAL_BITE();
+    
+    //
+    // "metrics": {
+    //     "interval": <ms>,
+    //     "samples": <number of samples kept for each child>
+    // }
+    //
+    const Json::Value& metrics = config["metrics"];
+    sampler_.Setup(( true == metrics.isObject() ? metrics.get("interval", 1000).asInt()  : 1000 ),
+                   ( true == metrics.isObject() ? metrics.get("samples" , 300 ).asUInt() : 300  )
+    );
+    
+    //
+    // "spawn": "posix_spawn" | "fork"
+    //
+    const std::string spawn = config.get("spawn", "posix_spawn").asString();
+    if ( 0 == spawn.compare("posix_spawn") ) {
+#if CASPER_APP_MONITOR_SPAWN_CLOSES_FDS
+        spawn_mode_ = SpawnMode::PosixSpawn;
+#else
+        // ... no posix_spawn_file_actions_addclosefrom_np, children would inherit all our fds ...
+        spawn_mode_ = SpawnMode::Fork;
+        CASPER_APP_DEBUG_LOG("status", "%s", "posix_spawn can't close inherited fds on this platform, using fork...");
+#endif
+    } else if ( 0 == spawn.compare("fork") ) {
+        spawn_mode_ = SpawnMode::Fork;
+    } else {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                     sys::Error::k_no_error_,
+                                     "invalid 'spawn' mode '%s': expecting posix_spawn or fork", spawn.c_str()
+        );
+    }
+    
+    // ... notify fatal error ( if any ) ...
+    CASPER_APP_WATCHDOG_FATAL_BITE();
+    
+    //
+    // "logs": {
+    //     "max_size": <bytes, 0 to disable>, "max_age": <ms, 0 to disable>, "keep": <number of closed segments>,
+    //     "buffer": <bytes buffered for each log>, "compress": <true to gzip closed segments>
+    // }
+    //
+    const Json::Value logs = ( true == config["logs"].isObject() ? config["logs"] : Json::Value(Json::objectValue) );
+    collector_.Setup({
+        /* max_size_    */ logs.get("max_size", 64 * 1024 * 1024).asUInt64(),
+        /* max_age_ms_  */ logs.get("max_age", 0).asInt(),
+        /* keep_        */ logs.get("keep", 10).asUInt(),
+        /* buffer_size_ */ logs.get("buffer", 1024 * 1024).asUInt(),
+        /* compress_    */ logs.get("compress", true).asBool()
+    });
+    
+    //
+    // "crashes": {
+    //     "directory": "<where cores and reports are kept, default is logs directory 'crashes' sub directory>",
+    //     "keep": <number of reports>, "max_size": <bytes, all cores>, "lines": <stderr lines kept in each report>
+    // }
+    //
+    const Json::Value crashes = ( true == config["crashes"].isObject() ? config["crashes"] : Json::Value(Json::objectValue) );
+    crashes_.Setup({
+        /* directory_ */ crashes.get("directory", a_config["directories"]["logs"].asString() + "crashes/").asString(),
+        /* keep_      */ crashes.get("keep", 10).asUInt(),
+        /* max_size_  */ crashes.get("max_size", 1024 * 1024 * 1024).asUInt64(),
+        /* lines_     */ crashes.get("lines", 20).asUInt()
+    });
+    
+    //
+    // "runs": {
+    //     "keep": <runs kept in memory, per child>, "max_size": <bytes, history file is rotated when it reaches this size>
+    // }
+    //
+    const Json::Value runs = ( true == config["runs"].isObject() ? config["runs"] : Json::Value(Json::objectValue) );
+    runs_.Setup({
+        /* uri_      */ a_config["directories"]["runtime"].asString() + "monitor-runs.log",
+        /* keep_     */ runs.get("keep", 100).asUInt(),
+        /* max_size_ */ runs.get("max_size", 4 * 1024 * 1024).asUInt64()
+    });
+    
+    //
+    // "board": {
+    //     "capacity": <maximum number of children published in status board>
+    // }
+    //
+    const Json::Value board     = ( true == config["board"].isObject() ? config["board"] : Json::Value(Json::objectValue) );
+    const std::string board_uri = a_config["directories"]["runtime"].asString() + "monitor.board";
+    if ( false == board_.Create(board_uri, board.get("capacity", 256).asUInt()) ) {
+        CASPER_APP_LOG("error", "Unable to create status board '%s': %s, state will only be known by IPC...", board_uri.c_str(), strerror(errno));
+    }
+    
+    //
+    // "reload": {
+    //     "watch": <true to apply configuration file changes as soon as they are saved>,
+    //     "debounce": <ms, changes are applied when no other change happens within this period>
+    // }
+    //
+    const Json::Value reload = ( true == config["reload"].isObject() ? config["reload"] : Json::Value(Json::objectValue) );
+    watch_ = {
+        /* enabled_     */ reload.get("watch", false).asBool(),
+        /* debounce_ms_ */ reload.get("debounce", 500).asInt()
+    };
+    
+    //
+    // "adopt": <true to keep processes started by a previous monitor running, when they still match their definition>
+    //
+    adopt_ = config.get("adopt", false).asBool();
+    
+    // ... try to launch and start monitoring them ...
+    if ( false == Start(sorted, options, pools, a_detached, a_listener, a_abort_flag) ) {
+        // ... notify fatal error ...
+        CASPER_APP_WATCHDOG_FATAL_BITE();
+    }
+}
+
+/**
+ * @brief Read configuration file and load processes to launch and monitor.
+ *
+ * @param a_config  Startup configuration, see \link Start \link.
+ * @param o_file    Configuration file contents.
+ * @param o_list    Processes definition, sorted by dependencies.
+ * @param o_options Readiness probe, restart policy and stop signal, by process id.
+ * @param o_pools   Worker pools, by pool id.
+ *
+ * @return True on success, false otherwise ( error is set ).
+ *
+ * @note Only processes are loaded here, global settings are applied by the caller.
+ *       A child with "instances" is a pool, it's expanded to one process per instance, '<id>-<n>', n in [1, max].
+ */
+bool casper::app::monitor::Watchdog::Load (const Json::Value& a_config, Json::Value& o_file,
+                                           std::list<const ::sys::Process::Info>& o_list,
+                                           std::map<std::string, casper::app::monitor::Watchdog::Options>& o_options,
+                                           std::map<std::string, casper::app::monitor::Scaler::Pool>& o_pools)
+{
     const Json::Value& variables        = a_config["variables"];
     const Json::Value& common_variables = a_config["variables"]["common"];
     
@@ -184,11 +356,11 @@ void casper::app::monitor::Watchdog::Start (const Json::Value& a_config, const b
     }
     
     
-    // ... notify fatal error ( if any ) ...
-    CASPER_APP_WATCHDOG_FATAL_BITE();
+    if ( true == IsErrorSetUnsafe() ) {
+        return false;
+    }
     
     Json::Reader reader;
-    Json::Value  config;
     
     std::ifstream stream(uri);
     if ( false == stream.is_open() ) {
@@ -196,762 +368,3610 @@ void casper::app::monitor::Watchdog::Start (const Json::Value& a_config, const b
                                      sys::Error::k_no_error_,
                                      "an error occurred while trying to open configuration file '%s'", config_file_uri.c_str()
         );
-    } else if ( false == reader.parse(stream, config, false)  ) {
+    } else if ( false == reader.parse(stream, o_file, false)  ) {
         CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
                                      sys::Error::k_no_error_,
                                      "an error occurred while parsing configuration file '%s'", config_file_uri.c_str()
         );
     }
     
-    // ... notify fatal error ( if any ) ...
-    CASPER_APP_WATCHDOG_FATAL_BITE();
+    if ( true == IsErrorSetUnsafe() ) {
+        return false;
+    }
 
-    const Json::Value& children = config["children"];
+    const Json::Value& children = o_file["children"];
     
-    const auto replace_variables = [] (const std::string& a_string, const Json::Value& a_variables, bool a_is_path) -> std::string {
-        
-        if ( 0 == a_string.length() ) {
-            return a_string;
+    //
+    // "variables": { "<@@NAME@@>": "<value>" } - only string values are used
+    //
+    const auto load_variables = [] (const Json::Value& a_object, Template::Variables& o_variables) {
+        if ( false == a_object.isObject() ) {
+            return;
+        }
+        for ( auto key : a_object.getMemberNames() ) {
+            const Json::Value& value = a_object[key];
+            if ( true == value.isString() ) {
+                o_variables[key] = value.asString();
+            }
         }
+    };
+    
+    Template::Variables common;
+    load_variables(common_variables, common);
+    
+    //
+    // "ready_when": {
+    //     "tcp": "<host>:<port>" | "unix": "<uri>" | "pid_file": "<uri>" | "exec": "<command>" |
+    //     "log": { "stream": "stdout" | "stderr", "pattern": "<regex>" },
+    //     "interval": <ms>, "timeout": <ms>, "retries": <count, -1 for unlimited>
+    // }
+    //
+    const auto load_probe = [this, &logs_dir] (const std::string& a_id, const Json::Value& a_ready_when,
+                                               const std::function<std::string(const std::string&, bool)>& a_expand,
+                                               Probe::Config& o_config) -> bool {
+        
+        o_config = {
+            /* kind_        */ Probe::Kind::TCP,
+            /* host_        */ "",
+            /* port_        */ 0,
+            /* path_        */ "",
+            /* pattern_     */ "",
+            /* command_     */ "",
+            /* interval_ms_ */ a_ready_when.get("interval", 250).asInt(),
+            /* timeout_ms_  */ a_ready_when.get("timeout", 1000).asInt(),
+            /* retries_     */ a_ready_when.get("retries", 120).asInt()
+        };
         
-        std::string rv  = a_string;
+        size_t count = 0;
         
-        for ( auto key : a_variables.getMemberNames() ) {
-            
-            const Json::Value& value = a_variables[key];
-            if ( true == value.isNull() || false == value.isString() || nullptr == strcasestr(rv.c_str(), key.c_str()) ) {
-                continue;
+        if ( true == a_ready_when.isMember("tcp") ) {
+            const std::string address = a_expand(a_ready_when["tcp"].asString(), /* a_is_path */ false);
+            if ( true == IsErrorSetUnsafe() ) {
+                return false;
             }
-            
-            const std::string v  = value.asString();
-            const std::string to = ( true == a_is_path && rv.length() >= 2 && '@' == rv.c_str()[0]  && '@' == rv.c_str()[1] && '/' == v[v.length() -1]  ) ? v.substr(0, v.length() - 1) : v;
-            
-            size_t pos = 0;
-            while ( std::string::npos != ( pos = rv.find(key, pos) ) ) {
-                rv.replace(pos, key.length(), to);
-                pos += rv.length();
+            const size_t      colon   = address.rfind(':');
+            o_config.kind_ = Probe::Kind::TCP;
+            o_config.host_ = ( std::string::npos != colon ? address.substr(0, colon) : "" );
+            o_config.port_ = ( std::string::npos != colon ? atoi(address.c_str() + colon + 1) : 0 );
+            if ( 0 == o_config.host_.length() || o_config.port_ <= 0 || o_config.port_ > 65535 ) {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'ready_when' tcp address '%s' for '%s': expecting <host>:<port>", address.c_str(), a_id.c_str()
+                );
+                return false;
             }
-            
+            count++;
+        }
+        if ( true == a_ready_when.isMember("unix") ) {
+            o_config.kind_ = Probe::Kind::Unix;
+            o_config.path_ = a_expand(a_ready_when["unix"].asString(), /* a_is_path */ true);
+            count++;
+        }
+        if ( true == a_ready_when.isMember("pid_file") ) {
+            o_config.kind_ = Probe::Kind::PIDFile;
+            o_config.path_ = a_expand(a_ready_when["pid_file"].asString(), /* a_is_path */ true);
+            count++;
+        }
+        if ( true == a_ready_when.isMember("log") ) {
+            const std::string stream = a_ready_when["log"].get("stream", "stdout").asString();
+            if ( 0 != stream.compare("stdout") && 0 != stream.compare("stderr") ) {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'ready_when' log stream '%s' for '%s': expecting stdout or stderr", stream.c_str(), a_id.c_str()
+                );
+                return false;
+            }
+            o_config.kind_    = Probe::Kind::Log;
+            o_config.path_    = logs_dir + a_id + "-" + stream + ".log";
+            o_config.pattern_ = a_ready_when["log"].get("pattern", "").asString();
+            try {
+                (void)std::regex(o_config.pattern_, std::regex::ECMAScript);
+            } catch (const std::regex_error& a_regex_error) {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'ready_when' log pattern '%s' for '%s': %s", o_config.pattern_.c_str(), a_id.c_str(), a_regex_error.what()
+                );
+                return false;
+            }
+            count++;
+        }
+        if ( true == a_ready_when.isMember("exec") ) {
+            o_config.kind_    = Probe::Kind::Exec;
+            o_config.command_ = a_expand(a_ready_when["exec"].asString(), /* a_is_path */ false);
+            count++;
         }
         
-        return rv;
+        if ( 1 != count ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'ready_when' for '%s': expecting exactly one of tcp, unix, pid_file, log or exec", a_id.c_str()
+            );
+            return false;
+        }
+        
+        if ( o_config.interval_ms_ < 0 || o_config.timeout_ms_ <= 0 || o_config.retries_ < -1 ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'ready_when' interval, timeout or retries for '%s'", a_id.c_str()
+            );
+            return false;
+        }
+        
+        return true;
     };
     
     //
-    // ... load processes to launch and monitor ...
+    // "restart": "never" | "on-failure" | "always" or
+    // "restart": {
+    //     "policy": "never" | "on-failure" | "always",
+    //     "delay": <ms>, "max_delay": <ms>, "multiplier": <number>, "jitter": <0..1>,
+    //     "max_retries": <count, -1 for unlimited>, "window": <ms>
+    // }
     //
-   
-    std::vector<const ::sys::Process::Info> vector;
-    
-    for ( Json::ArrayIndex idx = 0 ; idx < children.size() ; ++idx ) {
+    const auto load_restart = [this] (const std::string& a_id, const Json::Value& a_restart, Restart& o_restart) -> bool {
         
-        const Json::Value& entry = children[idx];
-
-        std::string arguments = replace_variables(entry.get("arguments", "").asString(), common_variables, /* a_is_path */ false);
+        const Json::Value object = ( true == a_restart.isObject() ? a_restart : Json::Value(Json::objectValue) );
+        
+        o_restart = {
+            /* policy_       */ RestartPolicy::Never,
+            /* delay_ms_     */ object.get("delay", 100).asInt(),
+            /* max_delay_ms_ */ object.get("max_delay", 30000).asInt(),
+            /* multiplier_   */ object.get("multiplier", 2.0).asDouble(),
+            /* jitter_       */ object.get("jitter", 0.1).asDouble(),
+            /* max_retries_  */ object.get("max_retries", 5).asInt(),
+            /* window_ms_    */ object.get("window", 60000).asInt()
+        };
         
-        const Json::Value& process_variables = variables[entry["id"].asString()];
-        if ( false == process_variables.isNull() && true == process_variables.isObject() ) {
-            arguments = replace_variables(arguments, process_variables, /* a_is_path */ false);
+        if ( true == a_restart.isNull() ) {
+            return true;
         }
-
-        std::list<std::string> precedents;
-
-        const Json::Value& depends_on = entry["depends_on"];
-        if ( false == depends_on.isNull() && true == depends_on.isArray() && depends_on.size() > 0 ) {
-            for ( Json::ArrayIndex idx = 0 ; idx < depends_on.size() ; ++idx ) {
-                precedents.push_back(depends_on[idx].asString());
-            }
+        
+        const std::string policy = ( true == a_restart.isString() ? a_restart.asString() : object.get("policy", "").asString() );
+        if ( 0 == policy.compare("never") ) {
+            o_restart.policy_ = RestartPolicy::Never;
+        } else if ( 0 == policy.compare("on-failure") ) {
+            o_restart.policy_ = RestartPolicy::OnFailure;
+        } else if ( 0 == policy.compare("always") ) {
+            o_restart.policy_ = RestartPolicy::Always;
+        } else {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'restart' policy '%s' for '%s': expecting never, on-failure or always", policy.c_str(), a_id.c_str()
+            );
+            return false;
         }
-
-        vector.push_back({
-            /* id_          */ entry["id"].asString(),
-            /* owner_       */ "",
-            /* path_        */ replace_variables(entry["path"].asString(),common_variables, /* a_is_path */ true),
-            /* executable_  */ entry["executable"].asString(),
-            /* arguments_   */ arguments,
-            /* user_        */ "",
-            /* group_       */ "",
-            /* working_dir_ */ replace_variables(entry.get("working_dir", "").asString(), common_variables, /* a_is_path */ true),
-            /* log_dir      */ logs_dir,
-            /* pid_file_    */ entry.get("pid_file", ( runtime_dir + entry["executable"].asString() + ".pid" ) ).asString(),
-            /* depends_on_  */ precedents
-        });
         
-    }
- 
-    std::list<const ::sys::Process::Info> sorted;
-    
-    // ... solve dependencies ...
-    sys::Process::Sort(vector, sorted);
-
-    // ... try to launch and start monitoring them ...
-    if ( false == Start(sorted, a_detached, a_listener, a_abort_flag) ) {
-        // ... notify fatal error ...
-        CASPER_APP_WATCHDOG_FATAL_BITE();
-    }
-}
-
-/**
- * @brief Spawn and monitor a list of processes.
- *
- * @param a_list       List of processes to start.
- * @param a_listener   A listener to be notified when process(es) list is modified.
- * @param a_detached   True when a new thread must be started, false it will run in current thread.
- * @param a_abort_flag External abort flag.
- *
- * @return True on success, false otherwise.
- */
-bool casper::app::monitor::Watchdog::Start (const std::list<const ::sys::Process::Info>& a_list, const bool a_detached,
-                                            casper::app::monitor::Watchdog::Listener& a_listener,
-                                            bool volatile* a_abort_flag)
-{
-    // ... cleanup, if required ...
-    Stop();
-    
-    CASPER_APP_WATCHDOG_LOCK();
-    
-    listener_ptr_ = &a_listener;
-    detached_     = a_detached;
-    main_pid_     = getpid();
-    
-    // ... keep track of new process(es) to spawn ...
-    for ( auto info : a_list ) {
-        // ... create a new process ...
-        ::sys::darwin::Process* process = new ::sys::darwin::Process(::sys::darwin::Process::Info(info));
-        // ... check if it's an executable and ensure directories are created and can be accessed ...
-        if ( false == EnsureRequirements(*process) ) {
-            // ... forget process ...
-            delete process;
-            // ... failure, unlock mutex ...
-            CASPER_APP_WATCHDOG_UNLOCK();
-            // ... done ...
+        if ( o_restart.delay_ms_ < 0 || o_restart.max_delay_ms_ < o_restart.delay_ms_ || o_restart.multiplier_ < 1.0
+            || o_restart.jitter_ < 0.0 || o_restart.jitter_ > 1.0 || o_restart.max_retries_ < -1 || o_restart.window_ms_ <= 0 ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'restart' delay, max_delay, multiplier, jitter, max_retries or window for '%s'", a_id.c_str()
+            );
             return false;
         }
-        // ... load previous executed pid from file ( if any ) ...
-        (void) process->LoadPIDFromFile(/* a_optional */ true);
-        // ... keep track of it ...
-        list_.push_back(process);
-    }
-    
-    // ... now try to terminate all running processes, launched by this app ...
-    if ( false == TerminateAll(/* a_optional */ true) ) {
-        CASPER_APP_WATCHDOG_BITE_UNSAFE();
-    }
+        
+        return true;
+    };
     
-    CASPER_APP_WATCHDOG_UNLOCK();
+    //
+    // "stop_signal": "SIGTERM" | "SIGINT" | "SIGQUIT" | "SIGHUP" | "SIGUSR1" | "SIGUSR2" | "SIGKILL" | <number>,
+    // "stop_timeout": <ms, SIGKILL is sent when it expires>
+    //
+    const auto load_stop = [this] (const std::string& a_id, const Json::Value& a_entry, Halt& o_stop) -> bool {
+        
+        static const std::map<std::string, int> k_signals_ = {
+            { "SIGTERM", SIGTERM }, { "SIGINT" , SIGINT  }, { "SIGQUIT", SIGQUIT }, { "SIGHUP" , SIGHUP  },
+            { "SIGUSR1", SIGUSR1 }, { "SIGUSR2", SIGUSR2 }, { "SIGKILL", SIGKILL }
+        };
+        
+        o_stop = {
+            /* signal_     */ SIGTERM,
+            /* timeout_ms_ */ a_entry.get("stop_timeout", 10000).asInt()
+        };
+        
+        const Json::Value& signal = a_entry["stop_signal"];
+        if ( true == signal.isString() ) {
+            const auto it = k_signals_.find(signal.asString());
+            if ( k_signals_.end() == it ) {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'stop_signal' '%s' for '%s'", signal.asString().c_str(), a_id.c_str()
+                );
+                return false;
+            }
+            o_stop.signal_ = it->second;
+        } else if ( true == signal.isIntegral() ) {
+            o_stop.signal_ = signal.asInt();
+        } else if ( false == signal.isNull() ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'stop_signal' for '%s': expecting a signal name or number", a_id.c_str()
+            );
+            return false;
+        }
+        
+        if ( o_stop.signal_ <= 0 || o_stop.signal_ >= NSIG || o_stop.timeout_ms_ < 0 ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'stop_signal' or 'stop_timeout' for '%s'", a_id.c_str()
+            );
+            return false;
+        }
+        
+        return true;
+    };
     
-    // ... install signal(s) handler(s) ...
-    signal(SIGUSR2, casper::app::monitor::Watchdog::OnSignal);
-    signal(SIGCHLD, casper::app::monitor::Watchdog::OnSignal);
-    signal(SIGTERM, casper::app::monitor::Watchdog::OnSignal);
+    //
+    // "crash": {
+    //     "core": <RLIMIT_CORE, bytes> | "unlimited", "quarantine": <crashes, 0 to disable>, "window": <ms>
+    // }
+    //
+    const auto load_crash = [this] (const std::string& a_id, const Json::Value& a_crash, Crash& o_crash) -> bool {
+        
+        if ( false == a_crash.isNull() && false == a_crash.isObject() ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'crash' for '%s': expecting an object", a_id.c_str()
+            );
+            return false;
+        }
+        
+        const Json::Value object = ( true == a_crash.isObject() ? a_crash : Json::Value(Json::objectValue) );
+        
+        o_crash = {
+            /* core_       */ false,
+            /* core_limit_ */ 0,
+            /* quarantine_ */ object.get("quarantine", 3).asInt(),
+            /* window_ms_  */ object.get("window", 60000).asInt()
+        };
+        
+        const Json::Value& core = object["core"];
+        if ( true == core.isString() && 0 == core.asString().compare("unlimited") ) {
+            o_crash.core_       = true;
+            o_crash.core_limit_ = -1;
+        } else if ( true == core.isIntegral() && core.asInt64() >= 0 ) {
+            o_crash.core_       = true;
+            o_crash.core_limit_ = core.asInt64();
+        } else if ( false == core.isNull() ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'crash' core for '%s': expecting a size, in bytes, or unlimited", a_id.c_str()
+            );
+            return false;
+        }
+        
+        if ( o_crash.quarantine_ < 0 || o_crash.window_ms_ <= 0 ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'crash' quarantine or window for '%s'", a_id.c_str()
+            );
+            return false;
+        }
+        
+        return true;
+    };
     
-    // .. keep track of abort flag ...
-    abort_flag_ = a_abort_flag;
+    //
+    // "thresholds": {
+    //     "cpu": <percent, 100 is one core>, "rss": <bytes>
+    // }
+    //
+    const auto load_thresholds = [this] (const std::string& a_id, const Json::Value& a_thresholds, Sampler::Limits& o_limits) -> bool {
+        
+        if ( false == a_thresholds.isObject() ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'thresholds' for '%s': expecting an object", a_id.c_str()
+            );
+            return false;
+        }
+        
+        const Json::Value& cpu = a_thresholds["cpu"];
+        const Json::Value& rss = a_thresholds["rss"];
+        if ( ( false == cpu.isNull() && ( false == cpu.isNumeric() || cpu.asDouble() <= 0.0 ) )
+            || ( false == rss.isNull() && ( false == rss.isIntegral() || rss.asInt64() <= 0 ) ) ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'thresholds' for '%s': expecting a positive cpu percentage and / or rss, in bytes", a_id.c_str()
+            );
+            return false;
+        }
+        
+        o_limits = {
+            /* cpu_ */ ( true == cpu.isNull() ? 0.0f : cpu.asFloat() ),
+            /* rss_ */ ( true == rss.isNull() ? 0    : rss.asUInt64() )
+        };
+        
+        return true;
+    };
+    
+    //
+    // "health": {
+    //     "redis": "<host>:<port>" | "beanstalkd": "<host>:<port>" | "postgres": "<host>:<port>" | "http": "<host>:<port>",
+    //     "path": "<http path>", "interval": <ms>, "timeout": <ms>, "failures": <count>,
+    //     "max_latency": <ms, 0 to disable>, "sustain": <ms>
+    // }
+    //
+    const auto load_health = [this] (const std::string& a_id, const Json::Value& a_health,
+                                      const std::function<std::string(const std::string&, bool)>& a_expand,
+                                      Health::Check& o_check) -> bool {
+        
+        o_check = {
+            /* kind_           */ Health::Kind::Redis,
+            /* host_           */ "",
+            /* port_           */ 0,
+            /* path_           */ a_health.get("path", "/").asString(),
+            /* interval_ms_    */ a_health.get("interval", 5000).asInt(),
+            /* timeout_ms_     */ a_health.get("timeout", 2000).asInt(),
+            /* failures_       */ a_health.get("failures", 3).asInt(),
+            /* max_latency_ms_ */ a_health.get("max_latency", 0).asInt(),
+            /* sustain_ms_     */ a_health.get("sustain", 30000).asInt()
+        };
+        
+        size_t count = 0;
+        
+        for ( auto kind : { Health::Kind::Redis, Health::Kind::Beanstalkd, Health::Kind::Postgres, Health::Kind::HTTP } ) {
+            const char* const name = Health::Name(kind);
+            if ( false == a_health.isMember(name) ) {
+                continue;
+            }
+            const std::string address = a_expand(a_health[name].asString(), /* a_is_path */ false);
+            if ( true == IsErrorSetUnsafe() ) {
+                return false;
+            }
+            const size_t colon = address.rfind(':');
+            o_check.kind_ = kind;
+            o_check.host_ = ( std::string::npos != colon ? address.substr(0, colon) : "" );
+            o_check.port_ = ( std::string::npos != colon ? atoi(address.c_str() + colon + 1) : 0 );
+            if ( 0 == o_check.host_.length() || o_check.port_ <= 0 || o_check.port_ > 65535 ) {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'health' %s address '%s' for '%s': expecting <host>:<port>", name, address.c_str(), a_id.c_str()
+                );
+                return false;
+            }
+            count++;
+        }
+        
+        if ( 1 != count ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'health' for '%s': expecting exactly one of redis, beanstalkd, postgres or http", a_id.c_str()
+            );
+            return false;
+        }
+        
+        if ( o_check.interval_ms_ <= 0 || o_check.timeout_ms_ <= 0 || o_check.failures_ <= 0 || o_check.max_latency_ms_ < 0 || o_check.sustain_ms_ < 0
+            || 0 == o_check.path_.length() || '/' != o_check.path_[0] ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'health' path, interval, timeout, failures, max_latency or sustain for '%s'", a_id.c_str()
+            );
+            return false;
+        }
+        
+        return true;
+    };
+    
+    //
+    // "listen": [
+    //     { "tcp": "<host>:<port>" | "unix": "<uri>", "backlog": <count> }, ...
+    // ]
+    //
+    // ... sockets are passed as fds 3, 4, ... and announced by LISTEN_FDS / LISTEN_PID and by NGINX=3;4;...;
+    //     nginx only reuses the ones matching it's own 'listen' directives, so entries must mirror it's nginx.conf ...
+    // ... etc/monitor.json declares none: nginx ports live in each nginx.conf, not in this tree, so there this
+    //     feature is inert for the stack's own services and nginx binds it's sockets itself ...
+    //
+    const auto load_listen = [this] (const std::string& a_id, const Json::Value& a_listen,
+                                     const std::function<std::string(const std::string&, bool)>& a_expand,
+                                     std::vector<Sockets::Address>& o_addresses) -> bool {
+        
+        o_addresses.clear();
+        
+        if ( true == a_listen.isNull() ) {
+            return true;
+        }
+        
+        if ( false == a_listen.isArray() ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'listen' for '%s': expecting an array", a_id.c_str()
+            );
+            return false;
+        }
+        
+        for ( Json::ArrayIndex idx = 0 ; idx < a_listen.size() ; ++idx ) {
+            
+            const Json::Value& entry = a_listen[idx];
+            
+            Sockets::Address address = {
+                /* kind_    */ Sockets::Kind::TCP,
+                /* host_    */ "",
+                /* port_    */ 0,
+                /* path_    */ "",
+                /* backlog_ */ ( true == entry.isObject() ? entry.get("backlog", SOMAXCONN).asInt() : 0 )
+            };
+            
+            if ( true == entry.isObject() && true == entry.isMember("tcp") && false == entry.isMember("unix") ) {
+                const std::string value = a_expand(entry["tcp"].asString(), /* a_is_path */ false);
+                if ( true == IsErrorSetUnsafe() ) {
+                    return false;
+                }
+                const size_t colon = value.rfind(':');
+                address.host_ = ( std::string::npos != colon ? value.substr(0, colon) : "" );
+                address.port_ = ( std::string::npos != colon ? atoi(value.c_str() + colon + 1) : 0 );
+                // ... [<ipv6>]:<port> ...
+                if ( address.host_.length() > 2 && '[' == address.host_[0] && ']' == address.host_[address.host_.length() - 1] ) {
+                    address.host_ = address.host_.substr(1, address.host_.length() - 2);
+                }
+                if ( 0 == address.host_.length() || address.port_ <= 0 || address.port_ > 65535 ) {
+                    CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                                 sys::Error::k_no_error_,
+                                                 "invalid 'listen' tcp address '%s' for '%s': expecting <host>:<port>", value.c_str(), a_id.c_str()
+                    );
+                    return false;
+                }
+            } else if ( true == entry.isObject() && true == entry.isMember("unix") && false == entry.isMember("tcp") ) {
+                address.kind_ = Sockets::Kind::Unix;
+                address.path_ = a_expand(entry["unix"].asString(), /* a_is_path */ true);
+                if ( true == IsErrorSetUnsafe() ) {
+                    return false;
+                }
+            } else {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'listen' entry for '%s': expecting an object with exactly one of tcp or unix", a_id.c_str()
+                );
+                return false;
+            }
+            
+            if ( address.backlog_ <= 0 ) {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'listen' backlog for '%s'", a_id.c_str()
+                );
+                return false;
+            }
+            
+            o_addresses.push_back(address);
+        }
+        
+        return true;
+    };
+    
+    //
+    // "instances": <count> or
+    // "instances": {
+    //     "min": <count>, "max": <count>,
+    //     "scale": {
+    //         "beanstalkd": "<host>:<port>", "tube": "<name>", "per_instance": <jobs>,
+    //         "interval": <ms>, "cooldown": <ms>, "timeout": <ms>
+    //     }
+    // }
+    //
+    const auto load_instances = [this] (const std::string& a_id, const Json::Value& a_instances,
+                                        const std::function<std::string(const std::string&, bool)>& a_expand,
+                                        Scaler::Pool& o_pool) -> bool {
+        
+        const Json::Value object = ( true == a_instances.isObject() ? a_instances : Json::Value(Json::objectValue) );
+        const Json::Value scale  = ( true == object["scale"].isObject() ? object["scale"] : Json::Value(Json::objectValue) );
+        
+        const int min = ( true == a_instances.isIntegral() ? a_instances.asInt() : object.get("min", 1).asInt() );
+        const int max = ( true == a_instances.isIntegral() ? a_instances.asInt() : object.get("max", min).asInt() );
+        
+        o_pool = {
+            /* min_          */ static_cast<size_t>(std::max(min, 0)),
+            /* max_          */ static_cast<size_t>(std::max(max, 0)),
+            /* scaled_       */ object.isMember("scale"),
+            /* gauge_        */ {
+                /* kind_       */ Gauge::Kind::Beanstalkd,
+                /* host_       */ "",
+                /* port_       */ 0,
+                /* tube_       */ a_expand(scale.get("tube", "default").asString(), /* a_is_path */ false),
+                /* timeout_ms_ */ scale.get("timeout", 1000).asInt()
+            },
+            /* per_instance_ */ scale.get("per_instance", 1).asDouble(),
+            /* interval_ms_  */ scale.get("interval", 5000).asInt(),
+            /* cooldown_ms_  */ scale.get("cooldown", 60000).asInt()
+        };
+        
+        if ( false == a_instances.isIntegral() && false == a_instances.isObject() ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'instances' for '%s': expecting a number or an object", a_id.c_str()
+            );
+            return false;
+        }
+        
+        if ( min < 1 || max < min || ( max > min && false == o_pool.scaled_ ) ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'instances' min or max for '%s': expecting 1 <= min <= max, and 'scale' when max > min", a_id.c_str()
+            );
+            return false;
+        }
+        
+        if ( false == o_pool.scaled_ ) {
+            return true;
+        }
+        
+        const std::string address = a_expand(scale.get("beanstalkd", "127.0.0.1:11300").asString(), /* a_is_path */ false);
+        if ( true == IsErrorSetUnsafe() ) {
+            return false;
+        }
+        const size_t colon = address.rfind(':');
+        o_pool.gauge_.host_ = ( std::string::npos != colon ? address.substr(0, colon) : "" );
+        o_pool.gauge_.port_ = ( std::string::npos != colon ? atoi(address.c_str() + colon + 1) : 0 );
+        if ( 0 == o_pool.gauge_.host_.length() || o_pool.gauge_.port_ <= 0 || o_pool.gauge_.port_ > 65535 ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'scale' beanstalkd address '%s' for '%s': expecting <host>:<port>", address.c_str(), a_id.c_str()
+            );
+            return false;
+        }
+        
+        if ( 0 == o_pool.gauge_.tube_.length() || o_pool.per_instance_ <= 0.0 || o_pool.interval_ms_ <= 0
+            || o_pool.cooldown_ms_ < 0 || o_pool.gauge_.timeout_ms_ <= 0 ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "invalid 'scale' tube, per_instance, interval, cooldown or timeout for '%s'", a_id.c_str()
+            );
+            return false;
+        }
+        
+        return true;
+    };
+    
+    // ... single pass substitution, unknown variables are errors ...
+    const auto render = [this] (const std::string& a_id, const Template::Variables& a_variables,
+                                const std::string& a_value, bool a_is_path) -> std::string {
+        std::string rv;
+        std::string unknown;
+        if ( false == Template(a_value).Render(a_variables, a_is_path, rv, unknown) && false == IsErrorSetUnsafe() ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                         sys::Error::k_no_error_,
+                                         "unknown variable '%s' in '%s' for '%s'", unknown.c_str(), a_value.c_str(), a_id.c_str()
+            );
+        }
+        return rv;
+    };
+    
+    //
+    // ... pools are expanded first, one definition per instance ...
+    //
+    
+    typedef struct {
+        Json::ArrayIndex index_;    //!< Child entry index.
+        std::string      id_;       //!< Child id, <pool>-<instance> for pool instances.
+        std::string      pool_;     //!< Pool id, empty when it's not a pool instance.
+        size_t           instance_; //!< Instance number, 1 based, 0 when it's not a pool instance.
+    } Definition;
+    
+    std::vector<Definition> definitions;
+    
+    o_pools.clear();
+    
+    for ( Json::ArrayIndex idx = 0 ; idx < children.size() ; ++idx ) {
+        
+        const Json::Value& entry = children[idx];
+        const std::string  id    = entry["id"].asString();
+        
+        if ( false == entry.isMember("instances") ) {
+            definitions.push_back({ /* index_ */ idx, /* id_ */ id, /* pool_ */ "", /* instance_ */ 0 });
+            continue;
+        }
+        
+        Template::Variables pool_variables = common;
+        load_variables(variables[id], pool_variables);
+        
+        Scaler::Pool& pool = o_pools[id];
+        if ( false == load_instances(id, entry["instances"],
+                                     [&render, &id, &pool_variables] (const std::string& a_value, bool a_is_path) -> std::string {
+                                         return render(id, pool_variables, a_value, a_is_path);
+                                     },
+                                     pool)
+        ) {
+            break;
+        }
+        
+        for ( size_t instance = 1 ; instance <= pool.max_ ; ++instance ) {
+            definitions.push_back({ /* index_ */ idx, /* id_ */ id + '-' + std::to_string(instance), /* pool_ */ id, /* instance_ */ instance });
+        }
+    }
+    
+    if ( true == IsErrorSetUnsafe() ) {
+        return false;
+    }
+    
+    //
+    // ... load processes to launch and monitor ...
+    //
+   
+    std::vector<const ::sys::Process::Info> vector;
+    std::map<std::string, std::string>      listening; // ... process id, by socket name ...
+    
+    o_options.clear();
+    
+    for ( auto definition : definitions ) {
+        
+        const Json::Value& entry = children[definition.index_];
+
+        // ... per-child variables override common ones, pool instances share them ...
+        Template::Variables child_variables = common;
+        load_variables(variables[entry["id"].asString()], child_variables);
+        if ( 0 != definition.instance_ ) {
+            child_variables["@@INSTANCE@@"] = std::to_string(definition.instance_);
+        }
+        
+        const std::string id = definition.id_;
+        
+        const auto expand = [&render, &id, &child_variables] (const std::string& a_value, bool a_is_path) -> std::string {
+            return render(id, child_variables, a_value, a_is_path);
+        };
+        
+        const std::string arguments   = expand(entry.get("arguments", "").asString(), /* a_is_path */ false);
+        const std::string path        = expand(entry["path"].asString(), /* a_is_path */ true);
+        const std::string working_dir = expand(entry.get("working_dir", "").asString(), /* a_is_path */ true);
+        if ( true == IsErrorSetUnsafe() ) {
+            break;
+        }
+        
+        Options& child_options = o_options[id];
+        
+        child_options.pool_     = definition.pool_;
+        child_options.instance_ = definition.instance_;
+        
+        // ... restart policy ( optional ) ...
+        if ( false == load_restart(id, entry["restart"], child_options.restart_) ) {
+            break;
+        }
+        
+        // ... stop signal and grace period ( optional ) ...
+        if ( false == load_stop(id, entry, child_options.stop_) ) {
+            break;
+        }
+        
+        // ... readiness probe ( optional ) ...
+        child_options.ready_when_ = false;
+        
+        const Json::Value& ready_when = entry["ready_when"];
+        if ( false == ready_when.isNull() ) {
+            if ( false == ready_when.isObject() || false == load_probe(id, ready_when, expand, child_options.probe_) ) {
+                if ( false == IsErrorSetUnsafe() ) {
+                    CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                                 sys::Error::k_no_error_,
+                                                 "invalid 'ready_when' for '%s': expecting an object", id.c_str()
+                    );
+                }
+                break;
+            }
+            child_options.ready_when_ = true;
+        }
+        
+        // ... core dumps and crash loops ( optional ) ...
+        if ( false == load_crash(id, entry["crash"], child_options.crash_) ) {
+            break;
+        }
+        
+        // ... health check ( optional ) ...
+        child_options.checked_ = false;
+        
+        const Json::Value& health = entry["health"];
+        if ( false == health.isNull() ) {
+            if ( false == health.isObject() || false == load_health(id, health, expand, child_options.check_) ) {
+                if ( false == IsErrorSetUnsafe() ) {
+                    CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                                 sys::Error::k_no_error_,
+                                                 "invalid 'health' for '%s': expecting an object", id.c_str()
+                    );
+                }
+                break;
+            }
+            child_options.checked_ = true;
+        }
+        
+        // ... resource usage thresholds ( optional ) ...
+        child_options.limited_ = false;
+        
+        const Json::Value& thresholds = entry["thresholds"];
+        if ( false == thresholds.isNull() ) {
+            if ( false == load_thresholds(id, thresholds, child_options.limits_) ) {
+                break;
+            }
+            child_options.limited_ = true;
+        }
+        
+        // ... listening sockets ( optional ) ...
+        if ( false == load_listen(id, entry["listen"], expand, child_options.listen_) ) {
+            break;
+        }
+        for ( auto address : child_options.listen_ ) {
+            const std::string name = Sockets::Name(address);
+            if ( listening.end() != listening.find(name) ) {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'listen' for '%s': %s is already used by '%s'", id.c_str(), name.c_str(), listening[name].c_str()
+                );
+                break;
+            }
+            listening[name] = id;
+        }
+        if ( true == IsErrorSetUnsafe() ) {
+            break;
+        }
+
+        std::list<std::string> precedents;
+
+        const Json::Value& depends_on = entry["depends_on"];
+        if ( false == depends_on.isNull() && true == depends_on.isArray() && depends_on.size() > 0 ) {
+            for ( Json::ArrayIndex idx = 0 ; idx < depends_on.size() ; ++idx ) {
+                // ... a pool is a set of instances, none of them can be waited for ...
+                if ( o_pools.end() != o_pools.find(depends_on[idx].asString()) ) {
+                    CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                                 sys::Error::k_no_error_,
+                                                 "invalid 'depends_on' for '%s': '%s' is a pool", id.c_str(), depends_on[idx].asString().c_str()
+                    );
+                    break;
+                }
+                precedents.push_back(depends_on[idx].asString());
+            }
+            if ( true == IsErrorSetUnsafe() ) {
+                break;
+            }
+        }
+
+        // ... pool instances can't share a pid file ...
+        std::string pid_file;
+        if ( true == entry.isMember("pid_file") ) {
+            if ( 0 != definition.instance_ && o_pools[definition.pool_].max_ > 1 && std::string::npos == entry["pid_file"].asString().find("@@INSTANCE@@") ) {
+                CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
+                                             sys::Error::k_no_error_,
+                                             "invalid 'pid_file' for '%s': expecting @@INSTANCE@@ in a pool", id.c_str()
+                );
+                break;
+            }
+            pid_file = expand(entry["pid_file"].asString(), /* a_is_path */ true);
+        } else {
+            pid_file = runtime_dir + ( 0 != definition.instance_ ? id : entry["executable"].asString() ) + ".pid";
+        }
+
+        vector.push_back({
+            /* id_          */ id,
+            /* owner_       */ "",
+            /* path_        */ path,
+            /* executable_  */ entry["executable"].asString(),
+            /* arguments_   */ arguments,
+            /* user_        */ "",
+            /* group_       */ "",
+            /* working_dir_ */ working_dir,
+            /* log_dir      */ logs_dir,
+            /* pid_file_    */ pid_file,
+            /* depends_on_  */ precedents
+        });
+        
+    }
+ 
+    if ( true == IsErrorSetUnsafe() ) {
+        return false;
+    }
+    
+    // ... solve dependencies ...
+    o_list.clear();
+    sys::Process::Sort(vector, o_list);
+    
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Spawn and monitor a list of processes.
+ *
+ * @param a_list       List of processes to start.
+ * @param a_options    Readiness probe and restart policy, by process id.
+ * @param a_pools      Worker pools, by pool id.
+ * @param a_listener   A listener to be notified when process(es) list is modified.
+ * @param a_detached   True when a new thread must be started, false it will run in current thread.
+ * @param a_abort_flag External abort flag.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Watchdog::Start (const std::list<const ::sys::Process::Info>& a_list,
+                                            const std::map<std::string, casper::app::monitor::Watchdog::Options>& a_options,
+                                            const std::map<std::string, casper::app::monitor::Scaler::Pool>& a_pools,
+                                            const bool a_detached,
+                                            casper::app::monitor::Watchdog::Listener& a_listener,
+                                            bool volatile* a_abort_flag)
+{
+    const int64_t start_us = ::casper::app::Tracer::Now();
+    
+    // ... cleanup, if required ...
+    Stop();
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    listener_ptr_ = &a_listener;
+    detached_     = a_detached;
+    main_pid_     = getpid();
+    
+    // ... restart delays jitter ...
+    random_.seed(static_cast<std::minstd_rand::result_type>(std::chrono::steady_clock::now().time_since_epoch().count()));
+    
+    // ... keep track of new process(es) to spawn ...
+    ::sys::Process::List list;
+    for ( auto info : a_list ) {
+        // ... create a new process ...
+        ::sys::Process* process = new ::casper::app::monitor::Process(info);
+        // ... check if it's an executable and ensure directories are created and can be accessed ...
+        if ( false == EnsureRequirements(*process) ) {
+            // ... forget process(es) ...
+            delete process;
+            for ( auto it : list ) {
+                delete it;
+            }
+            // ... failure, unlock mutex ...
+            CASPER_APP_WATCHDOG_UNLOCK();
+            // ... done ...
+            return false;
+        }
+        // ... load previous executed pid from file ( if any ) ...
+        (void) process->LoadPIDFromFile(/* a_optional */ true);
+        // ... keep track of it ...
+        list.push_back(process);
+    }
+    
+    // ... pools start with their minimum number of instances ...
+    pools_ = a_pools;
+    for ( const auto& it : pools_ ) {
+        sizes_[it.first] = it.second.min_;
+    }
+    
+    // ... index and group by dependency level ...
+    registry_.Reset(list);
+    Group(a_options);
+    options_ = a_options;
+    
+    // ... now try to adopt or terminate all running processes, launched by this app ...
+    if ( true == adopt_ ) {
+        Adopt();
+        // ... a previous monitor might have scaled pools up, keep their adopted instances running ...
+        for ( auto process : registry_.list() ) {
+            const Options& options = options_[process->info().id_];
+            const State&   state   = states_[process->info().id_];
+            if ( true == state.adopted_ && false == state.stopping_ && options.instance_ > sizes_[options.pool_] ) {
+                sizes_[options.pool_] = options.instance_;
+            }
+        }
+        for ( const auto& it : sizes_ ) {
+            Resize(it.first, it.second);
+        }
+    } else if ( false == TerminateAll(/* a_optional */ true) ) {
+        CASPER_APP_WATCHDOG_BITE_UNSAFE();
+    }
+    
+    scaler_.Setup(pools_, sizes_);
+    
+    std::map<std::string, Health::Check>   checks;
+    std::map<std::string, Sampler::Limits> limits;
+    for ( const auto& it : options_ ) {
+        if ( true == it.second.checked_ ) {
+            checks[it.first] = it.second.check_;
+        }
+        if ( true == it.second.limited_ ) {
+            limits[it.first] = it.second.limits_;
+        }
+    }
+    checker_.Setup(checks);
+    sampler_.Limit(limits);
+    
+    CASPER_APP_WATCHDOG_UNLOCK();
+    
+    // ... install signal(s) handler(s) ...
+    // ( only used when a signal is delivered to a thread other than the loop one, children exits are watched by the reactor )
+    signal(SIGUSR2, casper::app::monitor::Watchdog::OnSignal);
+    signal(SIGTERM, casper::app::monitor::Watchdog::OnSignal);
+    
+    // .. keep track of abort flag ...
+    abort_flag_ = a_abort_flag;
+    
+    ::casper::app::Tracer::GetInstance().Complete("Start", start_us, ::casper::app::Tracer::Now(), ::casper::app::Tracer::ThreadID(), "");
+    
+    // ... start a new thread? ....
+    if ( true == a_detached ) {
+        // ... start a new thread ....
+        thread_ = new std::thread(&casper::app::monitor::Watchdog::Loop, this);
+        thread_->detach();
+        // ... wait for thread to be running ...
+        thread_cv_.Wait();
+    } else {
+        Loop();
+    }
+    
+    // ... we're done ...
+    return true;
+}
+
+/**
+ * @brief Stop monitoring processes.
+ */
+void casper::app::monitor::Watchdog::Stop ()
+{
+    // ... first release thread ...
+    if ( nullptr != thread_ ) {
+        delete thread_;
+        thread_ = nullptr;
+    }
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    // ... now try to terminate all running processes, launched by this app ...
+    if ( false == TerminateAll(/* a_optional */ true) ) {
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+    }
+    
+    // ... then release them ...
+    for ( auto it : registry_.list() ) {
+        delete it;
+    }
+    registry_.Clear();
+    for ( auto it : states_ ) {
+        if ( -1 != it.second.exec_fd_ ) {
+            close(it.second.exec_fd_);
+        }
+        if ( nullptr != it.second.probe_ ) {
+            delete it.second.probe_;
+        }
+    }
+    states_.clear();
+    options_.clear();
+    pools_.clear();
+    sizes_.clear();
+    last_error_.Reset();
+    
+    // ... all children are gone, connections can now be refused ...
+    sockets_.Close();
+    
+    // ... forget all other data ...
+    listener_ptr_ = nullptr;
+    detached_     = false;
+    main_pid_     = 0;
+    
+    CASPER_APP_WATCHDOG_UNLOCK();
+}
+
+/**
+ * @brief Quit loop.
+ */
+void casper::app::monitor::Watchdog::Quit ()
+{
+    Stop();
+}
+
+/**
+ * @brief Quit loop.
+ */
+void casper::app::monitor::Watchdog::Refresh ()
+{
+    if ( true == detached_ ) {
+        // ... signal parent ...
+        kill(getppid(), SIGUSR2);
+    } else {
+        // ... just call signal handler ...
+        casper::app::monitor::Watchdog::OnSignal(SIGUSR2);
+    }
+}
+
+/**
+ * @brief Read configuration file again and apply it's changes, only changed processes ( and their dependants ) are restarted.
+ *
+ * @note Thread safe, changes are applied by the loop thread.
+ */
+void casper::app::monitor::Watchdog::Reload ()
+{
+    reload_ = true;
+    reactor_.Wake();
+}
+
+/**
+ * @brief Submit a command about a single process.
+ *
+ * @param a_command     What to do.
+ * @param a_id          Process id.
+ * @param a_signal_no   Signal number, only used by \link Command::Signal \link.
+ * @param a_acknowledge Called once the command was executed, or when loop exited before executing it.
+ *
+ * @note Thread safe, commands are executed in order by the loop thread.
+ */
+void casper::app::monitor::Watchdog::Submit (const casper::app::monitor::Watchdog::Command a_command, const std::string& a_id, const int a_signal_no,
+                                             const casper::app::monitor::Watchdog::Acknowledge& a_acknowledge)
+{
+    {
+        // ... not the loop thread, lock accounting is not used ...
+        std::lock_guard<std::mutex> lock(mutex_);
+        orders_.push_back({ /* command_ */ a_command, /* id_ */ a_id, /* signal_ */ a_signal_no, /* acknowledge_ */ a_acknowledge });
+    }
+    order_ = true;
+    reactor_.Wake();
+}
+
+/**
+ * @brief Copy most recent output lines of a process.
+ *
+ * @param a_id     Process id.
+ * @param a_stderr True for stderr, false for stdout.
+ * @param a_lines  Maximum number of lines.
+ * @param o_lines  Lines, oldest first.
+ *
+ * @return True on success, false when process is unknown or it was never spawned.
+ *
+ * @note Thread safe.
+ */
+bool casper::app::monitor::Watchdog::Tail (const std::string& a_id, const bool a_stderr, const size_t a_lines, std::vector<std::string>& o_lines)
+{
+    std::string uri;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const ::sys::Process* process = registry_.Find(a_id);
+        if ( nullptr == process ) {
+            o_lines.clear();
+            return false;
+        }
+        uri = process->info().log_dir_ + a_id + ( true == a_stderr ? "-stderr.log" : "-stdout.log" );
+    }
+    return collector_.Tail(uri, a_lines, o_lines);
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Thread function where the 'loop' will run.
+ */
+void casper::app::monitor::Watchdog::Loop ()
+{
+    ::casper::app::Tracer::Span span("Loop");
+    
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "%s", "Starting...");
+
+    // ... signal thread is running ...
+    thread_cv_.Wake();
+    
+#ifdef __APPLE__
+    if ( true == detached_ ) {
+        pthread_setname_np("Monitor Watchdog");
+    } else {
+        pthread_setname_np("Monitor");
+    }
+#else
+    if ( true == detached_ ) {
+        pthread_setname_np(pthread_self(), "Watchdog");
+    } else {
+        pthread_setname_np(pthread_self(), "Monitor");
+    }
+#endif
+    
+    const int64_t setup_us = ::casper::app::Tracer::Now();
+    
+    CASPER_APP_WATCHDOG_LOCK();
+
+    // ... control signals will be delivered by the reactor ( blocked in this thread ) ...
+    if ( false == reactor_.Open({ SIGUSR2, SIGTERM }) ) {
+        last_error_ = reactor_.error();
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    }
+
+    // ... first try to terminate all running processes, launched by this app, unless they were already adopted ...
+    if ( false == adopt_ && false == TerminateAll(/* a_optional */ true) ) {
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+    }
+    
+    // ... start collecting resource usage ( control signals are already blocked, sampler thread inherits mask ) ...
+    // ( crossed thresholds are published by this thread )
+    sampler_.Start([this] () {
+        alert_ = true;
+        reactor_.Wake();
+    }, [this] (const std::string& a_id, const Sampler::Sample& a_sample) {
+        board_.Measure(a_id, a_sample.timestamp_, a_sample.cpu_, a_sample.rss_, a_sample.fds_, a_sample.threads_, a_sample.processes_);
+    });
+    
+    // ... and children output ...
+    if ( false == collector_.Start() ) {
+        last_error_ = collector_.error();
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    }
+    
+    // ... and children crashes ...
+    (void)crashes_.Start();
+    
+    // ... and worker pools load, new sizes are applied by this thread ...
+    scaler_.Start([this] () {
+        scale_ = true;
+        reactor_.Wake();
+    });
+    
+    // ... and children health, unhealthy children are stopped by this thread ...
+    if ( false == checker_.Start([this] () {
+        heal_ = true;
+        reactor_.Wake();
+    }) ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_, errno, "%s", "unable to start health checks");
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    }
+    
+    // ... adopted processes are not our children, only their exit can be watched ...
+    for ( auto process : registry_.list() ) {
+        State& state = states_[process->info().id_];
+        if ( false == state.adopted_ ) {
+            continue;
+        }
+        if ( false == reactor_.Watch(process->pid()) ) {
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "%s ( %d ) is gone, it will be spawned...",
+                                 process->info().id_.c_str(), process->pid()
+            );
+            state.adopted_  = false;
+            state.stopping_ = false;
+            (*process)      = static_cast<pid_t>(0);
+            continue;
+        }
+        registry_.Index(process);
+        // ... no longer matching it's definition: killed if it does not stop in time, it's exit spawns it's replacement ...
+        if ( true == state.stopping_ ) {
+            state.spawned_ = true;
+            Retire(*process, state);
+            continue;
+        }
+        sampler_.Track(process->info().id_, process->pid());
+        checker_.Track(process->info().id_);
+        // ... it was ready for previous monitor ...
+        state.spawned_ = true;
+        state.ready_   = true;
+        Post(*process, state);
+    }
+    
+    // ... listener applies events on top of a full list, adopted processes included ...
+    reactor_.Raise(SIGUSR2);
+    
+    // ... and configuration file changes ( optional ) ...
+    if ( true == watch_.enabled_ ) {
+        const std::string        config_file_uri = config_["directories"]["config"].asString() + "monitor.json";
+        std::vector<std::string> uris            = { config_file_uri };
+        // ... a symbolic link target can also be modified in place ...
+        char target[PATH_MAX];
+        if ( nullptr != realpath(config_file_uri.c_str(), target) && 0 != config_file_uri.compare(target) ) {
+            uris.push_back(target);
+        }
+        if ( false == watcher_.Open(uris) || false == reactor_.Add(watcher_.fd(), [this] (const int /* a_fd */) {
+            if ( false == watcher_.Changed() ) {
+                return;
+            }
+            // ... editors might write it more than once, wait for it to settle ...
+            if ( 0 != watch_timer_ ) {
+                reactor_.Cancel(watch_timer_);
+            }
+            watch_timer_ = reactor_.Schedule(watch_.debounce_ms_, [this] () {
+                watch_timer_ = 0;
+                reload_      = true;
+            });
+        }) ) {
+            // ... not critical, reload is still available on request ...
+            last_error_ = ( -1 == watcher_.fd() ? watcher_.error() : reactor_.error() );
+            CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+            watcher_.Close();
+        } else {
+            CASPER_APP_DEBUG_LOG("status", "Watching %s for changes...", config_file_uri.c_str());
+        }
+    }
+    
+    // ... now spawn all processes without precedents, dependants will be spawned as soon as their precedents are ready ...
+    startup_tp_  = std::chrono::steady_clock::now();
+    spawn_stats_ = { 0, 0, 0 };
+    if ( false == Launch() ) {
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    }
+
+    CASPER_APP_WATCHDOG_UNLOCK();
+    
+    ::casper::app::Tracer::GetInstance().Complete("Setup", setup_us, ::casper::app::Tracer::Now(), ::casper::app::Tracer::ThreadID(), "");
+
+    typedef struct  {
+        pid_t                 pid_;
+        const ::sys::Process* process_;
+        std::string           reason_;
+        bool                  terminated_;
+        int                   status_;
+        bool                  signalled_;
+        int                   signal_;
+    } Child;
+    
+    std::vector<Reactor::Exit> exits;
+    
+    // ... monitor children ...
+    while ( false == (*abort_flag_) ) {
+
+        // ... children that exited while a reload was being applied are handled first ...
+        if ( 0 == exits.size() ) {
+            
+            // ... wait for children exit and / or control signals, without any timeout ...
+            const bool waited = reactor_.Wait(/* a_timeout_ms */ -1,
+                                              /* a_exit_callback */
+                                              [&exits] (const Reactor::Exit& a_exit) {
+                                                  exits.push_back(a_exit);
+                                              },
+                                              /* a_signal_callback */
+                                              [this] (const int a_signal_no) {
+                                                  Notify(a_signal_no);
+                                              }
+            );
+            
+            if ( false == waited ) {
+                CASPER_APP_WATCHDOG_LOCK();
+                last_error_ = reactor_.error();
+                CASPER_APP_WATCHDOG_UNLOCK();
+                break;
+            }
+            
+        }
+        
+        // ... every child that exited was already reaped ...
+        for ( auto exit : exits ) {
+            
+            Child child = { exit.pid_, nullptr, "", false, exit.status_, false, INT_MIN };
+            
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "%s", "Received signal...");
+            
+            CASPER_APP_WATCHDOG_LOCK();
+
+            child.process_ = registry_.Find(child.pid_);
+     
+            if ( nullptr == child.process_ ) {
+                CASPER_APP_MONITOR_SET_ERROR(child.process_, last_error_,
+                                             ::sys::Error::k_no_error_,
+                                             "an error occurred while monitoring child with pid %d: A signal was sent to a child that no longer exists?", child.pid_
+                );
+                CASPER_APP_WATCHDOG_UNLOCK();
+                break;
+            }
+
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "... for child %s ( %d )...",
+                                 child.process_->info().id_.c_str(), child.pid_
+            );
+            
+            // ... check child status ...
+            if ( false == exit.known_ ) {
+                // ... adopted, it's not our child ...
+                child.terminated_ = true;
+                child.status_     = EXIT_FAILURE;
+                child.reason_     = "exited, exit status is unknown ( adopted )";
+            } else if ( true == WIFEXITED(child.status_) ) {
+                // ... child terminated normally ...
+                child.terminated_ = true;
+                // ... grab exit status of the child ...
+                child.status_     = WEXITSTATUS(child.status_);
+                child.reason_     = "terminated normally";
+            } else if ( true == WIFSIGNALED(child.status_) ) {
+                // ... child process was signaled by a signal ...
+                child.signalled_ = true;
+                //  ... grab number of the signal that caused the child process to terminate ...
+                child.signal_    = WTERMSIG(child.status_);
+                child.reason_    = "received signal " + std::to_string(child.signal_);
+                if ( 0 != WCOREDUMP(child.status_) ) {
+                    // ... child produced a core dump ...
+                    child.reason_ += " and produced a core dump";
+                } else if ( SIGTRAP == child.signal_ ) {
+                    child.signalled_ = false;
+                }
+            }
+            
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "... %s...",
+                                 child.reason_.c_str()
+            );
+            
+            State& state = states_[child.process_->info().id_];
+            
+            // ... keep kernel accounting ...
+            Record(*child.process_, state, exit, child.reason_);
+            
+            // ... listener applies it to it's copy of the list ...
+            Publish(Change::Exited, child.process_->info().id_, child.pid_, child.reason_);
+            
+            // ... crashed, and not while being stopped by us?
+            const bool dumped   = ( true == child.signalled_ && 0 != WCOREDUMP(exit.status_) );
+            const bool expected = ( ( true == state.stopping_ || true == state.unhealthy_ || true == state.parked_ || true == state.halted_ )
+                                      && ( state.stop_.signal_ == child.signal_ || SIGKILL == child.signal_ ) );
+            if ( true == child.signalled_ && false == expected && ( true == dumped ||
+                    SIGSEGV == child.signal_ || SIGBUS == child.signal_ || SIGILL == child.signal_ ||
+                    SIGFPE == child.signal_ || SIGABRT == child.signal_ || SIGSYS == child.signal_ ) ) {
+                OnCrash(*child.process_, state, exit, child.signal_);
+            }
+            
+            // ... restart it, or give up ( error will be set ) ...
+            (void)OnExit(*const_cast<::sys::Process*>(child.process_), states_[child.process_->info().id_], child.reason_,
+                         /* a_failure */ ( false == child.terminated_ || 0 != child.status_ ),
+                         /* a_fatal   */ ( true == child.terminated_ || ( true == child.signalled_ && ( SIGTERM == child.signal_ || SIGQUIT == child.signal_ || SIGKILL == child.signal_ ) ) )
+            );
+            Post(*child.process_, state);
+
+            CASPER_APP_WATCHDOG_UNLOCK();
+            
+            if ( true == IsErrorSet() ) {
+                break;
+            }
+            
+        }
+        
+        exits.clear();
+        
+        if ( true == IsErrorSet() ) {
+            break;
+        }
+        
+        // ... configuration changed?
+        if ( true == reload_.exchange(false) && false == (*abort_flag_) ) {
+            Apply(exits);
+        }
+        
+        // ... worker pools load changed?
+        if ( true == scale_.exchange(false) && false == (*abort_flag_) ) {
+            Scale();
+        }
+        
+        // ... children failed their health checks?
+        if ( true == heal_.exchange(false) && false == (*abort_flag_) ) {
+            Heal();
+        }
+        
+        // ... children resource usage crossed their thresholds?
+        if ( true == alert_.exchange(false) && false == (*abort_flag_) ) {
+            Alert();
+        }
+        
+        // ... commands submitted?
+        if ( true == order_.exchange(false) && false == (*abort_flag_) ) {
+            Execute();
+        }
+
+    }
+
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "%s", "Cleanup...");
+    
+    // ... uninstall signal(s) handler(s) ...
+    signal(SIGUSR2, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+
+    // ... stop watching configuration file ...
+    if ( -1 != watcher_.fd() ) {
+        reactor_.Remove(watcher_.fd());
+        watcher_.Close();
+    }
+    watch_timer_ = 0;
+    
+    // ... no more pool sizes changes ...
+    scaler_.Stop();
+    scale_ = false;
+    
+    // ... no more health checks, statistics are kept ...
+    checker_.Stop();
+    heal_ = false;
+    
+    // ... stop all children, dependants first ...
+    Shutdown();
+
+    // ... stop collecting resource usage, samples are kept ...
+    sampler_.Stop();
+    alert_ = false;
+    
+    // ... commands not executed yet won't be ...
+    std::deque<Order> orders;
+    CASPER_APP_WATCHDOG_LOCK();
+    orders.swap(orders_);
+    order_ = false;
+    CASPER_APP_WATCHDOG_UNLOCK();
+    for ( const auto& order : orders ) {
+        order.acknowledge_(Outcome::Refused, "monitor is shutting down");
+    }
+
+    // ... write all collected output ...
+    collector_.Stop();
+    
+    // ... nothing is running or will be restarted, readers can tell board is no longer updated ...
+    CASPER_APP_WATCHDOG_LOCK();
+    for ( auto process : registry_.list() ) {
+        const State& state = states_[process->info().id_];
+        board_.Set(process->info().id_, 0, ::casper::app::Board::State::Stopped, state.restarted_, state.started_);
+    }
+    CASPER_APP_WATCHDOG_UNLOCK();
+    board_.Close();
+    
+    // ... and collect pending cores, reports are kept ...
+    crashes_.Stop();
+
+    // ... release reactor and restore signal mask ...
+    reactor_.Close();
+
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "%s", "Shutting down...");
+}
+
+/**
+ * @brief Group processes by dependency level, a new state is created for each process without one.
+ *
+ * @param a_options Readiness probe, restart policy and stop signal, by process id.
+ */
+void casper::app::monitor::Watchdog::Group (const std::map<std::string, casper::app::monitor::Watchdog::Options>& a_options)
+{
+    // ... list is already sorted, so precedents are known before their dependants ...
+    for ( auto process : registry_.list() ) {
+        size_t level = 0;
+        for ( const auto& precedent : process->info().depends_on_ ) {
+            const auto it = states_.find(precedent);
+            if ( states_.end() != it && it->second.level_ + 1 > level ) {
+                level = it->second.level_ + 1;
+            }
+        }
+        const auto it = states_.find(process->info().id_);
+        if ( states_.end() != it ) {
+            // ... kept process, precedents might have moved ...
+            it->second.level_ = level;
+        } else {
+            const std::string id      = process->info().id_;
+            const Options&    options = a_options.find(id)->second;
+            states_[id] = {
+                /* level_    */ level,
+                /* spawned_  */ false,
+                /* ready_    */ false,
+                /* held_     */ false,
+                /* stopping_ */ false,
+                /* adopted_  */ false,
+                /* exec_fd_  */ -1,
+                /* probe_    */ ( true == options.ready_when_ ? new Probe(id, options.probe_, reactor_, [this, id] () { OnProbe(id); }) : nullptr ),
+                /* restart_  */ options.restart_,
+                /* restarts_ */ {},
+                /* timer_    */ 0,
+                /* stop_     */ options.stop_,
+                /* parked_    */ ( 0 != options.instance_ && options.instance_ > sizes_[options.pool_] ),
+                /* trace_us_    */ 0,
+                /* unhealthy_   */ false,
+                /* crash_       */ options.crash_,
+                /* crashed_     */ {},
+                /* quarantined_ */ false,
+                /* started_     */ 0,
+                /* restarted_   */ 0,
+                /* halted_      */ false
+            };
+        }
+        registry_.Place(process, level);
+    }
+    
+    // ... publish new layout, kept processes keep their board entries ...
+    std::vector<std::string> ids;
+    for ( auto process : registry_.list() ) {
+        ids.push_back(process->info().id_);
+    }
+    board_.Reset(ids);
+    for ( auto process : registry_.list() ) {
+        Post(*process, states_[process->info().id_]);
+    }
+}
+
+/**
+ * @brief Apply configuration file changes.
+ *
+ * @param o_exits Children exits reaped while changed processes were being stopped, to be handled by the loop.
+ *
+ * @note Processes which definition changed or that were removed are stopped, dependants first, along with all
+ *       processes that directly or indirectly depend on them. Unchanged processes keep running. Global settings
+ *       ( metrics, spawn, logs and reload ) and startup variables are not reloaded.
+ *       An invalid configuration file is reported and ignored.
+ */
+void casper::app::monitor::Watchdog::Apply (std::vector<casper::app::monitor::Reactor::Exit>& o_exits)
+{
+    ::casper::app::Tracer::Span span("Apply");
+    
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "%s", "Reloading configuration...");
+    
+    Json::Value                           file;
+    std::list<const ::sys::Process::Info> sorted;
+    std::map<std::string, Options>        options;
+    std::map<std::string, Scaler::Pool>   pools;
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    // ... on error, keep running with current configuration ...
+    const auto reject = [this] () {
+        if ( nullptr != listener_ptr_ ) {
+            listener_ptr_->OnError(last_error_, /* a_fatal */ false);
+        }
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+    };
+    
+    if ( false == Load(config_, file, sorted, options, pools) ) {
+        reject();
+        CASPER_APP_WATCHDOG_UNLOCK();
+        return;
+    }
+    
+    // ... processes to stop: changed or removed ...
+    std::set<std::string> down;
+    size_t                added   = 0;
+    size_t                changed = 0;
+    size_t                removed = 0;
+    for ( auto info : sorted ) {
+        const ::sys::Process* process = registry_.Find(info.id_);
+        if ( nullptr == process ) {
+            added++;
+        } else if ( false == Equals(process->info(), info) || false == Equals(options_[info.id_], options[info.id_]) ) {
+            down.insert(info.id_);
+            changed++;
+        }
+    }
+    for ( auto process : registry_.list() ) {
+        if ( options.end() == options.find(process->info().id_) ) {
+            down.insert(process->info().id_);
+            removed++;
+        }
+    }
+    
+    // ... and their dependants ( list is sorted, so dependants are always after their precedents ) ...
+    for ( auto process : registry_.list() ) {
+        for ( auto precedent : process->info().depends_on_ ) {
+            if ( down.end() != down.find(precedent) ) {
+                down.insert(process->info().id_);
+                break;
+            }
+        }
+    }
+    
+    // ... pools keep their current size, within new limits, new pools start with their minimum number of instances ...
+    std::map<std::string, size_t> sizes;
+    for ( const auto& it : pools ) {
+        const auto size = sizes_.find(it.first);
+        sizes[it.first] = ( sizes_.end() == size ? it.second.min_ : std::min(std::max(size->second, it.second.min_), it.second.max_) );
+    }
+    pools_ = pools;
+    sizes_ = sizes;
+    scaler_.Setup(pools_, sizes_);
+    
+    // ... changed processes are only checked again when their new run is ready, thresholds apply from next sample ...
+    std::map<std::string, Health::Check>   checks;
+    std::map<std::string, Sampler::Limits> limits;
+    for ( const auto& it : options ) {
+        if ( true == it.second.checked_ ) {
+            checks[it.first] = it.second.check_;
+        }
+        if ( true == it.second.limited_ ) {
+            limits[it.first] = it.second.limits_;
+        }
+    }
+    checker_.Setup(checks);
+    sampler_.Limit(limits);
+    
+    if ( 0 == added && 0 == down.size() ) {
+        // ... log ...
+        CASPER_APP_DEBUG_LOG("status", "%s", "Configuration reloaded, nothing changed...");
+        // ... except, maybe, pools limits ...
+        for ( const auto& it : sizes_ ) {
+            Resize(it.first, it.second);
+        }
+        if ( false == Launch() ) {
+            CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+        }
+        CASPER_APP_WATCHDOG_UNLOCK();
+        return;
+    }
+    
+    // ... new processes must be valid before anything is stopped ...
+    std::map<std::string, ::sys::Process*> created;
+    for ( auto info : sorted ) {
+        if ( nullptr != registry_.Find(info.id_) && down.end() == down.find(info.id_) ) {
+            continue;
+        }
+        ::sys::Process* process = new ::casper::app::monitor::Process(info);
+        if ( false == EnsureRequirements(*process) ) {
+            delete process;
+            for ( auto it : created ) {
+                delete it.second;
+            }
+            reject();
+            CASPER_APP_WATCHDOG_UNLOCK();
+            return;
+        }
+        created[info.id_] = process;
+    }
+    
+    CASPER_APP_WATCHDOG_UNLOCK();
+    
+    // ... stop changed and removed processes, dependants first ...
+    if ( down.size() > 0 ) {
+        Shutdown(&down, &o_exits);
+    }
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    // ... replace them ...
+    ::sys::Process::List list;
+    for ( auto info : sorted ) {
+        const auto it = created.find(info.id_);
+        list.push_back(created.end() != it ? it->second : registry_.Find(info.id_));
+    }
+    for ( auto id : down ) {
+        State& state = states_[id];
+        if ( -1 != state.exec_fd_ ) {
+            reactor_.Remove(state.exec_fd_);
+            close(state.exec_fd_);
+        }
+        if ( 0 != state.timer_ ) {
+            reactor_.Cancel(state.timer_);
+        }
+        if ( nullptr != state.probe_ ) {
+            delete state.probe_;
+        }
+        states_.erase(id);
+        // ... removed children samples are released, changed ones keep their history ...
+        if ( options.end() == options.find(id) ) {
+            sampler_.Forget(id);
+        } else {
+            sampler_.Untrack(id);
+        }
+        ::sys::Process* process = registry_.Find(id);
+        registry_.Unindex(process);
+        delete process;
+    }
+    
+    // ... reindex and regroup, new processes get a fresh state ...
+    registry_.Reset(list);
+    Group(options);
+    options_ = options;
+    
+    // ... kept pool instances might now be above or below their pool size ...
+    for ( const auto& it : sizes_ ) {
+        Resize(it.first, it.second);
+    }
+    
+    // ... sockets still declared are kept open ( even for replaced processes ), others are closed ...
+    std::set<std::string> listening;
+    for ( auto it : options_ ) {
+        for ( auto address : it.second.listen_ ) {
+            listening.insert(Sockets::Name(address));
+        }
+    }
+    sockets_.Retain(listening);
+    
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "Configuration reloaded, %zu added, %zu changed, %zu removed, %zu dependant(s) restarted, %zu kept...",
+                         added, changed, removed, down.size() - changed - removed, registry_.list().size() - created.size()
+    );
+    
+    // ... spawn new processes, as soon as their precedents are ready ...
+    if ( false == Launch() ) {
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    }
+    
+    CASPER_APP_WATCHDOG_UNLOCK();
+    
+    Notify(SIGUSR2);
+}
+
+/**
+ * @brief Apply worker pools sizes, as decided by the scaler.
+ */
+void casper::app::monitor::Watchdog::Scale ()
+{
+    std::map<std::string, size_t> sizes;
+    scaler_.Sizes(sizes);
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    size_t resized = 0;
+    for ( const auto& it : sizes ) {
+        const auto current = sizes_.find(it.first);
+        // ... removed by a reload, or unchanged ...
+        if ( sizes_.end() == current || current->second == it.second ) {
+            continue;
+        }
+        // ... log ...
+        CASPER_APP_DEBUG_LOG("status", "Scaling %s from %zu to %zu instance(s)...",
+                             it.first.c_str(), current->second, it.second
+        );
+        Resize(it.first, it.second);
+        resized++;
+    }
+    
+    // ... spawn new instances ...
+    if ( resized > 0 && false == Launch() ) {
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    }
+    
+    CASPER_APP_WATCHDOG_UNLOCK();
+}
+
+/**
+ * @brief Park pool instances above a new pool size, stopping them if running, and release the others.
+ *
+ * @param a_pool Pool id.
+ * @param a_size Number of instances that should be running.
+ *
+ * @note Released instances are only spawned by \link Launch \link.
+ */
+void casper::app::monitor::Watchdog::Resize (const std::string& a_pool, const size_t a_size)
+{
+    sizes_[a_pool] = a_size;
+    
+    for ( auto process : registry_.list() ) {
+        
+        const Options& options = options_[process->info().id_];
+        if ( 0 != options.pool_.compare(a_pool) ) {
+            continue;
+        }
+        
+        State& state = states_[process->info().id_];
+        
+        if ( options.instance_ <= a_size ) {
+            if ( true == state.parked_ ) {
+                // ... a fresh start, previous restarts are forgotten ...
+                state.parked_ = false;
+                state.held_   = false;
+                state.restarts_.clear();
+                Post(*process, state);
+            }
+            continue;
+        }
+        
+        if ( true == state.parked_ ) {
+            continue;
+        }
+        state.parked_ = true;
+        
+        // ... no more probes or restarts ...
+        if ( 0 != state.timer_ ) {
+            reactor_.Cancel(state.timer_);
+            state.timer_ = 0;
+        }
+        Post(*process, state);
+        
+        if ( false == state.spawned_ || 0 == process->pid() || true == state.stopping_ ) {
+            continue;
+        }
+        
+        const std::string id = process->info().id_;
+        
+        // ... log ...
+        CASPER_APP_DEBUG_LOG("status", "Stopping %s ( %d ) with signal %d, %s was scaled down...",
+                             id.c_str(), process->pid(), state.stop_.signal_, a_pool.c_str()
+        );
+        
+        state.stopping_ = true;
+        Retire(*process, state);
+    }
+}
+
+/**
+ * @brief Stop children that failed their health checks, their exit is handled according to their restart policy.
+ */
+void casper::app::monitor::Watchdog::Heal ()
+{
+    std::map<std::string, std::string> reasons;
+    checker_.Unhealthy(reasons);
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    for ( const auto& it : reasons ) {
+        
+        ::sys::Process* process = registry_.Find(it.first);
+        const auto      state   = states_.find(it.first);
+        // ... exited, or already being stopped, meanwhile ...
+        if ( nullptr == process || states_.end() == state || 0 == process->pid() || false == state->second.ready_
+            || true == state->second.stopping_ || true == state->second.unhealthy_ || true == state->second.halted_ ) {
+            continue;
+        }
+        
+        // ... log ...
+        CASPER_APP_DEBUG_LOG("status", "Stopping %s ( %d ) with signal %d, %s...",
+                             it.first.c_str(), process->pid(), state->second.stop_.signal_, it.second.c_str()
+        );
+        
+        state->second.unhealthy_ = true;
+        Retire(*process, state->second);
+    }
+    
+    CASPER_APP_WATCHDOG_UNLOCK();
+}
+
+/**
+ * @brief Publish resource usage thresholds crossed by children, nothing else is done about them.
+ */
+void casper::app::monitor::Watchdog::Alert ()
+{
+    std::vector<Sampler::Crossing> crossings;
+    sampler_.Crossed(crossings);
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    for ( const auto& crossing : crossings ) {
+        
+        ::sys::Process* process = registry_.Find(crossing.id_);
+        // ... exited, or already restarted, meanwhile ...
+        if ( nullptr == process || crossing.pid_ != process->pid() ) {
+            continue;
+        }
+        
+        char detail[128];
+        (void)snprintf(detail, sizeof(detail), "%s %s %.0f: %.0f",
+                       Sampler::Name(crossing.metric_), ( true == crossing.above_ ? "above" : "below" ), crossing.limit_, crossing.value_
+        );
+        
+        // ... log ...
+        CASPER_APP_DEBUG_LOG("status", "%s ( %d ) %s...",
+                             crossing.id_.c_str(), crossing.pid_, detail
+        );
+        
+        Publish(Change::Threshold, crossing.id_, crossing.pid_, detail);
+    }
+    
+    CASPER_APP_WATCHDOG_UNLOCK();
+}
+
+/**
+ * @brief Execute submitted commands, in order, they are acknowledged once all of them were executed.
+ */
+void casper::app::monitor::Watchdog::Execute ()
+{
+    typedef struct {
+        Acknowledge acknowledge_;
+        Outcome     outcome_;
+        std::string detail_;
+    } Acknowledgement;
+    
+    std::deque<Order>            orders;
+    std::vector<Acknowledgement> acknowledgements;
+    bool                         launch = false;
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    orders.swap(orders_);
+    for ( const auto& order : orders ) {
+        std::string   detail;
+        const Outcome outcome = Obey(order, launch, detail);
+        acknowledgements.push_back({ order.acknowledge_, outcome, detail });
+    }
+    
+    // ... held processes were released, spawn them as soon as their precedents are ready ...
+    if ( true == launch && false == Launch() ) {
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    }
+    
+    CASPER_APP_WATCHDOG_UNLOCK();
+    
+    // ... acknowledgements are sent without mutex locked ...
+    for ( const auto& acknowledgement : acknowledgements ) {
+        acknowledgement.acknowledge_(acknowledgement.outcome_, acknowledgement.detail_);
+    }
+}
+
+/**
+ * @brief Execute a single command.
+ *
+ * @param a_order  Command and target process.
+ * @param o_launch Set to true when a held process was released, \link Launch \link must be called.
+ * @param o_detail What was done, or why it was not.
+ *
+ * @return Outcome.
+ *
+ * @note Mutex must be locked.
+ */
+casper::app::monitor::Watchdog::Outcome casper::app::monitor::Watchdog::Obey (const casper::app::monitor::Watchdog::Order& a_order,
+                                                                              bool& o_launch, std::string& o_detail)
+{
+    ::sys::Process* process = registry_.Find(a_order.id_);
+    const auto      it      = states_.find(a_order.id_);
+    if ( nullptr == process || states_.end() == it ) {
+        o_detail = "unknown process";
+        return Outcome::Unknown;
+    }
+    
+    State&      state   = it->second;
+    const pid_t pid     = process->pid();
+    const bool  running = ( true == state.spawned_ && 0 != pid );
+    
+    switch (a_order.command_) {
+            
+        case Command::Signal:
+        {
+            if ( false == running ) {
+                o_detail = "not running";
+                return Outcome::Refused;
+            }
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "Sending signal %d to %s ( %d ), on request...",
+                                 a_order.signal_, a_order.id_.c_str(), pid
+            );
+            if ( false == process->Signal(a_order.signal_, /* a_optional */ false) ) {
+                o_detail = process->error().message();
+                return Outcome::Failed;
+            }
+            o_detail = "signal " + std::to_string(a_order.signal_) + " sent to " + std::to_string(pid);
+            return Outcome::Done;
+        }
+            
+        case Command::Stop:
+        {
+            if ( true == state.halted_ ) {
+                o_detail = ( true == running ? "already being stopped" : "already stopped" );
+                return Outcome::Done;
+            }
+            state.halted_ = true;
+            if ( true == running ) {
+                // ... stopping for some other reason, it's exit will keep it stopped ...
+                if ( false == state.stopping_ && false == state.unhealthy_ ) {
+                    // ... log ...
+                    CASPER_APP_DEBUG_LOG("status", "Stopping %s ( %d ) with signal %d, on request...",
+                                         a_order.id_.c_str(), pid, state.stop_.signal_
+                    );
+                    Retire(*process, state);
+                } else {
+                    Post(*process, state);
+                }
+                o_detail = "stopping " + std::to_string(pid);
+                return Outcome::Done;
+            }
+            // ... no restart, if one was pending ...
+            if ( 0 != state.timer_ ) {
+                reactor_.Cancel(state.timer_);
+                state.timer_ = 0;
+            }
+            state.held_ = true;
+            Post(*process, state);
+            o_detail = "stopped";
+            return Outcome::Done;
+        }
+            
+        case Command::Restart:
+        default:
+        {
+            if ( true == state.parked_ ) {
+                o_detail = "parked, it's pool was scaled down";
+                return Outcome::Refused;
+            }
+            if ( true == running ) {
+                if ( true == state.stopping_ || true == state.unhealthy_ ) {
+                    o_detail = "already being stopped";
+                    return Outcome::Refused;
+                }
+                // ... being stopped on request, already signalled ...
+                if ( true == state.halted_ ) {
+                    state.halted_   = false;
+                    state.stopping_ = true;
+                    Post(*process, state);
+                    StopDependants(a_order.id_);
+                    o_detail = "stopping " + std::to_string(pid);
+                    return Outcome::Done;
+                }
+                // ... log ...
+                CASPER_APP_DEBUG_LOG("status", "Restarting %s ( %d ) with signal %d, on request...",
+                                     a_order.id_.c_str(), pid, state.stop_.signal_
+                );
+                // ... it's exit is expected, it will be spawned as soon as it's precedents are ready ...
+                state.halted_   = false;
+                state.stopping_ = true;
+                Retire(*process, state);
+                // ... dependants must be restarted too ...
+                StopDependants(a_order.id_);
+                o_detail = "stopping " + std::to_string(pid);
+                return Outcome::Done;
+            }
+            // ... a fresh start: pending restart, quarantine and previous restarts are forgotten ...
+            if ( 0 != state.timer_ ) {
+                reactor_.Cancel(state.timer_);
+                state.timer_ = 0;
+            }
+            state.halted_      = false;
+            state.held_        = false;
+            state.quarantined_ = false;
+            state.crashed_.clear();
+            state.restarts_.clear();
+            Post(*process, state);
+            o_launch = true;
+            o_detail = "spawning, as soon as it's precedents are ready";
+            return Outcome::Done;
+        }
+    }
+}
+
+/**
+ * @brief Send a process it's stop signal and kill it if it's still running when it's grace period expires.
+ *
+ * @param a_process The process to stop.
+ * @param a_state   It's state.
+ *
+ * @note It's exit cancels the kill timer.
+ */
+void casper::app::monitor::Watchdog::Retire (::sys::Process& a_process, casper::app::monitor::Watchdog::State& a_state)
+{
+    if ( 0 != a_state.timer_ ) {
+        reactor_.Cancel(a_state.timer_);
+        a_state.timer_ = 0;
+    }
+    
+    if ( false == a_process.Signal(a_state.stop_.signal_, /* a_optional */ true) ) {
+        last_error_ = a_process.error();
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+    }
+    
+    Post(a_process, a_state);
+    
+    const std::string id         = a_process.info().id_;
+    const int         timeout_ms = a_state.stop_.timeout_ms_;
+    a_state.timer_ = reactor_.Schedule(timeout_ms, [this, id, timeout_ms] () {
+        CASPER_APP_WATCHDOG_LOCK();
+        const auto      it      = states_.find(id);
+        ::sys::Process* process = registry_.Find(id);
+        if ( states_.end() != it && nullptr != process && 0 != process->pid() ) {
+            it->second.timer_ = 0;
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "%s ( %d ) did not stop within %d ms, killing it...",
+                                 id.c_str(), process->pid(), timeout_ms
+            );
+            if ( false == process->Kill(/* a_optional */ true) ) {
+                last_error_ = process->error();
+                CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+            }
+        }
+        CASPER_APP_WATCHDOG_UNLOCK();
+    });
+}
+
+/**
+ * @brief Spawn all processes that were not spawned yet and which precedents are already ready.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Watchdog::Launch ()
+{
+    size_t pending = 0;
+    
+    for ( const auto& level : registry_.levels() ) {
+        for ( auto process : level ) {
+            
+            State& state = states_[process->info().id_];
+            if ( true == state.ready_ || true == state.parked_ ) {
+                continue;
+            }
+            
+            pending++;
+            
+            if ( true == state.spawned_ || true == state.held_ || true == state.halted_ ) {
+                continue;
+            }
+            
+            // ... waiting for precedents starts now ...
+            if ( 0 == state.trace_us_ ) {
+                state.trace_us_ = ::casper::app::Tracer::Now();
+            }
+            
+            // ... all precedents must be ready ...
+            bool released = true;
+            for ( const auto& precedent : process->info().depends_on_ ) {
+                const auto it = states_.find(precedent);
+                if ( states_.end() != it && false == it->second.ready_ ) {
+                    released = false;
+                    break;
+                }
+            }
+            
+            if ( false == released ) {
+                continue;
+            }
+            
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "Spawning %s ( level %zu )...",
+                                 process->info().id_.c_str(), state.level_
+            );
+            
+            // ... readiness probe must ignore anything from a previous run ...
+            if ( nullptr != state.probe_ ) {
+                state.probe_->Arm();
+            }
+            
+            // ... try to fork and exec for this process ...
+            const int64_t spawn_us = ::casper::app::Tracer::Now();
+            if ( false == Spawn(*process) ) {
+                return false;
+            }
+            
+            // ... on it's own track, by pid ...
+            if ( process->info().depends_on_.size() > 0 ) {
+                ::casper::app::Tracer::GetInstance().Complete("Wait", state.trace_us_, spawn_us, static_cast<uint64_t>(process->pid()), process->info().id_);
+            }
+            state.trace_us_ = ::casper::app::Tracer::Now();
+            
+            state.spawned_ = true;
+        }
+    }
+    
+    // ... first time only, restarts are logged by each process ...
+    if ( 0 == pending && std::chrono::steady_clock::time_point() != startup_tp_ ) {
+        // ... log ...
+        CASPER_APP_DEBUG_LOG("status", "All processes are ready, startup took %lld ms ( %zu %s spawn(s), %lld us average, %lld us max )...",
+                             static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startup_tp_).count()),
+                             spawn_stats_.count_, ( SpawnMode::PosixSpawn == spawn_mode_ ? "posix_spawn" : "fork" ),
+                             static_cast<long long>(spawn_stats_.count_ > 0 ? spawn_stats_.total_us_ / static_cast<int64_t>(spawn_stats_.count_) : 0),
+                             static_cast<long long>(spawn_stats_.max_us_)
+        );
+        ::casper::app::Tracer::GetInstance().Complete("Startup",
+                                                      static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(startup_tp_.time_since_epoch()).count()),
+                                                      ::casper::app::Tracer::Now(), ::casper::app::Tracer::ThreadID(), ""
+        );
+        startup_tp_ = std::chrono::steady_clock::time_point();
+    }
+    
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Adopt processes started by a previous monitor, instead of restarting them.
+ *
+ * @note Each pid loaded from a pid file is validated against process start time and executable, and against the
+ *       identity saved next to it's pid file when it was spawned: processes may rewrite their own command line.
+ *       Processes that no longer match their definition are only marked here: the loop stops them, as \link Retire \link
+ *       does, and their replacements are spawned when their exit is seen. Stale pids are forgotten, they are never signalled.
+ */
+void casper::app::monitor::Watchdog::Adopt ()
+{
+    std::vector<std::pair<::sys::Process*, Adoption>> candidates;
+    std::map<pid_t, ::sys::Process*>                  owners;
+    std::map<pid_t, ::sys::Process*>                  pending;
+    
+    // ... adopted first: several processes might share the same pid file ( same executable ) ...
+    for ( auto process : registry_.list() ) {
+        if ( process->pid() <= 0 ) {
+            continue;
+        }
+        std::string    reason;
+        const Adoption adoption = Recognize(*process, reason);
+        if ( Adoption::Adopted == adoption && owners.end() == owners.find(process->pid()) ) {
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "%s ( %d ) was started by a previous monitor, adopting it...",
+                                 process->info().id_.c_str(), process->pid()
+            );
+            states_[process->info().id_].adopted_ = true;
+            owners[process->pid()] = process;
+        } else {
+            candidates.push_back(std::make_pair(process, ( Adoption::Adopted == adoption ? Adoption::Stale : adoption )));
+            if ( Adoption::Stale == adoption ) {
+                // ... log ...
+                CASPER_APP_DEBUG_LOG("status", "%s: ignoring pid %d, %s...",
+                                     process->info().id_.c_str(), process->pid(), reason.c_str()
+                );
+            }
+        }
+    }
+    
+    for ( auto candidate : candidates ) {
+        
+        ::sys::Process* process = candidate.first;
+        const pid_t     pid     = process->pid();
+        State&          state   = states_[process->info().id_];
+        
+        if ( Adoption::Changed == candidate.second && owners.end() == owners.find(pid) && pending.end() == pending.find(pid) ) {
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "%s ( %d ) was started by a previous monitor, but it no longer matches it's definition: it will be stopped with signal %d...",
+                                 process->info().id_.c_str(), pid, state.stop_.signal_
+            );
+            // ... stopped by the loop, as any other process, it's replacement is spawned when it's exit is seen ...
+            state.adopted_  = true;
+            state.stopping_ = true;
+            pending[pid]    = process;
+        } else {
+            // ... stale, or it belongs to other process ...
+            (*process) = static_cast<pid_t>(0);
+        }
+    }
+}
+
+/**
+ * @brief Check if a process, which pid was loaded from it's pid file, was started by a previous monitor.
+ *
+ * @param a_process The process to check.
+ * @param o_reason  Why it can't be adopted, only set when it can't.
+ *
+ * @return \link Adoption \link.
+ */
+casper::app::monitor::Watchdog::Adoption casper::app::monitor::Watchdog::Recognize (::sys::Process& a_process, std::string& o_reason) const
+{
+    Identity identity;
+    if ( false == identity.Load(a_process.pid()) ) {
+        o_reason = "it's not running";
+        return Adoption::Stale;
+    }
+    
+    // ... as it was spawned, only when it's the same process ...
+    Identity spawned;
+    const bool remembered = ( true == spawned.Load(a_process.info().pid_file_ + ".identity") && spawned.pid() == identity.pid() );
+    
+    // ... a process can't start after it's pid was written, if it did the pid was reused ...
+    if ( true == remembered ) {
+        if ( spawned.started() != identity.started() ) {
+            o_reason = "it's pid was reused";
+            return Adoption::Stale;
+        }
+    } else {
+        struct stat info;
+        if ( 0 != stat(a_process.info().pid_file_.c_str(), &info) ) {
+            o_reason = "pid file is gone";
+            return Adoption::Stale;
+        }
+        if ( identity.started() > info.st_mtime + 1 ) {
+            o_reason = "it's pid was reused";
+            return Adoption::Stale;
+        }
+    }
+    
+    std::string              executable;
+    std::vector<std::string> arguments;
+    Describe(a_process, executable, arguments);
+    
+    // ... binary might have been upgraded, the kernel's path is never rewritten by the process ...
+    if ( 0 != executable.compare(identity.executable()) ) {
+        o_reason = "it's running '" + identity.executable() + "' instead of '" + executable + "'";
+        return Adoption::Changed;
+    }
+    
+    // ... or it's definition changed: it's own command line can't be compared, it may have been rewritten ( 'redis-server *:6379', 'nginx: master process' ) ...
+    if ( true == remembered && ( 0 != executable.compare(spawned.executable()) || arguments != spawned.arguments() ) ) {
+        o_reason = "it's command line changed";
+        return Adoption::Changed;
+    }
+    
+    return Adoption::Adopted;
+}
+
+/**
+ * @brief Collect what a process runs and how, as it's defined.
+ *
+ * @param a_process    The process.
+ * @param o_executable Absolute executable path, symbolic links resolved as the kernel does.
+ * @param o_arguments  Command line, including argv[0].
+ */
+void casper::app::monitor::Watchdog::Describe (::sys::Process& a_process, std::string& o_executable, std::vector<std::string>& o_arguments) const
+{
+    char path[PATH_MAX];
+    o_executable = ( nullptr != realpath(a_process.uri().c_str(), path) ? std::string(path) : a_process.uri() );
+    o_arguments.clear();
+    for ( char* const* it = a_process.argv() ; nullptr != (*it) ; ++it ) {
+        o_arguments.push_back(*it);
+    }
+}
+
+/**
+ * @brief Save a spawned process identity next to it's pid file, for \link Recognize \link.
+ *
+ * @param a_process The process that was just spawned.
+ *
+ * @note A process that already exited is not remembered, it's previous identity is removed.
+ */
+void casper::app::monitor::Watchdog::Remember (::sys::Process& a_process)
+{
+    if ( 0 == a_process.info().pid_file_.length() ) {
+        return;
+    }
+    
+    const std::string uri = a_process.info().pid_file_ + ".identity";
+    
+    std::string              executable;
+    std::vector<std::string> arguments;
+    Describe(a_process, executable, arguments);
+    
+    // ... start time is set by fork, exec does not change it ...
+    Identity identity;
+    if ( false == identity.Load(a_process.pid()) ) {
+        (void)unlink(uri.c_str());
+        return;
+    }
+    identity.Define(executable, arguments);
+    if ( false == identity.Save(uri) ) {
+        last_error_ = identity.error();
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+        (void)unlink(uri.c_str());
+    }
+}
+
+/**
+ * @brief Kill all processes loaded processes.
+ *
+ * @param a_optional If true won't report failure when signal is not sent.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Watchdog::KillAll (const bool& a_optional, const pid_t a_parent_pid)
+{
+    return SignalAll(SIGKILL, a_optional, a_parent_pid);
+}
+
+/**
+ * @brief Terminate all processes loaded processes.
+ *
+ * @param a_optional If true won't report failure when signal is not sent.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Watchdog::TerminateAll (const bool& a_optional, const pid_t a_parent_pid)
+{
+    return SignalAll(SIGTERM, a_optional, a_parent_pid);
+}
+
+/**
+ * @brief Signal all processes loaded processes.
+ *
+ * @param a_no       Signal number to send.
+ * @param a_optional If true won't report failure when signal is not sent.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Watchdog::SignalAll (const int a_no, const bool& a_optional, const pid_t a_parent_pid)
+{
+    // ... one snapshot for all process(es), instead of two probes per process ...
+    if ( false == table_.Refresh() ) {
+        last_error_ = table_.error();
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+        if ( a_optional == false ) {
+            return false;
+        }
+    }
+    const pid_t parent_pid = ( 0 != a_parent_pid ? a_parent_pid : 1 );
     
-    // ... start a new thread? ....
-    if ( true == a_detached ) {
-        // ... start a new thread ....
-        thread_ = new std::thread(&casper::app::monitor::Watchdog::Loop, this);
-        thread_->detach();
-        // ... wait for thread to be running ...
-        thread_cv_.Wait();
+    // ... reverse terminate process(es) ...
+    for ( auto it = registry_.list().rbegin() ; registry_.list().rend() != it ; ++it ) {
+        
+        ::sys::Process* process = (::sys::Process*)(*it);
+        
+        // ... try to send a signal to process ...
+        const bool is_running = ( process->pid() > 0 && true == table_.IsRunning(process->pid(), parent_pid) );
+        const bool is_zombie  = ( process->pid() > 0 && true == table_.IsZombie(process->pid()) );
+        
+        if ( true == is_running || true == is_zombie ) {
+            if ( false == process->Signal(a_no, a_optional) ) {
+                // ... error should be set, nothing else to do here ...
+                if ( a_optional == false ) {
+                    return false;
+                }
+            }
+        }
+        
+        // ... log ...
+        CASPER_APP_DEBUG_LOG("status", "%-30s %-4d %-8d %c%c",
+                             process->info().id_.c_str(),
+                             a_no,
+                             static_cast<int>(process->pid()),
+                             is_running ? 'R' : '-', is_zombie ? 'Z' : '-'
+        );
+
+    }
+    
+    // ... done ...
+    return true;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Spawn a new process.
+ *
+ * @param a_process The process that requested this action.
+ *
+ * @return True on success, false on failure.
+ */
+bool casper::app::monitor::Watchdog::Spawn (::sys::Process& a_process)
+{
+    ::casper::app::Tracer::Span span("Spawn", a_process.info().id_);
+    
+    const auto start_tp = std::chrono::steady_clock::now();
+    
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status",
+                         "1) %s", a_process.uri().c_str()
+    );
+    
+    // ... listening sockets, bound on first spawn and kept open across restarts ...
+    std::vector<int> listen_fds;
+    for ( auto address : options_[a_process.info().id_].listen_ ) {
+        int fd = -1;
+        if ( false == sockets_.Listen(address, fd) ) {
+            last_error_ = sockets_.error();
+            return false;
+        }
+        listen_fds.push_back(fd);
+    }
+    
+    // ... exec status pipe: closed on exec success, errno is written to it on exec failure ...
+    int exec_fds[2];
+#ifdef __APPLE__
+    if ( -1 == pipe(exec_fds) || -1 == fcntl(exec_fds[0], F_SETFD, FD_CLOEXEC) || -1 == fcntl(exec_fds[1], F_SETFD, FD_CLOEXEC) ) {
+#else
+    if ( -1 == pipe2(exec_fds, O_CLOEXEC) ) {
+#endif
+        CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
+                                     errno,
+                                     "unable to launch '%s' - pipe failure", a_process.uri().c_str()
+        );
+        return false;
+    }
+    
+    // ... stdout and stderr pipes, read by collector ...
+    int log_fds[2] = { -1, -1 };
+    if ( false == collector_.Open(a_process.info().log_dir_ + a_process.info().id_ + "-stdout.log", log_fds[0])
+        ||
+         false == collector_.Open(a_process.info().log_dir_ + a_process.info().id_ + "-stderr.log", log_fds[1])
+    ) {
+        last_error_ = collector_.error();
+        close(exec_fds[0]);
+        close(exec_fds[1]);
+        if ( -1 != log_fds[0] ) {
+            close(log_fds[0]);
+        }
+        return false;
+    }
+    
+    // ... core dumps size limit, when crashes should leave one ...
+    const Crash&  crash = options_[a_process.info().id_].crash_;
+    struct rlimit core_rlimit;
+    struct rlimit child_rlimit;
+    const bool    core  = ( true == crash.core_ && 0 == getrlimit(RLIMIT_CORE, &core_rlimit) );
+    if ( true == core ) {
+        child_rlimit = core_rlimit;
+        child_rlimit.rlim_cur = ( crash.core_limit_ < 0 ? RLIM_INFINITY : static_cast<rlim_t>(crash.core_limit_) );
+        if ( child_rlimit.rlim_cur > child_rlimit.rlim_max ) {
+            child_rlimit.rlim_cur = child_rlimit.rlim_max;
+        }
+    }
+    
+    // ... exec status write end is inherited, and closed on exec, by both ...
+    // ( LISTEN_PID must be set by the child itself, so processes with listening sockets are always forked )
+    const bool by_posix_spawn = ( SpawnMode::PosixSpawn == spawn_mode_ && 0 == listen_fds.size() );
+    
+    // ... posix_spawn has no attribute for resource limits and the child inherits ours, so ours is only changed while spawning ...
+    // ( a forked child sets it's own, after fork )
+    const bool toggled = ( true == core && true == by_posix_spawn );
+    if ( true == toggled && 0 != setrlimit(RLIMIT_CORE, &child_rlimit) ) {
+        CASPER_APP_DEBUG_LOG("status", "Unable to set %s core dumps size limit: %s...", a_process.info().id_.c_str(), strerror(errno));
+    }
+    
+    const bool spawned = ( true == by_posix_spawn
+                              ? PosixSpawn(a_process, log_fds)
+                              : Fork(a_process, exec_fds[1], log_fds, listen_fds, ( true == core ? &child_rlimit : nullptr ))
+    );
+    
+    if ( true == toggled ) {
+        (void)setrlimit(RLIMIT_CORE, &core_rlimit);
+    }
+    
+    close(exec_fds[1]);
+    close(log_fds[0]);
+    close(log_fds[1]);
+    
+    if ( false == spawned ) {
+        close(exec_fds[0]);
+        return false;
+    }
+    
+    // ... reaped exits are matched by pid ...
+    registry_.Index(&a_process);
+    
+    // ... what was spawned, a next monitor adopts it by this and not by it's command line, which it may rewrite ...
+    Remember(a_process);
+    
+    // ... each run has it's own trace track ...
+    ::casper::app::Tracer::GetInstance().Name(static_cast<uint64_t>(a_process.pid()), a_process.info().id_);
+    
+    // ... watch child exit ...
+    if ( false == reactor_.Watch(a_process.pid()) ) {
+        last_error_ = reactor_.error();
+        close(exec_fds[0]);
+        return false;
+    }
+    
+    // ... and exec status ...
+    ::sys::Process* process = &a_process;
+    if ( false == reactor_.Add(exec_fds[0], [this, process] (const int a_fd) { OnExecStatus(*process, a_fd); }) ) {
+        last_error_ = reactor_.error();
+        close(exec_fds[0]);
+        return false;
+    }
+    states_[a_process.info().id_].exec_fd_ = exec_fds[0];
+    
+    // ... and resource usage ...
+    sampler_.Track(a_process.info().id_, a_process.pid());
+    states_[a_process.info().id_].started_ = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    
+    // ... listener only needs to know about this one ...
+    Publish(Change::Spawned, a_process.info().id_, a_process.pid());
+    Post(a_process, states_[a_process.info().id_]);
+    
+    // ... time this thread was blocked, with posix_spawn it also includes child exec ...
+    const int64_t elapsed_us = static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_tp).count());
+    spawn_stats_.count_    += 1;
+    spawn_stats_.total_us_ += elapsed_us;
+    if ( elapsed_us > spawn_stats_.max_us_ ) {
+        spawn_stats_.max_us_ = elapsed_us;
+    }
+    
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "%s ( %d ) spawned in %lld us...",
+                         a_process.info().id_.c_str(), a_process.pid(), static_cast<long long>(elapsed_us)
+    );
+    
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Spawn a new process by fork-exec combination.
+ *
+ * @param a_process     The process that requested this action.
+ * @param a_exec_fd     Write end of exec status pipe.
+ * @param a_log_fds     Write end of stdout and stderr pipes.
+ * @param a_listen_fds  Listening sockets, passed as fds 3, 4, ... ( LISTEN_FDS / LISTEN_PID and NGINX conventions ).
+ * @param a_core_rlimit Core dumps size limit to set in the child, nullptr to inherit ours.
+ *
+ * @return True on success, false on failure.
+ *
+ * @note This thread is not the only one, so the child only makes async-signal-safe calls until exec: everything it
+ *       needs, including it's environment, is prepared here, nothing is allocated or logged after fork.
+ */
+bool casper::app::monitor::Watchdog::Fork (::sys::Process& a_process, const int a_exec_fd, const int a_log_fds[2],
+                                           const std::vector<int>& a_listen_fds, const struct rlimit* a_core_rlimit)
+{
+    // ... copies, the child moves them around ...
+    std::vector<int> listen_fds = a_listen_fds;
+    int              exec_fd    = a_exec_fd;
+    int              log_fds[2] = { a_log_fds[0], a_log_fds[1] };
+    
+    // ... sockets are only meant for this process, not for anything it might exec later ...
+    std::vector<std::string> environment;
+    Environment(a_process, environment);
+    if ( listen_fds.size() > 0 ) {
+        // ... nginx ignores LISTEN_FDS, it takes inherited sockets from NGINX=3;4;... and reuses the ones matching it's 'listen' directives ...
+        std::string nginx = "NGINX=";
+        for ( size_t idx = 0 ; idx < listen_fds.size() ; ++idx ) {
+            nginx += std::to_string(3 + idx) + ';';
+        }
+        environment.push_back(nginx);
+        environment.push_back("LISTEN_FDS=" + std::to_string(listen_fds.size()));
+        // ... it's pid is only known by the child, room for any pid is reserved here ...
+        environment.push_back("LISTEN_PID=" + std::string(20, '0'));
+    }
+    
+    std::vector<char*> envp;
+    for ( auto& entry : environment ) {
+        envp.push_back(const_cast<char*>(entry.c_str()));
+    }
+    envp.push_back(nullptr);
+    
+    char* const       listen_pid = ( listen_fds.size() > 0 ? envp[envp.size() - 2] + 11 : nullptr );
+    const std::string uri        = a_process.uri();
+    char* const*      argv       = a_process.argv();
+    
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status",
+                         "%s %s", uri.c_str(), a_process.info().arguments_.c_str()
+    );
+    
+    const pid_t pid = fork();
+    
+    if ( 0 > pid ) { // ... unable to fork ...
+        CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
+                                     errno,
+                                     "unable to launch '%s' - fork failure", uri.c_str()
+        );
+        return false;
+    } else if ( 0 == pid ) { // ... child ...
+        
+        // ... reset signal mask, control signals are blocked in watchdog thread ...
+        sigset_t sigmask;
+        sigemptyset(&sigmask);
+        pthread_sigmask(SIG_SETMASK, &sigmask, NULL);
+        
+        // ... and restore default handlers, ignored signals would survive exec ...
+        for ( auto signal_no : { SIGINT, SIGHUP, SIGTERM, SIGUSR2, SIGPIPE, SIGTRAP } ) {
+            (void)signal(signal_no, SIG_DFL);
+        }
+        
+        // ... listening sockets go to 3, 4, ..., everything else that must survive is first moved above them ...
+        const int first = 3 + static_cast<int>(listen_fds.size());
+        if ( listen_fds.size() > 0 ) {
+            for ( int* fd : { &exec_fd, &log_fds[0], &log_fds[1] } ) {
+                if ( (*fd) < first ) {
+                    (*fd) = fcntl((*fd), F_DUPFD_CLOEXEC, first);
+                }
+            }
+            for ( auto& fd : listen_fds ) {
+                if ( fd < first ) {
+                    fd = fcntl(fd, F_DUPFD_CLOEXEC, first);
+                }
+            }
+            // ... dup2 clears close-on-exec, so only these copies are inherited ...
+            for ( size_t idx = 0 ; idx < listen_fds.size() ; ++idx ) {
+                (void)dup2(listen_fds[idx], 3 + static_cast<int>(idx));
+            }
+        }
+        
+        // ... close ALL other open files on exec ( exec status and output pipes are already close-on-exec ) ...
+#ifdef __APPLE__
+        const bool closed = false;
+#else
+        const bool closed = ( 0 == syscall(SYS_close_range, static_cast<unsigned int>(first), ~0U, CASPER_APP_MONITOR_CLOSE_RANGE_CLOEXEC) );
+#endif
+        if ( false == closed ) {
+            // ... no close_range ( or too old kernel ), one syscall per possible fd ...
+            const int max = getdtablesize();
+            // ... but skip 0 - stdin, 1 - stdout, 2 - stderr, listening sockets, exec status and output pipes ....
+            for ( int n = first; n < max; n++ ) {
+                if ( exec_fd != n && log_fds[0] != n && log_fds[1] != n ) {
+                    close(n);
+                }
+            }
+        }
+        
+        // ... redirect stdout and stderr to collector pipes, originals are close-on-exec ...
+        if ( -1 == dup2(log_fds[0], STDOUT_FILENO) || -1 == dup2(log_fds[1], STDERR_FILENO) ) {
+            const int err_no = errno;
+            (void)write(exec_fd, &err_no, sizeof(err_no));
+            _exit(127);
+        }
+        
+        // ... create session and set process group ID ...
+        setsid();
+        
+        // ... only this process limit changes, setrlimit is async-signal-safe ...
+        if ( nullptr != a_core_rlimit ) {
+            (void)setrlimit(RLIMIT_CORE, a_core_rlimit);
+        }
+        
+        // ... no std::to_string here ...
+        if ( nullptr != listen_pid ) {
+            char  digits[20];
+            int   count = 0;
+            pid_t value = getpid();
+            do {
+                digits[count++] = static_cast<char>('0' + ( value % 10 ));
+                value /= 10;
+            } while ( value > 0 );
+            char* it = listen_pid;
+            while ( count > 0 ) {
+                *(it++) = digits[--count];
+            }
+            (*it) = '\0';
+        }
+        
+        // ... execute process ...
+        (void)execve(uri.c_str(), argv, envp.data());
+        
+        // ... report exec failure to parent, it will notify listener ...
+        const int err_no = errno;
+        (void)write(exec_fd, &err_no, sizeof(err_no));
+        
+        _exit(127);
+        
+    } /* else { ... } - parent */
+    
+    // ... set pid ...
+    a_process = pid;
+    
+    // ... write pid, child can't do it safely ...
+    if ( false == a_process.WritePID() ) {
+        last_error_ = a_process.error();
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+    }
+    
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Spawn a new process with posix_spawn, nothing runs in the child between clone and exec.
+ *
+ * @param a_process The process that requested this action.
+ * @param a_log_fds Write end of stdout and stderr pipes.
+ *
+ * @return True on success, false on failure.
+ */
+bool casper::app::monitor::Watchdog::PosixSpawn (::sys::Process& a_process, const int a_log_fds[2])
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t          attributes;
+    
+    (void)posix_spawn_file_actions_init(&actions);
+    (void)posix_spawnattr_init(&attributes);
+    
+    // ... redirect stdout and stderr to collector pipes, originals are close-on-exec ...
+    (void)posix_spawn_file_actions_adddup2(&actions, a_log_fds[0], STDOUT_FILENO);
+    (void)posix_spawn_file_actions_adddup2(&actions, a_log_fds[1], STDERR_FILENO);
+    
+    short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+    
+    // ... close ALL other open files ...
+    // ( never used without it, see \link CASPER_APP_MONITOR_SPAWN_CLOSES_FDS \link )
+#ifdef __APPLE__
+    (void)posix_spawn_file_actions_addinherit_np(&actions, STDIN_FILENO);
+    flags |= POSIX_SPAWN_CLOEXEC_DEFAULT;
+#elif CASPER_APP_MONITOR_SPAWN_CLOSES_FDS
+    (void)posix_spawn_file_actions_addclosefrom_np(&actions, 3);
+#endif
+    
+    // ... create session and set process group ID ...
+#ifdef POSIX_SPAWN_SETSID
+    flags |= POSIX_SPAWN_SETSID;
+#else
+    flags |= POSIX_SPAWN_SETPGROUP;
+    (void)posix_spawnattr_setpgroup(&attributes, 0);
+#endif
+    
+    // ... reset signal mask, control signals are blocked in watchdog thread ...
+    sigset_t sigmask;
+    sigemptyset(&sigmask);
+    (void)posix_spawnattr_setsigmask(&attributes, &sigmask);
+    
+    // ... and restore default handlers, as \link Exec \link does ...
+    sigset_t sigdefault;
+    sigemptyset(&sigdefault);
+    for ( auto signal_no : { SIGINT, SIGHUP, SIGTERM, SIGUSR2, SIGPIPE, SIGTRAP } ) {
+        sigaddset(&sigdefault, signal_no);
+    }
+    (void)posix_spawnattr_setsigdefault(&attributes, &sigdefault);
+    
+    (void)posix_spawnattr_setflags(&attributes, flags);
+    
+    // ... no sockets are passed ( see \link Fork \link ) ...
+    std::vector<std::string> environment;
+    Environment(a_process, environment);
+    
+    std::vector<char*> envp;
+    for ( auto& entry : environment ) {
+        envp.push_back(const_cast<char*>(entry.c_str()));
+    }
+    envp.push_back(nullptr);
+    
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status",
+                         "%s %s", a_process.uri().c_str(), a_process.info().arguments_.c_str()
+    );
+    
+    pid_t pid = 0;
+    
+    const int rv = posix_spawn(&pid, a_process.uri().c_str(), &actions, &attributes, a_process.argv(), envp.data());
+    
+    (void)posix_spawnattr_destroy(&attributes);
+    (void)posix_spawn_file_actions_destroy(&actions);
+    
+    if ( 0 != rv ) {
+        // ... exec failures are reported here, child was already reaped ...
+        CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
+                                     rv,
+                                     "unable to start '%s' - exec failure", a_process.uri().c_str()
+        );
+        return false;
+    }
+    
+    // ... set pid ...
+    a_process = pid;
+    
+    // ... write pid, child can't do it ...
+    if ( false == a_process.WritePID() ) {
+        last_error_ = a_process.error();
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+    }
+    
+    // ... done ...
+    return true;
+}
+
+/**
+ * @brief Build a child process environment, before it's spawned.
+ *
+ * @param a_process The process to be launched.
+ * @param o_entries Same environment as ours, but PATH is set to process path and no listening sockets are passed.
+ */
+void casper::app::monitor::Watchdog::Environment (const ::sys::Process& a_process, std::vector<std::string>& o_entries) const
+{
+    o_entries.clear();
+    for ( char** it = environ ; nullptr != (*it) ; ++it ) {
+        if ( 0 != strncmp(*it, "PATH=", 5) && 0 != strncmp(*it, "LISTEN_FDS=", 11) && 0 != strncmp(*it, "LISTEN_PID=", 11) && 0 != strncmp(*it, "LISTEN_FDNAMES=", 15) && 0 != strncmp(*it, "NGINX=", 6) ) {
+            o_entries.push_back(*it);
+        }
+    }
+    o_entries.push_back("PATH=" + a_process.info().path_);
+}
+
+/**
+ * @brief Called by reactor when the exec status pipe of a child is closed or has data.
+ *
+ * @param a_process The process that was spawned.
+ * @param a_fd      Read end of exec status pipe.
+ */
+void casper::app::monitor::Watchdog::OnExecStatus (::sys::Process& a_process, const int a_fd)
+{
+    int     err_no = 0;
+    ssize_t count;
+    do {
+        count = read(a_fd, &err_no, sizeof(err_no));
+    } while ( -1 == count && EINTR == errno );
+    
+    reactor_.Remove(a_fd);
+    close(a_fd);
+    
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    State& state = states_[a_process.info().id_];
+    state.exec_fd_ = -1;
+    
+    if ( sizeof(err_no) == count ) {
+        // ... exec failure ...
+        CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
+                                     err_no,
+                                     "unable to start '%s' - exec failure", a_process.uri().c_str()
+        );
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    } else if ( nullptr != state.probe_ ) {
+        ::casper::app::Tracer::GetInstance().Complete("Exec", state.trace_us_, ::casper::app::Tracer::Now(), static_cast<uint64_t>(a_process.pid()), a_process.info().id_);
+        state.trace_us_ = ::casper::app::Tracer::Now();
+        // ... exec succeeded, but dependants must wait for readiness probe ...
+        CASPER_APP_DEBUG_LOG("status", "%s ( %d ) is up, waiting for %s probe...",
+                             a_process.info().id_.c_str(), a_process.pid(), Probe::Name(state.probe_->kind())
+        );
+        const std::string id = a_process.info().id_;
+        state.timer_ = reactor_.Schedule(/* a_delay_ms */ 0, [this, id] () { OnProbe(id); });
     } else {
-        Loop();
+        ::casper::app::Tracer::GetInstance().Complete("Exec", state.trace_us_, ::casper::app::Tracer::Now(), static_cast<uint64_t>(a_process.pid()), a_process.info().id_);
+        state.trace_us_ = 0;
+        // ... exec succeeded ...
+        SetReady(a_process, state);
     }
     
-    // ... we're done ...
-    return true;
+    CASPER_APP_WATCHDOG_UNLOCK();
 }
 
 /**
- * @brief Stop monitoring processes.
+ * @brief Called by reactor when it's time to start or continue a readiness probe attempt.
+ *
+ * @param a_id Process id.
  */
-void casper::app::monitor::Watchdog::Stop ()
+void casper::app::monitor::Watchdog::OnProbe (const std::string& a_id)
 {
-    // ... first release thread ...
-    if ( nullptr != thread_ ) {
-        delete thread_;
-        thread_ = nullptr;
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    // ... process might be gone ...
+    const auto it = states_.find(a_id);
+    if ( states_.end() == it || nullptr == it->second.probe_ ) {
+        CASPER_APP_WATCHDOG_UNLOCK();
+        return;
     }
     
-    CASPER_APP_WATCHDOG_LOCK();
+    ::sys::Process* process = registry_.Find(a_id);
     
-    // ... now try to terminate all running processes, launched by this app ...
-    if ( false == TerminateAll(/* a_optional */ true) ) {
-        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+    State& state = it->second;
+    
+    // ... already ready, or it's run is over: a late call back of an attempt that is no longer wanted ...
+    if ( true == state.ready_ || false == state.spawned_ || true == state.stopping_ || nullptr == process || 0 == process->pid() ) {
+        state.probe_->Abort();
+        CASPER_APP_WATCHDOG_UNLOCK();
+        return;
     }
     
-    // ... then release them ...
-    for ( auto it : list_ ) {
-        delete it;
+    // ... called by it's timer or by it's pending attempt, only one of them is left ...
+    if ( 0 != state.timer_ ) {
+        reactor_.Cancel(state.timer_);
+        state.timer_ = 0;
     }
-    list_.clear();
-    last_error_.Reset();
     
-    // ... forget all other data ...
-    listener_ptr_ = nullptr;
-    detached_     = false;
-    main_pid_     = 0;
+    int delay_ms = 0;
+    switch ( state.probe_->Step(delay_ms) ) {
+        case Probe::Status::Ready:
+            SetReady(*process, state);
+            break;
+        case Probe::Status::Waiting:
+            state.timer_ = reactor_.Schedule(delay_ms, [this, a_id] () { OnProbe(a_id); });
+            break;
+        case Probe::Status::Failed:
+            CASPER_APP_MONITOR_SET_ERROR(process, last_error_,
+                                         state.probe_->error().no(),
+                                         "%s is not ready after %d %s probe attempt(s): %s",
+                                         a_id.c_str(), state.probe_->attempts(), Probe::Name(state.probe_->kind()),
+                                         state.probe_->error().message().c_str()
+            );
+            CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+            break;
+    }
     
     CASPER_APP_WATCHDOG_UNLOCK();
 }
 
 /**
- * @brief Quit loop.
+ * @brief Mark a process as ready and release it's dependants.
+ *
+ * @param a_process The process that is now ready.
+ * @param a_state   The process state.
  */
-void casper::app::monitor::Watchdog::Quit ()
+void casper::app::monitor::Watchdog::SetReady (const ::sys::Process& a_process, casper::app::monitor::Watchdog::State& a_state)
 {
-    Stop();
+    a_state.ready_ = true;
+    checker_.Track(a_process.info().id_);
+    Publish(Change::Ready, a_process.info().id_, a_process.pid());
+    Post(a_process, a_state);
+    if ( 0 != a_state.trace_us_ ) {
+        ::casper::app::Tracer::GetInstance().Complete("Probe", a_state.trace_us_, ::casper::app::Tracer::Now(), static_cast<uint64_t>(a_process.pid()), a_process.info().id_);
+        a_state.trace_us_ = 0;
+    }
+    // ... log ...
+    if ( nullptr != a_state.probe_ ) {
+        CASPER_APP_DEBUG_LOG("status", "%s ( %d ) is ready, %s probe succeeded after %d attempt(s)...",
+                             a_process.info().id_.c_str(), a_process.pid(), Probe::Name(a_state.probe_->kind()), a_state.probe_->attempts()
+        );
+    } else {
+        CASPER_APP_DEBUG_LOG("status", "%s ( %d ) is ready...",
+                             a_process.info().id_.c_str(), a_process.pid()
+        );
+    }
+    // ... release dependants ...
+    if ( false == Launch() ) {
+        CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
+    }
 }
 
 /**
- * @brief Quit loop.
+ * @brief Append a child run to runs history and publish it's exit in status board, called when it's reaped.
+ *
+ * @param a_process The process that exited.
+ * @param a_state   The process state.
+ * @param a_exit    It's exit status and resource usage.
+ * @param a_reason  Human readable exit reason.
+ *
+ * @note Kernel accounting is only known for our own children, adopted ones are not recorded.
  */
-void casper::app::monitor::Watchdog::Refresh ()
+void casper::app::monitor::Watchdog::Record (const ::sys::Process& a_process, const casper::app::monitor::Watchdog::State& a_state,
+                                             const casper::app::monitor::Reactor::Exit& a_exit, const std::string& a_reason)
 {
-    if ( true == detached_ ) {
-        // ... signal parent ...
-        kill(getppid(), SIGUSR2);
-    } else {
-        // ... just call signal handler ...
-        casper::app::monitor::Watchdog::OnSignal(SIGUSR2);
+    board_.Exited(a_process.info().id_,
+                  ( true == a_exit.known_ && true == WIFEXITED(a_exit.status_) ? WEXITSTATUS(a_exit.status_) : -1 ),
+                  ( true == a_exit.known_ && true == WIFSIGNALED(a_exit.status_) ? WTERMSIG(a_exit.status_) : 0 ),
+                  a_reason,
+                  static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count())
+    );
+    if ( false == a_exit.known_ ) {
+        return;
     }
-}
-
+    runs_.Add({
+        /* id_                   */ a_process.info().id_,
+        /* pid_                  */ a_exit.pid_,
+        /* start_                */ a_state.started_,
+        /* stop_                 */ static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()),
+        /* user_us_              */ static_cast<uint64_t>(a_exit.usage_.ru_utime.tv_sec) * 1000000 + static_cast<uint64_t>(a_exit.usage_.ru_utime.tv_usec),
+        /* system_us_            */ static_cast<uint64_t>(a_exit.usage_.ru_stime.tv_sec) * 1000000 + static_cast<uint64_t>(a_exit.usage_.ru_stime.tv_usec),
 #ifdef __APPLE__
-#pragma mark -
+        /* max_rss_              */ static_cast<uint64_t>(a_exit.usage_.ru_maxrss),
+#else
+        /* max_rss_              */ static_cast<uint64_t>(a_exit.usage_.ru_maxrss) * 1024,
 #endif
+        /* minor_faults_         */ static_cast<uint64_t>(a_exit.usage_.ru_minflt),
+        /* major_faults_         */ static_cast<uint64_t>(a_exit.usage_.ru_majflt),
+        /* voluntary_switches_   */ static_cast<uint64_t>(a_exit.usage_.ru_nvcsw),
+        /* involuntary_switches_ */ static_cast<uint64_t>(a_exit.usage_.ru_nivcsw),
+        /* status_               */ ( true == WIFEXITED(a_exit.status_) ? WEXITSTATUS(a_exit.status_) : -1 ),
+        /* signal_               */ ( true == WIFSIGNALED(a_exit.status_) ? WTERMSIG(a_exit.status_) : 0 ),
+        /* reason_               */ a_reason
+    });
+}
 
 /**
- * @brief Thread function where the 'loop' will run.
+ * @brief Report a child crash and quarantine it if it's crashing in a loop, called before it's exit is handled.
+ *
+ * @param a_process The process that crashed, already reaped but not forgotten.
+ * @param a_state   The process state.
+ * @param a_exit    It's exit status and resource usage.
+ * @param a_signal  Signal that terminated it.
  */
-void casper::app::monitor::Watchdog::Loop ()
+void casper::app::monitor::Watchdog::OnCrash (const ::sys::Process& a_process, casper::app::monitor::Watchdog::State& a_state,
+                                              const casper::app::monitor::Reactor::Exit& a_exit, const int a_signal)
 {
-    // ... log ...
-    CASPER_APP_DEBUG_LOG("status", "%s", "Starting...");
-
-    // ... signal thread is running ...
-    thread_cv_.Wake();
-    
-    sigset_t sigmask;
-    sigset_t saved_sigmask;
-    
-    // ... block SIGCHLD ...
-    sigemptyset(&sigmask);
-    sigaddset(&sigmask, SIGCHLD);
-    pthread_sigmask(SIG_BLOCK, &sigmask, &saved_sigmask);
+    const std::string& id = a_process.info().id_;
     
-    if ( true == detached_ ) {
-        pthread_setname_np("Monitor Watchdog");
-    } else {
-        pthread_setname_np("Monitor");
+    // ... forget crashes outside window ...
+    const auto now = std::chrono::steady_clock::now();
+    while ( a_state.crashed_.size() > 0 && ( now - a_state.crashed_.front() ) > std::chrono::milliseconds(a_state.crash_.window_ms_) ) {
+        a_state.crashed_.pop_front();
     }
+    a_state.crashed_.push_back(now);
     
-    CASPER_APP_WATCHDOG_LOCK();
-
-    // ... first try to terminate all running processes, launched by this app ...
-    if ( false == TerminateAll(/* a_optional */ true) ) {
-        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+    if ( a_state.crash_.quarantine_ > 0 && a_state.crashed_.size() >= static_cast<size_t>(a_state.crash_.quarantine_) ) {
+        a_state.quarantined_ = true;
     }
     
-    // ... now spawn new processes ...
-    for ( auto internal : list_ ) {
-        // ... try to fork and exec for this process ...
-        if ( false == Spawn(*internal, /* a_block_sigchld */ false) ) {
-            CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
-        }
-        
-        // TODO CW: fix this?
-        // ... give some time to process start ...
-        CASPER_APP_WATCHDOG_UNLOCK();
-        usleep(1000*1000);
-        CASPER_APP_WATCHDOG_LOCK();
-        
+    Crashes::Report report = {
+        /* id_          */ id,
+        /* pid_         */ a_process.pid(),
+        /* uri_         */ a_process.uri(),
+        /* signal_      */ a_signal,
+        /* core_dumped_ */ ( 0 != WCOREDUMP(a_exit.status_) ),
+        /* timestamp_   */ static_cast<int64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()),
+        /* user_cpu_    */ static_cast<double>(a_exit.usage_.ru_utime.tv_sec) + static_cast<double>(a_exit.usage_.ru_utime.tv_usec) / 1000000.0,
+        /* system_cpu_  */ static_cast<double>(a_exit.usage_.ru_stime.tv_sec) + static_cast<double>(a_exit.usage_.ru_stime.tv_usec) / 1000000.0,
+#ifdef __APPLE__
+        /* max_rss_     */ static_cast<uint64_t>(a_exit.usage_.ru_maxrss),
+#else
+        /* max_rss_     */ static_cast<uint64_t>(a_exit.usage_.ru_maxrss) * 1024,
+#endif
+        /* count_       */ a_state.crashed_.size(),
+        /* quarantined_ */ a_state.quarantined_,
+        /* stderr_      */ {},
+        /* core_        */ "",
+        /* core_size_   */ 0,
+        /* name_        */ ""
+    };
+    
+    // ... whatever it said last, output still in the pipe might be missing ...
+    (void)collector_.Tail(a_process.info().log_dir_ + id + "-stderr.log", crashes_.lines(), report.stderr_);
+    
+    // ... a core with a relative path is written to it's current directory, which we don't know ...
+    std::vector<std::string> directories = { a_process.info().working_dir_ };
+    char                     cwd[PATH_MAX];
+    if ( nullptr != getcwd(cwd, sizeof(cwd)) ) {
+        directories.push_back(cwd);
     }
-
-    CASPER_APP_WATCHDOG_UNLOCK();
-
-    // ... restore the signal mask ...
-    pthread_sigmask(SIG_SETMASK, &saved_sigmask, NULL);
     
-    typedef struct  {
-        pid_t                 pid_;
-        const ::sys::Process* process_;
-        std::string           reason_;
-        bool                  terminated_;
-        int                   status_;
-        bool                  signalled_;
-        int                   signal_;
-        bool                  stopped_;
-    } Child;
+    crashes_.Add(report, directories);
     
-#if 0
-    const int wait_options = WUNTRACED | WCONTINUED;
-#else
-    const int wait_options = WNOHANG;
-
-    struct timeval timeout;
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "%s ( %d ) crashed with signal %d ( %s )%s, %zu crash(es) in %d ms...",
+                         id.c_str(), a_process.pid(), a_signal, strsignal(a_signal),
+                         ( true == report.core_dumped_ ? " and produced a core dump" : "" ), a_state.crashed_.size(), a_state.crash_.window_ms_
+    );
+}
 
-    timeout.tv_sec  = 1;
-    timeout.tv_usec = 0;
+/**
+ * @brief Handle an unexpected or requested child exit, according to it's restart policy.
+ *
+ * @param a_process The process that exited, already reaped.
+ * @param a_state   The process state.
+ * @param a_reason  Human readable exit reason.
+ * @param a_failure True when it exited with a non-zero status or by a signal.
+ * @param a_fatal   True when, without a restart policy, this exit must stop the whole stack.
+ *
+ * @return True when the process will be restarted or it's exit was expected, false otherwise.
+ */
+bool casper::app::monitor::Watchdog::OnExit (::sys::Process& a_process, casper::app::monitor::Watchdog::State& a_state,
+                                             const std::string& a_reason, const bool a_failure, const bool a_fatal)
+{
+    const std::string id  = a_process.info().id_;
+    const pid_t       pid = a_process.pid();
     
-#endif
+    const bool was_ready = a_state.ready_;
+    const bool unhealthy = a_state.unhealthy_;
     
-    // ... monitor children ...
-    while ( false == (*abort_flag_) ) {
-
-        Child child = { 0, nullptr, "", false, INT_MIN, false, INT_MIN, false };
-        
-#if 0
+    // ... forget current run ...
+    Forget(a_process, a_state);
+    
+    // ... stopped by us, because it's pool shrunk?
+    if ( true == a_state.parked_ ) {
+        a_state.stopping_ = false;
         // ... log ...
-        CASPER_APP_DEBUG_LOG("status", "%s", "Waiting...");
-        
-        child.pid_ = waitpid(-1, &child.status_, wait_options);
-        
-#else
-
+        CASPER_APP_DEBUG_LOG("status", "%s ( %d ) %s, it won't be spawned, pool was scaled down...",
+                             id.c_str(), pid, a_reason.c_str()
+        );
+        return true;
+    }
+    
+    // ... stopped on request?
+    if ( true == a_state.halted_ ) {
+        a_state.stopping_ = false;
+        a_state.held_     = true;
         // ... log ...
-//        CASPER_APP_DEBUG_LOG("status", "Waiting, timeout in %d second(s)...", static_cast<int>(timeout.tv_sec));
-
-        bool polling_timeout = false;
-        
-        while ( false == (*abort_flag_) ) {
-            
-            const int rv = select(0, nullptr, nullptr, nullptr, &timeout);
-            if ( rv == -1 && errno == EINTR ) {
-                child.pid_ = waitpid(-1, &child.status_, wait_options);
-                if ( -1 == child.pid_ || child.pid_ > 0 ) {
-                    break;
-                }
-            } else if ( 0 == rv ) {
-                // ... timeout ..
-                polling_timeout = true;
-                break;
-            } else {
-                // ... error ...
-                break;
-            }
-        }
-
-        if ( true == polling_timeout ) {
-            continue;
-        }
-        
-        if ( true == (*abort_flag_ ) ) {
-            break;
-        }
-        
-#endif
-        
-        if ( -1 == child.pid_ ) {
-            const auto err_no = errno;
-            if ( SIGILL == err_no ) { // 4 - Interrupted system call
-                // ... log ...
-                CASPER_APP_DEBUG_LOG("status", "%s", "4 - Interrupted system call");
-                continue;
-                
-            }
-            CASPER_APP_MONITOR_SET_ERROR(nullptr, last_error_,
-                                         errno,
-                                         "%s", "an error occurred while monitoring children"
-            );
-            break;
+        CASPER_APP_DEBUG_LOG("status", "%s ( %d ) %s, it won't be spawned until it's restarted on request...",
+                             id.c_str(), pid, a_reason.c_str()
+        );
+        // ... dependants can't run without it ...
+        if ( true == was_ready ) {
+            StopDependants(id);
         }
-        
+        return true;
+    }
+    
+    // ... stopped by us, because a precedent is restarting?
+    if ( true == a_state.stopping_ ) {
+        a_state.stopping_ = false;
         // ... log ...
-        CASPER_APP_DEBUG_LOG("status", "%s", "Received signal...");
-        
-        CASPER_APP_WATCHDOG_LOCK();
-
-        for ( auto process : list_ ) {
-            if ( process->pid() == child.pid_ ) {
-                child.process_ = process;
-                break;
-            }
+        CASPER_APP_DEBUG_LOG("status", "%s ( %d ) stopped, it will be spawned as soon as it's precedents are ready...",
+                             id.c_str(), pid
+        );
+        // ... precedents might be ready already ...
+        return Launch();
+    }
+    
+    // ... crashing in a loop?
+    if ( true == a_state.quarantined_ ) {
+        a_state.held_ = true;
+        CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
+                                     ::sys::Error::k_no_error_,
+                                     "%s ( %d ) %s, quarantined after %zu crash(es) in %d ms, it won't be restarted", id.c_str(), pid, a_reason.c_str(),
+                                     a_state.crashed_.size(), a_state.crash_.window_ms_
+        );
+        // ... not fatal, everything else keeps running ...
+        if ( nullptr != listener_ptr_ ) {
+            listener_ptr_->OnError(last_error_, /* a_fatal */ false);
         }
- 
-        if ( nullptr == child.process_ ) {
-            CASPER_APP_MONITOR_SET_ERROR(child.process_, last_error_,
-                                         errno,
-                                         "an error occurred while monitoring child with pid %d: A signal was sent to a child that no longer exists?", child.pid_
-            );
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+        // ... dependants can't run without it ...
+        if ( true == was_ready ) {
+            StopDependants(id);
         }
-        
-        CASPER_APP_WATCHDOG_UNLOCK();
-        
-        // ... if an error is set, we're in a invalid state!
-        if ( true == IsErrorSet() ) {
-            break;
+        return true;
+    }
+    
+    // ... stopped by us, because it failed it's health checks: a failure, whatever it's exit status ...
+    const std::string reason  = ( true == unhealthy ? a_reason + " after failing it's health checks" : a_reason );
+    const bool        failure = ( true == unhealthy || true == a_failure );
+    const bool        fatal   = ( true == unhealthy || true == a_fatal );
+    
+    const bool restart = ( RestartPolicy::Always == a_state.restart_.policy_ || ( RestartPolicy::OnFailure == a_state.restart_.policy_ && true == failure ) );
+    if ( false == restart ) {
+        if ( RestartPolicy::Never == a_state.restart_.policy_ && true == fatal ) {
+            CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
+                                         ::sys::Error::k_no_error_,
+                                         "%s ( %d ) %s", id.c_str(), pid, reason.c_str()
+            );
+            return false;
         }
-        
-        CASPER_APP_WATCHDOG_LOCK();
-
         // ... log ...
-        CASPER_APP_DEBUG_LOG("status", "... for child %s ( %d )...",
-                             child.process_->info().id_.c_str(), child.pid_
+        CASPER_APP_DEBUG_LOG("status", "%s ( %d ) %s, it won't be restarted...",
+                             id.c_str(), pid, reason.c_str()
         );
-        
-        // ... check child status ...
-        if ( true == WIFEXITED(child.status_) ) {
-            // ... child terminated normally ...
-            child.terminated_ = true;
-            // ... grab exit status of the child ...
-            child.status_     = WEXITSTATUS(child.status_);
-            child.reason_     = "terminated normally";
-        } else if ( true == WIFSIGNALED(child.status_) ) {
-            // ... child process was signaled by a signal ...
-            child.signalled_ = true;
-            child.reason_    = "received signal ";
-            if ( true == WCOREDUMP(child.status_) ) {
-                // ... child produced a core dump ...
-                child.reason_ += " and produced a core dump";
-            } else {
-                //  ... grab number of the signal that caused the child process to terminate ...
-                child.signal_ = WTERMSIG(child.status_);
-                if ( SIGTRAP == child.signal_ ) {
-                    child.signalled_ = false;
-                }
-                child.reason_ += std::to_string(child.signal_);
-            }
-        } else if ( wait_options & WUNTRACED ) {
-            if ( true == WIFSTOPPED(child.status_) ) {
-                // ... child process was stopped by delivery of a signal ...
-                child.stopped_ = true;
-                child.reason_  = " was stopped by delivery of a signal";
-                // ... grab number of the signal which caused the child to stop ...
-                child.signal_ = WSTOPSIG(child.status_);
-                child.reason_ += " ( " + std::to_string(child.signal_) + " )";
-            }
-        } else if ( wait_options & WCONTINUED ) {
-            if ( true == WIFCONTINUED(child.status_) ) {
-                // ... child process was resumed by delivery of SIGCONT ...
-                child.reason_ += "resumed by delivery of SIGCONT";
-            }
+        a_state.held_ = true;
+        // ... dependants can't run without it ...
+        if ( true == was_ready ) {
+            StopDependants(id);
         }
-        
-        // ... log ...
-        CASPER_APP_DEBUG_LOG("status", "... %s...",
-                             child.reason_.c_str()
+        return true;
+    }
+    
+    // ... forget restarts outside window ...
+    const auto now = std::chrono::steady_clock::now();
+    while ( a_state.restarts_.size() > 0 && ( now - a_state.restarts_.front() ) > std::chrono::milliseconds(a_state.restart_.window_ms_) ) {
+        a_state.restarts_.pop_front();
+    }
+    
+    if ( a_state.restart_.max_retries_ >= 0 && a_state.restarts_.size() >= static_cast<size_t>(a_state.restart_.max_retries_) ) {
+        CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
+                                     ::sys::Error::k_no_error_,
+                                     "%s ( %d ) %s, giving up after %zu restart(s) in %d ms", id.c_str(), pid, reason.c_str(),
+                                     a_state.restarts_.size(), a_state.restart_.window_ms_
         );
-        
-        if ( true == child.terminated_ || true == child.signalled_ ) {
-            
-
-            if ( true == child.terminated_ || SIGTERM == child.signal_ || SIGQUIT == child.signal_ || SIGKILL == child.signal_  ) {
-                
-                CASPER_APP_MONITOR_SET_ERROR(child.process_, last_error_,
-                                             ::sys::Error::k_no_error_,
-                                             "%s ( %d ) %s", child.process_->info().id_.c_str(), child.process_->pid(), child.reason_.c_str()
-                );
-
-            }
-            
-        }
-
-        CASPER_APP_WATCHDOG_UNLOCK();
-        
-        if ( true == IsErrorSet() ) {
-            break;
-        }
-
+        return false;
     }
-
-    // ... log ...
-    CASPER_APP_DEBUG_LOG("status", "%s", "Cleanup...");
     
-    // ... uninstall signal(s) handler(s) ...
-    signal(SIGUSR2, SIG_DFL);
-    signal(SIGCHLD, SIG_DFL);
-    signal(SIGTERM, SIG_DFL);
-
-    CASPER_APP_WATCHDOG_LOCK();
+    // ... exponential backoff, with jitter ...
+    double delay = static_cast<double>(a_state.restart_.delay_ms_);
+    for ( size_t idx = 0 ; idx < a_state.restarts_.size() && delay < a_state.restart_.max_delay_ms_ ; ++idx ) {
+        delay *= a_state.restart_.multiplier_;
+    }
+    if ( delay > a_state.restart_.max_delay_ms_ ) {
+        delay = static_cast<double>(a_state.restart_.max_delay_ms_);
+    }
+    if ( a_state.restart_.jitter_ > 0.0 ) {
+        std::uniform_real_distribution<double> distribution(-a_state.restart_.jitter_, a_state.restart_.jitter_);
+        delay += delay * distribution(random_);
+    }
+    const int delay_ms = static_cast<int>(delay);
     
-    const pid_t my_pid = getpid();
+    a_state.restarts_.push_back(now);
+    a_state.restarted_ += 1;
+    a_state.held_       = true;
+    a_state.timer_      = reactor_.Schedule(delay_ms, [this, id] () { OnRestart(id); });
     
-    TerminateAll(/* a_optional */ true, my_pid);
-
-    std::list<const sys::Process*> interest;
-    for ( auto it : list_ ) {
-        interest.push_back(it);
+    Publish(Change::Restarting, id, 0, std::to_string(delay_ms) + " ms");
+    
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "%s ( %d ) %s, restarting in %d ms ( restart %zu )...",
+                         id.c_str(), pid, reason.c_str(), delay_ms, a_state.restarts_.size()
+    );
+    
+    // ... dependants must be restarted too ...
+    if ( true == was_ready ) {
+        StopDependants(id);
     }
+    
+    return true;
+}
 
-    std::list<const sys::Process*> pending;
-    if ( true == sys::Process::Filter(interest, pending) ) {
-        
-        while ( pending.size() > 0 ) {
-
-            CASPER_APP_DEBUG_LOG("status", "%lu process(es) remaining...", pending.size());
-
-            for ( std::list<const ::sys::Process*>::reverse_iterator it = pending.rbegin() ; pending.rend() != it ; ++it ) {
-                ::sys::Process* process = const_cast<::sys::Process*>(*it);
-                
-                bool is_running, is_zombie, erased = false;
-                
-                if ( ( true == process->IsRunning(/* a_optional */ true, /* a_parent_pid */ my_pid, is_running) && false == is_running )
-                    ||
-                    ( true == process->IsZombie(/* a_optional */ true, is_zombie) && true == is_zombie )
-                )
-                {
-                    for ( std::list<const sys::Process*>::iterator it2 = interest.begin(); interest.end() != it2 ; ++it2 ) {
-                        const ::sys::Process* p2 = (*it2);
-                        if ( p2 == process ) {
-                            erased = true;
-                            interest.erase(it2);
-                            break;
-                        }
-                    }
-                }
-                
-                CASPER_APP_DEBUG_LOG("status", "%s ( %d ) %s running...",
-                                     process->info().id_.c_str(), process->pid(), true == erased ? "no longer" : "still"
-                );
-                
-                if ( true == erased ) {
-                    (*process) = static_cast<pid_t>(0);
-                }
-                
-            }
-
-            CASPER_APP_WATCHDOG_UNLOCK();
-
-            Notify(SIGUSR2);
-            usleep(500*1000);
-
-            CASPER_APP_WATCHDOG_LOCK();
-
-            pending.clear();
-            if ( false == sys::Process::Filter(interest, pending) ) {
-                break;
-            }
-            
+/**
+ * @brief Called by reactor when a restart delay expired.
+ *
+ * @param a_id Process id.
+ */
+void casper::app::monitor::Watchdog::OnRestart (const std::string& a_id)
+{
+    CASPER_APP_WATCHDOG_LOCK();
+    
+    const auto it = states_.find(a_id);
+    if ( states_.end() != it ) {
+        it->second.timer_ = 0;
+        it->second.held_  = false;
+        // ... spawn it, as soon as it's precedents are ready ...
+        if ( false == Launch() ) {
+            CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
         }
     }
     
     CASPER_APP_WATCHDOG_UNLOCK();
-
-    Notify(SIGUSR2);
-
-    // ... log ...
-    CASPER_APP_DEBUG_LOG("status", "%s", "Shutting down...");
 }
 
 /**
- * @brief Kill all processes loaded processes.
- *
- * @param a_optional If true won't report failure when signal is not sent.
+ * @brief Publish a process state in status board.
  *
- * @return True on success, false otherwise.
+ * @param a_process The process.
+ * @param a_state   It's state.
  */
-bool casper::app::monitor::Watchdog::KillAll (const bool& a_optional, const pid_t a_parent_pid)
+void casper::app::monitor::Watchdog::Post (const ::sys::Process& a_process, const casper::app::monitor::Watchdog::State& a_state)
 {
-    return SignalAll(SIGKILL, a_optional, a_parent_pid);
+    ::casper::app::Board::State state;
+    if ( 0 != a_process.pid() ) {
+        if ( true == a_state.stopping_ || true == a_state.unhealthy_ || true == a_state.halted_ ) {
+            state = ::casper::app::Board::State::Stopping;
+        } else if ( true == a_state.ready_ ) {
+            state = ::casper::app::Board::State::Ready;
+        } else {
+            state = ::casper::app::Board::State::Starting;
+        }
+    } else if ( true == a_state.quarantined_ ) {
+        state = ::casper::app::Board::State::Quarantined;
+    } else if ( true == a_state.parked_ ) {
+        state = ::casper::app::Board::State::Parked;
+    } else if ( true == a_state.halted_ ) {
+        state = ::casper::app::Board::State::Held;
+    } else if ( true == a_state.held_ ) {
+        state = ( 0 != a_state.timer_ ? ::casper::app::Board::State::Restarting : ::casper::app::Board::State::Held );
+    } else {
+        state = ::casper::app::Board::State::Stopped;
+    }
+    board_.Set(a_process.info().id_, a_process.pid(), state, a_state.restarted_, a_state.started_);
 }
 
 /**
- * @brief Terminate all processes loaded processes.
+ * @brief Publish a process change, listener applies it to the most recent list it got.
  *
- * @param a_optional If true won't report failure when signal is not sent.
+ * @param a_kind   What changed.
+ * @param a_id     Process id.
+ * @param a_pid    Process pid, 0 when it's not running.
+ * @param a_detail Exit reason, restart delay or crossed threshold.
  *
- * @return True on success, false otherwise.
+ * @note Mutex must be locked, so events and lists are delivered in sequence order.
  */
-bool casper::app::monitor::Watchdog::TerminateAll (const bool& a_optional, const pid_t a_parent_pid)
+void casper::app::monitor::Watchdog::Publish (const casper::app::monitor::Watchdog::Change a_kind, const std::string& a_id, const pid_t a_pid,
+                                              const std::string& a_detail)
 {
-    return SignalAll(SIGTERM, a_optional, a_parent_pid);
+    sequence_++;
+    if ( nullptr != listener_ptr_ ) {
+        listener_ptr_->OnProcessChanged({ /* sequence_ */ sequence_, /* kind_ */ a_kind, /* id_ */ a_id, /* pid_ */ a_pid, /* detail_ */ a_detail });
+    }
 }
 
 /**
- * @brief Signal all processes loaded processes.
- *
- * @param a_no       Signal number to send.
- * @param a_optional If true won't report failure when signal is not sent.
+ * @brief Terminate all running processes that directly or indirectly depend on a process.
  *
- * @return True on success, false otherwise.
+ * @param a_id Process id.
  */
-bool casper::app::monitor::Watchdog::SignalAll (const int a_no, const bool& a_optional, const pid_t a_parent_pid)
+void casper::app::monitor::Watchdog::StopDependants (const std::string& a_id)
 {
-    // ... reverse terminate process(es) ...
-    for ( std::list<::sys::Process*>::reverse_iterator it = list_.rbegin() ; list_.rend() != it ; ++it ) {
-        
-        ::sys::Process* process = (::sys::Process*)(*it);
+    std::set<std::string>   down    = { a_id };
+    std::deque<std::string> pending = { a_id };
+    
+    // ... only direct and indirect dependants are visited ...
+    while ( pending.size() > 0 ) {
         
-        // ... try to send a signal to process ...
-        bool is_running, is_zombie = false;
+        const std::string precedent = pending.front();
+        pending.pop_front();
         
-        if ( ( true == process->IsRunning(/* a_optional */ true, /* a_parent_pid */ 0 != a_parent_pid ? a_parent_pid : 1, is_running) && true == is_running )
-                ||
-             ( true == process->IsZombie(/* a_optional */ true, is_zombie) && true == is_zombie )
-        ) {
-            if ( false == process->Signal(a_no, a_optional) ) {
-                // ... error should be set, nothing else to do here ...
-                if ( a_optional == false ) {
-                    return false;
-                }
+        for ( auto process : registry_.Dependants(precedent) ) {
+            
+            // ... it might depend on more than one of them ...
+            if ( false == down.insert(process->info().id_).second ) {
+                continue;
+            }
+            pending.push_back(process->info().id_);
+            
+            State& state = states_[process->info().id_];
+            state.ready_ = false;
+            
+            if ( false == state.spawned_ || true == state.stopping_ ) {
+                continue;
             }
+            
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "Stopping %s ( %d ), %s is down...",
+                                 process->info().id_.c_str(), process->pid(), a_id.c_str()
+            );
+            
+            // ... killed if it does not stop within it's stop timeout, it's exit lets it be respawned ...
+            state.stopping_ = true;
+            Retire(*process, state);
         }
-        
-        // ... log ...
-        CASPER_APP_DEBUG_LOG("status", "%-30s %-4d %-8d %c%c",
-                             process->info().id_.c_str(),
-                             a_no,
-                             static_cast<int>(process->pid()),
-                             is_running ? 'R' : '-', is_zombie ? 'Z' : '-'
-        );
+    }
+}
 
+/**
+ * @brief Forget a process current run, it's exit was already reaped.
+ *
+ * @param a_process The process that exited.
+ * @param a_state   It's state.
+ */
+void casper::app::monitor::Watchdog::Forget (::sys::Process& a_process, casper::app::monitor::Watchdog::State& a_state)
+{
+    if ( -1 != a_state.exec_fd_ ) {
+        reactor_.Remove(a_state.exec_fd_);
+        close(a_state.exec_fd_);
+        a_state.exec_fd_ = -1;
+    }
+    if ( 0 != a_state.timer_ ) {
+        reactor_.Cancel(a_state.timer_);
+        a_state.timer_ = 0;
     }
     
-    // ... done ...
-    return true;
+    sampler_.Untrack(a_process.info().id_);
+    checker_.Untrack(a_process.info().id_);
+    registry_.Unindex(&a_process);
+    
+    // ... workers or backends might have outlived it ...
+    Sweep(a_process);
+    
+    a_process          = static_cast<pid_t>(0);
+    a_state.spawned_   = false;
+    a_state.ready_     = false;
+    a_state.adopted_   = false;
+    a_state.trace_us_  = 0;
+    a_state.unhealthy_ = false;
 }
 
-#ifdef __APPLE__
-#pragma mark -
-#endif
-
 /**
- * @brief Spawn a new process by fork-exec combination.
+ * @brief Kill what is left of a process tree, after it's root exited.
  *
- * @param a_process       The process that requested this action.
- * @param a_block_sigchld When true SIGCHLD will be blocked.
+ * @param a_process The process that exited, it's pid is still set.
  *
- * @return True on success, false on failure.
+ * @note Children are spawned as session leaders, so all processes of their group belong to their tree,
+ *       even if they were reparented. SIGKILL is used because no one is left to stop them gracefully.
+ *       It never blocks: the process table is only read when the group is not empty, and whether SIGKILL
+ *       emptied it is checked later by a reactor timer.
  */
-bool casper::app::monitor::Watchdog::Spawn (::sys::Process& a_process, const bool& a_block_sigchld)
+void casper::app::monitor::Watchdog::Sweep (const ::sys::Process& a_process)
 {
-    sigset_t sigmask;
-    sigset_t saved_sigmask;
-
-    // ... reset all signals ...
-    sigemptyset(&sigmask);
-    pthread_sigmask(SIG_SETMASK, &sigmask, NULL);
-
-    // ... block SIGCHLD?
-    if ( true == a_block_sigchld ) {
-        sigaddset(&sigmask, SIGCHLD);
-        pthread_sigmask(SIG_BLOCK, &sigmask, &saved_sigmask);
+    const pid_t pid = a_process.pid();
+    if ( pid <= 0 ) {
+        return;
     }
-
+    
+    // ... cheap probe first, most trees are gone with their root ...
+    if ( 0 != killpg(pid, 0) ) {
+        return;
+    }
+    
+    const auto count = [this, pid] () -> size_t {
+        size_t rv = 0;
+        for ( const auto& it : table_.entries() ) {
+            if ( pid == it.second.pgid_ && 'Z' != it.second.state_ && 'X' != it.second.state_ ) {
+                rv++;
+            }
+        }
+        return rv;
+    };
+    
+    if ( false == table_.Refresh() ) {
+        last_error_ = table_.error();
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+        return;
+    }
+    
+    const size_t leftovers = count();
+    if ( 0 == leftovers ) {
+        return;
+    }
+    
     // ... log ...
-    CASPER_APP_DEBUG_LOG("status",
-                         "1) %s", a_process.uri().c_str()
+    CASPER_APP_DEBUG_LOG("status", "%s ( %d ) exited, killing %zu leftover process(es) of it's group...",
+                         a_process.info().id_.c_str(), pid, leftovers
     );
     
-    a_process = fork();    
-    
-    if ( 0 > a_process.pid() ) { // ... unable to fork ...
+    // ... group id can't be reused while it has members ...
+    if ( 0 != killpg(pid, SIGKILL) && ESRCH != errno ) {
         CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
                                      errno,
-                                     "unable to launch '%s' - fork failure", a_process.uri().c_str()
+                                     "unable to kill process group %d", pid
         );
-        return false;
-    } else if ( 0 == a_process.pid() ) { // ... child ...
-        
-        // ... close ALL open files ...
-        const int max = getdtablesize();
-        // ... but skip 0 - stdin, 1 - stdout, 2 - stderr ....
-        for ( int n = 3; n < max; n++ ) {
-            close(n);
-        }
-
-        // ... restart logger ...
-        if ( true == detached_ ) {
-            casper::app::Logger::GetInstance().Restart("watchdog", a_process.info().id_.c_str());
-        }
-        
-        // ... redirect stdout and stderr to a file
-        const std::list<std::pair<FILE*, std::string>> redirect_list = {
-            { stdout, a_process.info().log_dir_ + a_process.info().id_ + "-stdout.log" },
-            { stderr, a_process.info().log_dir_ + a_process.info().id_ + "-stderr.log" }
-        };
-        
-        if ( false == Redirect(a_process, redirect_list) ) {
-            CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
-        }
-
-        // ... create session and set process group ID ...
-        setsid();
-        
-        // ... set pid ...
-        a_process = getpid();
-        
-        // ... signal parent ...
-        kill(getppid(), SIGUSR2);
-        
-        // ... log ...
-        CASPER_APP_DEBUG_LOG("status",
-                             "2) %s", a_process.uri().c_str()
-        );
-        
-        // ... execute process ...
-        if ( false == Exec(a_process) ) {
-            CASPER_APP_WATCHDOG_FATAL_BITE_UNSAFE();
-        }
-        
-    } /* else { ... } - parent */
-    
-    // ... restore the signal mask?
-    if ( true == a_block_sigchld ) {
-        pthread_sigmask(SIG_SETMASK, &saved_sigmask, NULL);
+        CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+        return;
     }
     
-    // ... done ...
-    return true;
+    // ... not our children, exit can only be polled - later, from the reactor ...
+    const std::string id = a_process.info().id_;
+    (void)reactor_.Schedule(200, [this, id, pid, count] () {
+        if ( 0 != killpg(pid, 0) ) {
+            return;
+        }
+        CASPER_APP_WATCHDOG_LOCK();
+        const size_t left = ( true == table_.Refresh() ? count() : 0 );
+        if ( left > 0 ) {
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "%s ( %d ) group still has %zu process(es) after SIGKILL, giving up...",
+                                 id.c_str(), pid, left
+            );
+        }
+        CASPER_APP_WATCHDOG_UNLOCK();
+    });
 }
 
 /**
- * @brief Exec a child process, assuming fork was already called.
+ * @brief Stop all running processes, or some of them, dependants first.
  *
- * @param a_process The process to be launched.
+ * @param a_ids     Processes to stop, nullptr for all.
+ * @param o_exits   When stopping only some processes, other processes exits that were reaped meanwhile.
  *
- * @return True on success, false on failure.
+ * @note Dependency levels are stopped from the highest to the lowest one, all processes of a level are signalled
+ *       at once and the next level is only stopped when all of them exited ( as reported by the reactor ).
+ *       A process that does not exit within it's 'stop_timeout' is killed.
  */
-bool casper::app::monitor::Watchdog::Exec (::sys::Process& a_process)
+void casper::app::monitor::Watchdog::Shutdown (const std::set<std::string>* a_ids, std::vector<Reactor::Exit>* o_exits)
 {
-    const std::string uri  = a_process.uri();
-    const std::string args = a_process.info().arguments_;
-
-    // ... log ...
-    CASPER_APP_DEBUG_LOG("status",
-                         "%s %s", uri.c_str(), args.c_str()
-    );
+    ::casper::app::Tracer::Span span(( nullptr != a_ids ? "Partial Shutdown" : "Shutdown" ));
     
-    // ... write pid ...
-    if ( false == a_process.WritePID() ) {
-        // ... error already set ...
-        return false;
-    }
+    const auto start_tp = std::chrono::steady_clock::now();
     
-    // ... the child process if the parent dies ...
-    // LINUX ONLY: prctl(PR_SET_PDEATHSIG, SIGHUP);
+    int64_t                      level_us = 0; // ... when current level was signalled ...
+    std::map<pid_t, std::string> pending;
+    std::vector<uint64_t>        timers;
+    size_t                       stopped = 0;
+    size_t                       killed  = 0;
     
-    // TODO CW: confirm this
-    signal(SIGINT , SIG_DFL);
-    signal(SIGHUP , SIG_DFL);
-    signal(SIGTERM, SIG_DFL);
-    signal(SIGUSR2, SIG_DFL);
-    signal(SIGPIPE, SIG_DFL);
-    // TODO CW: fix this?
-    signal(SIGTRAP, SIG_DFL);
+    CASPER_APP_WATCHDOG_LOCK();
     
-    // TODO
-    // Clear(); ?
-
-    if ( -1 == setenv("PATH", a_process.info().path_.c_str(), 1) ) {
-        CASPER_APP_LOG("status",
-                       "WARNING: Failed to set environment variable 'PATH' to '%s', while preparing to execute %s!",
-                        a_process.info().path_.c_str(), a_process.info().executable_.c_str()
-        );
+    // ... nothing else will be probed, spawned or restarted ...
+    for ( auto& it : states_ ) {
+        if ( nullptr != a_ids && a_ids->end() == a_ids->find(it.first) ) {
+            continue;
+        }
+        if ( 0 != it.second.timer_ ) {
+            reactor_.Cancel(it.second.timer_);
+            it.second.timer_ = 0;
+        }
+        it.second.held_ = true;
     }
     
-    (void)execvP(a_process.info().executable_.c_str(), a_process.info().path_.c_str(), a_process.argv());    
+    CASPER_APP_WATCHDOG_UNLOCK();
     
-    // ... if it reaches here, an error occurred with execvP ...
-    CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
-                                 errno,
-                                 "unable to start '%s' - exec failure", a_process.uri().c_str()
-    );
+    // ... called by reactor when a process did not exit within it's grace period ...
+    const auto escalate = [this, &pending, &timers, &killed] (const pid_t a_pid, const int a_timeout_ms) {
+        CASPER_APP_WATCHDOG_LOCK();
+        ::sys::Process* process = registry_.Find(a_pid);
+        if ( nullptr != process && pending.end() != pending.find(a_pid) ) {
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "%s ( %d ) did not stop within %d ms, killing it...",
+                                 process->info().id_.c_str(), a_pid, a_timeout_ms
+            );
+            if ( false == process->Kill(/* a_optional */ true) ) {
+                last_error_ = process->error();
+                CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+            }
+            killed++;
+            // ... SIGKILL can't be ignored, but an exit might never be reported ( uninterruptible sleep ) ...
+            timers.push_back(reactor_.Schedule(5000, [this, &pending, a_pid] () {
+                CASPER_APP_WATCHDOG_LOCK();
+                const auto it = pending.find(a_pid);
+                if ( pending.end() != it ) {
+                    // ... log ...
+                    CASPER_APP_DEBUG_LOG("status", "%s ( %d ) still running after SIGKILL, giving up...",
+                                         it->second.c_str(), a_pid
+                    );
+                    pending.erase(it);
+                }
+                CASPER_APP_WATCHDOG_UNLOCK();
+            }));
+        }
+        CASPER_APP_WATCHDOG_UNLOCK();
+    };
+    
+    // ... called by reactor when a process exited, it was already reaped ...
+    const auto on_exit = [this, &pending, &start_tp, &level_us, &stopped, o_exits] (const Reactor::Exit& a_exit) {
+        CASPER_APP_WATCHDOG_LOCK();
+        // ... not one of ours? it must be handled as usual ...
+        if ( nullptr != o_exits && pending.end() == pending.find(a_exit.pid_) ) {
+            o_exits->push_back(a_exit);
+            CASPER_APP_WATCHDOG_UNLOCK();
+            return;
+        }
+        ::sys::Process* process = registry_.Find(a_exit.pid_);
+        if ( nullptr != process ) {
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "%s ( %d ) stopped after %lld ms...",
+                                 process->info().id_.c_str(), a_exit.pid_,
+                                 static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_tp).count())
+            );
+            ::casper::app::Tracer::GetInstance().Complete("Stop", level_us, ::casper::app::Tracer::Now(), static_cast<uint64_t>(a_exit.pid_), process->info().id_);
+            Record(*process, states_[process->info().id_], a_exit, "stopped by monitor");
+            Forget(*process, states_[process->info().id_]);
+            Post(*process, states_[process->info().id_]);
+            stopped++;
+        }
+        pending.erase(a_exit.pid_);
+        CASPER_APP_WATCHDOG_UNLOCK();
+    };
+    
+    for ( size_t level = registry_.levels().size() ; level-- > 0 ; ) {
+        
+        CASPER_APP_WATCHDOG_LOCK();
+        
+        level_us = ::casper::app::Tracer::Now();
+        
+        // ... signal all processes of this level at once ...
+        for ( auto process : registry_.levels()[level] ) {
+            
+            if ( nullptr != a_ids && a_ids->end() == a_ids->find(process->info().id_) ) {
+                continue;
+            }
+            
+            const State& state = states_[process->info().id_];
+            const pid_t  pid   = process->pid();
+            
+            if ( false == state.spawned_ || 0 == pid ) {
+                continue;
+            }
+            
+            // ... log ...
+            CASPER_APP_DEBUG_LOG("status", "Stopping %s ( %d ) with signal %d, grace period is %d ms...",
+                                 process->info().id_.c_str(), pid, state.stop_.signal_, state.stop_.timeout_ms_
+            );
+            
+            if ( false == process->Signal(state.stop_.signal_, /* a_optional */ true) ) {
+                last_error_ = process->error();
+                CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+            }
+            
+            pending[pid] = process->info().id_;
+            
+            const int timeout_ms = state.stop_.timeout_ms_;
+            timers.push_back(reactor_.Schedule(timeout_ms, [&escalate, pid, timeout_ms] () { escalate(pid, timeout_ms); }));
+        }
+        
+        CASPER_APP_WATCHDOG_UNLOCK();
+        
+        // ... wait for all of them to exit ...
+        while ( pending.size() > 0 ) {
+            if ( false == reactor_.Wait(/* a_timeout_ms */ -1, on_exit, [this] (const int a_signal_no) { Notify(a_signal_no); }) ) {
+                CASPER_APP_WATCHDOG_LOCK();
+                last_error_ = reactor_.error();
+                CASPER_APP_WATCHDOG_BARK_ONCE_UNSAFE();
+                CASPER_APP_WATCHDOG_UNLOCK();
+                pending.clear();
+            }
+        }
+        
+        // ... timers capture local data, they can't outlive this function ...
+        for ( auto timer : timers ) {
+            reactor_.Cancel(timer);
+        }
+        timers.clear();
+        
+        Notify(SIGUSR2);
+    }
     
-    // ... failure ...
-    return false;
+    // ... log ...
+    CASPER_APP_DEBUG_LOG("status", "%s took %lld ms, %zu process(es) stopped, %zu killed...",
+                         ( nullptr != a_ids ? "Partial shutdown" : "Shutdown" ),
+                         static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_tp).count()),
+                         stopped, killed
+    );
 }
 
 /**
@@ -1065,50 +4085,6 @@ bool casper::app::monitor::Watchdog::EnsureRequirements (const ::sys::Process& a
     return ( false == IsErrorSetUnsafe() );
 }
 
-/**
- * @brief Redirect a FILE* output to a file.
- *
- * @param a_process The \link Process \link that wants to redirect.
- * @param a_list    The list of FILE* to redirect.
- *
- * @return True on success, false on failure.
- */
-bool casper::app::monitor::Watchdog::Redirect (const ::sys::Process& a_process,
-                                               const std::list<std::pair<FILE *, std::string>>& a_list)
-{
-    // TODO CW : check why S_IWGRP does't stick
-    const int mode        = O_RDWR | O_CREAT | O_APPEND;                     /* Open for Read and Write, Create if doesn't exist or Append */
-    const int permissions = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH; /* Grant User Read and Write permissions, Read for Group and all others */
-    
-    // ... redirect all streams to a file ...
-    for ( auto it : a_list ) {
-        
-        const int src_fd = fileno(it.first);
-        const int dst_fd = open(it.second.c_str(), mode, permissions);
-        
-        // ... log ...
-        CASPER_APP_DEBUG_LOG("status",
-                             "redirecting %s fd %d to %d ( %s ) ", a_process.info().id_.c_str(), src_fd, dst_fd, it.second.c_str()
-        );
-
-        if ( -1 == dst_fd ) {
-            CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
-                                         errno,
-                                         "unable to open %s for stream redirect", it.second.c_str()
-            );
-        } else if ( -1 == dup2(dst_fd, src_fd) ) {
-            CASPER_APP_MONITOR_SET_ERROR(&a_process, last_error_,
-                                         errno,
-                                         "unable to duplicate fd %d for stream redirect to %s", src_fd, it.second.c_str()
-            );
-        }
-        
-    }
-    
-    // ... done ...
-    return ( false == IsErrorSetUnsafe() );
-}
-
 #ifdef __APPLE__
 #pragma mark -
 #endif
@@ -1122,11 +4098,104 @@ void casper::app::monitor::Watchdog::OnSignal (int a_signal_no)
 {
     casper::app::monitor::Watchdog& instance = casper::app::monitor::Watchdog::GetInstance();
     
-    // ... log ...
-    CASPER_APP_DEBUG_LOG("status", "%2d", a_signal_no);
-    
     // ... notify parent?
     if ( getpid() == instance.main_pid_ ) {
-        instance.Notify(a_signal_no);
+        // ... listener will be notified by loop thread ...
+        instance.reactor_.Raise(a_signal_no);
+    }
+}
+
+/**
+ * @brief Compare two process definitions.
+ *
+ * @param a_lhs Left hand side.
+ * @param a_rhs Right hand side.
+ *
+ * @return True when a running process does not need to be restarted to apply the new definition, false otherwise.
+ */
+bool casper::app::monitor::Watchdog::Equals (const ::sys::Process::Info& a_lhs, const ::sys::Process::Info& a_rhs)
+{
+    return (
+            a_lhs.id_          == a_rhs.id_          &&
+            a_lhs.owner_       == a_rhs.owner_       &&
+            a_lhs.path_        == a_rhs.path_        &&
+            a_lhs.executable_  == a_rhs.executable_  &&
+            a_lhs.arguments_   == a_rhs.arguments_   &&
+            a_lhs.user_        == a_rhs.user_        &&
+            a_lhs.group_       == a_rhs.group_       &&
+            a_lhs.working_dir_ == a_rhs.working_dir_ &&
+            a_lhs.log_dir_     == a_rhs.log_dir_     &&
+            a_lhs.pid_file_    == a_rhs.pid_file_    &&
+            a_lhs.depends_on_  == a_rhs.depends_on_
+    );
+}
+
+/**
+ * @brief Compare two sets of process options.
+ *
+ * @param a_lhs Left hand side.
+ * @param a_rhs Right hand side.
+ *
+ * @return True when both readiness probes, health checks, crash handling, restart policies, stop signals and listening sockets are the same, false otherwise.
+ */
+bool casper::app::monitor::Watchdog::Equals (const casper::app::monitor::Watchdog::Options& a_lhs,
+                                             const casper::app::monitor::Watchdog::Options& a_rhs)
+{
+    if ( a_lhs.ready_when_ != a_rhs.ready_when_ ) {
+        return false;
+    }
+    if ( true == a_lhs.ready_when_ && (
+            a_lhs.probe_.kind_        != a_rhs.probe_.kind_        ||
+            a_lhs.probe_.host_        != a_rhs.probe_.host_        ||
+            a_lhs.probe_.port_        != a_rhs.probe_.port_        ||
+            a_lhs.probe_.path_        != a_rhs.probe_.path_        ||
+            a_lhs.probe_.pattern_     != a_rhs.probe_.pattern_     ||
+            a_lhs.probe_.command_     != a_rhs.probe_.command_     ||
+            a_lhs.probe_.interval_ms_ != a_rhs.probe_.interval_ms_ ||
+            a_lhs.probe_.timeout_ms_  != a_rhs.probe_.timeout_ms_  ||
+            a_lhs.probe_.retries_     != a_rhs.probe_.retries_
+        )
+    ) {
+        return false;
+    }
+    if ( a_lhs.crash_.core_ != a_rhs.crash_.core_ || ( true == a_lhs.crash_.core_ && a_lhs.crash_.core_limit_ != a_rhs.crash_.core_limit_ )
+        || a_lhs.crash_.quarantine_ != a_rhs.crash_.quarantine_ || a_lhs.crash_.window_ms_ != a_rhs.crash_.window_ms_ ) {
+        return false;
+    }
+    if ( a_lhs.checked_ != a_rhs.checked_ ) {
+        return false;
     }
+    if ( true == a_lhs.checked_ && (
+            a_lhs.check_.kind_           != a_rhs.check_.kind_           ||
+            a_lhs.check_.host_           != a_rhs.check_.host_           ||
+            a_lhs.check_.port_           != a_rhs.check_.port_           ||
+            a_lhs.check_.path_           != a_rhs.check_.path_           ||
+            a_lhs.check_.interval_ms_    != a_rhs.check_.interval_ms_    ||
+            a_lhs.check_.timeout_ms_     != a_rhs.check_.timeout_ms_     ||
+            a_lhs.check_.failures_       != a_rhs.check_.failures_       ||
+            a_lhs.check_.max_latency_ms_ != a_rhs.check_.max_latency_ms_ ||
+            a_lhs.check_.sustain_ms_     != a_rhs.check_.sustain_ms_
+        )
+    ) {
+        return false;
+    }
+    if ( a_lhs.listen_.size() != a_rhs.listen_.size() ) {
+        return false;
+    }
+    for ( size_t idx = 0 ; idx < a_lhs.listen_.size() ; ++idx ) {
+        if ( Sockets::Name(a_lhs.listen_[idx]) != Sockets::Name(a_rhs.listen_[idx]) || a_lhs.listen_[idx].backlog_ != a_rhs.listen_[idx].backlog_ ) {
+            return false;
+        }
+    }
+    return (
+            a_lhs.restart_.policy_       == a_rhs.restart_.policy_       &&
+            a_lhs.restart_.delay_ms_     == a_rhs.restart_.delay_ms_     &&
+            a_lhs.restart_.max_delay_ms_ == a_rhs.restart_.max_delay_ms_ &&
+            a_lhs.restart_.multiplier_   == a_rhs.restart_.multiplier_   &&
+            a_lhs.restart_.jitter_       == a_rhs.restart_.jitter_       &&
+            a_lhs.restart_.max_retries_  == a_rhs.restart_.max_retries_  &&
+            a_lhs.restart_.window_ms_    == a_rhs.restart_.window_ms_    &&
+            a_lhs.stop_.signal_          == a_rhs.stop_.signal_          &&
+            a_lhs.stop_.timeout_ms_      == a_rhs.stop_.timeout_ms_
+    );
 }
@@ -27,19 +27,38 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <stdlib.h> // malloc, free
 #include <string.h> // strdup
+#include <sys/resource.h> // struct rlimit
 #include <thread>
 #include <mutex>
 #include <functional>
 #include <atomic>  // std::atomic
+#include <chrono>  // std::chrono
+#include <deque>   // std::deque
+#include <random>  // std::minstd_rand
 
 #include "cc/singleton.h"
 #include "casper/app/logger.h"
 
 #include "osal/condition_variable.h"
 
-#include "sys/darwin/process.h"
+#include "casper/app/monitor/process.h"
+#include "casper/app/monitor/reactor.h"
+#include "casper/app/monitor/probe.h"
+#include "casper/app/monitor/sampler.h"
+#include "casper/app/monitor/collector.h"
+#include "casper/app/monitor/watcher.h"
+#include "casper/app/monitor/sockets.h"
+#include "casper/app/monitor/registry.h"
+#include "casper/app/monitor/scaler.h"
+#include "casper/app/monitor/process_table.h"
+#include "casper/app/monitor/health.h"
+#include "casper/app/monitor/crashes.h"
+#include "casper/app/monitor/runs.h"
+
+#include "casper/app/board.h"
 
 #include "cc/exception.h"
 
@@ -76,6 +95,37 @@ namespace casper
                 
             public: // Data Type(s)
 
+                enum class Change : uint8_t {
+                    Spawned = 0, //!< It's running, with a new pid.
+                    Ready,       //!< It's readiness probe ( if any ) succeeded.
+                    Exited,      //!< It's no longer running, detail is the exit reason.
+                    Restarting,  //!< It will be spawned again, detail is the restart delay.
+                    Threshold    //!< A resource usage threshold was crossed, detail describes it.
+                };
+                
+                enum class Command : uint8_t {
+                    Restart = 0, //!< Stop it ( if running ) and spawn it again, a stopped, held or quarantined process is just spawned.
+                    Stop,        //!< Stop it, it won't be spawned again until it's restarted on request.
+                    Signal       //!< Send it a signal, it's exit ( if any ) is handled as usual.
+                };
+                
+                enum class Outcome : uint8_t {
+                    Done = 0, //!< Done, or being done - exits and spawns are asynchronous.
+                    Unknown,  //!< No such process.
+                    Refused,  //!< Not possible in it's current state.
+                    Failed    //!< Attempted, but it failed.
+                };
+                
+                typedef std::function<void(const Outcome a_outcome, const std::string& a_detail)> Acknowledge;
+                
+                typedef struct {
+                    uint64_t    sequence_; //!< Consecutive events differ by one, a gap means events were lost.
+                    Change      kind_;
+                    std::string id_;       //!< Process id.
+                    pid_t       pid_;      //!< Process pid, 0 when it's not running.
+                    std::string detail_;
+                } Event;
+
                 class Listener
                 {
                     
@@ -91,20 +141,135 @@ namespace casper
                     
                 public: // API Pure Virtual Method(s) / Function(s)
                     
-                    virtual void OnRunningProcessesUpdated (const ::sys::Process::List& a_list             ) = 0;
-                    virtual void OnError                   (const ::sys::Error& a_error, const bool a_fatal) = 0;
-                    virtual void OnTerminated              ()                                                = 0;
+                    virtual void OnRunningProcessesUpdated (const ::sys::Process::List& a_list, const uint64_t a_sequence) = 0;
+                    virtual void OnProcessChanged          (const Event& a_event                                    ) = 0;
+                    virtual void OnError                   (const ::sys::Error& a_error, const bool a_fatal          ) = 0;
+                    virtual void OnTerminated              ()                                                          = 0;
                     
                 }; // end of class 'Listener'
                 
+            private: // Data Type(s)
+                
+                enum class RestartPolicy : uint8_t {
+                    Never = 0, //!< Any exit is fatal, the whole stack is stopped.
+                    OnFailure, //!< Restart when it exits with a non-zero status or by a signal.
+                    Always     //!< Restart on any exit.
+                };
+                
+                typedef struct {
+                    RestartPolicy policy_;
+                    int           delay_ms_;     //!< First restart delay.
+                    int           max_delay_ms_; //!< Maximum restart delay.
+                    double        multiplier_;   //!< Delay multiplier, applied for each restart within window.
+                    double        jitter_;       //!< Fraction of delay, [0, 1], randomly added or subtracted.
+                    int           max_retries_;  //!< Maximum number of restarts within window, -1 for unlimited.
+                    int           window_ms_;    //!< Restarts older than this are forgotten.
+                } Restart;
+                
+                typedef struct {
+                    int signal_;     //!< Signal sent first.
+                    int timeout_ms_; //!< Grace period, SIGKILL is sent when it expires.
+                } Halt;
+                
+                typedef struct {
+                    bool    core_;       //!< True when core dumps size limit must be set, otherwise monitor's limit is inherited.
+                    int64_t core_limit_; //!< RLIMIT_CORE, in bytes, -1 for unlimited, only valid when core_ is true.
+                    int     quarantine_; //!< Number of crashes within window that stop it from being restarted, 0 to disable.
+                    int     window_ms_;  //!< Crashes older than this are forgotten.
+                } Crash;
+                
+                typedef struct {
+                    bool                          ready_when_; //!< True when a readiness probe is configured.
+                    Probe::Config                 probe_;      //!< Readiness probe, only valid when ready_when_ is true.
+                    Restart                       restart_;    //!< Restart policy.
+                    Halt                          stop_;       //!< How to stop it.
+                    std::vector<Sockets::Address> listen_;     //!< Sockets bound by the watchdog, passed as fds 3, 4, ... ( LISTEN_FDS ).
+                    std::string                   pool_;       //!< Pool id, empty when it's not a pool instance.
+                    size_t                        instance_;   //!< Instance number within pool, 1 based, 0 when it's not a pool instance.
+                    bool                          checked_;    //!< True when a health check is configured.
+                    Health::Check                 check_;      //!< Health check, only valid when checked_ is true.
+                    Crash                         crash_;      //!< Core dumps and crash loop handling.
+                    bool                          limited_;    //!< True when resource usage thresholds are configured.
+                    Sampler::Limits               limits_;     //!< Resource usage thresholds, only valid when limited_ is true.
+                } Options;
+                
+                enum class SpawnMode : uint8_t {
+                    Fork = 0,  //!< fork, close all inherited fds, redirect, setsid and exec.
+                    PosixSpawn //!< posix_spawn, redirects and session expressed as file actions and attributes.
+                };
+                
+                typedef struct {
+                    size_t  count_;    //!< Number of spawns.
+                    int64_t total_us_; //!< Sum of time spent spawning, in microseconds.
+                    int64_t max_us_;   //!< Slowest spawn, in microseconds.
+                } SpawnStats;
+                
+                enum class Adoption : uint8_t {
+                    Adopted = 0, //!< Started by a previous monitor and still matching it's definition, it keeps running.
+                    Stale,       //!< Not running, or it's pid was reused by an unrelated process.
+                    Changed      //!< Started by a previous monitor, but it no longer matches it's definition.
+                };
+                
+                typedef struct {
+                    bool enabled_;     //!< True when configuration file changes must be applied.
+                    int  debounce_ms_; //!< Changes are applied when no other change happens within this period.
+                } Watch;
+                
+                typedef std::deque<std::chrono::steady_clock::time_point> History;
+                
+                typedef struct {
+                    Command     command_;
+                    std::string id_;          //!< Process id.
+                    int         signal_;      //!< Signal only, signal number.
+                    Acknowledge acknowledge_; //!< Called by loop thread, without mutex locked.
+                } Order;
+                
+                typedef struct {
+                    size_t   level_;       //!< Dependency level, 0 when it does not depend on any other process.
+                    bool     spawned_;     //!< True when it was already forked.
+                    bool     ready_;       //!< True when it was successfully executed and it's readiness probe ( if any ) succeeded.
+                    bool     held_;        //!< True when it must not be spawned ( restart delay pending or finished ).
+                    bool     stopping_;    //!< True when it was signalled by the watchdog, exit is expected.
+                    bool     adopted_;     //!< True when it was started by a previous monitor, it's exit status won't be known.
+                    int      exec_fd_;     //!< Read end of exec status pipe, -1 when not waiting for it.
+                    Probe*   probe_;       //!< Readiness probe, nullptr when a successful exec is enough.
+                    Restart  restart_;     //!< Restart policy.
+                    History  restarts_;    //!< Restarts within current window.
+                    uint64_t timer_;       //!< Pending reactor timer ( probe or restart ), 0 when none.
+                    Halt     stop_;        //!< How to stop it.
+                    bool     parked_;      //!< True when it's a pool instance above current pool size, it must not run.
+                    int64_t  trace_us_;    //!< Start of current trace span ( waiting, exec or probe ), 0 when none.
+                    bool     unhealthy_;   //!< True when it was stopped because it failed it's health checks.
+                    Crash    crash_;       //!< Core dumps and crash loop handling.
+                    History  crashed_;     //!< Crashes within quarantine window.
+                    bool     quarantined_; //!< True when it crashed too often, it won't be restarted until it's definition changes.
+                    int64_t  started_;     //!< When it was last spawned, in milliseconds since epoch, 0 when unknown.
+                    uint32_t restarted_;   //!< Number of restarts since it was loaded.
+                    bool     halted_;      //!< True when it was stopped on request, it won't be spawned until it's restarted on request.
+                } State;
+                
             private: // Ptrs
 
                 Listener* listener_ptr_; //!< NOT MANAGED BY THIS CLASS
                 
             private: // Data
                 
-                ::sys::Process::List list_;
-                ::sys::Error         last_error_;
+                Json::Value                            config_;  //!< Startup configuration ( directories and variables ), kept for reloads.
+                Registry                               registry_;
+                ProcessTable                           table_;   //!< Process snapshot, only accessed with mutex locked.
+                std::unordered_map<std::string, State> states_;
+                std::map<std::string, Options>         options_; //!< As loaded, by process id.
+                std::map<std::string, Scaler::Pool>    pools_;   //!< As loaded, by pool id.
+                std::map<std::string, size_t>          sizes_;   //!< Number of pool instances that should be running, by pool id.
+                Watch                                  watch_;
+                bool                                   adopt_;   //!< True when processes started by a previous monitor are adopted.
+                std::chrono::steady_clock::time_point  startup_tp_;
+                std::minstd_rand                       random_;
+                SpawnMode                              spawn_mode_;
+                SpawnStats                             spawn_stats_;
+                ::sys::Error                           last_error_;
+                uint64_t                               sequence_; //!< Most recent event sequence number, only accessed with mutex locked.
+                std::deque<Order>                      orders_;   //!< Submitted commands, not executed yet, only accessed with mutex locked.
                 
             private: // Threading
                 
@@ -115,6 +280,22 @@ namespace casper
                 bool volatile*          abort_flag_;
                 osal::ConditionVariable thread_cv_;
                 pid_t                   main_pid_;
+                Reactor                 reactor_;
+                Sampler                 sampler_;
+                std::atomic<bool>       alert_;
+                Collector               collector_;
+                Sockets                 sockets_;
+                Watcher                 watcher_;
+                uint64_t                watch_timer_;
+                std::atomic<bool>       reload_;
+                Scaler                  scaler_;
+                std::atomic<bool>       scale_;
+                Health                  checker_;
+                std::atomic<bool>       heal_;
+                Crashes                 crashes_;
+                Runs                    runs_;
+                ::casper::app::Board    board_;
+                std::atomic<bool>       order_;
                 
             public: // Method(s) / Function(s)
                 
@@ -123,33 +304,78 @@ namespace casper
                 void        Stop      ();
                 void        Quit      ();
                 void        Refresh   ();
+                void        Reload    ();
+                void        Submit    (const Command a_command, const std::string& a_id, const int a_signal_no, const Acknowledge& a_acknowledge);
+                bool        Tail      (const std::string& a_id, const bool a_stderr, const size_t a_lines, std::vector<std::string>& o_lines);
             
             public: // Inline Method(s) / Function(s)
                 
-                bool        IsErrorSet ();
-                void        GetError   (const std::function<void(const ::sys::Error& a_last_error)>& a_callback);
+                bool           IsErrorSet ();
+                void           GetError   (const std::function<void(const ::sys::Error& a_last_error)>& a_callback);
+                const Sampler& sampler    () const;
+                const Health&  health     () const;
+                const Crashes& crashes    () const;
+                const Runs&    runs       () const;
                 
             private: // Method(s) / Function(s)
 
-                bool Start             (const std::list<const ::sys::Process::Info>& a_list, const bool a_detached, Listener& a_listener,
+                bool Start             (const std::list<const ::sys::Process::Info>& a_list, const std::map<std::string, Options>& a_options,
+                                        const std::map<std::string, Scaler::Pool>& a_pools,
+                                        const bool a_detached, Listener& a_listener,
                                         bool volatile* a_abort_flag);
                 void Loop              ();
                 
+                bool Load              (const Json::Value& a_config, Json::Value& o_file,
+                                        std::list<const ::sys::Process::Info>& o_list, std::map<std::string, Options>& o_options,
+                                        std::map<std::string, Scaler::Pool>& o_pools);
+                void Group             (const std::map<std::string, Options>& a_options);
+                void Apply             (std::vector<Reactor::Exit>& o_exits);
+                void Scale             ();
+                void Resize            (const std::string& a_pool, const size_t a_size);
+                void Heal              ();
+                void Alert             ();
+                void Execute           ();
+                Outcome Obey           (const Order& a_order, bool& o_launch, std::string& o_detail);
+                void Retire            (::sys::Process& a_process, State& a_state);
+                
+                void Adopt             ();
+                Adoption Recognize (::sys::Process& a_process, std::string& o_reason) const;
+                void Describe          (::sys::Process& a_process, std::string& o_executable, std::vector<std::string>& o_arguments) const;
+                void Remember          (::sys::Process& a_process);
+                
                 bool KillAll           (const bool& a_optional, const pid_t a_parent_pid = 1);
                 bool TerminateAll      (const bool& a_optional, const pid_t a_parent_pid = 1);
                 bool SignalAll         (const int a_no, const bool& a_optional, const pid_t a_parent_pid = 1);
                 
-                bool Spawn             (::sys::Process& a_process, const bool& a_block_sigchld);
-                bool Exec              (::sys::Process& a_process);
+                bool Launch            ();
+                bool Spawn             (::sys::Process& a_process);
+                bool Fork              (::sys::Process& a_process, const int a_exec_fd, const int a_log_fds[2],
+                                        const std::vector<int>& a_listen_fds, const struct rlimit* a_core_rlimit);
+                bool PosixSpawn        (::sys::Process& a_process, const int a_log_fds[2]);
+                void Environment       (const ::sys::Process& a_process, std::vector<std::string>& o_entries) const;
+                void OnExecStatus      (::sys::Process& a_process, const int a_fd);
+                void OnProbe           (const std::string& a_id);
+                void SetReady          (const ::sys::Process& a_process, State& a_state);
+                
+                void Record            (const ::sys::Process& a_process, const State& a_state, const Reactor::Exit& a_exit, const std::string& a_reason);
+                void OnCrash           (const ::sys::Process& a_process, State& a_state, const Reactor::Exit& a_exit, const int a_signal);
+                bool OnExit            (::sys::Process& a_process, State& a_state, const std::string& a_reason, const bool a_failure, const bool a_fatal);
+                void OnRestart         (const std::string& a_id);
+                void Post              (const ::sys::Process& a_process, const State& a_state);
+                void Publish           (const Change a_kind, const std::string& a_id, const pid_t a_pid, const std::string& a_detail = "");
+                void StopDependants    (const std::string& a_id);
+                void Forget            (::sys::Process& a_process, State& a_state);
+                void Sweep             (const ::sys::Process& a_process);
+                void Shutdown          (const std::set<std::string>* a_ids = nullptr, std::vector<Reactor::Exit>* o_exits = nullptr);
                 
                 bool MKDIR              (const ::sys::Process* a_process, const std::string& a_directory);
                 bool EnsureRequirements (const ::sys::Process& a_process);
-                bool Redirect           (const ::sys::Process& a_process,
-                                         const std::list<std::pair<FILE*, std::string>>& a_list);
 
             private: // Static Method(s) / Function(s)
                 
                 static void OnSignal (int a_signal_no);
+                static bool Equals   (const ::sys::Process::Info& a_lhs, const ::sys::Process::Info& a_rhs);
+                static bool Equals   (const Options& a_lhs, const Options& a_rhs);
                 
             private:
                 
@@ -181,6 +407,38 @@ namespace casper
                 a_callback(last_error_);
             }
             
+            /**
+             * @return R/O access to resource usage samples.
+             */
+            inline const Sampler& Watchdog::sampler () const
+            {
+                return sampler_;
+            }
+            
+            /**
+             * @return R/O access to health checks statistics.
+             */
+            inline const Health& Watchdog::health () const
+            {
+                return checker_;
+            }
+            
+            /**
+             * @return R/O access to crash reports.
+             */
+            inline const Crashes& Watchdog::crashes () const
+            {
+                return crashes_;
+            }
+            
+            /**
+             * @return R/O access to children runs history.
+             */
+            inline const Runs& Watchdog::runs () const
+            {
+                return runs_;
+            }
+            
             /**
              * @return True if an error is set, false otherwise.
              */
@@ -260,7 +518,7 @@ namespace casper
                     if ( SIGTERM == a_signal_no ) {
                         listener_ptr_->OnTerminated();
                     } else if ( SIGUSR2 == a_signal_no ) {
-                        listener_ptr_->OnRunningProcessesUpdated(list_);
+                        listener_ptr_->OnRunningProcessesUpdated(registry_.list(), sequence_);
                     }
                 }
             }
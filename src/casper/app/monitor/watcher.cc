@@ -0,0 +1,229 @@
+/**
+ * @file watcher.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/monitor/watcher.h"
+
+#include "casper/app/monitor/helper.h"
+
+#include <unistd.h>   // read, close
+#include <errno.h>    // errno
+#include <fcntl.h>    // open
+#include <sys/stat.h> // stat
+
+#ifdef __APPLE__
+    #include <sys/event.h> // kqueue, kevent
+#else
+    #include <sys/inotify.h> // inotify_init1, inotify_add_watch
+#endif
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::monitor::Watcher::Watcher ()
+{
+    fd_ = -1;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::monitor::Watcher::~Watcher ()
+{
+    Close();
+}
+
+/**
+ * @brief Start watching a set of files, they don't need to exist.
+ *
+ * @param a_uris Files to watch.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::monitor::Watcher::Open (const std::vector<std::string>& a_uris)
+{
+    Close();
+
+#ifdef __APPLE__
+    fd_ = kqueue();
+#else
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    if ( -1 == fd_ ) {
+        CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "%s", "unable to create file watcher");
+        return false;
+    }
+
+    for ( auto uri : a_uris ) {
+
+        const size_t slash = uri.rfind('/');
+
+        Entry entry = {
+            /* uri_       */ uri,
+            /* directory_ */ ( std::string::npos != slash ? uri.substr(0, slash + 1) : "./" ),
+            /* name_      */ ( std::string::npos != slash ? uri.substr(slash + 1)    : uri  ),
+            /* wd_        */ -1,
+            /* fd_        */ -1,
+            /* ino_       */ 0,
+            /* mtime_     */ 0,
+            /* size_      */ 0
+        };
+
+#ifdef __APPLE__
+        entry.wd_ = open(entry.directory_.c_str(), O_EVTONLY | O_CLOEXEC);
+        if ( -1 != entry.wd_ ) {
+            struct kevent change;
+            EV_SET(&change, entry.wd_, EVFILT_VNODE, EV_ADD | EV_CLEAR, NOTE_WRITE, 0, nullptr);
+            (void)kevent(fd_, &change, 1, nullptr, 0, nullptr);
+        }
+        (void)Arm(entry, /* a_initial */ true);
+#else
+        // ... directory, not file: editors usually write a new file and rename it ...
+        entry.wd_ = inotify_add_watch(fd_, entry.directory_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+#endif
+        if ( -1 == entry.wd_ ) {
+            CASPER_APP_MONITOR_SET_ERROR(nullptr, error_, errno, "unable to watch directory '%s'", entry.directory_.c_str());
+            Close();
+            return false;
+        }
+
+        entries_.push_back(entry);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Stop watching all files.
+ */
+void casper::app::monitor::Watcher::Close ()
+{
+#ifdef __APPLE__
+    for ( auto entry : entries_ ) {
+        if ( -1 != entry.fd_ ) {
+            close(entry.fd_);
+        }
+        if ( -1 != entry.wd_ ) {
+            close(entry.wd_);
+        }
+    }
+#endif
+    entries_.clear();
+    if ( -1 != fd_ ) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+/**
+ * @brief Consume all pending events, call it when the descriptor is readable.
+ *
+ * @return True when at least one of the watched files was modified, created or replaced.
+ */
+bool casper::app::monitor::Watcher::Changed ()
+{
+    bool changed = false;
+
+#ifdef __APPLE__
+
+    struct kevent   events[16];
+    struct timespec timeout = { 0, 0 };
+
+    while ( kevent(fd_, nullptr, 0, events, 16, &timeout) > 0 ) {
+        /* drained, changes are detected below */
+    }
+
+    // ... a directory event is any entry change, file must be checked ...
+    for ( auto& entry : entries_ ) {
+        if ( true == Arm(entry, /* a_initial */ false) ) {
+            changed = true;
+        }
+    }
+
+#else
+
+    // ... events are variable length, buffer must be aligned ...
+    char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+    ssize_t count;
+    while ( ( count = read(fd_, buffer, sizeof(buffer)) ) > 0 ) {
+        for ( char* ptr = buffer ; ptr < buffer + count ; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            if ( event->len > 0 ) {
+                for ( auto entry : entries_ ) {
+                    if ( entry.wd_ == event->wd && 0 == entry.name_.compare(event->name) ) {
+                        changed = true;
+                    }
+                }
+            }
+            ptr += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+#endif
+
+    return changed;
+}
+
+#ifdef __APPLE__
+
+/**
+ * @brief Watch a file, again if it was replaced.
+ *
+ * @param a_entry   File entry.
+ * @param a_initial True when called by Open, nothing was seen yet.
+ *
+ * @return True when file is not the one last seen.
+ */
+bool casper::app::monitor::Watcher::Arm (casper::app::monitor::Watcher::Entry& a_entry, const bool a_initial)
+{
+    struct stat info;
+    if ( 0 != stat(a_entry.uri_.c_str(), &info) ) {
+        // ... gone, wait for it to be created ( directory event ) ...
+        if ( -1 != a_entry.fd_ ) {
+            close(a_entry.fd_);
+            a_entry.fd_ = -1;
+        }
+        a_entry.ino_ = 0;
+        return false;
+    }
+
+    const bool changed = ( info.st_ino != a_entry.ino_ || info.st_mtime != a_entry.mtime_ || info.st_size != a_entry.size_ );
+
+    if ( info.st_ino != a_entry.ino_ || -1 == a_entry.fd_ ) {
+        if ( -1 != a_entry.fd_ ) {
+            close(a_entry.fd_);
+        }
+        a_entry.fd_ = open(a_entry.uri_.c_str(), O_EVTONLY | O_CLOEXEC);
+        if ( -1 != a_entry.fd_ ) {
+            struct kevent change;
+            EV_SET(&change, a_entry.fd_, EVFILT_VNODE, EV_ADD | EV_CLEAR, NOTE_WRITE | NOTE_EXTEND | NOTE_DELETE | NOTE_RENAME, 0, nullptr);
+            (void)kevent(fd_, &change, 1, nullptr, 0, nullptr);
+        }
+    }
+
+    a_entry.ino_   = info.st_ino;
+    a_entry.mtime_ = info.st_mtime;
+    a_entry.size_  = info.st_size;
+
+    return ( true == changed && false == a_initial );
+}
+
+#endif
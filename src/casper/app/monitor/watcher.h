@@ -0,0 +1,117 @@
+/**
+ * @file watcher.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_MONITOR_WATCHER_H_
+#define CASPER_APP_MONITOR_WATCHER_H_
+#pragma once
+
+#include <sys/types.h> // ino_t, off_t
+#include <time.h>      // time_t
+
+#include <string> // std::string
+#include <vector> // std::vector
+
+#include "sys/error.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        namespace monitor
+        {
+
+            /**
+             * @brief Watches a few files for changes, it's descriptor is meant to be added to a reactor.
+             *
+             * Linux: inotify on each file directory, so files replaced by a rename ( editors ) are also noticed.
+             * Darwin: kqueue EVFILT_VNODE on each file and it's directory, changes are confirmed by stat.
+             */
+            class Watcher final
+            {
+
+            private: // Data Type(s)
+
+                typedef struct {
+                    std::string uri_;       //!< File uri.
+                    std::string directory_; //!< Directory uri, with trailing '/'.
+                    std::string name_;      //!< File name.
+                    int         wd_;        //!< Linux: inotify watch descriptor, Darwin: directory descriptor.
+                    int         fd_;        //!< Darwin only, file descriptor, -1 when it does not exist.
+                    ino_t       ino_;       //!< Darwin only, last seen inode.
+                    time_t      mtime_;     //!< Darwin only, last seen modification time.
+                    off_t       size_;      //!< Darwin only, last seen size.
+                } Entry;
+
+            private: // Data
+
+                int                fd_;
+                std::vector<Entry> entries_;
+                ::sys::Error       error_;
+
+            public: // Constructor(s) / Destructor
+
+                Watcher ();
+                virtual ~Watcher ();
+
+            public: // Method(s) / Function(s)
+
+                bool Open    (const std::vector<std::string>& a_uris);
+                void Close   ();
+                bool Changed ();
+
+            public: // Inline Method(s) / Function(s)
+
+                int                 fd    () const;
+                const ::sys::Error& error () const;
+
+#ifdef __APPLE__
+            private: // Method(s) / Function(s)
+
+                bool Arm     (Entry& a_entry, const bool a_initial);
+#endif
+
+            }; // end of class 'Watcher'
+
+            /**
+             * @return Descriptor to wait for, -1 when not open.
+             */
+            inline int Watcher::fd () const
+            {
+                return fd_;
+            }
+
+            /**
+             * @return R/O access to last error.
+             */
+            inline const ::sys::Error& Watcher::error () const
+            {
+                return error_;
+            }
+
+        } // end of namespace 'monitor'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_MONITOR_WATCHER_H_
@@ -0,0 +1,412 @@
+/**
+ * @file rpc.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/rpc.h"
+
+#include <pthread.h> // pthread_setname_np
+#include <string.h>  // strcasecmp
+
+#include <vector>  // std::vector
+#include <memory>  // std::shared_ptr
+#include <utility> // std::pair
+
+#include "cc/sockets/dgram/ipc/client.h"
+#include "cc/exception.h"
+
+/**
+ * @brief Default constructor.
+ */
+casper::app::RPC::RPC ()
+{
+    sender_  = nullptr;
+    next_id_ = 0;
+    thread_  = nullptr;
+    running_ = false;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::RPC::~RPC ()
+{
+    Stop();
+}
+
+#ifdef __APPLE__
+#pragma mark - Client
+#endif
+
+/**
+ * @brief Start timeouts thread, if not running already.
+ *
+ * @param a_sender Sends a message to the peer, when not set IPC client is used - it must be started by the caller.
+ *
+ * @return True on success, false otherwise.
+ */
+bool casper::app::RPC::Start (const casper::app::RPC::Sender& a_sender)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( nullptr != thread_ ) {
+        return true;
+    }
+    if ( nullptr != a_sender ) {
+        sender_ = a_sender;
+    } else {
+        sender_ = [] (const Json::Value& a_message) {
+            ::cc::sockets::dgram::ipc::Client::GetInstance().Send(a_message);
+        };
+    }
+    running_ = true;
+    thread_  = new std::thread(&casper::app::RPC::Loop, this);
+    return true;
+}
+
+/**
+ * @brief Stop timeouts thread, pending calls are completed as cancelled.
+ */
+void casper::app::RPC::Stop ()
+{
+    std::thread*                thread;
+    std::map<uint64_t, Pending> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        thread   = thread_;
+        thread_  = nullptr;
+        running_ = false;
+        pending.swap(pending_);
+    }
+    if ( nullptr != thread ) {
+        cv_.notify_all();
+        thread->join();
+        delete thread;
+    }
+    // ... callbacks are never called with mutex locked, they might call again ...
+    for ( const auto& it : pending ) {
+        it.second.callback_({ /* id_ */ it.first, /* status_ */ Status::Cancelled, /* message_ */ "stopped before a response arrived", /* result_ */ Json::Value::null });
+    }
+}
+
+/**
+ * @brief Send a request, callback is called when it's response arrives, when it does not arrive in time or when it can't be sent.
+ *
+ * @param a_op         Operation.
+ * @param a_target     Child id, empty when operation is not about a single child.
+ * @param a_args       Operation arguments, null when none.
+ * @param a_timeout_ms For how long to wait for it's response.
+ * @param a_callback   Called exactly once, from IPC, timeouts or caller's thread.
+ */
+void casper::app::RPC::Call (const std::string& a_op, const std::string& a_target, const Json::Value& a_args, const int a_timeout_ms,
+                             const casper::app::RPC::Callback& a_callback)
+{
+    uint64_t id;
+    Sender   sender;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if ( nullptr == thread_ ) {
+            id = 0;
+        } else {
+            id = ++next_id_;
+            // ... registered before it's sent, response might arrive before send returns ...
+            pending_[id] = {
+                /* callback_   */ a_callback,
+                /* deadline_   */ std::chrono::steady_clock::now() + std::chrono::milliseconds(a_timeout_ms),
+                /* timeout_ms_ */ a_timeout_ms
+            };
+            sender = sender_;
+        }
+    }
+    if ( 0 == id ) {
+        a_callback({ /* id_ */ 0, /* status_ */ Status::Cancelled, /* message_ */ "not started", /* result_ */ Json::Value::null });
+        return;
+    }
+
+    // ... it might be the nearest deadline ...
+    cv_.notify_one();
+
+    Json::Value message = Json::Value(Json::ValueType::objectValue);
+    message["type"] = "request";
+
+    Json::Value& request = message["request"];
+    request["id"] = static_cast<Json::UInt64>(id);
+    request["op"] = a_op;
+    if ( a_target.length() > 0 ) {
+        request["target"] = a_target;
+    }
+    if ( false == a_args.isNull() ) {
+        request["args"] = a_args;
+    }
+
+    try {
+        sender(message);
+    } catch (const ::cc::Exception& a_cc_exception) {
+        (void)Complete({ /* id_ */ id, /* status_ */ Status::Failed, /* message_ */ a_cc_exception.what(), /* result_ */ Json::Value::null });
+    }
+}
+
+/**
+ * @brief Send a request, returned future is ready when it's response arrives, when it does not arrive in time or when it can't be sent.
+ *
+ * @param a_op         Operation.
+ * @param a_target     Child id, empty when operation is not about a single child.
+ * @param a_args       Operation arguments, null when none.
+ * @param a_timeout_ms For how long to wait for it's response.
+ *
+ * @return Response future, never waiting for it from the IPC thread - it's the one that delivers responses.
+ */
+std::future<casper::app::RPC::Response> casper::app::RPC::Call (const std::string& a_op, const std::string& a_target, const Json::Value& a_args,
+                                                                const int a_timeout_ms)
+{
+    const auto promise = std::make_shared<std::promise<Response>>();
+
+    std::future<Response> future = promise->get_future();
+
+    Call(a_op, a_target, a_args, a_timeout_ms, [promise] (const Response& a_response) {
+        promise->set_value(a_response);
+    });
+
+    return future;
+}
+
+/**
+ * @brief Complete a pending call with a received response.
+ *
+ * @param a_message Any message received from the peer.
+ *
+ * @return True when it was a response, even if it's call is no longer pending, false otherwise.
+ */
+bool casper::app::RPC::Receive (const Json::Value& a_message)
+{
+    if ( false == a_message.isObject() || false == a_message["type"].isString() || 0 != strcasecmp("response", a_message["type"].asCString()) ) {
+        return false;
+    }
+
+    const Json::Value& object = a_message["response"];
+    if ( false == object.isObject() || false == object["id"].isUInt64() ) {
+        return true;
+    }
+
+    Response response = {
+        /* id_      */ object["id"].asUInt64(),
+        /* status_  */ Status::Failed,
+        /* message_ */ ( true == object["message"].isString() ? object["message"].asString() : "" ),
+        /* result_  */ object["result"]
+    };
+    if ( false == object["status"].isString() || false == Parse(object["status"].asString(), response.status_) ) {
+        response.status_  = Status::Failed;
+        response.message_ = "invalid response status";
+    }
+
+    // ... late responses, of calls that already timed out, are ignored ...
+    (void)Complete(response);
+
+    return true;
+}
+
+#ifdef __APPLE__
+#pragma mark - Server
+#endif
+
+/**
+ * @brief Read a received request.
+ *
+ * @param a_message Any message received from the peer.
+ * @param o_request Request, an unknown operation is left for the caller to reject.
+ *
+ * @return True when it was a request with an id, false otherwise - it can't be answered.
+ */
+bool casper::app::RPC::Parse (const Json::Value& a_message, casper::app::RPC::Request& o_request)
+{
+    if ( false == a_message.isObject() || false == a_message["type"].isString() || 0 != strcasecmp("request", a_message["type"].asCString()) ) {
+        return false;
+    }
+
+    const Json::Value& object = a_message["request"];
+    if ( false == object.isObject() || false == object["id"].isUInt64() ) {
+        return false;
+    }
+
+    o_request.id_     = object["id"].asUInt64();
+    o_request.op_     = ( true == object["op"].isString()     ? object["op"].asString()     : "" );
+    o_request.target_ = ( true == object["target"].isString() ? object["target"].asString() : "" );
+    o_request.args_   = object["args"];
+
+    return true;
+}
+
+/**
+ * @brief Build a request response message.
+ *
+ * @param a_request The request being answered.
+ * @param a_status  Outcome.
+ * @param a_message Why it was not OK, ignored when empty.
+ * @param a_result  Operation result, ignored when null.
+ * @param o_message { "type": "response" } message, ready to be sent.
+ */
+void casper::app::RPC::Reply (const casper::app::RPC::Request& a_request, const casper::app::RPC::Status a_status, const std::string& a_message,
+                              const Json::Value& a_result, Json::Value& o_message)
+{
+    o_message = Json::Value(Json::ValueType::objectValue);
+    o_message["type"] = "response";
+
+    Json::Value& response = o_message["response"];
+    response["id"]     = static_cast<Json::UInt64>(a_request.id_);
+    response["status"] = Name(a_status);
+    if ( a_message.length() > 0 ) {
+        response["message"] = a_message;
+    }
+    if ( false == a_result.isNull() ) {
+        response["result"] = a_result;
+    }
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Translate a status to it's name.
+ *
+ * @param a_status Status.
+ *
+ * @return Status name, as used by JSON messages.
+ */
+const char* casper::app::RPC::Name (const casper::app::RPC::Status a_status)
+{
+    switch (a_status) {
+        case Status::OK:
+            return "ok";
+        case Status::Invalid:
+            return "invalid";
+        case Status::NotFound:
+            return "not_found";
+        case Status::Rejected:
+            return "rejected";
+        case Status::Failed:
+            return "failed";
+        case Status::Timeout:
+            return "timeout";
+        case Status::Cancelled:
+            return "cancelled";
+        default:
+            return "???";
+    }
+}
+
+/**
+ * @brief Find a status by it's name.
+ *
+ * @param a_name   Status name, as used by JSON messages.
+ * @param o_status Status.
+ *
+ * @return True when name is known, false otherwise.
+ */
+bool casper::app::RPC::Parse (const std::string& a_name, casper::app::RPC::Status& o_status)
+{
+    for ( uint8_t status = static_cast<uint8_t>(Status::OK) ; status <= static_cast<uint8_t>(Status::Cancelled) ; ++status ) {
+        if ( 0 == a_name.compare(Name(static_cast<Status>(status))) ) {
+            o_status = static_cast<Status>(status);
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef __APPLE__
+#pragma mark -
+#endif
+
+/**
+ * @brief Complete a pending call.
+ *
+ * @param a_response It's response.
+ *
+ * @return True when it was pending, false otherwise.
+ */
+bool casper::app::RPC::Complete (const casper::app::RPC::Response& a_response)
+{
+    Callback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = pending_.find(a_response.id_);
+        if ( pending_.end() == it ) {
+            return false;
+        }
+        callback = it->second.callback_;
+        pending_.erase(it);
+    }
+    callback(a_response);
+    return true;
+}
+
+/**
+ * @brief Thread function where pending calls deadlines are watched.
+ */
+void casper::app::RPC::Loop ()
+{
+#ifdef __APPLE__
+    pthread_setname_np("RPC");
+#else
+    pthread_setname_np(pthread_self(), "RPC");
+#endif
+
+    std::vector<std::pair<uint64_t, Pending>> expired;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while ( true == running_ ) {
+
+        const auto now  = std::chrono::steady_clock::now();
+        auto       next = std::chrono::steady_clock::time_point::max();
+
+        for ( auto it = pending_.begin() ; pending_.end() != it ; ) {
+            if ( it->second.deadline_ <= now ) {
+                expired.push_back(*it);
+                it = pending_.erase(it);
+            } else {
+                if ( it->second.deadline_ < next ) {
+                    next = it->second.deadline_;
+                }
+                ++it;
+            }
+        }
+
+        if ( expired.size() > 0 ) {
+            // ... callbacks are never called with mutex locked ...
+            lock.unlock();
+            for ( const auto& it : expired ) {
+                it.second.callback_({
+                    /* id_      */ it.first,
+                    /* status_  */ Status::Timeout,
+                    /* message_ */ "no response within " + std::to_string(it.second.timeout_ms_) + " ms",
+                    /* result_  */ Json::Value::null
+                });
+            }
+            expired.clear();
+            lock.lock();
+            continue;
+        }
+
+        if ( std::chrono::steady_clock::time_point::max() == next ) {
+            cv_.wait(lock);
+        } else {
+            cv_.wait_until(lock, next);
+        }
+    }
+}
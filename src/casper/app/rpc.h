@@ -0,0 +1,144 @@
+/**
+ * @file rpc.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_RPC_H_
+#define CASPER_APP_RPC_H_
+#pragma once
+
+#include <stdint.h> // uint8_t, uint64_t
+
+#include <string>             // std::string
+#include <map>                // std::map
+#include <thread>             // std::thread
+#include <mutex>              // std::mutex
+#include <condition_variable> // std::condition_variable
+#include <functional>         // std::function
+#include <future>             // std::future
+#include <chrono>             // std::chrono
+
+#include "json/json.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        /**
+         * @brief Correlated request / response calls between app and 'monitor', on top of IPC datagrams.
+         *
+         * A request is a { "type": "request" } message carrying an id, an operation, an optional target ( child id )
+         * and optional arguments, it's response is a { "type": "response" } message with the same id, a status and an
+         * optional result. Calls are asynchronous, a callback or a future is completed exactly once: with the response,
+         * or locally when it did not arrive in time or when this object is stopped. Late responses are ignored.
+         */
+        class RPC final
+        {
+
+        public: // Data Type(s)
+
+            enum class Status : uint8_t {
+                OK = 0,   //!< Done, or accepted and being done.
+                Invalid,  //!< Malformed request, unknown operation or bad arguments.
+                NotFound, //!< Unknown target.
+                Rejected, //!< Not possible in target's current state.
+                Failed,   //!< Attempted, but it failed.
+                Timeout,  //!< Local, no response in time.
+                Cancelled //!< Local, stopped before a response arrived.
+            };
+
+            typedef struct {
+                uint64_t    id_;
+                std::string op_;
+                std::string target_; //!< Child id, empty when operation is not about a single child.
+                Json::Value args_;   //!< Operation arguments, null when none.
+            } Request;
+
+            typedef struct {
+                uint64_t    id_;
+                Status      status_;
+                std::string message_; //!< Why it was not OK, empty otherwise.
+                Json::Value result_;  //!< Operation result, null when none.
+            } Response;
+
+            typedef std::function<void(const Response& a_response)> Callback;
+            typedef std::function<void(const Json::Value& a_message)> Sender;
+
+        private: // Data Type(s)
+
+            typedef struct {
+                Callback                              callback_;
+                std::chrono::steady_clock::time_point deadline_;
+                int                                   timeout_ms_;
+            } Pending;
+
+        private: // Data
+
+            Sender                      sender_;
+            uint64_t                    next_id_;
+            std::map<uint64_t, Pending> pending_; //!< By request id.
+
+        private: // Threading
+
+            std::thread*            thread_;
+            mutable std::mutex      mutex_;
+            std::condition_variable cv_;
+            bool                    running_;
+
+        public: // Constructor(s) / Destructor
+
+            RPC ();
+            virtual ~RPC ();
+
+        public: // Client Method(s) / Function(s)
+
+            bool                  Start   (const Sender& a_sender = nullptr);
+            void                  Stop    ();
+
+            void                  Call    (const std::string& a_op, const std::string& a_target, const Json::Value& a_args, const int a_timeout_ms,
+                                           const Callback& a_callback);
+            std::future<Response> Call    (const std::string& a_op, const std::string& a_target, const Json::Value& a_args, const int a_timeout_ms);
+
+            bool                  Receive (const Json::Value& a_message);
+
+        public: // Server Static Method(s) / Function(s)
+
+            static bool Parse (const Json::Value& a_message, Request& o_request);
+            static void Reply (const Request& a_request, const Status a_status, const std::string& a_message, const Json::Value& a_result,
+                               Json::Value& o_message);
+
+        public: // Static Method(s) / Function(s)
+
+            static const char* Name  (const Status a_status);
+            static bool        Parse (const std::string& a_name, Status& o_status);
+
+        private: // Method(s) / Function(s)
+
+            bool Complete (const Response& a_response);
+            void Loop     ();
+
+        }; // end of class 'RPC'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_RPC_H_
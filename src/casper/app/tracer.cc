@@ -0,0 +1,259 @@
+/**
+ * @file tracer.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "casper/app/tracer.h"
+
+#include <unistd.h>   // write, close, getpid
+#include <fcntl.h>    // open
+#include <errno.h>    // errno
+#include <stdio.h>    // snprintf
+#include <inttypes.h> // PRId64, PRIu64
+#include <sys/stat.h> // fstat
+#include <pthread.h>  // pthread_threadid_np
+
+#ifndef __APPLE__
+    #include <sys/syscall.h> // syscall, SYS_gettid
+#endif
+
+#include <chrono> // std::chrono
+
+const size_t casper::app::Tracer::k_max_size_ = ( 16 * 1024 * 1024 );
+
+/**
+ * @brief This method will be called when it's time to initialize this singleton.
+ *
+ * @param a_instance A referece to the owner of this class.
+ */
+casper::app::TracerInitializer::TracerInitializer (casper::app::Tracer& a_instance)
+    : ::cc::Initializer<casper::app::Tracer>(a_instance)
+{
+    instance_.fd_   = -1;
+    instance_.pid_  = 0;
+    instance_.size_ = 0;
+}
+
+/**
+ * @brief Destructor.
+ */
+casper::app::TracerInitializer::~TracerInitializer ()
+{
+    instance_.Shutdown();
+}
+
+#ifdef __APPLE__
+#pragma mark - Span
+#endif
+
+/**
+ * @brief Default constructor, span starts now.
+ *
+ * @param a_name Span name, must be a literal.
+ * @param a_id   Child id, if any.
+ */
+casper::app::Tracer::Span::Span (const char* const a_name, const std::string& a_id)
+    : name_(a_name), id_(a_id), start_us_(casper::app::Tracer::Now())
+{
+    /* empty */
+}
+
+/**
+ * @brief Destructor, span ends now.
+ */
+casper::app::Tracer::Span::~Span ()
+{
+    casper::app::Tracer::GetInstance().Complete(name_, start_us_, casper::app::Tracer::Now(), casper::app::Tracer::ThreadID(), id_);
+}
+
+#ifdef __APPLE__
+#pragma mark - Tracer
+#endif
+
+/**
+ * @brief Start tracing.
+ *
+ * @param a_path     Directory where trace.json is written, with trailing '/'.
+ * @param a_process  Process name, shown by trace viewers.
+ * @param a_truncate True when a new trace must be started, false to append to current one.
+ *
+ * @note Failures are not reported, tracing is just disabled.
+ */
+void casper::app::Tracer::Startup (const std::string& a_path, const std::string& a_process, const bool a_truncate)
+{
+    Shutdown();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // ... events are written with a single write each, O_APPEND keeps them whole across processes ...
+    const std::string uri = a_path + "trace.json";
+    fd_ = open(uri.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | ( true == a_truncate ? O_TRUNC : 0 ), 0644);
+    if ( -1 == fd_ ) {
+        return;
+    }
+
+    struct stat info;
+    if ( 0 != fstat(fd_, &info) ) {
+        close(fd_);
+        fd_ = -1;
+        return;
+    }
+
+    pid_      = getpid();
+    category_ = a_process;
+    size_     = static_cast<size_t>(info.st_size);
+
+    // ... array format, closing ']' and trailing ',' are optional ...
+    if ( 0 == size_ && 2 == write(fd_, "[\n", 2) ) {
+        size_ = 2;
+    }
+
+    Write("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid_) + ",\"args\":{\"name\":\"" + Escape(category_) + "\"}}");
+}
+
+/**
+ * @brief Stop tracing, file is kept as is.
+ */
+void casper::app::Tracer::Shutdown ()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( -1 != fd_ ) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+/**
+ * @brief Name a track, by default tracks are named by their thread id.
+ *
+ * @param a_tid  Track id, a thread or a child pid.
+ * @param a_name Name to show.
+ */
+void casper::app::Tracer::Name (const uint64_t a_tid, const std::string& a_name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( -1 == fd_ ) {
+        return;
+    }
+    Write("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid_) + ",\"tid\":" + std::to_string(a_tid)
+          + ",\"args\":{\"name\":\"" + Escape(a_name) + "\"}}"
+    );
+}
+
+/**
+ * @brief Write a complete event.
+ *
+ * @param a_name     Event name, must be a literal.
+ * @param a_start_us Start, as returned by \link Now \link.
+ * @param a_end_us   End, as returned by \link Now \link.
+ * @param a_tid      Track id, a thread or a child pid.
+ * @param a_id       Child id, if any.
+ */
+void casper::app::Tracer::Complete (const char* const a_name, const int64_t a_start_us, const int64_t a_end_us,
+                                    const uint64_t a_tid, const std::string& a_id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if ( -1 == fd_ ) {
+        return;
+    }
+
+    char buffer[192];
+    const int count = snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRId64 ",\"dur\":%" PRId64 ",\"pid\":%d,\"tid\":%" PRIu64,
+                               a_name, category_.c_str(), a_start_us, ( a_end_us > a_start_us ? a_end_us - a_start_us : 0 ), static_cast<int>(pid_), a_tid
+    );
+    if ( count <= 0 || static_cast<size_t>(count) >= sizeof(buffer) ) {
+        return;
+    }
+
+    std::string event(buffer, static_cast<size_t>(count));
+    if ( 0 != a_id.length() ) {
+        event += ",\"args\":{\"id\":\"" + Escape(a_id) + "\"}";
+    }
+    event += '}';
+
+    Write(event);
+}
+
+/**
+ * @return Monotonic clock, in microseconds, shared by all processes.
+ */
+int64_t casper::app::Tracer::Now ()
+{
+    return static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * @return Calling thread id, as shown by system tools.
+ */
+uint64_t casper::app::Tracer::ThreadID ()
+{
+#ifdef __APPLE__
+    uint64_t tid = 0;
+    (void)pthread_threadid_np(nullptr, &tid);
+    return tid;
+#else
+    return static_cast<uint64_t>(syscall(SYS_gettid));
+#endif
+}
+
+/**
+ * @brief Append an event, mutex must be locked.
+ *
+ * @param a_event JSON object.
+ */
+void casper::app::Tracer::Write (const std::string& a_event)
+{
+    const std::string line = a_event + ",\n";
+    if ( size_ + line.length() > k_max_size_ ) {
+        return;
+    }
+    ssize_t written;
+    do {
+        written = write(fd_, line.c_str(), line.length());
+    } while ( -1 == written && EINTR == errno );
+    if ( written > 0 ) {
+        size_ += static_cast<size_t>(written);
+    }
+}
+
+/**
+ * @brief Escape a value to be written as a JSON string.
+ *
+ * @param a_value Value to escape.
+ *
+ * @return Escaped value.
+ */
+std::string casper::app::Tracer::Escape (const std::string& a_value)
+{
+    std::string rv;
+    rv.reserve(a_value.length());
+    for ( const char c : a_value ) {
+        if ( '"' == c || '\\' == c ) {
+            rv += '\\';
+            rv += c;
+        } else if ( static_cast<unsigned char>(c) < 0x20 ) {
+            char tmp[8];
+            snprintf(tmp, sizeof(tmp), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+            rv += tmp;
+        } else {
+            rv += c;
+        }
+    }
+    return rv;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file tracer.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_TRACER_H_
+#define CASPER_APP_TRACER_H_
+#pragma once
+
+#include <sys/types.h> // pid_t
+#include <stdint.h>    // int64_t, uint64_t
+
+#include <string> // std::string
+#include <mutex>  // std::mutex
+
+#include "cc/singleton.h"
+
+namespace casper
+{
+
+    namespace app
+    {
+
+        // ---- //
+
+        class Tracer;
+
+        class TracerInitializer final : public ::cc::Initializer<Tracer>
+        {
+
+        public: // Constructor(s) / Destructor
+
+            TracerInitializer (Tracer& a_instance);
+            virtual ~TracerInitializer ();
+
+        };
+
+        // ---- //
+
+        /**
+         * @brief Writes Chrome trace-event JSON ( array format ), to be loaded by chrome://tracing or Perfetto.
+         *
+         * All processes of a stack append to the same file, timestamps are monotonic clock microseconds so
+         * events from different processes share the same timeline.
+         */
+        class Tracer final : public ::cc::Singleton<Tracer, TracerInitializer>
+        {
+
+            friend class TracerInitializer;
+
+        public: // Data Type(s)
+
+            /**
+             * @brief A complete event, written when it goes out of scope, on the calling thread track.
+             */
+            class Span final
+            {
+
+            private: // Data
+
+                const char* const name_;
+                const std::string id_;
+                const int64_t     start_us_;
+
+            public: // Constructor(s) / Destructor
+
+                Span (const char* const a_name, const std::string& a_id = "");
+                virtual ~Span ();
+
+            }; // end of class 'Span'
+
+        private: // Const Data
+
+            static const size_t k_max_size_; //!< Events are dropped when file reaches this size.
+
+        private: // Data
+
+            std::mutex  mutex_;
+            int         fd_;       //!< -1 when not tracing.
+            pid_t       pid_;
+            std::string category_; //!< Process name.
+            size_t      size_;     //!< Current file size.
+
+        public: // Method(s) / Function(s)
+
+            void Startup  (const std::string& a_path, const std::string& a_process, const bool a_truncate);
+            void Shutdown ();
+            void Name     (const uint64_t a_tid, const std::string& a_name);
+            void Complete (const char* const a_name, const int64_t a_start_us, const int64_t a_end_us,
+                           const uint64_t a_tid, const std::string& a_id);
+
+        public: // Static Method(s) / Function(s)
+
+            static int64_t  Now      ();
+            static uint64_t ThreadID ();
+
+        private: // Method(s) / Function(s)
+
+            void Write (const std::string& a_event);
+
+        private: // Static Method(s) / Function(s)
+
+            static std::string Escape (const std::string& a_value);
+
+        }; // end of class 'Tracer'
+
+    } // end of namespace 'app'
+
+} // end of namespace 'casper'
+
+#endif // CASPER_APP_TRACER_H_
@@ -50,6 +50,7 @@
 #include "casper/app/version.h"
 
 #include "casper/app/logger.h"
+#include "casper/app/tracer.h"
 
 #include "osal/osalite.h"
 #include "osal/osal_file.h"
@@ -279,6 +280,11 @@ static int StartCEF3 (int a_argc, char* a_argv[],
         
         ::casper::app::Logger::GetInstance().Startup(a_settings.paths_.logs_path_, "casper", CASPER_INFO);
         
+        // ... a new trace for each launch, 'monitor' process appends to it ...
+        if ( ::casper::cef3::common::Main::ProcessType::Browser == process_type ) {
+            ::casper::app::Tracer::GetInstance().Startup(a_settings.paths_.logs_path_, "casper", /* a_truncate */ true);
+        }
+        
     } catch (const std::exception* a_std_exception) {
         [Alerts showCriticalMessage: @"An std::exception Occurred"
                     informativeText: [NSString stringWithCString: a_std_exception->what() encoding: NSUTF8StringEncoding]
@@ -317,7 +323,10 @@ static int StartCEF3 (int a_argc, char* a_argv[],
     // ... initialize CEF ...
     CASPER_APP_DEBUG_LOG("status", "%s", "CEF initializing...");
     
-    context->Initialize(main_args, settings, app, NULL);
+    {
+        ::casper::app::Tracer::Span span("CEF Initialize");
+        context->Initialize(main_args, settings, app, NULL);
+    }
     
     // ... create the application delegate and window ...
     AppDelegate* delegate = [[AppDelegate alloc]
@@ -657,6 +666,7 @@ int main (int a_argc, char* a_argv[])
                          Json::Value config = Json::Value(Json::ValueType::objectValue);
                          
                          config["directories"]["runtime"] = directories["runtime"].asCString();
+                         config["directories"]["logs"]    = directories["logs"].asCString();
                          config["monitor"]["path"] = launch_path;
                          config["monitor"]["arguments"] = Json::Value(Json::ValueType::arrayValue);
                          config["monitor"]["arguments"].append("-c");
@@ -34,9 +34,12 @@
 
 #include "osal/condition_variable.h"
 
+#include "casper/app/rpc.h"
+#include "casper/app/codec.h"
 
 #include <mutex>
 #include <list>
+#include <future>
 
 namespace casper
 {
@@ -74,15 +77,21 @@ namespace casper
             private: // Threading
                 
                 std::mutex              mutex_;
-                std::list<Json::Value>  messages_;
+                std::list<Json::Value>  messages_;   //!< Received, not dispatched yet, only accessed with mutex locked.
+                bool                    dispatched_; //!< True when a main thread dispatch is pending, only accessed with mutex locked.
                 sys::Process*           process_;
 
             private: // Data
                 
-                AppDelegate*     app_delegate_;
-                DispatchCallback main_thread_dispatcher_;
-                Json::Value      rc_object_;
-                QuitCallback     quit_callback_;
+                AppDelegate*       app_delegate_;
+                DispatchCallback   main_thread_dispatcher_;
+                Json::Value        rc_frame_;      //!< 'refresh' control, as sent to 'monitor' when a full list is needed.
+                QuitCallback       quit_callback_;
+                int64_t            trace_us_;      //!< Start of current trace span ( launch or handshake ), 0 when none.
+                Json::Value        list_;          //!< Running processes, most recent full list with all events since applied to it, main thread only.
+                uint64_t           sequence_;      //!< Sequence number of most recent event reflected by \link list_ \link.
+                bool               synced_;        //!< False while waiting for a full list, events are ignored meanwhile.
+                ::casper::app::RPC rpc_;           //!< Requests to 'monitor', responses complete their calls on IPC thread.
                 
             public: // Method(s) / Function(s)
                 
@@ -90,9 +99,17 @@ namespace casper
                             QuitCallback a_quit_callback);
                 void Stop  (bool a_soft);
                 
+                void                                       Call (const std::string& a_op, const std::string& a_target, const Json::Value& a_args,
+                                                                 const ::casper::app::RPC::Callback& a_callback, const int a_timeout_ms = 5000);
+                std::future<::casper::app::RPC::Response> Call (const std::string& a_op, const std::string& a_target, const Json::Value& a_args,
+                                                                 const int a_timeout_ms = 5000);
+                
             private: // Method(s) / Function(s)
                 
+                void Enqueue                 (const Json::Value& a_message);
                 void ProcessReceivedMessages ();
+                bool Load                    (::casper::app::Codec::Frame& a_frame);
+                bool Apply                   (const ::casper::app::Codec::Change& a_change);
                 
             }; // end of class 'Monitor'
             
@@ -28,6 +28,10 @@
 
 #include "osal/osal_file.h"
 
+#include "casper/app/tracer.h"
+#include "casper/app/codec.h"
+#include "casper/app/rpc.h"
+
 #ifdef __APPLE__
 #pragma mark - MonitorInitializer
 #endif
@@ -43,9 +47,15 @@ casper::app::mac::MonitorInitializer::MonitorInitializer (casper::app::mac::Moni
     instance_.app_delegate_           = nullptr;
     instance_.main_thread_dispatcher_ = nullptr;
     instance_.process_                = nullptr;
-    instance_.rc_object_              = Json::Value(Json::ValueType::objectValue);
-    instance_.rc_object_["type"]      = "control";
-    instance_.rc_object_["control"]   = "refresh";
+    instance_.dispatched_             = false;
+    instance_.trace_us_               = 0;
+    instance_.list_                   = Json::Value(Json::ValueType::arrayValue);
+    instance_.sequence_               = 0;
+    instance_.synced_                 = false;
+    // ... encoded once, it's sent every time ...
+    casper::app::Codec codec;
+    codec.Control("refresh");
+    codec.Wrap(instance_.rc_frame_);
 }
 
 /**
@@ -78,11 +88,22 @@ void casper::app::mac::Monitor::Start (const Json::Value& a_config,
                                        casper::app::mac::Monitor::DispatchCallback a_dispatch_callback,
                                        casper::app::mac::Monitor::QuitCallback a_quit_callback)
 {
+    ::casper::app::Tracer::Span span("Monitor::Start");
+    
     Stop(/* a_soft */ false);
     
     main_thread_dispatcher_ = a_dispatch_callback;
     app_delegate_           = a_bind_callback(std::bind(&casper::app::mac::Monitor::ProcessReceivedMessages, this));
     quit_callback_          = a_quit_callback;
+    list_                   = Json::Value(Json::ValueType::arrayValue);
+    sequence_               = 0;
+    synced_                 = false;
+    {
+        // ... a dispatch still pending for a previous run will find nothing to process ...
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.clear();
+        dispatched_ = false;
+    }
     
     const Json::Value& directories = a_config["directories"];
     
@@ -96,10 +117,12 @@ void casper::app::mac::Monitor::Start (const Json::Value& a_config,
                                                            {
                                                                /* on_message_received_ */
                                                                [this] (const Json::Value& a_value) {
-                                                                   // ... on this callback message must be handled ...
-                                                                   std::lock_guard<std::mutex> lock(mutex_);
-                                                                   messages_.push_back(a_value);
-                                                                   main_thread_dispatcher_();
+                                                                   // ... responses complete their calls right here, main thread might be waiting for them ...
+                                                                   if ( true == rpc_.Receive(a_value) ) {
+                                                                       return;
+                                                                   }
+                                                                   // ... it will be handled by main thread ...
+                                                                   Enqueue(a_value);
                                                                },
                                                                /* on_terminated_ */
                                                                [] () {
@@ -120,6 +143,9 @@ void casper::app::mac::Monitor::Start (const Json::Value& a_config,
     // ... start a unidirectional message channel to send messages to 'monitor' process ...
     // ( on error, an exception will be thrown )
     cc::sockets::dgram::ipc::Client::GetInstance().Start("monitor", runtime_dir);
+    
+    // ... and requests sent through it ...
+    (void)rpc_.Start();
 
     process_ = new ::sys::darwin::Process(::sys::Process::Info({
         /* id_          */ "monitor",
@@ -150,17 +176,17 @@ void casper::app::mac::Monitor::Start (const Json::Value& a_config,
     }
 
     // ... start new 'monitor' process ..
+    trace_us_ = ::casper::app::Tracer::Now();
     [app_delegate_ startProcess: a_config
          notifyWhenStarted:^(pid_t a_pid) {
              
              (*process_) = a_pid;
              process_->WritePID();
              
-             cc::sockets::dgram::ipc::Server::GetInstance().Schedule([this]() {
-                 std::lock_guard<std::mutex> lock(mutex_);
-                 messages_.push_back(rc_object_);
-                 main_thread_dispatcher_();
-             }, /* a_timeout_ms */ 5000, /* a_recurrent */ true);
+             // ... launched, now waiting for it's 'started' status ...
+             // ( no polling, 'monitor' pushes a full list once started and events after that )
+             ::casper::app::Tracer::GetInstance().Complete("Launch", trace_us_, ::casper::app::Tracer::Now(), ::casper::app::Tracer::ThreadID(), "monitor");
+             trace_us_ = ::casper::app::Tracer::Now();
              
          }
         andWhenFinished:^(int a_code, Json::Value a_error) {
@@ -175,9 +201,7 @@ void casper::app::mac::Monitor::Start (const Json::Value& a_config,
                 message["type"]  = "error";
                 message["error"] = a_error;
                 
-                std::lock_guard<std::mutex> lock(mutex_);
-                messages_.push_back(message);
-                main_thread_dispatcher_();
+                Enqueue(message);
                                 
             }
          }
@@ -192,6 +216,8 @@ void casper::app::mac::Monitor::Start (const Json::Value& a_config,
  */
 void casper::app::mac::Monitor::Stop (bool a_soft)
 {
+    // ... pending requests won't be answered ...
+    rpc_.Stop();
     if ( nullptr != process_ ) {
         process_->Terminate(/* a_optional */ false);
     }
@@ -205,52 +231,326 @@ void casper::app::mac::Monitor::Stop (bool a_soft)
 }
 
 /**
- * @brief Process received messages;
+ * @brief Send a request to 'monitor'.
+ *
+ * @param a_op         Operation: restart, stop, signal, tail or metrics with a target, start, refresh, reload or stop without one.
+ * @param a_target     Child id, empty when operation is not about a single child.
+ * @param a_args       Operation arguments, null when none.
+ * @param a_callback   Called exactly once, from IPC or timeouts thread - never from main thread.
+ * @param a_timeout_ms For how long to wait for it's response.
+ */
+void casper::app::mac::Monitor::Call (const std::string& a_op, const std::string& a_target, const Json::Value& a_args,
+                                      const ::casper::app::RPC::Callback& a_callback, const int a_timeout_ms)
+{
+    rpc_.Call(a_op, a_target, a_args, a_timeout_ms, a_callback);
+}
+
+/**
+ * @brief Send a request to 'monitor'.
+ *
+ * @param a_op         Operation: restart, stop, signal, tail or metrics with a target, start, refresh, reload or stop without one.
+ * @param a_target     Child id, empty when operation is not about a single child.
+ * @param a_args       Operation arguments, null when none.
+ * @param a_timeout_ms For how long to wait for it's response.
+ *
+ * @return Response future, it's always ready within timeout.
+ */
+std::future<::casper::app::RPC::Response> casper::app::mac::Monitor::Call (const std::string& a_op, const std::string& a_target, const Json::Value& a_args,
+                                                                          const int a_timeout_ms)
+{
+    return rpc_.Call(a_op, a_target, a_args, a_timeout_ms);
+}
+
+/**
+ * @brief Queue a received message, main thread dispatch is only scheduled when none is pending.
+ *
+ * @param a_message Received message.
+ *
+ * @note Called by IPC thread, mutex is only locked to splice the message in - it's never held by main thread for
+ *       longer than a swap.
+ */
+void casper::app::mac::Monitor::Enqueue (const Json::Value& a_message)
+{
+    // ... copied before locking ...
+    std::list<Json::Value> message = { a_message };
+    bool                   dispatch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.splice(messages_.end(), message);
+        dispatch    = ( false == dispatched_ );
+        dispatched_ = true;
+    }
+    if ( true == dispatch ) {
+        main_thread_dispatcher_();
+    }
+}
+
+/**
+ * @brief Process all messages received so far, on main thread.
+ *
+ * @note The whole batch is taken at once, messages received meanwhile schedule a new dispatch. Only the newest list
+ *       of a batch is applied, along with events received after it - older lists and events are already reflected by it.
+ *       App delegate is called without mutex locked, running processes are set at most once for each batch of events.
+ *       Binary frames are read in place, plain JSON messages are only received when 'monitor' runs with -j.
  */
 void casper::app::mac::Monitor::ProcessReceivedMessages ()
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::list<Json::Value> batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        batch.swap(messages_);
+        dispatched_ = false;
+    }
     
     cc::sockets::dgram::ipc::Client& client = cc::sockets::dgram::ipc::Client::GetInstance();
     
-    while ( messages_.size() > 0 ) {
-
-        const Json::Value message     = messages_.front();
-        const Json::Value& type       = message["type"];
-        const char* const  type_c_str = type.asCString();
-        const Json::Value& data       = message[type_c_str];
+    typedef struct {
+        casper::app::Codec::Type  type_;
+        const Json::Value*        message_; //!< Plain JSON message, nullptr when it's a frame.
+        std::string               data_;    //!< Frame, decoded views point into it.
+        casper::app::Codec::Frame frame_;
+    } Received;
+    
+    // ... reserved, decoded views must not move ...
+    std::vector<Received> received;
+    received.reserve(batch.size());
+    
+    size_t newest = batch.size();
+    for ( const auto& message : batch ) {
+        received.push_back({ /* type_ */ casper::app::Codec::Type::List, /* message_ */ nullptr, /* data_ */ "", /* frame_ */ {} });
+        Received& entry = received.back();
+        if ( true == casper::app::Codec::Unwrap(message, entry.data_) ) {
+            if ( false == casper::app::Codec::Decode(entry.data_.c_str(), entry.data_.length(), entry.frame_) ) {
+                fprintf(stderr, "casper-application: ignored an invalid frame\n");
+                fflush(stderr);
+                received.pop_back();
+                continue;
+            }
+            entry.type_ = entry.frame_.type_;
+        } else if ( true == message["type"].isString() ) {
+            const char* const type_c_str = message["type"].asCString();
+            if ( 0 == strcasecmp("list", type_c_str) ) {
+                entry.type_ = casper::app::Codec::Type::List;
+            } else if ( 0 == strcasecmp("event", type_c_str) ) {
+                entry.type_ = casper::app::Codec::Type::Event;
+            } else if ( 0 == strcasecmp("error", type_c_str) ) {
+                entry.type_ = casper::app::Codec::Type::Error;
+            } else if ( 0 == strcasecmp("status", type_c_str) ) {
+                entry.type_ = casper::app::Codec::Type::Status;
+            } else {
+                received.pop_back();
+                continue;
+            }
+            entry.message_ = &message;
+        } else {
+            received.pop_back();
+            continue;
+        }
+        if ( casper::app::Codec::Type::List == entry.type_ ) {
+            newest = received.size() - 1;
+        }
+    }
+    
+    bool superseded = ( newest < received.size() ); // ... true while before newest list ...
+    bool changed    = false;                       // ... true when list_ changed but app delegate was not told yet ...
+    
+    const auto flush = [this, &changed] () {
+        if ( true == changed ) {
+            [app_delegate_ setRunningProcesses: list_];
+            changed = false;
+        }
+    };
+    
+    for ( size_t idx = 0 ; idx < received.size() ; ++idx ) {
         
-        if ( 0 == strcasecmp("list", type_c_str) ) {
+        Received& entry = received[idx];
+        
+        if ( newest == idx ) {
+            superseded = false;
+        }
+        
+        if ( casper::app::Codec::Type::List == entry.type_ ) {
             
-            [app_delegate_ setRunningProcesses: data];
+            if ( true == superseded ) {
+                continue;
+            }
             
-        } else if ( 0 == strcasecmp("error", type_c_str) ) {
+            // ... a full list replaces whatever was known, it already reflects all events up to it's sequence number ...
+            if ( nullptr != entry.message_ ) {
+                list_     = (*entry.message_)["list"];
+                sequence_ = entry.message_->get("sequence", 0).asUInt64();
+            } else if ( true == Load(entry.frame_) ) {
+                sequence_ = entry.frame_.sequence_;
+            } else {
+                continue;
+            }
+            synced_ = true;
+            changed = true;
             
+        } else if ( casper::app::Codec::Type::Event == entry.type_ ) {
+            
+            if ( true == superseded ) {
+                continue;
+            }
+            
+            casper::app::Codec::Change change;
+            uint64_t                   sequence;
+            bool                       known = true; // ... unknown kinds still count for sequence, but change nothing ...
+            if ( nullptr != entry.message_ ) {
+                const Json::Value& event = (*entry.message_)["event"];
+                const Json::Value& id    = event["id"];
+                known = ( true == id.isString() && true == event["kind"].isString() && true == casper::app::Codec::Parse(event["kind"].asString(), change.kind_) );
+                if ( true == known ) {
+                    change.id_ = { /* data_ */ id.asCString(), /* length_ */ strlen(id.asCString()) };
+                }
+                change.pid_    = event.get("pid", 0).asInt();
+                change.detail_ = { /* data_ */ nullptr, /* length_ */ 0 };
+                sequence       = event.get("sequence", 0).asUInt64();
+            } else if ( true == casper::app::Codec::Read(entry.frame_, change) ) {
+                sequence = entry.frame_.sequence_;
+            } else {
+                continue;
+            }
+            
+            if ( false == synced_ || sequence <= sequence_ ) {
+                // ... waiting for a full list, or already reflected by it ...
+            } else if ( sequence != sequence_ + 1 ) {
+                // ... events were lost, ask for a full list ...
+                synced_ = false;
+                try {
+                    if ( true == client.IsReady() ) {
+                        client.Send(rc_frame_);
+                    }
+                } catch (...) {
+                    // ... process is shutting down ...
+                }
+            } else {
+                sequence_ = sequence;
+                if ( true == known && true == Apply(change) ) {
+                    changed = true;
+                }
+            }
+            
+        } else if ( casper::app::Codec::Type::Error == entry.type_ ) {
+            
+            Json::Value data;
+            if ( nullptr != entry.message_ ) {
+                data = (*entry.message_)["error"];
+            } else {
+                casper::app::Codec::Failure error;
+                if ( false == casper::app::Codec::Read(entry.frame_, error) ) {
+                    continue;
+                }
+                data["no"]    = error.no_;
+                data["str"]   = Json::Value(error.str_.data_, error.str_.data_ + error.str_.length_);
+                data["msg"]   = Json::Value(error.msg_.data_, error.msg_.data_ + error.msg_.length_);
+                data["fnc"]   = Json::Value(error.fnc_.data_, error.fnc_.data_ + error.fnc_.length_);
+                data["ln"]    = error.ln_;
+                data["fatal"] = error.fatal_;
+            }
+            
+            flush();
             [app_delegate_ showError: data andRelaunch: YES];
             
-        } else if ( 0 == strcasecmp("status", type_c_str) ) {
-
-            if ( 0 == strcasecmp("started", data.asCString()) ) {
-                Json::Value message = Json::Value(Json::ValueType::objectValue);
-                message["type"]    = "control";
-                message["control"] = "start";
-                client.Send(message);
-            } else if ( 0 == strcasecmp("terminated", data.asCString()) ) {
-                client.Stop(SIGQUIT);
-                quit_callback_(message.get("error", Json::Value::null));
+        } else if ( casper::app::Codec::Type::Status == entry.type_ ) {
+            
+            std::string status;
+            if ( nullptr != entry.message_ ) {
+                status = entry.message_->get("status", "").asString();
+            } else {
+                casper::app::Codec::View value;
+                if ( false == casper::app::Codec::Read(entry.frame_, value) ) {
+                    continue;
+                }
+                status.assign(value.data_, value.length_);
             }
             
-        } else if ( 0 == strcasecmp("control", type_c_str) ) {
-            try {
-                if ( true == client.IsReady() ) {
-                    client.Send(rc_object_);
+            flush();
+            if ( 0 == strcasecmp("started", status.c_str()) ) {
+                if ( 0 != trace_us_ ) {
+                    ::casper::app::Tracer::GetInstance().Complete("Handshake", trace_us_, ::casper::app::Tracer::Now(), ::casper::app::Tracer::ThreadID(), "monitor");
+                    trace_us_ = 0;
                 }
-            } catch (...) {
-                // ... process is shutting down ...
+                casper::app::Codec codec;
+                codec.Control("start");
+                Json::Value start;
+                codec.Wrap(start);
+                client.Send(start);
+            } else if ( 0 == strcasecmp("terminated", status.c_str()) ) {
+                client.Stop(SIGQUIT);
+                // ... 'terminated' is always sent as JSON, it carries the error ...
+                quit_callback_(( nullptr != entry.message_ ? entry.message_->get("error", Json::Value::null) : Json::Value::null ));
             }
+            
+        }
+    }
+    
+    flush();
+}
+
+/**
+ * @brief Replace the most recent list with a received one.
+ *
+ * @param a_frame 'list' frame, read in place.
+ *
+ * @return True when list was replaced, false when frame is truncated - current list is kept.
+ */
+bool casper::app::mac::Monitor::Load (casper::app::Codec::Frame& a_frame)
+{
+    Json::Value                 list = Json::Value(Json::ValueType::arrayValue);
+    casper::app::Codec::Process process;
+    for ( uint32_t idx = 0 ; idx < a_frame.count_ ; ++idx ) {
+        if ( false == casper::app::Codec::Next(a_frame, process) ) {
+            return false;
         }
+        Json::Value& element = list.append(Json::Value(Json::ValueType::objectValue));
+        element["id"]   = Json::Value(process.id_.data_, process.id_.data_ + process.id_.length_);
+        element["pid"]  = process.pid_;
+        Json::Value& tree = ( element["tree"] = Json::Value(Json::ValueType::arrayValue) );
+        for ( size_t member = 0 ; member < process.tree_ ; ++member ) {
+            tree.append(casper::app::Codec::Pid(process, member));
+        }
+    }
+    list_.swap(list);
+    return true;
+}
+
+/**
+ * @brief Apply a process change to the most recent list.
+ *
+ * @param a_change Received event, it's id is a view into the received message.
+ *
+ * @return True when list changed, false otherwise.
+ */
+bool casper::app::mac::Monitor::Apply (const casper::app::Codec::Change& a_change)
+{
+    // ... restarts and crossed thresholds don't change running processes ...
+    if ( casper::app::Codec::Kind::Spawned != a_change.kind_ && casper::app::Codec::Kind::Ready != a_change.kind_ && casper::app::Codec::Kind::Exited != a_change.kind_ ) {
+        return false;
+    }
+    const int pid = ( casper::app::Codec::Kind::Exited == a_change.kind_ ? 0 : a_change.pid_ );
     
-        messages_.pop_front();
+    Json::Value* process = nullptr;
+    for ( Json::ArrayIndex idx = 0 ; idx < list_.size() ; ++idx ) {
+        const Json::Value& id = list_[idx]["id"];
+        const char*        begin;
+        const char*        end;
+        if ( true == id.isString() && true == id.getString(&begin, &end)
+                && a_change.id_.length_ == static_cast<size_t>(end - begin) && 0 == memcmp(begin, a_change.id_.data_, a_change.id_.length_) ) {
+            process = &list_[idx];
+            break;
+        }
     }
+    if ( nullptr == process ) {
+        process = &list_.append(Json::Value(Json::ValueType::objectValue));
+        (*process)["id"] = Json::Value(a_change.id_.data_, a_change.id_.data_ + a_change.id_.length_);
+    } else if ( pid == (*process).get("pid", 0).asInt() ) {
+        return false;
+    }
+    
+    // ... process tree is only known by full lists ...
+    (*process)["pid"]  = pid;
+    (*process)["tree"] = Json::Value(Json::ValueType::arrayValue);
     
+    return true;
 }
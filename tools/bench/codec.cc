@@ -0,0 +1,194 @@
+/**
+ * @file codec.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Encode + send + receive + decode cost of a running processes list, over a local datagram socket pair:
+//
+//   json             - the original { "type": "list" } message
+//   frame            - binary frame, sent as is
+//   frame, wrapped   - binary frame inside a { "type": "frame" } message, as sent by IPC transport
+//   frame -> ToJSON  - binary frame, decoded to the original message
+//
+// Usage: codec [<messages, default 20000>] [<processes per list, default 20>]
+//
+
+#include "casper/app/codec.h"
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h> // strcasecmp
+#include <unistd.h>
+
+#include <chrono>     // std::chrono
+#include <functional> // std::function
+#include <string>     // std::string
+#include <vector>     // std::vector
+
+typedef struct {
+    std::string        id_;
+    pid_t              pid_;
+    std::vector<pid_t> tree_;
+} Entry;
+
+int main (int a_argc, char** a_argv)
+{
+    const int messages  = ( a_argc > 1 ? atoi(a_argv[1]) : 20000 );
+    const int processes = ( a_argc > 2 ? atoi(a_argv[2]) : 20    );
+    if ( messages < 1 || processes < 1 ) {
+        fprintf(stderr, "usage: %s [<messages>] [<processes per list>]\n", a_argv[0]);
+        return 1;
+    }
+
+    std::vector<Entry> entries;
+    for ( int idx = 0 ; idx < processes ; ++idx ) {
+        Entry entry = { /* id_ */ "process-" + std::to_string(idx), /* pid_ */ 1000 + idx, /* tree_ */ {} };
+        for ( int member = 0 ; member < 4 ; ++member ) {
+            entry.tree_.push_back(entry.pid_ + member * 100);
+        }
+        entries.push_back(entry);
+    }
+
+    int fds[2];
+    if ( 0 != socketpair(AF_UNIX, SOCK_DGRAM, 0, fds) ) {
+        perror("socketpair");
+        return 1;
+    }
+    int size = 1 << 20;
+    (void)setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    (void)setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    std::vector<char>  rx(1 << 16);
+    std::string        payload;
+    size_t             bytes = 0;
+    uint64_t           seen  = 0;
+    casper::app::Codec codec;
+
+    // ... one datagram there and back, returns received length ...
+    const auto transfer = [&] (const std::string& a_payload) -> size_t {
+        bytes += a_payload.length();
+        if ( static_cast<ssize_t>(a_payload.length()) != send(fds[0], a_payload.data(), a_payload.length(), 0) ) {
+            return 0;
+        }
+        const ssize_t received = recv(fds[1], rx.data(), rx.size(), 0);
+        return ( received > 0 ? static_cast<size_t>(received) : 0 );
+    };
+
+    const auto encode = [&] () {
+        codec.List(/* a_sequence */ 1);
+        for ( const auto& entry : entries ) {
+            codec.Append(entry.id_, entry.pid_, entry.tree_.data(), entry.tree_.size());
+        }
+    };
+
+    const auto read = [&] (const char* const a_data, const size_t a_length) {
+        casper::app::Codec::Frame   frame;
+        casper::app::Codec::Process process;
+        if ( true == casper::app::Codec::Decode(a_data, a_length, frame) && casper::app::Codec::Type::List == frame.type_ ) {
+            while ( true == casper::app::Codec::Next(frame, process) ) {
+                seen += process.pid_ + process.id_.length_ + process.tree_;
+            }
+        }
+    };
+
+    const auto run = [&] (const char* const a_name, const std::function<void()>& a_function) {
+        bytes = 0;
+        const auto start_tp = std::chrono::steady_clock::now();
+        for ( int idx = 0 ; idx < messages ; ++idx ) {
+            a_function();
+        }
+        const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_tp).count();
+        fprintf(stdout, "%-18s %8.2f us / message, %6zu bytes / message\n", a_name, us / messages, bytes / messages);
+    };
+
+    fprintf(stdout, "%d messages, %d processes per list\n", messages, processes);
+
+    run("json", [&] () {
+        Json::Value message = Json::Value(Json::ValueType::objectValue);
+        message["type"] = "list";
+        Json::Value& list = ( message["list"] = Json::Value(Json::ValueType::arrayValue) );
+        for ( const auto& entry : entries ) {
+            Json::Value& element = list.append(Json::Value(Json::ValueType::objectValue));
+            element["id"]   = entry.id_;
+            element["pid"]  = entry.pid_;
+            element["tree"] = Json::Value(Json::ValueType::arrayValue);
+            for ( auto pid : entry.tree_ ) {
+                element["tree"].append(pid);
+            }
+        }
+        Json::FastWriter writer;
+        payload = writer.write(message);
+        const size_t length = transfer(payload);
+        Json::Reader reader;
+        Json::Value  received;
+        if ( 0 == length || false == reader.parse(rx.data(), rx.data() + length, received, false) ) {
+            return;
+        }
+        const char* const type = received["type"].asCString();
+        if ( 0 == strcasecmp("list", type) ) {
+            const Json::Value& data = received[type];
+            for ( Json::ArrayIndex idx = 0 ; idx < data.size() ; ++idx ) {
+                seen += data[idx]["pid"].asInt() + data[idx]["id"].asString().length() + data[idx]["tree"].size();
+            }
+        }
+    });
+
+    run("frame", [&] () {
+        encode();
+        const size_t length = transfer(codec.frame());
+        read(rx.data(), length);
+    });
+
+    run("frame, wrapped", [&] () {
+        encode();
+        Json::Value message;
+        codec.Wrap(message);
+        Json::FastWriter writer;
+        payload = writer.write(message);
+        const size_t length = transfer(payload);
+        Json::Reader reader;
+        Json::Value  received;
+        std::string  frame;
+        if ( 0 == length || false == reader.parse(rx.data(), rx.data() + length, received, false) ) {
+            return;
+        }
+        if ( true == casper::app::Codec::Unwrap(received, frame) ) {
+            read(frame.data(), frame.length());
+        }
+    });
+
+    run("frame -> ToJSON", [&] () {
+        encode();
+        const size_t length = transfer(codec.frame());
+        Json::Value received;
+        if ( true == casper::app::Codec::ToJSON(rx.data(), length, received) ) {
+            seen += received["list"].size();
+        }
+    });
+
+    close(fds[0]);
+    close(fds[1]);
+
+    // ... every message must have been read ...
+    return ( 0 == seen ? 1 : 0 );
+}
@@ -0,0 +1,216 @@
+/**
+ * @file reap.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Reap to notify latency of a watchdog with many children: stub children ( sleep ) are killed one at a time, from
+// the tail of the list - worst case of a linear scan - and the time until the listener is told about their exit
+// and about their replacement is measured.
+//
+// Usage: reap [<children, default 1000>] [<kills, default 200>]
+//
+
+#include "casper/app/monitor/watchdog.h"
+#include "casper/app/logger.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h> // mkdir
+
+#include <thread>             // std::thread
+#include <mutex>              // std::mutex
+#include <condition_variable> // std::condition_variable
+#include <fstream>            // std::ofstream
+#include <vector>             // std::vector
+#include <map>                // std::map
+#include <algorithm>          // std::sort
+#include <chrono>             // std::chrono
+
+/**
+ * @brief Keeps each child's most recent pid and when it last changed.
+ */
+class Listener final : public casper::app::monitor::Watchdog::Listener
+{
+
+public: // Data
+
+    std::mutex                                                   mutex_;
+    std::condition_variable                                      cv_;
+    std::map<std::string, pid_t>                                 pids_;
+    std::map<std::string, std::chrono::steady_clock::time_point> exited_tp_;
+    std::map<std::string, std::chrono::steady_clock::time_point> spawned_tp_;
+    bool volatile                                                abort_ = false;
+
+public: // Inherited Method(s) / Function(s)
+
+    virtual void OnRunningProcessesUpdated (const ::sys::Process::List& a_list, const uint64_t /* a_sequence */)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for ( auto process : a_list ) {
+            pids_[process->info().id_] = process->pid();
+        }
+        cv_.notify_all();
+    }
+
+    virtual void OnProcessChanged (const casper::app::monitor::Watchdog::Event& a_event)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if ( casper::app::monitor::Watchdog::Change::Exited == a_event.kind_ ) {
+            pids_[a_event.id_]      = 0;
+            exited_tp_[a_event.id_] = now;
+        } else if ( casper::app::monitor::Watchdog::Change::Spawned == a_event.kind_ ) {
+            pids_[a_event.id_]       = a_event.pid_;
+            spawned_tp_[a_event.id_] = now;
+        }
+        cv_.notify_all();
+    }
+
+    virtual void OnError (const ::sys::Error& a_error, const bool a_fatal)
+    {
+        fprintf(stderr, "error: %s%s\n", a_error.message().c_str(), ( true == a_fatal ? " ( fatal )" : "" ));
+    }
+
+    virtual void OnTerminated ()
+    {
+        abort_ = true;
+    }
+
+};
+
+/**
+ * @brief Print a latencies summary.
+ */
+static void Summary (const char* const a_name, std::vector<double>& a_us)
+{
+    std::sort(a_us.begin(), a_us.end());
+    double sum = 0;
+    for ( auto us : a_us ) {
+        sum += us;
+    }
+    fprintf(stdout, "%-18s mean %8.0f us, p50 %8.0f us, p99 %8.0f us, max %8.0f us\n", a_name,
+            sum / a_us.size(), a_us[a_us.size() / 2], a_us[a_us.size() * 99 / 100], a_us.back());
+}
+
+int main (int a_argc, char** a_argv)
+{
+    const int children = ( a_argc > 1 ? atoi(a_argv[1]) : 1000 );
+    const int kills    = ( a_argc > 2 ? atoi(a_argv[2]) : 200  );
+    if ( children < 10 || kills < 1 ) {
+        fprintf(stderr, "usage: %s [<children, at least 10>] [<kills>]\n", a_argv[0]);
+        return 1;
+    }
+
+    char root[] = "/tmp/casper-bench-reap-XXXXXX";
+    if ( nullptr == mkdtemp(root) ) {
+        perror("mkdtemp");
+        return 1;
+    }
+    const std::string dir = root;
+    for ( const char* sub : { "/config", "/runtime", "/logs" } ) {
+        (void)mkdir((dir + sub).c_str(), 0700);
+    }
+
+    // ... stub children, restarted as soon as they exit ...
+    {
+        std::ofstream config(dir + "/config/monitor.json");
+        config << "{ \"adopt\": false, \"children\": [\n";
+        for ( int idx = 0 ; idx < children ; ++idx ) {
+            config << ( idx > 0 ? "," : " " ) << "{ \"id\": \"c" << idx << "\", \"path\": \"/bin/\", \"executable\": \"sleep\", \"arguments\": \"1000\","
+                   << " \"working_dir\": \"" << dir << "/runtime\", \"pid_file\": \"" << dir << "/runtime/c" << idx << ".pid\","
+                   << " \"restart\": { \"policy\": \"always\", \"delay\": 0, \"jitter\": 0, \"max_retries\": -1 } }\n";
+        }
+        config << "]}\n";
+    }
+
+    Json::Value config;
+    config["directories"]["config"]  = dir + "/config/";
+    config["directories"]["runtime"] = dir + "/runtime/";
+    config["directories"]["logs"]    = dir + "/logs/";
+
+    ::casper::app::Logger::GetInstance().Startup(dir + "/logs/", "bench-reap", "0.0.0");
+
+    Listener listener;
+
+    std::thread thread([&] () {
+        // ... signals are handled by watchdog ...
+        sigset_t sigmask;
+        sigfillset(&sigmask);
+        pthread_sigmask(SIG_BLOCK, &sigmask, nullptr);
+
+        // ... until all children are running ...
+        {
+            std::unique_lock<std::mutex> lock(listener.mutex_);
+            listener.cv_.wait(lock, [&] () {
+                if ( listener.pids_.size() != static_cast<size_t>(children) ) {
+                    return false;
+                }
+                for ( const auto& it : listener.pids_ ) {
+                    if ( it.second <= 0 ) {
+                        return false;
+                    }
+                }
+                return true;
+            });
+        }
+        usleep(500 * 1000);
+
+        std::vector<double> exit_us;
+        std::vector<double> spawn_us;
+        for ( int idx = 0 ; idx < kills ; ++idx ) {
+            const std::string id = "c" + std::to_string(children - 1 - ( idx % 10 ));
+            pid_t             pid;
+            {
+                std::lock_guard<std::mutex> lock(listener.mutex_);
+                pid = listener.pids_[id];
+            }
+            const auto start_tp = std::chrono::steady_clock::now();
+            kill(pid, SIGKILL);
+            std::unique_lock<std::mutex> lock(listener.mutex_);
+            listener.cv_.wait(lock, [&] () {
+                return listener.pids_[id] > 0 && pid != listener.pids_[id] && listener.spawned_tp_[id] > start_tp;
+            });
+            exit_us.push_back(std::chrono::duration<double, std::micro>(listener.exited_tp_[id] - start_tp).count());
+            spawn_us.push_back(std::chrono::duration<double, std::micro>(listener.spawned_tp_[id] - start_tp).count());
+            lock.unlock();
+            usleep(2000);
+        }
+
+        fprintf(stdout, "%d children, %d kills\n", children, kills);
+        Summary("kill -> exited"   , exit_us);
+        Summary("kill -> respawned", spawn_us);
+        fflush(stdout);
+
+        kill(getpid(), SIGTERM);
+    });
+
+    casper::app::monitor::Watchdog::GetInstance().Start(config, /* a_detached */ false, listener, &listener.abort_);
+
+    thread.join();
+
+    const int rv = ( casper::app::monitor::Watchdog::GetInstance().IsErrorSet() ? 1 : 0 );
+
+    // ... config, pid files and logs ...
+    (void)system(("rm -rf " + dir).c_str());
+
+    return rv;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file spawn.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Per spawn latency of each way 'monitor' can start a child, measured until the child execs:
+//
+//   fork + close loop  - the original fork path, one close per possible fd
+//   fork + close_range - the fork path, Linux only
+//   posix_spawn        - the default, only when it can close inherited fds
+//
+// Usage: spawn [<spawns, default 500>] [<extra open fds, default 64>]
+//
+
+#include <spawn.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#ifndef __APPLE__
+    #include <sys/syscall.h> // syscall
+    #ifndef SYS_close_range
+        #define SYS_close_range 436
+    #endif
+#endif
+
+// ... as 'monitor', posix_spawn is only measured when it can close inherited fds ...
+#if defined(__APPLE__) || ( defined(__GLIBC__) && ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 34 ) ) )
+    #define CASPER_APP_BENCH_SPAWN_CLOSES_FDS 1
+#else
+    #define CASPER_APP_BENCH_SPAWN_CLOSES_FDS 0
+#endif
+
+#include <chrono> // std::chrono
+#include <vector> // std::vector
+
+extern char** environ;
+
+static char* const s_argv_[] = { const_cast<char*>("/bin/true"), nullptr };
+
+typedef enum {
+    ForkCloseLoop = 0,
+    ForkCloseRange,
+    PosixSpawn
+} Mode;
+
+/**
+ * @brief Start one child, as 'monitor' does, and wait until it execs.
+ *
+ * @param a_mode How to start it.
+ *
+ * @return Child pid, -1 on failure.
+ */
+static pid_t Spawn (const Mode a_mode)
+{
+    // ... exec status pipe: closed on exec ...
+    int exec_fds[2];
+    if ( -1 == pipe(exec_fds) || -1 == fcntl(exec_fds[0], F_SETFD, FD_CLOEXEC) || -1 == fcntl(exec_fds[1], F_SETFD, FD_CLOEXEC) ) {
+        return -1;
+    }
+
+    pid_t pid = -1;
+    if ( PosixSpawn == a_mode ) {
+        posix_spawn_file_actions_t actions;
+        posix_spawnattr_t          attributes;
+        (void)posix_spawn_file_actions_init(&actions);
+        (void)posix_spawnattr_init(&attributes);
+        short flags = POSIX_SPAWN_SETSIGMASK;
+#ifdef __APPLE__
+        (void)posix_spawn_file_actions_addinherit_np(&actions, STDIN_FILENO);
+        (void)posix_spawn_file_actions_addinherit_np(&actions, STDOUT_FILENO);
+        (void)posix_spawn_file_actions_addinherit_np(&actions, STDERR_FILENO);
+        flags |= POSIX_SPAWN_CLOEXEC_DEFAULT;
+#elif CASPER_APP_BENCH_SPAWN_CLOSES_FDS
+        (void)posix_spawn_file_actions_addclosefrom_np(&actions, 3);
+#endif
+        sigset_t sigmask;
+        sigemptyset(&sigmask);
+        (void)posix_spawnattr_setsigmask(&attributes, &sigmask);
+        (void)posix_spawnattr_setflags(&attributes, flags);
+        if ( 0 != posix_spawn(&pid, s_argv_[0], &actions, &attributes, s_argv_, environ) ) {
+            pid = -1;
+        }
+        (void)posix_spawnattr_destroy(&attributes);
+        (void)posix_spawn_file_actions_destroy(&actions);
+    } else {
+        pid = fork();
+        if ( 0 == pid ) {
+            bool closed = false;
+#ifndef __APPLE__
+            closed = ( ForkCloseRange == a_mode && 0 == syscall(SYS_close_range, 3U, ~0U, 1U << 2) );
+#endif
+            if ( false == closed ) {
+                const int max = getdtablesize();
+                for ( int n = 3 ; n < max ; n++ ) {
+                    if ( exec_fds[1] != n ) {
+                        close(n);
+                    }
+                }
+            }
+            setsid();
+            execve(s_argv_[0], s_argv_, environ);
+            _exit(127);
+        }
+    }
+
+    // ... until exec, as 'monitor' is blocked for ...
+    close(exec_fds[1]);
+    char byte;
+    while ( read(exec_fds[0], &byte, 1) > 0 ) {
+        // ... nothing is written on exec success ...
+    }
+    close(exec_fds[0]);
+
+    return pid;
+}
+
+/**
+ * @brief Time a number of spawns.
+ *
+ * @param a_mode   How to start each child.
+ * @param a_spawns Number of children.
+ *
+ * @return Average spawn latency in microseconds, negative on failure.
+ */
+static double Run (const Mode a_mode, const int a_spawns)
+{
+    double total_us = 0;
+    for ( int idx = 0 ; idx < a_spawns ; ++idx ) {
+        const auto  start_tp = std::chrono::steady_clock::now();
+        const pid_t pid      = Spawn(a_mode);
+        total_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_tp).count();
+        if ( -1 == pid ) {
+            return -1;
+        }
+        (void)waitpid(pid, nullptr, 0);
+    }
+    return total_us / a_spawns;
+}
+
+int main (int a_argc, char** a_argv)
+{
+    const int spawns = ( a_argc > 1 ? atoi(a_argv[1]) : 500 );
+    const int extra  = ( a_argc > 2 ? atoi(a_argv[2]) : 64  );
+
+    // ... 'monitor' keeps sockets, pipes and logs open ...
+    std::vector<int> fds;
+    for ( int idx = 0 ; idx < extra ; ++idx ) {
+        const int fd = open("/dev/null", O_RDONLY);
+        if ( -1 != fd ) {
+            fds.push_back(fd);
+        }
+    }
+
+    struct rlimit limit;
+    (void)getrlimit(RLIMIT_NOFILE, &limit);
+    fprintf(stdout, "%d spawns of %s, %zu extra open fds, fd limit %llu\n", spawns, s_argv_[0], fds.size(), static_cast<unsigned long long>(limit.rlim_cur));
+
+    const struct {
+        Mode        mode_;
+        const char* name_;
+    } modes[] = {
+        { /* mode_ */ ForkCloseLoop , /* name_ */ "fork + close loop"  },
+#ifndef __APPLE__
+        { /* mode_ */ ForkCloseRange, /* name_ */ "fork + close_range" },
+#endif
+#if CASPER_APP_BENCH_SPAWN_CLOSES_FDS
+        { /* mode_ */ PosixSpawn    , /* name_ */ "posix_spawn"        },
+#endif
+    };
+
+    int rv = 0;
+    for ( const auto& mode : modes ) {
+        const double us = Run(mode.mode_, spawns);
+        if ( us < 0 ) {
+            fprintf(stdout, "%-20s failed\n", mode.name_);
+            rv = 1;
+        } else {
+            fprintf(stdout, "%-20s %8.1f us / spawn\n", mode.name_, us);
+        }
+    }
+
+    for ( auto fd : fds ) {
+        close(fd);
+    }
+
+    return rv;
+}
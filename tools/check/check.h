@@ -0,0 +1,122 @@
+/**
+ * @file check.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_TOOLS_CHECK_CHECK_H_
+#define CASPER_APP_TOOLS_CHECK_CHECK_H_
+#pragma once
+
+#include <stdio.h>  // fprintf, perror
+#include <stdlib.h> // mkdtemp, system
+
+#include <string> // std::string
+#include <vector> // std::vector
+
+//
+// Shared by all checks, each one is a single translation unit: failed checks are counted and reported by Result(),
+// which is also the check's exit status.
+//
+
+static int s_failures_ = 0;
+
+#define CASPER_APP_CHECK(a_condition) \
+    if ( false == ( a_condition ) ) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #a_condition); \
+        s_failures_++; \
+    }
+
+/**
+ * @brief Report number of failed checks.
+ *
+ * @return Number of failed checks, to be used as exit status.
+ */
+static inline int Result ()
+{
+    fprintf(stdout, "%d check(s) failed\n", s_failures_);
+    return s_failures_;
+}
+
+/**
+ * @brief A temporary directory for a check's files, removed with all it's contents when it goes out of scope.
+ */
+class Sandbox final
+{
+
+private: // Data
+
+    std::string path_;
+
+public: // Constructor(s) / Destructor
+
+    Sandbox ()
+    {
+        /* empty */
+    }
+
+    virtual ~Sandbox ()
+    {
+        Remove();
+    }
+
+public: // Method(s) / Function(s)
+
+    /**
+     * @brief Create a new directory, /tmp/casper-<name>-XXXXXX.
+     *
+     * @param a_name Check name.
+     *
+     * @return True on success, false otherwise.
+     */
+    bool Create (const std::string& a_name)
+    {
+        const std::string tpl  = "/tmp/casper-" + a_name + "-XXXXXX";
+        std::vector<char> path(tpl.begin(), tpl.end());
+        path.push_back('\0');
+        if ( nullptr == mkdtemp(path.data()) ) {
+            perror("mkdtemp");
+            return false;
+        }
+        path_ = path.data();
+        return true;
+    }
+
+    /**
+     * @brief Remove directory and all it's contents, if any.
+     */
+    void Remove ()
+    {
+        if ( 0 == path_.length() ) {
+            return;
+        }
+        (void)system(("rm -rf " + path_).c_str());
+        path_.clear();
+    }
+
+    /**
+     * @return Directory path, without a trailing slash.
+     */
+    const std::string& path () const
+    {
+        return path_;
+    }
+
+}; // end of class 'Sandbox'
+
+#endif // CASPER_APP_TOOLS_CHECK_CHECK_H_
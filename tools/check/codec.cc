@@ -0,0 +1,214 @@
+/**
+ * @file codec.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// App <-> 'monitor' binary frames: every frame type is encoded, read back field by field, converted to JSON and
+// encoded again from it - it must be the same frame - and every truncation of it must be rejected.
+//
+// Usage: codec, exit status is the number of failed checks.
+//
+
+#include "casper/app/codec.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h> // memcpy
+
+#include <string> // std::string
+#include <vector> // std::vector
+
+/**
+ * @return True when a view holds exactly the expected value.
+ */
+static bool Equals (const casper::app::Codec::View& a_view, const char* const a_expected)
+{
+    return std::string(a_view.data_, a_view.length_) == a_expected;
+}
+
+/**
+ * @brief Check that a frame survives a JSON round trip and that it's truncations are rejected.
+ *
+ * @param a_name  Frame name, for failure messages.
+ * @param a_frame Encoded frame.
+ */
+static void RoundTrip (const char* const a_name, const std::string& a_frame)
+{
+    fprintf(stdout, "%s: %zu bytes\n", a_name, a_frame.length());
+
+    // ... frame -> JSON -> frame ...
+    Json::Value message;
+    CASPER_APP_CHECK(true == casper::app::Codec::ToJSON(a_frame.data(), a_frame.length(), message));
+    casper::app::Codec codec;
+    CASPER_APP_CHECK(true == codec.Encode(message));
+    CASPER_APP_CHECK(a_frame == codec.frame());
+
+    // ... IPC envelope ...
+    Json::Value wrapped;
+    std::string unwrapped;
+    codec.Wrap(wrapped);
+    CASPER_APP_CHECK(true == casper::app::Codec::Unwrap(wrapped, unwrapped));
+    CASPER_APP_CHECK(a_frame == unwrapped);
+
+    // ... a cut datagram: header length no longer matches ...
+    casper::app::Codec::Frame frame;
+    for ( size_t length = 0 ; length < a_frame.length() ; ++length ) {
+        if ( true == casper::app::Codec::Decode(a_frame.data(), length, frame) ) {
+            fprintf(stderr, "%s: frame cut to %zu byte(s) was accepted\n", a_name, length);
+            s_failures_++;
+        }
+    }
+
+    // ... a cut payload with a matching header length: it's contents must be rejected ...
+    for ( size_t length = 8 ; length < a_frame.length() ; ++length ) {
+        std::string    cut = a_frame.substr(0, length);
+        const uint32_t size = static_cast<uint32_t>(length - 8);
+        memcpy(&cut[4], &size, sizeof(size));
+        Json::Value ignored;
+        if ( true == casper::app::Codec::ToJSON(cut.data(), cut.length(), ignored) ) {
+            fprintf(stderr, "%s: payload cut to %u byte(s) was accepted\n", a_name, size);
+            s_failures_++;
+        }
+    }
+}
+
+int main (int /* a_argc */, char** /* a_argv */)
+{
+    casper::app::Codec codec;
+
+    // ... list ...
+    {
+        const std::vector<pid_t> first  = { 1000, 1100, 1200 };
+        const std::vector<pid_t> second = { 2000 };
+        codec.List(/* a_sequence */ 42);
+        codec.Append("first" , 1000, first.data() , first.size());
+        codec.Append("second", 2000, second.data(), second.size());
+        codec.Append("third" , 0   , nullptr      , 0);
+        const std::string encoded = codec.frame();
+
+        casper::app::Codec::Frame   frame;
+        casper::app::Codec::Process process;
+        CASPER_APP_CHECK(true == casper::app::Codec::Decode(encoded.data(), encoded.length(), frame));
+        CASPER_APP_CHECK(casper::app::Codec::Type::List == frame.type_);
+        CASPER_APP_CHECK(3 == frame.count_);
+        CASPER_APP_CHECK(42 == frame.sequence_);
+        CASPER_APP_CHECK(true == casper::app::Codec::Next(frame, process));
+        CASPER_APP_CHECK(true == Equals(process.id_, "first") && 1000 == process.pid_ && 3 == process.tree_);
+        for ( size_t idx = 0 ; idx < first.size() ; ++idx ) {
+            CASPER_APP_CHECK(first[idx] == casper::app::Codec::Pid(process, idx));
+        }
+        CASPER_APP_CHECK(true == casper::app::Codec::Next(frame, process));
+        CASPER_APP_CHECK(true == Equals(process.id_, "second") && 2000 == process.pid_ && 1 == process.tree_);
+        CASPER_APP_CHECK(2000 == casper::app::Codec::Pid(process, 0));
+        CASPER_APP_CHECK(true == casper::app::Codec::Next(frame, process));
+        CASPER_APP_CHECK(true == Equals(process.id_, "third") && 0 == process.pid_ && 0 == process.tree_);
+        CASPER_APP_CHECK(false == casper::app::Codec::Next(frame, process));
+
+        RoundTrip("list", encoded);
+    }
+
+    // ... empty list ...
+    {
+        codec.List(/* a_sequence */ 0);
+        RoundTrip("empty list", codec.frame());
+    }
+
+    // ... error ...
+    {
+        codec.Error(2, "No such file or directory", "unable to spawn 'x'", "Spawn", 123, true);
+        const std::string encoded = codec.frame();
+
+        casper::app::Codec::Frame   frame;
+        casper::app::Codec::Failure failure;
+        CASPER_APP_CHECK(true == casper::app::Codec::Decode(encoded.data(), encoded.length(), frame));
+        CASPER_APP_CHECK(true == casper::app::Codec::Read(frame, failure));
+        CASPER_APP_CHECK(2 == failure.no_ && 123 == failure.ln_ && true == failure.fatal_);
+        CASPER_APP_CHECK(true == Equals(failure.str_, "No such file or directory"));
+        CASPER_APP_CHECK(true == Equals(failure.msg_, "unable to spawn 'x'"));
+        CASPER_APP_CHECK(true == Equals(failure.fnc_, "Spawn"));
+
+        RoundTrip("error", encoded);
+    }
+
+    // ... status and control ...
+    {
+        codec.Status("started");
+        const std::string status = codec.frame();
+        codec.Control("refresh");
+        const std::string control = codec.frame();
+
+        casper::app::Codec::Frame frame;
+        casper::app::Codec::View  value;
+        CASPER_APP_CHECK(true == casper::app::Codec::Decode(status.data(), status.length(), frame));
+        CASPER_APP_CHECK(casper::app::Codec::Type::Status == frame.type_);
+        CASPER_APP_CHECK(true == casper::app::Codec::Read(frame, value) && true == Equals(value, "started"));
+        CASPER_APP_CHECK(true == casper::app::Codec::Decode(control.data(), control.length(), frame));
+        CASPER_APP_CHECK(casper::app::Codec::Type::Control == frame.type_);
+        CASPER_APP_CHECK(true == casper::app::Codec::Read(frame, value) && true == Equals(value, "refresh"));
+
+        RoundTrip("status", status);
+        RoundTrip("control", control);
+    }
+
+    // ... events, one per kind ...
+    {
+        const casper::app::Codec::Kind kinds[] = {
+            casper::app::Codec::Kind::Spawned, casper::app::Codec::Kind::Ready, casper::app::Codec::Kind::Exited,
+            casper::app::Codec::Kind::Restarting, casper::app::Codec::Kind::Threshold
+        };
+        uint64_t sequence = 0;
+        for ( const auto kind : kinds ) {
+            const std::string detail = std::string("detail of ") + casper::app::Codec::Name(kind);
+            sequence++;
+            codec.Event(sequence, kind, "child", static_cast<pid_t>(3000 + sequence), detail);
+            const std::string encoded = codec.frame();
+
+            casper::app::Codec::Frame  frame;
+            casper::app::Codec::Change change;
+            casper::app::Codec::Kind   parsed;
+            CASPER_APP_CHECK(true == casper::app::Codec::Decode(encoded.data(), encoded.length(), frame));
+            CASPER_APP_CHECK(casper::app::Codec::Type::Event == frame.type_ && sequence == frame.sequence_);
+            CASPER_APP_CHECK(true == casper::app::Codec::Read(frame, change));
+            CASPER_APP_CHECK(kind == change.kind_ && static_cast<int32_t>(3000 + sequence) == change.pid_);
+            CASPER_APP_CHECK(true == Equals(change.id_, "child") && true == Equals(change.detail_, detail.c_str()));
+            CASPER_APP_CHECK(true == casper::app::Codec::Parse(casper::app::Codec::Name(kind), parsed) && kind == parsed);
+
+            RoundTrip(casper::app::Codec::Name(kind), encoded);
+        }
+    }
+
+    // ... not frames at all ...
+    {
+        casper::app::Codec::Frame frame;
+        Json::Value               message;
+        std::string               unwrapped;
+        const std::string         text = "{\"type\":\"list\",\"list\":[]}";
+        CASPER_APP_CHECK(false == casper::app::Codec::Decode(text.data(), text.length(), frame));
+        message["type"] = "list";
+        CASPER_APP_CHECK(false == casper::app::Codec::Unwrap(message, unwrapped));
+        message["type"]  = "event";
+        message["event"] = Json::Value(Json::ValueType::objectValue);
+        message["event"]["kind"] = "unknown";
+        CASPER_APP_CHECK(false == codec.Encode(message));
+    }
+
+    return Result();
+}
@@ -0,0 +1,234 @@
+/**
+ * @file health.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Health checks of every kind, against local stand ins ( check/stubs/health.py ): healthy servers, also when their
+// reply arrives in parts, are never reported; bad replies and timeouts are reported once they fail a number of times
+// in a row; slow replies are reported once latency stays above threshold for the sustain period; a check that outlives
+// an untrack and track of it's child is not reported against the new run.
+//
+// Usage: health, exit status is the number of failed checks.
+//
+
+#include "casper/app/monitor/health.h"
+#include "casper/app/logger.h"
+
+#include "check.h"
+#include "stub.h"
+
+#include <stdio.h>
+
+#include <string>             // std::string
+#include <map>                // std::map
+#include <memory>             // std::unique_ptr
+#include <mutex>              // std::mutex
+#include <condition_variable> // std::condition_variable
+#include <chrono>             // std::chrono
+
+int main (int /* a_argc */, char** /* a_argv */)
+{
+    Sandbox sandbox;
+    if ( false == sandbox.Create("check-health") ) {
+        return 1;
+    }
+
+    ::casper::app::Logger::GetInstance().Startup(sandbox.path() + "/", "check-health", "0.0.0");
+
+    const casper::app::monitor::Health::Kind kinds[] = {
+        casper::app::monitor::Health::Kind::Redis, casper::app::monitor::Health::Kind::Beanstalkd,
+        casper::app::monitor::Health::Kind::Postgres, casper::app::monitor::Health::Kind::HTTP
+    };
+
+    // ... one stand in per kind, child id is kind name ...
+    std::map<std::string, std::unique_ptr<Stub>>               stubs;
+    std::map<std::string, casper::app::monitor::Health::Check> checks;
+    for ( const auto kind : kinds ) {
+        const std::string id = casper::app::monitor::Health::Name(kind);
+        stubs[id].reset(new Stub());
+        if ( false == stubs[id]->Start("health.py", { id }) ) {
+            fprintf(stderr, "unable to start %s stub\n", id.c_str());
+            return 1;
+        }
+        checks[id] = {
+            /* kind_           */ kind,
+            /* host_           */ "127.0.0.1",
+            /* port_           */ stubs[id]->port(),
+            /* path_           */ "/health",
+            /* interval_ms_    */ 50,
+            /* timeout_ms_     */ 250,
+            /* failures_       */ 3,
+            /* max_latency_ms_ */ 100,
+            /* sustain_ms_     */ 400
+        };
+    }
+
+    std::mutex                         mutex;
+    std::condition_variable            cv;
+    std::map<std::string, std::string> reasons;
+    bool                               hold = false; //!< When set, checks thread is held in the callback of it's next report.
+    bool                               held = false;
+
+    casper::app::monitor::Health health;
+
+    // ... until a child is reported, reasons are collected ...
+    const auto wait = [&] (const std::string& a_id, const int a_timeout_ms) -> bool {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, std::chrono::milliseconds(a_timeout_ms), [&] () {
+            std::map<std::string, std::string> collected;
+            health.Unhealthy(collected);
+            for ( const auto& it : collected ) {
+                reasons[it.first] = it.second;
+            }
+            return reasons.end() != reasons.find(a_id);
+        });
+    };
+
+    const auto contains = [&] (const std::string& a_id, const char* const a_text) -> bool {
+        const auto it = reasons.find(a_id);
+        if ( reasons.end() == it ) {
+            return false;
+        }
+        fprintf(stdout, "%s: %s\n", a_id.c_str(), it->second.c_str());
+        return std::string::npos != it->second.find(a_text);
+    };
+
+    health.Setup(checks);
+    CASPER_APP_CHECK(true == health.Start([&] () {
+        std::unique_lock<std::mutex> lock(mutex);
+        if ( true == hold ) {
+            held = true;
+            cv.notify_all();
+            cv.wait(lock, [&] () { return false == hold; });
+            held = false;
+        }
+        cv.notify_all();
+    }));
+    for ( const auto& it : checks ) {
+        health.Track(it.first);
+    }
+
+    // ... healthy, also when replies arrive in parts ...
+    CASPER_APP_CHECK(false == wait("*", 500));
+    for ( const auto& it : stubs ) {
+        CASPER_APP_CHECK(true == it.second->Send("split"));
+    }
+    CASPER_APP_CHECK(false == wait("*", 500));
+    CASPER_APP_CHECK(0 == reasons.size());
+    for ( const auto& it : stubs ) {
+        casper::app::monitor::Health::Stats stats;
+        CASPER_APP_CHECK(true == health.Copy(it.first, stats));
+        CASPER_APP_CHECK(stats.checks_ >= 10 && 0 == stats.failures_ && stats.latency_.max() > 0);
+        CASPER_APP_CHECK(true == it.second->Send("good"));
+    }
+
+    // ... bad replies, reported after 3 in a row ...
+    for ( const auto& it : stubs ) {
+        CASPER_APP_CHECK(true == it.second->Send("bad"));
+        CASPER_APP_CHECK(true == wait(it.first, 2000));
+        CASPER_APP_CHECK(true == contains(it.first, "check failed 3 time(s) in a row, unexpected reply to"));
+        CASPER_APP_CHECK(true == it.second->Send("good"));
+    }
+    CASPER_APP_CHECK(true == contains("http", "GET /health: 'HTTP/1.0 503 Service Unavailable'"));
+
+    // ... once reported, not checked until it's tracked again - as watchdog does, after it's restart ...
+    {
+        casper::app::monitor::Health::Stats before;
+        casper::app::monitor::Health::Stats after;
+        CASPER_APP_CHECK(true == health.Copy("redis", before));
+        usleep(300 * 1000);
+        CASPER_APP_CHECK(true == health.Copy("redis", after));
+        CASPER_APP_CHECK(before.checks_ == after.checks_);
+    }
+
+    // ... no reply at all ...
+    reasons.clear();
+    CASPER_APP_CHECK(true == stubs["postgres"]->Send("hang"));
+    health.Untrack("postgres");
+    health.Track("postgres");
+    CASPER_APP_CHECK(true == wait("postgres", 3000));
+    CASPER_APP_CHECK(true == contains("postgres", "check failed 3 time(s) in a row, timed out after 250 ms"));
+    CASPER_APP_CHECK(true == stubs["postgres"]->Send("good"));
+
+    // ... slow, reported only after sustain period ...
+    reasons.clear();
+    CASPER_APP_CHECK(true == stubs["redis"]->Send("slow 150"));
+    const auto slow_tp = std::chrono::steady_clock::now();
+    health.Untrack("redis");
+    health.Track("redis");
+    CASPER_APP_CHECK(true == wait("redis", 3000));
+    CASPER_APP_CHECK(std::chrono::steady_clock::now() - slow_tp >= std::chrono::milliseconds(400));
+    CASPER_APP_CHECK(true == contains("redis", "redis check latency above 100 ms for"));
+
+    // ... a fast reply in between restarts sustain period ...
+    reasons.clear();
+    CASPER_APP_CHECK(true == stubs["http"]->Send("slow 150"));
+    health.Untrack("http");
+    health.Track("http");
+    CASPER_APP_CHECK(false == wait("http", 250));
+    CASPER_APP_CHECK(true == stubs["http"]->Send("good"));
+    usleep(300 * 1000);
+    CASPER_APP_CHECK(true == stubs["http"]->Send("slow 150"));
+    CASPER_APP_CHECK(false == wait("http", 300));
+    CASPER_APP_CHECK(true == wait("http", 3000));
+
+    // ... a check that outlives an untrack and track belongs to the previous run: http and postgres time out together,
+    //     and while checks thread is held reporting http, postgres is untracked and tracked again ...
+    reasons.clear();
+    CASPER_APP_CHECK(true == stubs["http"]->Send("hang"));
+    CASPER_APP_CHECK(true == stubs["postgres"]->Send("hang"));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        hold = true;
+    }
+    health.Untrack("http");
+    health.Untrack("postgres");
+    health.Track("http");
+    health.Track("postgres");
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        CASPER_APP_CHECK(true == cv.wait_for(lock, std::chrono::milliseconds(3000), [&] () { return held; }));
+        health.Untrack("postgres");
+        health.Track("postgres");
+        hold = false;
+        cv.notify_all();
+    }
+    CASPER_APP_CHECK(true == stubs["postgres"]->Send("good"));
+    CASPER_APP_CHECK(true == wait("http", 1000));
+    CASPER_APP_CHECK(false == wait("postgres", 500));
+    CASPER_APP_CHECK(true == stubs["http"]->Send("good"));
+
+    // ... untracked children are not reported ...
+    reasons.clear();
+    health.Track("beanstalkd");
+    health.Untrack("beanstalkd");
+    CASPER_APP_CHECK(true == stubs["beanstalkd"]->Send("bad"));
+    CASPER_APP_CHECK(false == wait("beanstalkd", 500));
+
+    health.Stop();
+
+    for ( auto& it : stubs ) {
+        it.second->Stop();
+    }
+
+    sandbox.Remove();
+
+    return Result();
+}
@@ -0,0 +1,179 @@
+/**
+ * @file scaler.cc
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//
+// Beanstalkd load signal and pool scaling, against a local beanstalkd stand in ( check/stubs/beanstalkd.py ):
+// stats-tube replies are read as ready + reserved jobs, a missing tube is no load, any other reply is an error,
+// and pools grow at once but shrink only after their cooldown.
+//
+// Usage: scaler, exit status is the number of failed checks.
+//
+
+#include "casper/app/monitor/scaler.h"
+#include "casper/app/logger.h"
+
+#include "check.h"
+#include "stub.h"
+
+#include <stdio.h>
+
+#include <string>             // std::string
+#include <map>                // std::map
+#include <mutex>              // std::mutex
+#include <condition_variable> // std::condition_variable
+#include <chrono>             // std::chrono
+
+int main (int /* a_argc */, char** /* a_argv */)
+{
+    Sandbox sandbox;
+    if ( false == sandbox.Create("check-scaler") ) {
+        return 1;
+    }
+
+    ::casper::app::Logger::GetInstance().Startup(sandbox.path() + "/", "check-scaler", "0.0.0");
+
+    Stub stub;
+    if ( false == stub.Start("beanstalkd.py", {}) ) {
+        fprintf(stderr, "unable to start beanstalkd stub\n");
+        return 1;
+    }
+
+    const casper::app::monitor::Gauge::Config config = {
+        /* kind_       */ casper::app::monitor::Gauge::Kind::Beanstalkd,
+        /* host_       */ "127.0.0.1",
+        /* port_       */ stub.port(),
+        /* tube_       */ "jobs",
+        /* timeout_ms_ */ 1000
+    };
+
+    // ... gauge ...
+    {
+        casper::app::monitor::Gauge* gauge = casper::app::monitor::Gauge::New(config);
+        double                       value = -1;
+
+        CASPER_APP_CHECK(true == stub.Send("ready 30 5"));
+        CASPER_APP_CHECK(true == gauge->Read(value) && 35 == value);
+
+        // ... reply split across many reads ...
+        CASPER_APP_CHECK(true == stub.Send("split"));
+        value = -1;
+        CASPER_APP_CHECK(true == gauge->Read(value) && 35 == value);
+        CASPER_APP_CHECK(true == stub.Send("split"));
+
+        // ... a tube only exists while it's being used or watched ...
+        CASPER_APP_CHECK(true == stub.Send("missing"));
+        value = -1;
+        CASPER_APP_CHECK(true == gauge->Read(value) && 0 == value);
+
+        CASPER_APP_CHECK(true == stub.Send("bad"));
+        CASPER_APP_CHECK(false == gauge->Read(value));
+        CASPER_APP_CHECK(std::string::npos != gauge->error().message().find("unexpected beanstalkd reply to stats-tube"));
+
+        CASPER_APP_CHECK(true == stub.Send("partial"));
+        CASPER_APP_CHECK(false == gauge->Read(value));
+        CASPER_APP_CHECK(std::string::npos != gauge->error().message().find("unexpected beanstalkd reply to stats-tube"));
+
+        delete gauge;
+
+        // ... nothing listening ...
+        casper::app::monitor::Gauge::Config closed = config;
+        closed.port_ = 1;
+        gauge = casper::app::monitor::Gauge::New(closed);
+        CASPER_APP_CHECK(false == gauge->Read(value));
+        delete gauge;
+    }
+
+    // ... scaler ...
+    {
+        std::mutex                    mutex;
+        std::condition_variable       cv;
+        std::map<std::string, size_t> sizes;
+
+        casper::app::monitor::Scaler scaler;
+
+        const auto wait = [&] (const size_t a_size, const int a_timeout_ms) -> bool {
+            std::unique_lock<std::mutex> lock(mutex);
+            return cv.wait_for(lock, std::chrono::milliseconds(a_timeout_ms), [&] () {
+                scaler.Sizes(sizes);
+                return a_size == sizes["workers"];
+            });
+        };
+
+        CASPER_APP_CHECK(true == stub.Send("ready 0"));
+
+        scaler.Setup({
+            { "workers", {
+                /* min_          */ 1,
+                /* max_          */ 5,
+                /* scaled_       */ true,
+                /* gauge_        */ config,
+                /* per_instance_ */ 10,
+                /* interval_ms_  */ 50,
+                /* cooldown_ms_  */ 600
+            } }
+        }, { { "workers", 1 } });
+        scaler.Start([&] () {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        });
+
+        // ... 35 jobs, 10 per instance ...
+        CASPER_APP_CHECK(true == stub.Send("ready 35"));
+        const auto grow_tp = std::chrono::steady_clock::now();
+        CASPER_APP_CHECK(true == wait(4, 1000));
+        CASPER_APP_CHECK(std::chrono::steady_clock::now() - grow_tp < std::chrono::milliseconds(500));
+
+        // ... never above max ...
+        CASPER_APP_CHECK(true == stub.Send("ready 1000"));
+        CASPER_APP_CHECK(true == wait(5, 1000));
+
+        // ... shrink only after cooldown, to the highest size required meanwhile ...
+        CASPER_APP_CHECK(true == stub.Send("ready 0"));
+        const auto low_tp = std::chrono::steady_clock::now();
+        CASPER_APP_CHECK(false == wait(1, 300));
+        CASPER_APP_CHECK(true == stub.Send("ready 12"));
+        usleep(200 * 1000);
+        CASPER_APP_CHECK(true == stub.Send("ready 0"));
+        CASPER_APP_CHECK(true == wait(2, 2000));
+        CASPER_APP_CHECK(std::chrono::steady_clock::now() - low_tp >= std::chrono::milliseconds(600));
+        CASPER_APP_CHECK(true == wait(1, 2000));
+
+        // ... a failed reading keeps current size ...
+        CASPER_APP_CHECK(true == stub.Send("ready 35"));
+        CASPER_APP_CHECK(true == wait(4, 1000));
+        CASPER_APP_CHECK(true == stub.Send("bad"));
+        CASPER_APP_CHECK(false == wait(1, 1000));
+        scaler.Sizes(sizes);
+        CASPER_APP_CHECK(4 == sizes["workers"]);
+
+        // ... a missing tube is no load ...
+        CASPER_APP_CHECK(true == stub.Send("missing"));
+        CASPER_APP_CHECK(true == wait(1, 2000));
+
+        scaler.Stop();
+    }
+
+    stub.Stop();
+
+    sandbox.Remove();
+
+    return Result();
+}
@@ -0,0 +1,178 @@
+/**
+ * @file stub.h
+ *
+ * Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+ *
+ * This file is part of casper-app.
+ *
+ * casper-app is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * casper-app is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with casper.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CASPER_APP_TOOLS_CHECK_STUB_H_
+#define CASPER_APP_TOOLS_CHECK_STUB_H_
+#pragma once
+
+#include <signal.h>   // kill
+#include <stdio.h>    // fdopen, fgets
+#include <stdlib.h>   // atoi, getenv
+#include <string.h>   // strncmp
+#include <unistd.h>   // fork, execvp, pipe
+#include <sys/wait.h> // waitpid
+
+#include <string> // std::string
+#include <vector> // std::vector
+
+/**
+ * @brief A local server stand in, a python script from tools/check/stubs, driven by lines written to it's stdin.
+ *
+ * Scripts write their listening port when ready and 'ok' after each line is applied.
+ */
+class Stub final
+{
+
+private: // Data
+
+    pid_t pid_;
+    FILE* in_;   //!< Script's stdin.
+    FILE* out_;  //!< Script's stdout.
+    int   port_;
+
+public: // Constructor(s) / Destructor
+
+    Stub ()
+    {
+        pid_  = -1;
+        in_   = nullptr;
+        out_  = nullptr;
+        port_ = -1;
+    }
+
+    virtual ~Stub ()
+    {
+        Stop();
+    }
+
+public: // Method(s) / Function(s)
+
+    /**
+     * @brief Start a stub script and wait until it's listening.
+     *
+     * @param a_script    Script, relative to tools/check/stubs, override that directory with STUBS_DIR.
+     * @param a_arguments Script arguments.
+     *
+     * @return True on success, false otherwise.
+     */
+    bool Start (const std::string& a_script, const std::vector<std::string>& a_arguments)
+    {
+        const char* const dir    = getenv("STUBS_DIR");
+        const std::string script = std::string(nullptr != dir ? dir : "check/stubs") + "/" + a_script;
+
+        std::vector<char*> argv = { const_cast<char*>("python3"), const_cast<char*>(script.c_str()) };
+        for ( const auto& argument : a_arguments ) {
+            argv.push_back(const_cast<char*>(argument.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        int in_fds[2];
+        int out_fds[2];
+        if ( 0 != pipe(in_fds) ) {
+            return false;
+        }
+        if ( 0 != pipe(out_fds) ) {
+            close(in_fds[0]);
+            close(in_fds[1]);
+            return false;
+        }
+
+        pid_ = fork();
+        if ( 0 == pid_ ) {
+            dup2(in_fds[0], STDIN_FILENO);
+            dup2(out_fds[1], STDOUT_FILENO);
+            close(in_fds[0]);
+            close(in_fds[1]);
+            close(out_fds[0]);
+            close(out_fds[1]);
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+        close(in_fds[0]);
+        close(out_fds[1]);
+        if ( -1 == pid_ ) {
+            close(in_fds[1]);
+            close(out_fds[0]);
+            return false;
+        }
+        in_  = fdopen(in_fds[1], "w");
+        out_ = fdopen(out_fds[0], "r");
+
+        char line[64];
+        if ( nullptr == fgets(line, sizeof(line), out_) ) {
+            Stop();
+            return false;
+        }
+        port_ = atoi(line);
+
+        return ( port_ > 0 );
+    }
+
+    /**
+     * @brief Change stub behavior.
+     *
+     * @param a_line One of the lines the script understands.
+     *
+     * @return True when it was applied, false otherwise.
+     */
+    bool Send (const std::string& a_line)
+    {
+        if ( nullptr == in_ ) {
+            return false;
+        }
+        fprintf(in_, "%s\n", a_line.c_str());
+        fflush(in_);
+        char line[64];
+        return ( nullptr != fgets(line, sizeof(line), out_) && 0 == strncmp(line, "ok", 2) );
+    }
+
+    /**
+     * @brief Stop stub script, by closing it's stdin.
+     */
+    void Stop ()
+    {
+        if ( nullptr != in_ ) {
+            fclose(in_);
+            in_ = nullptr;
+        }
+        if ( nullptr != out_ ) {
+            fclose(out_);
+            out_ = nullptr;
+        }
+        if ( pid_ > 0 ) {
+            // ... a connection might still be served, it's not worth waiting for it ...
+            kill(pid_, SIGTERM);
+            (void)waitpid(pid_, nullptr, 0);
+            pid_ = -1;
+        }
+    }
+
+    /**
+     * @return Listening port.
+     */
+    int port () const
+    {
+        return port_;
+    }
+
+}; // end of class 'Stub'
+
+#endif // CASPER_APP_TOOLS_CHECK_STUB_H_
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+#
+# @file beanstalkd.py
+#
+# Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+#
+# This file is part of casper-app.
+#
+# casper-app is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# casper-app is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with casper.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+#
+# Local beanstalkd stand in, only 'stats-tube <tube>' is answered.
+#
+# Usage: beanstalkd.py [<port, default 0 - any>]
+#
+# Listening port is written to stdout, then it's reply is driven by lines read from stdin:
+#
+#   ready <n> [<reserved>] - tube exists, with <n> ready and <reserved> reserved jobs
+#   missing                - NOT_FOUND, tube does not exist
+#   bad                    - a reply that is not OK nor NOT_FOUND
+#   partial                - OK, but without current-jobs-reserved
+#   split                  - toggle sending replies one byte at a time
+#
+# It exits when stdin is closed.
+#
+
+import socket
+import sys
+import threading
+import time
+
+state = { 'mode': 'ready', 'ready': 0, 'reserved': 0, 'split': False }
+lock  = threading.Lock()
+
+
+def reply(tube):
+    with lock:
+        mode, ready, reserved = state['mode'], state['ready'], state['reserved']
+    if 'missing' == mode:
+        return b'NOT_FOUND\r\n'
+    if 'bad' == mode:
+        return b'INTERNAL_ERROR\r\n'
+    body = '---\nname: %s\ncurrent-jobs-urgent: 0\ncurrent-jobs-ready: %d\n' % (tube, ready)
+    if 'partial' != mode:
+        body += 'current-jobs-reserved: %d\ncurrent-jobs-delayed: 0\n' % reserved
+    body = body.encode()
+    return b'OK %d\r\n' % len(body) + body + b'\r\n'
+
+
+def serve(connection):
+    with connection:
+        stream = connection.makefile('rb')
+        for line in stream:
+            parts = line.split()
+            if 2 != len(parts) or b'stats-tube' != parts[0]:
+                connection.sendall(b'UNKNOWN_COMMAND\r\n')
+                continue
+            data = reply(parts[1].decode())
+            with lock:
+                split = state['split']
+            if split:
+                for idx in range(len(data)):
+                    connection.sendall(data[idx:idx + 1])
+                    time.sleep(0.001)
+            else:
+                connection.sendall(data)
+
+
+def accept(server):
+    while True:
+        connection, _ = server.accept()
+        threading.Thread(target=serve, args=(connection,), daemon=True).start()
+
+
+def main():
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(('127.0.0.1', int(sys.argv[1]) if len(sys.argv) > 1 else 0))
+    server.listen(16)
+    threading.Thread(target=accept, args=(server,), daemon=True).start()
+
+    print(server.getsockname()[1], flush=True)
+
+    for line in sys.stdin:
+        parts = line.split()
+        if 0 == len(parts):
+            continue
+        with lock:
+            if 'ready' == parts[0]:
+                state['mode']     = 'ready'
+                state['ready']    = int(parts[1])
+                state['reserved'] = int(parts[2]) if len(parts) > 2 else 0
+            elif parts[0] in ('missing', 'bad', 'partial'):
+                state['mode'] = parts[0]
+            elif 'split' == parts[0]:
+                state['split'] = not state['split']
+        # ... acknowledged, new replies are already in effect ...
+        print('ok', flush=True)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+#
+# @file health.py
+#
+# Copyright (c) 2011-2019 Cloudware S.A. All rights reserved.
+#
+# This file is part of casper-app.
+#
+# casper-app is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Affero General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# casper-app is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with casper.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+#
+# Local stand in of a server 'monitor' health checks talk to, it answers one request per connection.
+#
+# Usage: health.py redis|beanstalkd|postgres|http [<port, default 0 - any>]
+#
+# Listening port is written to stdout, then it's behavior is driven by lines read from stdin:
+#
+#   good       - expected reply, at once
+#   slow <ms>  - expected reply, after <ms>
+#   hang       - no reply at all
+#   bad        - an unexpected reply
+#   split      - expected reply, in two parts
+#
+# It exits when stdin is closed.
+#
+
+import socket
+import sys
+import threading
+import time
+
+GOOD = {
+    'redis'      : b'+PONG\r\n',
+    'beanstalkd' : b'OK 30\r\n---\ncurrent-jobs-ready: 0\n...\n\r\n',
+    'postgres'   : b'N',
+    'http'       : b'HTTP/1.0 200 OK\r\nContent-Length: 0\r\n\r\n'
+}
+
+BAD = {
+    'redis'      : b'-ERR unknown command\r\n',
+    'beanstalkd' : b'INTERNAL_ERROR\r\n',
+    'postgres'   : b'E',
+    'http'       : b'HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n'
+}
+
+kind  = sys.argv[1]
+state = { 'mode': 'good', 'delay': 0.0 }
+lock  = threading.Lock()
+
+
+def serve(connection):
+    with connection:
+        try:
+            connection.recv(4096)
+            with lock:
+                mode, delay = state['mode'], state['delay']
+            if 'hang' == mode:
+                time.sleep(60)
+            elif 'bad' == mode:
+                connection.sendall(BAD[kind])
+            elif 'split' == mode and len(GOOD[kind]) > 1:
+                half = len(GOOD[kind]) // 2
+                connection.sendall(GOOD[kind][:half])
+                time.sleep(0.01)
+                connection.sendall(GOOD[kind][half:])
+            else:
+                time.sleep(delay)
+                connection.sendall(GOOD[kind])
+            # ... until peer is done with it ...
+            connection.recv(4096)
+        except OSError:
+            pass
+
+
+def accept(server):
+    while True:
+        connection, _ = server.accept()
+        threading.Thread(target=serve, args=(connection,), daemon=True).start()
+
+
+def main():
+    if kind not in GOOD:
+        sys.exit('unknown kind: %s' % kind)
+
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(('127.0.0.1', int(sys.argv[2]) if len(sys.argv) > 2 else 0))
+    server.listen(16)
+    threading.Thread(target=accept, args=(server,), daemon=True).start()
+
+    print(server.getsockname()[1], flush=True)
+
+    for line in sys.stdin:
+        parts = line.split()
+        if 0 == len(parts):
+            continue
+        with lock:
+            if parts[0] in ('good', 'hang', 'bad', 'split'):
+                state['mode']  = parts[0]
+                state['delay'] = 0.0
+            elif 'slow' == parts[0]:
+                state['mode']  = 'slow'
+                state['delay'] = int(parts[1]) / 1000.0
+        # ... acknowledged, new connections already see it ...
+        print('ok', flush=True)
+
+
+if __name__ == '__main__':
+    main()